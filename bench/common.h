@@ -0,0 +1,44 @@
+// Helpers shared by the benchmark, regression and replay tools.
+#pragma once
+
+#include <sgg/graphics.h>
+#include <chrono>
+#include <vector>
+
+// Draws up to `count` frames (or until the window loop ends, if `count` is 0) with the frame profiler enabled, and
+// returns the statistics of each one. GPU times arrive a few frames late, so they are merged in from the profiler
+// history as it fills up, and a few more, unmeasured, frames are drawn at the end to collect those of the last ones.
+// If `elapsed` is given, it receives the wall-clock time of the measured frames in seconds.
+inline std::vector<graphics::FrameStats> profileFrames(unsigned int count, double * elapsed = nullptr)
+{
+	// enabling the profiler discards the frames drawn so far.
+	graphics::setProfiling(true);
+	std::vector<graphics::FrameStats> frames, history;
+	auto collectGPUTimes = [&]()
+	{
+		graphics::getFrameStatsHistory(history);
+		for (const graphics::FrameStats & stats : history)
+			if (stats.frame < frames.size())
+				frames[stats.frame].gpu_time = stats.gpu_time;
+	};
+
+	graphics::FrameStats stats;
+	bool running = true;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; count == 0 || i < count; i++)
+	{
+		if (!(running = graphics::runFrames(1)))
+			break;
+		if (graphics::getFrameStats(stats))
+			frames.push_back(stats);
+		if (frames.size() % 128 == 0)
+			collectGPUTimes();
+	}
+	if (elapsed)
+		*elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (running)
+		graphics::runFrames(4);
+	collectGPUTimes();
+	graphics::setProfiling(false);
+	return frames;
+}
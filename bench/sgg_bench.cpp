@@ -0,0 +1,304 @@
+// End-to-end rendering benchmarks: draws synthetic scenes of increasing size in a headless window and reports the
+// frame rate, the CPU and GPU time per frame and the workload counters of the frame profiler.
+//
+// usage: sgg_bench [--scenario name|all] [--n counts] [--frames count] [--warmup count]
+//                  [--renderer opengl|vulkan|software] [--format json|csv] [--output file] [--assets dir]
+//
+// --n is a comma-separated list of primitive counts to sweep (default 100,1000,10000).
+// --assets is the directory holding the bitmaps, font and sound of the demo (default "assets").
+// The results are written to the standard output, unless --output is given.
+
+#include <bench/common.h>
+#include <sgg/graphics.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const float canvas_width = 1000.0f;
+static const float canvas_height = 1000.0f;
+
+struct Options
+{
+	std::string scenario = "all";
+	std::vector<unsigned int> counts = { 100, 1000, 10000 };
+	unsigned int frames = 200;
+	unsigned int warmup = 20;
+	graphics::renderer_t renderer = graphics::RENDERER_AUTO;
+	std::string format = "json";
+	std::string output;
+	std::string assets = "assets";
+};
+
+// the per-primitive parameters of a scene, generated up front so that generating them is not measured.
+struct Primitive
+{
+	float x, y, size, angle;
+	graphics::Brush brush;
+};
+
+struct Scenario
+{
+	const char * name;
+	std::function<void(const std::vector<Primitive> & primitives, unsigned int frame)> draw;
+};
+
+struct Result
+{
+	std::string scenario;
+	unsigned int n = 0;
+	unsigned int frames = 0;
+	double fps = 0.0;
+	double cpu_ms = 0.0;
+	double draw_ms = 0.0;
+	double gpu_ms = -1.0;
+	double draw_calls = 0.0;
+	double vertices = 0.0;
+	double texture_binds = 0.0;
+};
+
+// a fixed-seed generator, so that every run draws the same scenes.
+static float random01(uint32_t & state)
+{
+	state = state * 1664525u + 1013904223u;
+	return (state >> 8) / 16777216.0f;
+}
+
+static std::vector<Primitive> generate(unsigned int n, const std::vector<std::string> & textures)
+{
+	std::vector<Primitive> primitives(n);
+	uint32_t state = 12345;
+	for (unsigned int i = 0; i < n; i++)
+	{
+		Primitive & p = primitives[i];
+		p.x = random01(state) * canvas_width;
+		p.y = random01(state) * canvas_height;
+		p.size = 5.0f + random01(state) * 45.0f;
+		p.angle = random01(state) * 360.0f;
+		for (int c = 0; c < 3; c++)
+			p.brush.fill_color[c] = p.brush.outline_color[c] = random01(state);
+		p.brush.fill_opacity = 0.5f + 0.5f * random01(state);
+		p.brush.outline_opacity = 0.0f;
+		if (!textures.empty())
+			p.brush.texture = textures[i % textures.size()];
+	}
+	return primitives;
+}
+
+static std::vector<Scenario> makeScenarios(const Options & options)
+{
+	std::string sound = options.assets + "/hit1.wav";
+	return {
+		{ "rects", [](const std::vector<Primitive> & primitives, unsigned int)
+		{
+			for (const Primitive & p : primitives)
+				graphics::drawRect(p.x, p.y, p.size, p.size, p.brush);
+		} },
+		{ "disks", [](const std::vector<Primitive> & primitives, unsigned int)
+		{
+			// disks and sectors alternate, to exercise both tessellations.
+			for (size_t i = 0; i < primitives.size(); i++)
+			{
+				const Primitive & p = primitives[i];
+				if (i % 2)
+					graphics::drawSector(p.x, p.y, p.size * 0.5f, p.size, p.angle, p.angle + 120.0f, p.brush);
+				else
+					graphics::drawDisk(p.x, p.y, p.size * 0.5f, p.brush);
+			}
+		} },
+		{ "lines", [](const std::vector<Primitive> & primitives, unsigned int)
+		{
+			for (const Primitive & p : primitives)
+				graphics::drawLine(p.x, p.y, p.x + p.size, p.y + p.size * 0.5f, p.brush);
+		} },
+		{ "text", [](const std::vector<Primitive> & primitives, unsigned int frame)
+		{
+			// the last string changes every frame, so that text caching does not hide the cost of laying out text.
+			for (const Primitive & p : primitives)
+				graphics::drawText(p.x, p.y, 20.0f, "sgg bench 0123", p.brush);
+			if (!primitives.empty())
+				graphics::drawText(10.0f, 30.0f, 20.0f, "frame " + std::to_string(frame), primitives.front().brush);
+		} },
+		{ "mixed_textures", [](const std::vector<Primitive> & primitives, unsigned int)
+		{
+			// consecutive rects use different bitmaps, so that every draw switches textures.
+			for (const Primitive & p : primitives)
+				graphics::drawRect(p.x, p.y, p.size, p.size, p.brush);
+		} },
+		{ "audio", [sound](const std::vector<Primitive> & primitives, unsigned int)
+		{
+			// one sound is triggered for every 100 primitives, on top of drawing them as plain rects.
+			for (size_t i = 0; i < primitives.size(); i++)
+			{
+				const Primitive & p = primitives[i];
+				graphics::drawRect(p.x, p.y, p.size, p.size, p.brush);
+				if (i % 100 == 0)
+					graphics::playSound(sound, 0.1f);
+			}
+		} }
+	};
+}
+
+static bool parseOptions(int argc, char ** argv, Options & options)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string option = argv[i], value = argv[i + 1];
+		if (option == "--scenario")
+			options.scenario = value;
+		else if (option == "--n")
+		{
+			options.counts.clear();
+			std::stringstream list(value);
+			std::string count;
+			while (std::getline(list, count, ','))
+				options.counts.push_back((unsigned int)std::stoul(count));
+		}
+		else if (option == "--frames")
+			options.frames = std::max(1u, (unsigned int)std::stoul(value));
+		else if (option == "--warmup")
+			options.warmup = (unsigned int)std::stoul(value);
+		else if (option == "--renderer")
+			options.renderer = value == "software" ? graphics::RENDERER_SOFTWARE : value == "vulkan" ? graphics::RENDERER_VULKAN : graphics::RENDERER_OPENGL;
+		else if (option == "--format" && (value == "json" || value == "csv"))
+			options.format = value;
+		else if (option == "--output")
+			options.output = value;
+		else if (option == "--assets")
+			options.assets = value;
+		else
+			return false;
+	}
+	return (argc % 2) == 1;
+}
+
+static Result run(const Scenario & scenario, const std::vector<Primitive> & primitives, const Options & options)
+{
+	unsigned int frame = 0;
+	graphics::setDrawFunction([&]() { scenario.draw(primitives, frame++); });
+	graphics::runFrames(options.warmup);
+
+	double elapsed = 0.0;
+	std::vector<graphics::FrameStats> frames = profileFrames(options.frames, &elapsed);
+	graphics::setDrawFunction(nullptr);
+
+	Result result;
+	result.scenario = scenario.name;
+	result.n = (unsigned int)primitives.size();
+	result.frames = (unsigned int)frames.size();
+	if (frames.empty())
+		return result;
+	result.fps = frames.size() / elapsed;
+	double gpu_ms = 0.0;
+	unsigned int gpu_frames = 0;
+	for (const graphics::FrameStats & f : frames)
+	{
+		result.cpu_ms += f.cpu_time[graphics::PROFILE_FRAME];
+		result.draw_ms += f.cpu_time[graphics::PROFILE_DRAW];
+		result.draw_calls += f.draw_calls;
+		result.vertices += f.vertices;
+		result.texture_binds += f.texture_binds;
+		if (f.gpu_time >= 0.0f)
+		{
+			gpu_ms += f.gpu_time;
+			gpu_frames++;
+		}
+	}
+	result.cpu_ms /= frames.size();
+	result.draw_ms /= frames.size();
+	result.draw_calls /= frames.size();
+	result.vertices /= frames.size();
+	result.texture_binds /= frames.size();
+	if (gpu_frames)
+		result.gpu_ms = gpu_ms / gpu_frames;
+	return result;
+}
+
+static void writeResults(std::ostream & out, const std::vector<Result> & results, const Options & options)
+{
+	const char * renderer = graphics::getRenderer() == graphics::RENDERER_SOFTWARE ? "software" : graphics::getRenderer() == graphics::RENDERER_VULKAN ? "vulkan" : "opengl";
+	if (options.format == "csv")
+	{
+		out << "renderer,scenario,n,frames,fps,cpu_ms,draw_ms,gpu_ms,draw_calls,vertices,texture_binds\n";
+		for (const Result & r : results)
+			out << renderer << "," << r.scenario << "," << r.n << "," << r.frames << "," << r.fps << "," << r.cpu_ms << ","
+				<< r.draw_ms << "," << r.gpu_ms << "," << r.draw_calls << "," << r.vertices << "," << r.texture_binds << "\n";
+		return;
+	}
+
+	out << "{\n  \"renderer\": \"" << renderer << "\",\n  \"frames\": " << options.frames << ",\n  \"warmup\": " << options.warmup
+		<< ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result & r = results[i];
+		out << "    { \"scenario\": \"" << r.scenario << "\", \"n\": " << r.n << ", \"frames\": " << r.frames
+			<< ", \"fps\": " << r.fps << ", \"cpu_ms\": " << r.cpu_ms << ", \"draw_ms\": " << r.draw_ms
+			<< ", \"gpu_ms\": " << r.gpu_ms << ", \"draw_calls\": " << r.draw_calls << ", \"vertices\": " << r.vertices
+			<< ", \"texture_binds\": " << r.texture_binds << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+}
+
+int main(int argc, char ** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cout << "usage: " << argv[0] << " [--scenario name|all] [--n counts] [--frames count] [--warmup count]\n"
+			<< "       [--renderer opengl|vulkan|software] [--format json|csv] [--output file] [--assets dir]\n";
+		return 1;
+	}
+
+	std::vector<Scenario> scenarios = makeScenarios(options);
+	if (options.scenario != "all" && std::none_of(scenarios.begin(), scenarios.end(),
+		[&](const Scenario & s) { return options.scenario == s.name; }))
+	{
+		std::cout << "Unknown scenario " << options.scenario << "\n";
+		return 1;
+	}
+
+	if (!graphics::createHeadlessWindow(1024, 1024, options.renderer))
+		return 1;
+	graphics::setCanvasSize(canvas_width, canvas_height);
+	graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
+	graphics::setFont(options.assets + "/orange juice 2.0.ttf");
+	// loading assets and initializing audio are startup costs, not part of the measurements.
+	graphics::preloadBitmaps(options.assets);
+	graphics::initSubsystems(graphics::SUBSYSTEM_ALL, false);
+
+	const std::vector<std::string> single_texture = { options.assets + "/iron.png" };
+	const std::vector<std::string> mixed_textures = { options.assets + "/iron.png", options.assets + "/boy2.png" };
+	std::vector<Result> results;
+	for (const Scenario & scenario : scenarios)
+	{
+		if (options.scenario != "all" && options.scenario != scenario.name)
+			continue;
+		std::string name = scenario.name;
+		for (unsigned int n : options.counts)
+		{
+			std::vector<Primitive> primitives = generate(n, name == "rects" ? single_texture :
+				name == "mixed_textures" ? mixed_textures : std::vector<std::string>());
+			results.push_back(run(scenario, primitives, options));
+			std::cerr << scenario.name << " n=" << n << ": " << results.back().fps << " frames/s\n";
+		}
+	}
+	graphics::destroyWindow();
+
+	if (options.output.empty())
+	{
+		writeResults(std::cout, results, options);
+		return 0;
+	}
+	std::ofstream out(options.output);
+	if (!out)
+	{
+		std::cout << "Unable to write " << options.output << "\n";
+		return 1;
+	}
+	writeResults(out, results, options);
+	return 0;
+}
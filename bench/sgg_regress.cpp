@@ -0,0 +1,401 @@
+// Golden-image and performance regression checks: renders a set of canonical scenes in a headless window, compares
+// each frame to a stored golden image and compares the timings and workload counters of the scenes to a baseline.
+//
+// usage: sgg_regress [--golden dir] [--update] [--renderer opengl|vulkan|software] [--tolerance levels] [--max-diff percent]
+//                    [--threshold percent] [--frames count] [--assets dir]
+//
+// The golden images and the baseline are kept per renderer, in <golden dir>/<renderer>/<scene>.png and
+// <golden dir>/<renderer>/baseline.csv (default golden dir: bench/golden). --update renders the scenes and
+// overwrites the golden images and the baseline, e.g. after an intended change of the output or on a new machine.
+//
+// A scene fails its image check if more than --max-diff percent of its pixels (default 0.1) differ from the golden
+// image by more than --tolerance levels (default 8 of 255) in any channel; a <scene>_diff.png highlighting the
+// differing pixels is then written next to the golden image. A scene fails its performance check if its mean CPU
+// frame time exceeds the baseline by more than --threshold percent (default 25), or if any of its draw call, vertex
+// or texture bind counts exceed the baseline, as these are deterministic.
+// The exit code is 0 if all checks passed, 1 otherwise. A renderer without a golden directory is reported as not
+// configured and skipped, with exit code 0; bench/golden holds the goldens of the software renderer.
+
+#include <bench/common.h>
+#include <sgg/graphics.h>
+#include <sgg/lodepng.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const int window_size = 512;
+
+struct Options
+{
+	std::string golden = "bench/golden";
+	bool update = false;
+	graphics::renderer_t renderer = graphics::RENDERER_AUTO;
+	int tolerance = 8;
+	float max_diff = 0.1f;
+	float threshold = 25.0f;
+	unsigned int frames = 100;
+	std::string assets = "assets";
+};
+
+struct Scene
+{
+	const char * name;
+	std::function<void()> draw;
+};
+
+// the measurements of a scene that are compared against the baseline.
+struct Measurement
+{
+	double cpu_ms = 0.0;
+	unsigned int draw_calls = 0;
+	unsigned int vertices = 0;
+	unsigned int texture_binds = 0;
+};
+
+static graphics::Brush solid(float r, float g, float b, float opacity = 1.0f)
+{
+	graphics::Brush br;
+	br.fill_color[0] = r;
+	br.fill_color[1] = g;
+	br.fill_color[2] = b;
+	br.fill_opacity = opacity;
+	br.outline_opacity = 0.0f;
+	return br;
+}
+
+// the scenes only depend on their inputs, never on time, so that every frame is identical.
+static std::vector<Scene> makeScenes(const std::string & assets)
+{
+	return {
+		{ "shapes", []()
+		{
+			graphics::Brush br = solid(0.9f, 0.3f, 0.2f);
+			br.outline_opacity = 1.0f;
+			br.outline_width = 3.0f;
+			br.outline_color[0] = br.outline_color[1] = br.outline_color[2] = 1.0f;
+			graphics::drawRect(120.0f, 120.0f, 150.0f, 100.0f, br);
+			br = solid(0.2f, 0.6f, 1.0f, 0.7f);
+			graphics::drawDisk(250.0f, 250.0f, 90.0f, br);
+			graphics::drawSector(380.0f, 380.0f, 30.0f, 80.0f, 20.0f, 250.0f, solid(0.3f, 0.9f, 0.4f));
+			for (int i = 0; i < 10; i++)
+			{
+				graphics::Brush line = solid(1.0f, 1.0f, 0.0f);
+				line.outline_opacity = 1.0f;
+				line.outline_width = 1.0f + i;
+				line.outline_color[0] = 1.0f;
+				line.outline_color[1] = i / 10.0f;
+				line.outline_color[2] = 0.0f;
+				graphics::drawLine(20.0f, 300.0f + i * 18.0f, 220.0f, 480.0f - i * 10.0f, line);
+			}
+		} },
+		{ "gradients", []()
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				graphics::Brush br = solid(1.0f, 0.0f, 0.0f);
+				br.gradient = true;
+				br.fill_secondary_color[0] = 0.0f;
+				br.fill_secondary_color[1] = 0.0f;
+				br.fill_secondary_color[2] = 1.0f;
+				br.fill_secondary_opacity = 0.25f * (i + 1);
+				br.gradient_dir_u = (i % 2) ? 1.0f : 0.0f;
+				br.gradient_dir_v = (i % 2) ? 0.0f : 1.0f;
+				graphics::drawRect(130.0f + (i % 2) * 240.0f, 130.0f + (i / 2) * 240.0f, 200.0f, 200.0f, br);
+			}
+		} },
+		{ "textures", [assets]()
+		{
+			graphics::Brush br = solid(1.0f, 1.0f, 1.0f);
+			for (int i = 0; i < 16; i++)
+			{
+				br.texture = assets + ((i % 2) ? "/boy2.png" : "/iron.png");
+				br.fill_opacity = 0.5f + (i % 4) * 0.125f;
+				graphics::drawRect(70.0f + (i % 4) * 120.0f, 70.0f + (i / 4) * 120.0f, 100.0f, 100.0f, br);
+			}
+		} },
+		{ "text", [assets]()
+		{
+			graphics::setFont(assets + "/orange juice 2.0.ttf");
+			for (int i = 0; i < 8; i++)
+			{
+				graphics::Brush br = solid(1.0f - i / 8.0f, 0.5f, i / 8.0f);
+				graphics::drawText(20.0f, 50.0f + i * 55.0f, 12.0f + i * 4.0f, "Simple Game Graphics " + std::to_string(i), br);
+			}
+		} },
+		{ "transforms", [assets]()
+		{
+			graphics::Brush br = solid(1.0f, 1.0f, 1.0f, 0.8f);
+			br.texture = assets + "/iron.png";
+			for (int i = 0; i < 12; i++)
+			{
+				graphics::setOrientation(i * 30.0f);
+				graphics::setScale(1.0f + i * 0.1f, 1.0f);
+				graphics::drawRect(250.0f, 250.0f, 200.0f, 20.0f, br);
+			}
+			graphics::resetPose();
+			graphics::setOrientation(45.0f);
+			graphics::drawText(150.0f, 450.0f, 30.0f, "rotated", solid(1.0f, 1.0f, 0.0f));
+			graphics::resetPose();
+		} }
+	};
+}
+
+static bool parseOptions(int argc, char ** argv, Options & options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		if (option == "--update")
+		{
+			options.update = true;
+			continue;
+		}
+		if (i + 1 == argc)
+			return false;
+		std::string value = argv[++i];
+		if (option == "--golden")
+			options.golden = value;
+		else if (option == "--renderer")
+			options.renderer = value == "software" ? graphics::RENDERER_SOFTWARE : value == "vulkan" ? graphics::RENDERER_VULKAN : graphics::RENDERER_OPENGL;
+		else if (option == "--tolerance")
+			options.tolerance = std::stoi(value);
+		else if (option == "--max-diff")
+			options.max_diff = std::stof(value);
+		else if (option == "--threshold")
+			options.threshold = std::stof(value);
+		else if (option == "--frames")
+			options.frames = std::max(1u, (unsigned int)std::stoul(value));
+		else if (option == "--assets")
+			options.assets = value;
+		else
+			return false;
+	}
+	return true;
+}
+
+static bool readBaseline(const std::string & filename, std::map<std::string, Measurement> & baseline)
+{
+	std::ifstream in(filename);
+	if (!in)
+		return false;
+	std::string line;
+	std::getline(in, line);  // the header
+	while (std::getline(in, line))
+	{
+		std::stringstream fields(line);
+		std::string scene;
+		Measurement m;
+		if (!std::getline(fields, scene, ','))
+			continue;
+		fields >> m.cpu_ms;
+		fields.ignore(1) >> m.draw_calls;
+		fields.ignore(1) >> m.vertices;
+		fields.ignore(1) >> m.texture_binds;
+		if (fields)
+			baseline[scene] = m;
+	}
+	return true;
+}
+
+static bool writeBaseline(const std::string & filename, const std::map<std::string, Measurement> & measurements)
+{
+	std::ofstream out(filename);
+	if (!out)
+	{
+		std::cout << "Unable to write " << filename << "\n";
+		return false;
+	}
+	out << "scene,cpu_ms,draw_calls,vertices,texture_binds\n";
+	for (const auto & m : measurements)
+		out << m.first << "," << m.second.cpu_ms << "," << m.second.draw_calls << "," << m.second.vertices << "," << m.second.texture_binds << "\n";
+	return true;
+}
+
+// compares a frame to its golden image and writes a diff image if they differ beyond the tolerance.
+static bool compareImage(const std::string & scene, const std::string & golden_file, const std::vector<unsigned char> & pixels,
+	int width, int height, const Options & options)
+{
+	std::vector<unsigned char> golden;
+	unsigned int golden_width, golden_height;
+	unsigned int error = lodepng::decode(golden, golden_width, golden_height, golden_file);
+	if (error)
+	{
+		std::cout << scene << ": unable to read golden image " << golden_file << ": " << lodepng_error_text(error) << "\n";
+		return false;
+	}
+	if ((int)golden_width != width || (int)golden_height != height)
+	{
+		std::cout << scene << ": frame is " << width << "x" << height << ", golden image is " << golden_width << "x" << golden_height << "\n";
+		return false;
+	}
+
+	// the diff image shows the frame dimmed, with the differing pixels in red.
+	std::vector<unsigned char> diff(pixels.size());
+	size_t differing = 0;
+	double squared_error = 0.0;
+	for (size_t i = 0; i < pixels.size(); i += 4)
+	{
+		int max_delta = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			int delta = std::abs((int)pixels[i + c] - (int)golden[i + c]);
+			max_delta = std::max(max_delta, delta);
+			squared_error += delta * delta;
+		}
+		bool differs = max_delta > options.tolerance;
+		differing += differs;
+		for (int c = 0; c < 3; c++)
+			diff[i + c] = differs ? (c == 0 ? 255 : 0) : pixels[i + c] / 4;
+		diff[i + 3] = 255;
+	}
+
+	size_t count = pixels.size() / 4;
+	float percent = 100.0f * differing / count;
+	float rmse = (float)std::sqrt(squared_error / (count * 3));
+	if (percent <= options.max_diff)
+	{
+		std::cout << scene << ": image ok (" << percent << "% of pixels differ, rmse " << rmse << ")\n";
+		return true;
+	}
+	std::string diff_file = (fs::path(golden_file).parent_path() / (scene + "_diff.png")).string();
+	lodepng::encode(diff_file, diff, width, height);
+	std::cout << scene << ": IMAGE MISMATCH, " << percent << "% of pixels differ (rmse " << rmse << "), see " << diff_file << "\n";
+	return false;
+}
+
+static bool compareMeasurement(const std::string & scene, const Measurement & m, const Measurement & base, const Options & options)
+{
+	bool ok = true;
+	double limit = base.cpu_ms * (1.0 + options.threshold / 100.0);
+	if (m.cpu_ms > limit)
+	{
+		std::cout << scene << ": CPU TIME REGRESSION, " << m.cpu_ms << " ms per frame, baseline " << base.cpu_ms << " ms\n";
+		ok = false;
+	}
+	const std::pair<const char *, std::pair<unsigned int, unsigned int>> counters[] = {
+		{ "draw calls", { m.draw_calls, base.draw_calls } },
+		{ "vertices", { m.vertices, base.vertices } },
+		{ "texture binds", { m.texture_binds, base.texture_binds } }
+	};
+	for (const auto & counter : counters)
+	{
+		if (counter.second.first <= counter.second.second)
+			continue;
+		std::cout << scene << ": " << counter.first << " increased from " << counter.second.second << " to " << counter.second.first << "\n";
+		ok = false;
+	}
+	if (ok)
+		std::cout << scene << ": performance ok (" << m.cpu_ms << " ms per frame, baseline " << base.cpu_ms << " ms, "
+			<< m.draw_calls << " draw calls)\n";
+	return ok;
+}
+
+static Measurement measure(unsigned int frames)
+{
+	Measurement m;
+	std::vector<graphics::FrameStats> stats = profileFrames(frames);
+	if (stats.empty())
+		return m;
+	for (const graphics::FrameStats & frame : stats)
+		m.cpu_ms += frame.cpu_time[graphics::PROFILE_FRAME];
+	m.cpu_ms /= stats.size();
+	// the counters are the same for every frame of a scene.
+	m.draw_calls = stats.back().draw_calls;
+	m.vertices = stats.back().vertices;
+	m.texture_binds = stats.back().texture_binds;
+	return m;
+}
+
+int main(int argc, char ** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cout << "usage: " << argv[0] << " [--golden dir] [--update] [--renderer opengl|vulkan|software] [--tolerance levels]\n"
+			<< "       [--max-diff percent] [--threshold percent] [--frames count] [--assets dir]\n";
+		return 1;
+	}
+
+	if (!graphics::createHeadlessWindow(window_size, window_size, options.renderer))
+		return 1;
+	graphics::setCanvasSize(500.0f, 500.0f);
+	graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
+	graphics::Brush background = solid(0.1f, 0.1f, 0.15f);
+	graphics::setWindowBackground(background);
+	graphics::preloadBitmaps(options.assets);
+	graphics::initSubsystems(graphics::SUBSYSTEM_FONTS, false);
+
+	std::string renderer = graphics::getRenderer() == graphics::RENDERER_SOFTWARE ? "software" : graphics::getRenderer() == graphics::RENDERER_VULKAN ? "vulkan" : "opengl";
+	fs::path dir = fs::path(options.golden) / renderer;
+	if (!options.update && !fs::is_directory(dir))
+	{
+		// not a failure: the goldens of each renderer are only committed once someone has generated them.
+		std::cout << "Regression checks are not configured for the " << renderer << " renderer: " << dir.string()
+			<< " does not exist (run with --update to create it), skipped\n";
+		graphics::destroyWindow();
+		return 0;
+	}
+	std::map<std::string, Measurement> baseline, measurements;
+	bool have_baseline = readBaseline((dir / "baseline.csv").string(), baseline);
+	if (options.update)
+		fs::create_directories(dir);
+	else if (!have_baseline)
+		std::cout << "No baseline in " << dir.string() << ", performance is not checked (run with --update to create one)\n";
+
+	bool ok = true;
+	for (const Scene & scene : makeScenes(options.assets))
+	{
+		graphics::setDrawFunction(scene.draw);
+		// a few frames first, so that bitmaps and glyphs are loaded and any frames in flight are complete.
+		graphics::runFrames(3);
+
+		std::vector<unsigned char> pixels;
+		int width, height;
+		if (!graphics::getFramePixels(pixels, width, height))
+		{
+			ok = false;
+			continue;
+		}
+		std::string golden_file = (dir / (std::string(scene.name) + ".png")).string();
+		Measurement m = measure(options.frames);
+		measurements[scene.name] = m;
+
+		if (options.update)
+		{
+			unsigned int error = lodepng::encode(golden_file, pixels, width, height);
+			if (error)
+			{
+				std::cout << "Unable to write " << golden_file << ": " << lodepng_error_text(error) << "\n";
+				ok = false;
+			}
+			continue;
+		}
+		ok = compareImage(scene.name, golden_file, pixels, width, height, options) && ok;
+		auto base = baseline.find(scene.name);
+		if (base != baseline.end())
+			ok = compareMeasurement(scene.name, m, base->second, options) && ok;
+		else if (have_baseline)
+			std::cout << scene.name << ": not in the baseline, performance is not checked\n";
+	}
+	graphics::setDrawFunction(nullptr);
+	graphics::destroyWindow();
+
+	if (options.update)
+	{
+		ok = writeBaseline((dir / "baseline.csv").string(), measurements) && ok;
+		std::cout << (ok ? "Updated " : "Failed to update ") << "the golden images and baseline in " << dir.string() << "\n";
+	}
+	else
+		std::cout << (ok ? "All checks passed\n" : "Some checks FAILED\n");
+	return ok ? 0 : 1;
+}
@@ -35,6 +35,44 @@ $CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/lodepng.cpp -o $BUILD_PATH/
 echo "Compiled lodepng!"
 $CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/fonts.cpp -o $BUILD_PATH/sgg/fonts.o
 echo "Compiled fonts!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/inputlog.cpp -o $BUILD_PATH/sgg/inputlog.o
+echo "Compiled inputlog!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/latency.cpp -o $BUILD_PATH/sgg/latency.o
+echo "Compiled latency!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/rendertarget.cpp -o $BUILD_PATH/sgg/rendertarget.o
+echo "Compiled rendertarget!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/arena.cpp -o $BUILD_PATH/sgg/arena.o
+echo "Compiled arena!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/alloctrack.cpp -o $BUILD_PATH/sgg/alloctrack.o
+echo "Compiled alloctrack!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/cmdstream.cpp -o $BUILD_PATH/sgg/cmdstream.o
+echo "Compiled cmdstream!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/remote.cpp -o $BUILD_PATH/sgg/remote.o
+echo "Compiled remote!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/readback.cpp -o $BUILD_PATH/sgg/readback.o
+echo "Compiled readback!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/frameexport.cpp -o $BUILD_PATH/sgg/frameexport.o
+echo "Compiled frameexport!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/glrenderer.cpp -o $BUILD_PATH/sgg/glrenderer.o
+echo "Compiled glrenderer!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/softrenderer.cpp -o $BUILD_PATH/sgg/softrenderer.o
+echo "Compiled softrenderer!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/profiler.cpp -o $BUILD_PATH/sgg/profiler.o
+echo "Compiled profiler!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/trace.cpp -o $BUILD_PATH/sgg/trace.o
+echo "Compiled trace!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/overlay.cpp -o $BUILD_PATH/sgg/overlay.o
+echo "Compiled overlay!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/memregistry.cpp -o $BUILD_PATH/sgg/memregistry.o
+echo "Compiled memregistry!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/gltrace.cpp -o $BUILD_PATH/sgg/gltrace.o
+echo "Compiled gltrace!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/capture.cpp -o $BUILD_PATH/sgg/capture.o
+echo "Compiled capture!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/framerecorder.cpp -o $BUILD_PATH/sgg/framerecorder.o
+echo "Compiled framerecorder!"
+$CC -c -std=c++17 $CFLAGS -I. -I3rdparty/include sgg/vkrenderer.cpp -o $BUILD_PATH/sgg/vkrenderer.o
+echo "Compiled vkrenderer!"
 
 $AR rcs $LIB_PATH/libsgg.a $BUILD_PATH/sgg/*.o
 
@@ -55,5 +93,43 @@ $CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/lodepng.cpp -o $BUILD
 echo "Compiled lodepng!"
 $CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/fonts.cpp -o $BUILD_PATH_DEBUG/sgg/fonts.o
 echo "Compiled fonts!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/inputlog.cpp -o $BUILD_PATH_DEBUG/sgg/inputlog.o
+echo "Compiled inputlog!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/latency.cpp -o $BUILD_PATH_DEBUG/sgg/latency.o
+echo "Compiled latency!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/rendertarget.cpp -o $BUILD_PATH_DEBUG/sgg/rendertarget.o
+echo "Compiled rendertarget!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/arena.cpp -o $BUILD_PATH_DEBUG/sgg/arena.o
+echo "Compiled arena!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/alloctrack.cpp -o $BUILD_PATH_DEBUG/sgg/alloctrack.o
+echo "Compiled alloctrack!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/cmdstream.cpp -o $BUILD_PATH_DEBUG/sgg/cmdstream.o
+echo "Compiled cmdstream!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/remote.cpp -o $BUILD_PATH_DEBUG/sgg/remote.o
+echo "Compiled remote!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/readback.cpp -o $BUILD_PATH_DEBUG/sgg/readback.o
+echo "Compiled readback!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/frameexport.cpp -o $BUILD_PATH_DEBUG/sgg/frameexport.o
+echo "Compiled frameexport!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/glrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/glrenderer.o
+echo "Compiled glrenderer!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/softrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/softrenderer.o
+echo "Compiled softrenderer!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/profiler.cpp -o $BUILD_PATH_DEBUG/sgg/profiler.o
+echo "Compiled profiler!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/trace.cpp -o $BUILD_PATH_DEBUG/sgg/trace.o
+echo "Compiled trace!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/overlay.cpp -o $BUILD_PATH_DEBUG/sgg/overlay.o
+echo "Compiled overlay!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/memregistry.cpp -o $BUILD_PATH_DEBUG/sgg/memregistry.o
+echo "Compiled memregistry!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/gltrace.cpp -o $BUILD_PATH_DEBUG/sgg/gltrace.o
+echo "Compiled gltrace!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/capture.cpp -o $BUILD_PATH_DEBUG/sgg/capture.o
+echo "Compiled capture!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/framerecorder.cpp -o $BUILD_PATH_DEBUG/sgg/framerecorder.o
+echo "Compiled framerecorder!"
+$CC -c -std=c++17 $CFLAGS_DEBUG -I. -I3rdparty/include sgg/vkrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/vkrenderer.o
+echo "Compiled vkrenderer!"
 
 $AR rcs $LIB_PATH/libsggd.a $BUILD_PATH_DEBUG/sgg/*.o
@@ -24,6 +24,25 @@ $CC -c $CFLAGS -I. -I3rdparty/include sgg/audio.cpp -o $BUILD_PATH/sgg/audio.o
 $CC -c $CFLAGS -I. -I3rdparty/include sgg/AudioManager.cpp -o $BUILD_PATH/sgg/AudioManager.o
 $CC -c $CFLAGS -I. -I3rdparty/include sgg/lodepng.cpp -o $BUILD_PATH/sgg/lodepng.o
 $CC -c $CFLAGS -I. -I3rdparty/include sgg/fonts.cpp -o $BUILD_PATH/sgg/fonts.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/inputlog.cpp -o $BUILD_PATH/sgg/inputlog.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/latency.cpp -o $BUILD_PATH/sgg/latency.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/rendertarget.cpp -o $BUILD_PATH/sgg/rendertarget.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/arena.cpp -o $BUILD_PATH/sgg/arena.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/alloctrack.cpp -o $BUILD_PATH/sgg/alloctrack.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/cmdstream.cpp -o $BUILD_PATH/sgg/cmdstream.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/remote.cpp -o $BUILD_PATH/sgg/remote.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/readback.cpp -o $BUILD_PATH/sgg/readback.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/frameexport.cpp -o $BUILD_PATH/sgg/frameexport.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/glrenderer.cpp -o $BUILD_PATH/sgg/glrenderer.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/softrenderer.cpp -o $BUILD_PATH/sgg/softrenderer.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/profiler.cpp -o $BUILD_PATH/sgg/profiler.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/trace.cpp -o $BUILD_PATH/sgg/trace.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/overlay.cpp -o $BUILD_PATH/sgg/overlay.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/memregistry.cpp -o $BUILD_PATH/sgg/memregistry.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/gltrace.cpp -o $BUILD_PATH/sgg/gltrace.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/capture.cpp -o $BUILD_PATH/sgg/capture.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/framerecorder.cpp -o $BUILD_PATH/sgg/framerecorder.o
+$CC -c $CFLAGS -I. -I3rdparty/include sgg/vkrenderer.cpp -o $BUILD_PATH/sgg/vkrenderer.o
 
 $AR rcs $LIB_PATH/libsgg.a $BUILD_PATH/sgg/*.o
 
@@ -35,5 +54,24 @@ $CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/audio.cpp -o $BUILD_PATH_DEBUG/s
 $CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/AudioManager.cpp -o $BUILD_PATH_DEBUG/sgg/AudioManager.o
 $CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/lodepng.cpp -o $BUILD_PATH_DEBUG/sgg/lodepng.o
 $CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/fonts.cpp -o $BUILD_PATH_DEBUG/sgg/fonts.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/inputlog.cpp -o $BUILD_PATH_DEBUG/sgg/inputlog.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/latency.cpp -o $BUILD_PATH_DEBUG/sgg/latency.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/rendertarget.cpp -o $BUILD_PATH_DEBUG/sgg/rendertarget.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/arena.cpp -o $BUILD_PATH_DEBUG/sgg/arena.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/alloctrack.cpp -o $BUILD_PATH_DEBUG/sgg/alloctrack.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/cmdstream.cpp -o $BUILD_PATH_DEBUG/sgg/cmdstream.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/remote.cpp -o $BUILD_PATH_DEBUG/sgg/remote.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/readback.cpp -o $BUILD_PATH_DEBUG/sgg/readback.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/frameexport.cpp -o $BUILD_PATH_DEBUG/sgg/frameexport.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/glrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/glrenderer.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/softrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/softrenderer.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/profiler.cpp -o $BUILD_PATH_DEBUG/sgg/profiler.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/trace.cpp -o $BUILD_PATH_DEBUG/sgg/trace.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/overlay.cpp -o $BUILD_PATH_DEBUG/sgg/overlay.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/memregistry.cpp -o $BUILD_PATH_DEBUG/sgg/memregistry.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/gltrace.cpp -o $BUILD_PATH_DEBUG/sgg/gltrace.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/capture.cpp -o $BUILD_PATH_DEBUG/sgg/capture.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/framerecorder.cpp -o $BUILD_PATH_DEBUG/sgg/framerecorder.o
+$CC -c $CFLAGS_DEBUG -I. -I3rdparty/include sgg/vkrenderer.cpp -o $BUILD_PATH_DEBUG/sgg/vkrenderer.o
 
 $AR rcs $LIB_PATH/libsggd.a $BUILD_PATH_DEBUG/sgg/*.o
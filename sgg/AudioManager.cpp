@@ -1,14 +1,30 @@
 #include <sgg/AudioManager.h>
+#include <sgg/graphics.h>
+#include <sgg/memregistry.h>
+#include <filesystem>
+
+#ifdef SGG_TRACING
+// runs on the audio thread of SDL_mixer after each mixed buffer, marking the cadence of the audio callback.
+static void SDLCALL tracePostMix(void *, Uint8 *, int)
+{
+	SGG_PROFILE_THREAD("audio");
+	SGG_PROFILE_EVENT("audio buffer mixed");
+}
+#endif
 
 void AudioManager::playSound(std::string soundfile, float volume, bool looping)
 {
+	if (!initialized)
+		return;
 	auto siter = sounds.find(soundfile);
 	if (siter == sounds.end())
 	{
+		SGG_PROFILE_SCOPE("AudioManager::loadSound");
 		Mix_Chunk * as = Mix_LoadWAV(soundfile.c_str());
 		if (as)
 		{
 			sounds.insert(std::pair<std::string, Mix_Chunk*>(soundfile, as));
+			graphics::MemoryRegistry::get().track(this, graphics::MEMORY_AUDIO, soundfile, sizeof(Mix_Chunk) + as->alen, 0);
 			Mix_VolumeChunk(as, (unsigned char)(MIX_MAX_VOLUME*volume));
 			Mix_PlayChannel(-1, as, looping ? -1 : 0);
 		}
@@ -22,13 +38,20 @@ void AudioManager::playSound(std::string soundfile, float volume, bool looping)
 
 void AudioManager::playMusic(std::string soundfile, float volume, bool looping, int fade_time)
 {
+	if (!initialized)
+		return;
 	auto siter = scores.find(soundfile);
 	if (siter == scores.end())
 	{
+		SGG_PROFILE_SCOPE("AudioManager::loadMusic");
 		Mix_Music * ms = Mix_LoadMUS(soundfile.c_str());
 		if (ms)
 		{
 			scores.insert(std::pair<std::string, Mix_Music*>(soundfile, ms));
+			// music is decoded while playing; the size of the file is the best available estimate.
+			std::error_code error;
+			auto size = std::filesystem::file_size(soundfile, error);
+			graphics::MemoryRegistry::get().track(this, graphics::MEMORY_AUDIO, soundfile, error ? 0 : (size_t)size, 0);
 			Mix_VolumeMusic((unsigned char)(MIX_MAX_VOLUME*volume));
 			Mix_FadeInMusic(ms, looping ? -1 : 1, fade_time);
 		}
@@ -46,15 +69,27 @@ void AudioManager::stopMusic(int fade_time)
 	
 }
 
+int AudioManager::getActiveVoices()
+{
+	if (!initialized)
+		return 0;
+	return Mix_Playing(-1) + (Mix_PlayingMusic() ? 1 : 0);
+}
+
 AudioManager::AudioManager()
 {
+	SGG_PROFILE_SCOPE("AudioManager::openAudio");
 	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096) == -1)
 		return;
 	initialized = true;
+#ifdef SGG_TRACING
+	Mix_SetPostMix(tracePostMix, nullptr);
+#endif
 }
 
 AudioManager::~AudioManager()
 {
+	graphics::MemoryRegistry::get().untrackAll(this);
 	
 	for (auto sound : sounds)
 		Mix_FreeChunk(sound.second);
@@ -9,11 +9,12 @@ class AudioManager
 {
 	std::unordered_map<std::string, Mix_Chunk*> sounds;
 	std::unordered_map<std::string, Mix_Music*> scores;
-	bool initialized = true;
+	bool initialized = false;
 public:
 	void playSound(std::string soundfile, float volume, bool looping = false);
 	void playMusic(std::string soundfile, float volume, bool looping = true, int fade_time = 0);
 	void stopMusic(int fade_time = 0);
+	int getActiveVoices();
 	AudioManager();
 	~AudioManager();
 	
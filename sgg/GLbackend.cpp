@@ -1,14 +1,19 @@
 #include <cstring>
 
 #include <sgg/GLbackend.h>
+#include <sgg/memregistry.h>
 #include <iostream>
 #include <string>
 #include <chrono>
 #include <cstdint>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
-#include <sgg/commonshaders.h>
 #include <sgg/graphics.h>
+#include <sgg/remote.h>
+#include <sgg/frameexport.h>
+#include <sgg/framerecorder.h>
+#include <sgg/capture.h>
+#include <sgg/lodepng.h>
 #include <filesystem>
 #include <cctype>
 
@@ -19,21 +24,33 @@ namespace fs = std::filesystem;
 #endif
 
 
-
-
-#ifdef __APPLE__
-#define sggBindVertexArray glBindVertexArrayAPPLE
-#define sggGenVertexArrays glGenVertexArraysAPPLE
-#else
-#define sggBindVertexArray glBindVertexArray
-#define sggGenVertexArrays glGenVertexArrays
-#endif
-
 namespace graphics
 {
 
-	const uint32_t delay = 5;  // update every delay ms.
-	float delta_time = 0.0f;
+	// SDL's event queue is process-wide and must be pumped by the thread that initialized video. The contexts on
+	// that thread drain it on behalf of all contexts, handing each event to the inbox of the context whose window it
+	// belongs to; events that belong to no window (such as SDL_QUIT) go to every context.
+	static std::mutex event_mutex;
+	static std::thread::id event_thread;
+	static std::vector<GLBackend *> event_contexts;
+
+	static uint32_t eventWindowID(const SDL_Event & event)
+	{
+		switch (event.type)
+		{
+		case SDL_WINDOWEVENT: return event.window.windowID;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: return event.key.windowID;
+		case SDL_TEXTEDITING: return event.edit.windowID;
+		case SDL_TEXTINPUT: return event.text.windowID;
+		case SDL_MOUSEMOTION: return event.motion.windowID;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: return event.button.windowID;
+		case SDL_MOUSEWHEEL: return event.wheel.windowID;
+		case SDL_USEREVENT: return event.user.windowID;
+		default: return 0;
+		}
+	}
 
 	GLBackend::GLBackend(int w, int h, std::string title) :
 		m_width(w), m_height(h), m_title(title),
@@ -47,17 +64,58 @@ namespace graphics
 
 	void GLBackend::cleanup()
 	{
-
-		SDL_GL_DeleteContext(m_context);
+		stopRemoteServer();
+		stopFrameExport();
+		// pending screenshots and recorded frames are saved while the graphics context still exists.
+		delete m_frame_recorder;
+		m_frame_recorder = nullptr;
+		stopCapture();
+		stopCaptureReplay();
+		m_latency.setEnabled(false, m_renderer_type);
+		m_profiler.setEnabled(false, false);
+		MemoryRegistry::get().untrackAll(&m_frame_arena);
+		if (m_warmup_thread.joinable())
+			m_warmup_thread.join();
+
+		if (m_renderer)
+			m_renderer->release();
+		delete m_renderer;
+		m_renderer = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(event_mutex);
+			event_contexts.erase(std::remove(event_contexts.begin(), event_contexts.end(), this), event_contexts.end());
+			m_windowID = 0;
+		}
 		SDL_DestroyWindow(m_window);
 		if (m_audio)
+		{
 			delete m_audio;
-		SDL_Quit();
+			SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		}
+		m_audio = nullptr;
+
+		// SDL reference-counts its subsystems, so other engine instances keep theirs alive.
+		SDL_QuitSubSystem(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS);
+		if (SDL_WasInit(SDL_INIT_EVERYTHING) == 0)
+			SDL_Quit();
 	}
 
 	void GLBackend::swap()
 	{
-		SDL_GL_SwapWindow(m_window);
+		SGG_PROFILE_SCOPE("present");
+		if (m_frame_exporter)
+			m_frame_exporter->capture(m_width, m_height);
+		if (m_frame_recorder)
+			m_frame_recorder->capture(*m_renderer, m_width, m_height);
+		m_renderer->present();
+		m_latency.framePresented();
+		// all transient data of the frame have been consumed.
+		m_frame_arena.reset();
+		if (m_frame_arena.getCapacity() != m_tracked_arena_capacity)
+		{
+			m_tracked_arena_capacity = m_frame_arena.getCapacity();
+			MemoryRegistry::get().track(&m_frame_arena, MEMORY_FRAME_DATA, "frame arena", m_tracked_arena_capacity, 0);
+		}
 	}
 
 	GLBackend::~GLBackend()
@@ -66,7 +124,8 @@ namespace graphics
 
 	void GLBackend::makeCurrent()
 	{
-		SDL_GL_MakeCurrent(m_window, m_context);
+		if (m_renderer)
+			m_renderer->makeCurrent();
 	}
 
 	void GLBackend::show(bool s)
@@ -130,17 +189,156 @@ namespace graphics
 		return m_mouse_dragging;
 	}
 
+	const std::vector<InputEvent> & GLBackend::getInputEvents()
+	{
+		return m_input_events;
+	}
+
+	void GLBackend::setInputEventCoalescing(bool coalesce)
+	{
+		m_coalesce_motion = coalesce;
+	}
+
+	bool GLBackend::startInputRecording(const std::string & filename)
+	{
+		return m_input_log.startRecording(filename);
+	}
+
+	void GLBackend::stopInputRecording()
+	{
+		m_input_log.stopRecording();
+	}
+
+	bool GLBackend::startInputReplay(const std::string & filename, bool uncapped)
+	{
+		m_replay_key_state.reset();
+		return m_input_log.startReplay(filename, uncapped);
+	}
+
+	void GLBackend::stopInputReplay()
+	{
+		if (!m_input_log.isReplaying())
+			return;
+		m_input_log.stopReplay();
+		// the clock was driven by the log, so live timing restarts now rather than at the start of the replay.
+		m_prev_time_tick = std::chrono::steady_clock::now();
+	}
+
+	bool GLBackend::isReplayingInput()
+	{
+		return m_input_log.isReplaying();
+	}
+
+	void GLBackend::setLatencyTracking(bool enable)
+	{
+		m_latency.setEnabled(enable, m_renderer_type);
+	}
+
+	void GLBackend::getLatencyStats(LatencyStats & stats)
+	{
+		m_latency.getStats(stats);
+	}
+
+	void GLBackend::setProfiling(bool enable)
+	{
+		// GPU timer queries need the GL context, which only the OpenGL renderer has.
+		m_profiler.setEnabled(enable, m_renderer_type == RENDERER_OPENGL);
+		// the application takes over the profiler, so hiding the overlay leaves it as it is.
+		m_overlay_profiling = false;
+	}
+
+	bool GLBackend::getFrameStats(FrameStats & stats)
+	{
+		return m_profiler.getLatest(stats);
+	}
+
+	void GLBackend::getFrameStatsHistory(std::vector<FrameStats> & history)
+	{
+		m_profiler.getHistory(history);
+	}
+
+	void GLBackend::setPerformanceOverlay(bool show)
+	{
+		m_overlay_shown = show;
+		if (show && !m_profiler.isEnabled())
+		{
+			m_profiler.setEnabled(true, m_renderer_type == RENDERER_OPENGL);
+			m_overlay_profiling = true;
+		}
+		else if (!show && m_overlay_profiling)
+		{
+			m_profiler.setEnabled(false, false);
+			m_overlay_profiling = false;
+		}
+	}
+
+	void GLBackend::drawOverlay()
+	{
+		SGG_PROFILE_SCOPE("performance overlay");
+		OverlayInfo info;
+		info.renderer = m_renderer_type;
+		info.texture_memory = m_renderer->getTextureMemory();
+		{
+			// the overlay does not open the audio device just to report that nothing plays.
+			std::lock_guard<std::mutex> lock(m_audio_mutex);
+			if (m_audio)
+				info.audio_voices = m_audio->getActiveVoices();
+		}
+
+		// the work of the overlay is left out of the counters of the frame, which it displays.
+		RenderCounters counters = renderCounters();
+		m_overlay.draw(*m_renderer, m_profiler, info, glm::vec4(0.0f, 0.0f, m_window_to_canvas_factors.x, m_window_to_canvas_factors.z));
+		renderCounters() = counters;
+	}
+
+	bool GLBackend::setOverdrawVisualization(bool enable)
+	{
+		if (!m_renderer)
+			return false;
+		return m_renderer->setOverdrawMode(enable);
+	}
+
+	bool GLBackend::getOverdrawStats(OverdrawStats & stats)
+	{
+		if (!m_renderer)
+			return false;
+		return m_renderer->getOverdrawStats(stats);
+	}
+
+	void GLBackend::getFrameMemoryStats(FrameMemoryStats & stats)
+	{
+		stats.used = m_frame_arena.getUsed();
+		stats.peak = m_frame_arena.getPeak();
+		stats.capacity = m_frame_arena.getCapacity();
+		stats.blocks = (unsigned int)m_frame_arena.getNumBlocks();
+	}
+
+	void GLBackend::setAllocationCheck(alloc_check_t check, unsigned int warmup_frames)
+	{
+		m_alloc_tracker.setCheck(check, warmup_frames);
+	}
+
+	void GLBackend::getAllocationStats(AllocationStats & stats)
+	{
+		stats = m_alloc_tracker.getStats();
+	}
+
 	void GLBackend::setCanvasMode(int m)
 	{
 		m_canvas_mode = m;
 		if (m == CANVAS_SCALE_WINDOW)
 			m_requested_canvas = glm::vec4(0.0f);
+		m_canvas_dirty = true;
 	}
 
 	void GLBackend::setCanvasSize(float w, float h)
 	{
+		// a remote client repeats its canvas size every frame, which should not recompute the projection each time.
+		if (m_requested_canvas.z == w && m_requested_canvas.w == h)
+			return;
 		m_requested_canvas.z = w;
 		m_requested_canvas.w = h;
+		m_canvas_dirty = true;
 	}
 
 	void GLBackend::setFullscreen(bool fs)
@@ -157,19 +355,277 @@ namespace graphics
 		resize(m_width, m_height);
 	}
 
+	void GLBackend::initSubsystems(unsigned int subsystems, bool background)
+	{
+		auto warmup = [this, subsystems, background]()
+		{
+			if (background)
+				SGG_PROFILE_THREAD("warm-up");
+			SGG_PROFILE_SCOPE("subsystem warm-up");
+			if (subsystems & SUBSYSTEM_AUDIO)
+				getAudio(background);
+			if ((subsystems & SUBSYSTEM_FONTS) && m_renderer && !m_renderer->isFontLibraryReady())
+			{
+				auto start = std::chrono::steady_clock::now();
+				m_renderer->initFontLibrary();
+				recordStartupPhase("font library", start, background);
+			}
+		};
+
+		if (m_warmup_thread.joinable())
+			m_warmup_thread.join();
+		if (background)
+			m_warmup_thread = std::thread(warmup);
+		else
+			warmup();
+	}
+
+	void GLBackend::getStartupTimings(std::vector<StartupTiming> & timings)
+	{
+		std::lock_guard<std::mutex> lock(m_startup_mutex);
+		timings = m_startup_timings;
+	}
+
+	bool GLBackend::startRemoteServer(const std::string & socket_path, const std::string & asset_root)
+	{
+		stopRemoteServer();
+		m_remote_server = new RemoteServer();
+		if (m_remote_server->listen(socket_path, asset_root))
+			return true;
+		stopRemoteServer();
+		return false;
+	}
+
+	void GLBackend::stopRemoteServer()
+	{
+		delete m_remote_server;
+		m_remote_server = nullptr;
+	}
+
+	bool GLBackend::isRemoteClientConnected()
+	{
+		return m_remote_server && m_remote_server->isClientConnected();
+	}
+
+	bool GLBackend::startFrameExport(const std::string & name, unsigned int slots)
+	{
+		stopFrameExport();
+		if (!m_window)
+			return false;
+		if (m_renderer_type != RENDERER_OPENGL)
+		{
+			// frames are read back asynchronously through GL pixel buffers.
+			std::cout << "Frame export requires the OpenGL renderer\n";
+			return false;
+		}
+
+		// slots are sized for the largest window the display can hold, so that resizing does not reallocate them.
+		int max_width = m_width, max_height = m_height;
+		SDL_DisplayMode mode;
+		if (SDL_GetDesktopDisplayMode(SDL_GetWindowDisplayIndex(m_window), &mode) == 0)
+		{
+			max_width = std::max(max_width, mode.w);
+			max_height = std::max(max_height, mode.h);
+		}
+
+		m_frame_exporter = new FrameExporter();
+		if (m_frame_exporter->start(name, slots, max_width, max_height))
+			return true;
+		stopFrameExport();
+		return false;
+	}
+
+	void GLBackend::stopFrameExport()
+	{
+		delete m_frame_exporter;
+		m_frame_exporter = nullptr;
+	}
+
+	void GLBackend::getFrameExportStats(FrameExportStats & stats)
+	{
+		stats = FrameExportStats();
+		if (!m_frame_exporter)
+			return;
+		stats.exported = m_frame_exporter->getExported();
+		stats.dropped = m_frame_exporter->getDropped();
+	}
+
+	bool GLBackend::captureFrame(const std::string & filename)
+	{
+		if (!m_renderer)
+			return false;
+		if (!m_frame_recorder)
+			m_frame_recorder = new FrameRecorder();
+		m_frame_recorder->requestScreenshot(filename);
+		return true;
+	}
+
+	bool GLBackend::startFrameRecording(const std::string & filename, recording_format_t format, unsigned int fps)
+	{
+		if (!m_renderer)
+			return false;
+		if (!m_frame_recorder)
+			m_frame_recorder = new FrameRecorder();
+		return m_frame_recorder->startRecording(filename, format, m_width, m_height, fps);
+	}
+
+	void GLBackend::stopFrameRecording()
+	{
+		if (m_frame_recorder)
+			m_frame_recorder->stopRecording();
+	}
+
+	void GLBackend::getFrameRecordingStats(FrameRecordingStats & stats)
+	{
+		stats = FrameRecordingStats();
+		if (m_frame_recorder)
+			m_frame_recorder->getStats(stats);
+	}
+
+	bool GLBackend::startCapture(const std::string & filename)
+	{
+		stopCapture();
+		CaptureInfo info;
+		info.window_width = m_width;
+		info.window_height = m_height;
+		info.canvas_width = m_requested_canvas.z;
+		info.canvas_height = m_requested_canvas.w;
+		info.canvas_mode = (scale_mode_t)m_canvas_mode;
+		for (int i = 0; i < 3; i++)
+			info.background[i] = m_back_color[i];
+
+		m_capture = new CaptureWriter();
+		if (m_capture->open(filename, info))
+		{
+			// the state set before the capture started, which the captured calls rely on. The pose is reset before
+			// each frame is drawn, so it only carries over into a capture started from within the draw callback.
+			CommandEncoder & encoder = m_capture->encoder();
+			if (!m_font.empty())
+				encoder.setFont(m_font);
+			if (m_drawing)
+			{
+				encoder.setScale(m_scale.x, m_scale.y, m_scale.z);
+				encoder.setOrientation(m_orientation);
+			}
+			return true;
+		}
+		stopCapture();
+		return false;
+	}
+
+	void GLBackend::stopCapture()
+	{
+		delete m_capture;
+		m_capture = nullptr;
+	}
+
+	bool GLBackend::isCapturing()
+	{
+		return m_capture != nullptr;
+	}
+
+	CommandEncoder * GLBackend::getCaptureEncoder()
+	{
+		return m_capture ? &m_capture->encoder() : nullptr;
+	}
+
+	bool GLBackend::startCaptureReplay(const std::string & filename, unsigned int loops)
+	{
+		stopCaptureReplay();
+		m_capture_replay = new CaptureReplay();
+		if (!m_capture_replay->load(filename, loops))
+		{
+			stopCaptureReplay();
+			return false;
+		}
+
+		// start from the setup of the captured application; later changes are part of the captured frames.
+		const CaptureInfo & info = m_capture_replay->getInfo();
+		setCanvasMode(info.canvas_mode);
+		setCanvasSize(info.canvas_width, info.canvas_height);
+		setBackgroundColor(info.background[0], info.background[1], info.background[2]);
+		return true;
+	}
+
+	void GLBackend::stopCaptureReplay()
+	{
+		delete m_capture_replay;
+		m_capture_replay = nullptr;
+	}
+
+	bool GLBackend::isReplayingCapture()
+	{
+		return m_capture_replay != nullptr;
+	}
+
+	void GLBackend::recordStartupPhase(const char * phase, std::chrono::steady_clock::time_point start, bool background)
+	{
+		std::chrono::duration<float> elapsed_seconds = std::chrono::steady_clock::now() - start;
+		StartupTiming timing;
+		timing.phase = phase;
+		timing.duration = elapsed_seconds.count() * 1000.0f;
+		timing.background = background;
+
+		std::lock_guard<std::mutex> lock(m_startup_mutex);
+		m_startup_timings.push_back(timing);
+	}
+
+	AudioManager * GLBackend::getAudio(bool background)
+	{
+		// the audio device is opened on first use, possibly by the warm-up thread.
+		std::lock_guard<std::mutex> lock(m_audio_mutex);
+		if (!m_audio)
+		{
+			SGG_PROFILE_SCOPE("audio device init");
+			auto start = std::chrono::steady_clock::now();
+			if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+				std::cout << "Failed to init SDL audio\n";
+			m_audio = new AudioManager();
+			recordStartupPhase("audio device", start, background);
+		}
+		return m_audio;
+	}
+
+	bool GLBackend::ensureFonts()
+	{
+		if (m_renderer->areFontsInitialized())
+			return true;
+
+		SGG_PROFILE_SCOPE("font init");
+		auto start = std::chrono::steady_clock::now();
+		if (!m_renderer->isFontLibraryReady())
+		{
+			// waits for a background warm-up, if one is in progress.
+			m_renderer->initFontLibrary();
+			recordStartupPhase("font library", start);
+			start = std::chrono::steady_clock::now();
+		}
+
+		if (!m_renderer->initFonts())
+		{
+			std::cout << "Unable to initialize font library\n";
+			return false;
+		}
+		recordStartupPhase("font shaders", start);
+		return true;
+	}
+
 	void GLBackend::playSound(std::string soundfile, float volume, bool looping)
 	{
-		m_audio->playSound(soundfile, volume, looping);
+		getAudio()->playSound(soundfile, volume, looping);
 	}
 
 	void GLBackend::playMusic(std::string soundfile, float volume, bool looping, int fade_time)
 	{
-		m_audio->playMusic(soundfile, volume, looping, fade_time);
+		getAudio()->playMusic(soundfile, volume, looping, fade_time);
 	}
 
 	void GLBackend::stopMusic(int fade_time)
 	{
-		m_audio->stopMusic(fade_time);
+		// nothing can be playing if the audio device was never opened.
+		std::lock_guard<std::mutex> lock(m_audio_mutex);
+		if (m_audio)
+			m_audio->stopMusic(fade_time);
 	}
 
 	void GLBackend::terminate()
@@ -178,38 +634,92 @@ namespace graphics
 	}
 
 
+	void GLBackend::pumpEvents()
+	{
+		std::lock_guard<std::mutex> lock(event_mutex);
+		if (event_thread != std::this_thread::get_id())
+			return;
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			uint32_t window = eventWindowID(event);
+			for (GLBackend * context : event_contexts)
+				if (window == 0 || context->m_windowID == window)
+					context->m_event_inbox.push_back(event);
+		}
+	}
+
 	bool GLBackend::processEvent(SDL_Event event)
 	{
 		if (m_quit)
 			return false;
 
+		// live input is ignored while replaying a recorded session.
+		bool input_event = (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP ||
+			event.type == SDL_MOUSEWHEEL || event.type == SDL_KEYDOWN || event.type == SDL_KEYUP);
+		if (input_event && m_input_log.isReplaying())
+			return true;
+
 		if (event.type == SDL_MOUSEMOTION)
 		{
-			m_prev_mouse_pos = m_mouse_pos;
-			m_mouse_pos.x = event.motion.x;
-			m_mouse_pos.y = event.motion.y;
-			m_mouse_dragging = (m_button_state[0] || m_button_state[1] || m_button_state[2]);
+			InputEvent ev;
+			ev.type = INPUT_MOUSE_MOTION;
+			ev.timestamp = event.motion.timestamp;
+			ev.x = event.motion.x;
+			ev.y = event.motion.y;
+			ev.dx = event.motion.xrel;
+			ev.dy = event.motion.yrel;
+			applyInputEvent(ev);
 		}
 		else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP)
 		{
-			bool new_state = (event.type == SDL_MOUSEBUTTONDOWN);
+			InputEvent ev;
+			ev.type = (event.type == SDL_MOUSEBUTTONDOWN) ? INPUT_MOUSE_BUTTON_DOWN : INPUT_MOUSE_BUTTON_UP;
+			ev.timestamp = event.button.timestamp;
+			ev.x = event.button.x;
+			ev.y = event.button.y;
 			switch (event.button.button)
 			{
-			case SDL_BUTTON_LEFT: m_button_state[0] = new_state;
-			case SDL_BUTTON_MIDDLE: m_button_state[1] = new_state;
-			case SDL_BUTTON_RIGHT: m_button_state[2] = new_state;
+			case SDL_BUTTON_LEFT: ev.button = MOUSE_BUTTON_LEFT; break;
+			case SDL_BUTTON_MIDDLE: ev.button = MOUSE_BUTTON_MIDDLE; break;
+			case SDL_BUTTON_RIGHT: ev.button = MOUSE_BUTTON_RIGHT; break;
+			default: ev.button = MOUSE_BUTTON_OTHER; break;
 			}
-			
+			applyInputEvent(ev);
 		}
-		else if (event.type == SDL_KEYDOWN)
+		else if (event.type == SDL_MOUSEWHEEL)
 		{
-			switch (event.key.keysym.sym)
+			InputEvent ev;
+			ev.type = INPUT_MOUSE_WHEEL;
+			ev.timestamp = event.wheel.timestamp;
+			ev.x = event.wheel.x;
+			ev.y = event.wheel.y;
+			if (event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED)
 			{
-			case SDLK_ESCAPE:
-				return false;
+				ev.x = -ev.x;
+				ev.y = -ev.y;
+			}
+			applyInputEvent(ev);
+		}
+		else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+		{
+			InputEvent ev;
+			ev.type = (event.type == SDL_KEYDOWN) ? INPUT_KEY_DOWN : INPUT_KEY_UP;
+			ev.timestamp = event.key.timestamp;
+			ev.key = (scancode_t)event.key.keysym.scancode;
+			ev.repeat = (event.key.repeat != 0);
+			applyInputEvent(ev);
+
+			if (event.type == SDL_KEYDOWN)
+			{
+				switch (event.key.keysym.sym)
+				{
+				case SDLK_ESCAPE:
+					return false;
 
-			default:
-				break;
+				default:
+					break;
+				}
 			}
 		}
 		else if (event.type == SDL_WINDOWEVENT)
@@ -219,8 +729,12 @@ namespace graphics
 				if (event.window.event == SDL_WINDOWEVENT_RESIZED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED
 					|| event.window.event == SDL_WINDOWEVENT_MAXIMIZED)
 				{
+					// several of these arrive per resize step; only the last size is applied, once per frame.
 					if (event.window.data1 != 0 && event.window.data2 != 0)
-						resize(event.window.data1, event.window.data2);
+					{
+						m_pending_size = glm::ivec2(event.window.data1, event.window.data2);
+						m_resize_pending = true;
+					}
 				}
 			}
 		}
@@ -228,6 +742,45 @@ namespace graphics
 		return true;
 	}
 
+	void GLBackend::applyInputEvent(const InputEvent & ev)
+	{
+		switch (ev.type)
+		{
+		case INPUT_MOUSE_MOTION:
+			m_prev_mouse_pos = m_mouse_pos;
+			m_mouse_pos.x = ev.x;
+			m_mouse_pos.y = ev.y;
+			m_mouse_dragging = (m_button_state[0] || m_button_state[1] || m_button_state[2]);
+			break;
+		case INPUT_MOUSE_BUTTON_DOWN:
+		case INPUT_MOUSE_BUTTON_UP:
+			if (ev.button >= MOUSE_BUTTON_LEFT && ev.button < MOUSE_BUTTON_OTHER)
+				m_button_state[ev.button] = (ev.type == INPUT_MOUSE_BUTTON_DOWN);
+			break;
+		case INPUT_KEY_DOWN:
+		case INPUT_KEY_UP:
+			if (m_input_log.isReplaying() && ev.key >= 0 && ev.key < NUM_SCANCODES)
+				m_replay_key_state[ev.key] = (ev.type == INPUT_KEY_DOWN);
+			break;
+		default:
+			break;
+		}
+
+		// merge runs of motion events into the last one, keeping the accumulated relative motion.
+		if (m_coalesce_motion && ev.type == INPUT_MOUSE_MOTION &&
+			!m_input_events.empty() && m_input_events.back().type == INPUT_MOUSE_MOTION)
+		{
+			InputEvent & last = m_input_events.back();
+			last.timestamp = ev.timestamp;
+			last.x = ev.x;
+			last.y = ev.y;
+			last.dx += ev.dx;
+			last.dy += ev.dy;
+		}
+		else
+			m_input_events.push_back(ev);
+	}
+
 	void GLBackend::advanceTime()
 	{
 		auto now = std::chrono::steady_clock::now();
@@ -280,100 +833,6 @@ namespace graphics
 		
 	}
 
-	void GLBackend::initPrimitives()
-	{
-		glGetError();
-		const GLubyte * s = glewGetErrorString(glGetError());
-
-		m_flat_shader = Shader(__PrimitivesVertexShader, __SolidFragmentShader);
-		
-		if (!m_flat_shader.init())
-			return;
-		
-		GLfloat box[4][4] = {
-			{ -0.5f, 0.5f, 0, 1 },
-			{ 0.5f, 0.5f, 1, 1 },
-			{ -0.5f, -0.5f, 0, 0 },
-			{ 0.5f, -0.5f, 1, 0 }
-		};
-
-		GLfloat box_outline[4][4] = {
-			{ -0.5f, 0.5f, 0, 0 },
-			{ 0.5f, 0.5f, 1, 0 },
-			{ 0.5f, -0.5f, 1, 1 },
-			{ -0.5f, -0.5f, 0, 1 }
-		};
-
-		GLfloat line[2][4] = 
-		{
-			{0,0,0,1},
-			{1,1,1,1}
-		};
-
-		float sector_vertices[2 * CURVE_SUBDIVS][4];
-		float sector_outline_vertices[2 * CURVE_SUBDIVS][4];
-		float r1 = 0.0f, r2 = 1.0f;
-		for (int i = 0; i < CURVE_SUBDIVS; i++)
-		{
-			float s = i / (float)CURVE_SUBDIVS;
-			sector_vertices[i*2+0][0] = r1*sin(3.1415936f*s);
-			sector_vertices[i*2+0][1] = r1*cos(3.1415936f*s);
-			sector_vertices[i*2+0][2] = s;
-			sector_vertices[i*2+0][3] = 0.0f;
-			sector_vertices[i * 2 + 1][0] = r2 * sin(3.1415936f*s);
-			sector_vertices[i * 2 + 1][1] = r2 * cos(3.1415936f*s);
-			sector_vertices[i * 2 + 1][2] = s;
-			sector_vertices[i * 2 + 1][3] = 1.0f;
-		}
-		for (int i = 0; i < CURVE_SUBDIVS; i++)
-		{
-			float s = i / (float)CURVE_SUBDIVS;
-			sector_vertices[i][0] = r1 * sin(3.1415936f*s);
-			sector_vertices[i][1] = r1 * cos(3.1415936f*s);
-			sector_vertices[i][2] = s;
-			sector_vertices[i][3] = 0.0f;
-			sector_vertices[2 * CURVE_SUBDIVS - i - 1][0] = r2 * sin(3.1415936f*s);
-			sector_vertices[2 * CURVE_SUBDIVS - i - 1][1] = r2 * cos(3.1415936f*s);
-			sector_vertices[2 * CURVE_SUBDIVS - i - 1][2] = s;
-			sector_vertices[2 * CURVE_SUBDIVS - i - 1][3] = 1.0f;
-		}
-
-		sggGenVertexArrays(1, &m_sector_vao);
-		sggBindVertexArray(m_sector_vao);
-		glGenBuffers(1, &m_sector_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_sector_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof sector_vertices, sector_vertices, GL_DYNAMIC_DRAW);
-
-		sggGenVertexArrays(1, &m_sector_outline_vao);
-		sggBindVertexArray(m_sector_outline_vao);
-		glGenBuffers(1, &m_sector_outline_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_sector_outline_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof sector_outline_vertices, sector_outline_vertices, GL_DYNAMIC_DRAW);
-
-		sggGenVertexArrays(1, &m_line_vao);
-		sggBindVertexArray(m_line_vao);
-		glGenBuffers(1, &m_line_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_line_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof line, line, GL_DYNAMIC_DRAW);
-		
-		sggGenVertexArrays(1, &m_rect_vao);
-		sggBindVertexArray(m_rect_vao);
-		glGenBuffers(1, &m_rect_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_rect_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof box, box, GL_STATIC_DRAW);
-
-		sggGenVertexArrays(1, &m_rect_outline_vao);
-		sggBindVertexArray(m_rect_outline_vao);
-		glGenBuffers(1, &m_rect_outline_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, m_rect_outline_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof box_outline, box_outline, GL_STATIC_DRAW);
-
-		unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-		glEnableVertexAttribArray(attrib_flat_position);
-		glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-		
-	}
-
 	void GLBackend::computeTransformation()
 	{
 		// note: rotation is CW, due to mirroring after projection.
@@ -382,94 +841,13 @@ namespace graphics
 
 	void GLBackend::drawRect(float cx, float cy, float w, float h, const Brush & brush)
 	{
-
-		glEnable(GL_TEXTURE_2D);
-		glFrontFace(GL_CCW);
-		glPolygonMode(GL_FRONT, GL_FILL);
-		glm::mat4 mat = glm::translate(glm::vec3(cx, cy, 0.0f)) * 
-			m_transformation * glm::scale(glm::vec3(w, h, 1.0f));
-		m_flat_shader["gradient"] = glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v);
-
-		// fill
-		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f )
-		{
-			int tid = textures.getTexture(brush.texture);
-			if (tid > 0)
-			{
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, tid);
-				
-			}
-			
-			m_flat_shader["color1"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
-
-			if (brush.gradient)
-			{
-				m_flat_shader["color2"] = glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
-					brush.fill_secondary_color[2], brush.fill_secondary_opacity);
-			}
-			else
-			{
-				m_flat_shader["color2"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
-			}
-				
-			m_flat_shader["MV"] = mat;
-			m_flat_shader["tex"] = 0;
-			if (tid>0) 
-				m_flat_shader["has_texture"] = 1;
-			else
-				m_flat_shader["has_texture"] = 0;
-
-			unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-			sggBindVertexArray(m_rect_vao); 
-			glBindBuffer(GL_ARRAY_BUFFER, m_rect_vbo);
-			glEnableVertexAttribArray(attrib_flat_position);
-			glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-			
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-		}
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		if (brush.outline_opacity>0.0f)
-		{
-			m_flat_shader.use();
-			m_flat_shader["color1"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
-			m_flat_shader["color2"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
-			m_flat_shader["MV"] = mat;
-			m_flat_shader["has_texture"] = 0;
-			glLineWidth(brush.outline_width);
-			sggBindVertexArray(m_rect_outline_vao);
-			glBindBuffer(GL_ARRAY_BUFFER, m_rect_outline_vbo);
-			unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-			glEnableVertexAttribArray(attrib_flat_position);
-			glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-			glDrawArrays(GL_LINE_LOOP, 0, 4);
-			glLineWidth(1);
-
-		}
-		
+		m_renderer->drawRect(glm::translate(glm::vec3(cx, cy, 0.0f)) *
+			m_transformation * glm::scale(glm::vec3(w, h, 1.0f)), brush);
 	}
 
 	void GLBackend::drawLine(float x_1, float y_1, float x_2, float y_2, const Brush & brush)
 	{
-		m_flat_shader["color1"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
-		m_flat_shader["MV"] = glm::mat4(1.0f);
-		m_flat_shader["gradient"] = glm::vec2(1.0f, 0.0f);
-		GLfloat line[2][4] = 
-		{
-			{ x_1, y_1, 0.0f, 1.0f},
-			{ x_2, y_2, 0.1f, 1.0f},
-		};
-
-		sggBindVertexArray(m_line_vao);
-		glBindBuffer(GL_ARRAY_BUFFER, m_line_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof line, line, GL_DYNAMIC_DRAW);
-		unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-		glEnableVertexAttribArray(attrib_flat_position);
-		glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-		glDrawArrays(GL_LINES, 0, 2);
+		m_renderer->drawLine(glm::vec2(x_1, y_1), glm::vec2(x_2, y_2), brush);
 	}
 
 	std::vector<std::string> GLBackend::preloadBitmaps(std::string dir)
@@ -491,7 +869,7 @@ namespace graphics
 				continue;
 			}
 			
-			if (textures.getTexture(filename))
+			if (m_renderer->preloadTexture(filename))
 			{
 				names.push_back(filename);
 			}
@@ -501,118 +879,16 @@ namespace graphics
 
 	void GLBackend::drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush)
 	{
-		glEnable(GL_TEXTURE_2D);
-		glFrontFace(GL_CCW);
-		glPolygonMode(GL_FRONT, GL_FILL);
-		m_flat_shader["MV"] = glm::translate(glm::vec3(cx, cy, 0.0f)) * m_transformation;
-		m_flat_shader["gradient"] = glm::vec2(brush.gradient_dir_u,brush.gradient_dir_v);
-
-		float sector_vertices[2 * CURVE_SUBDIVS+2][4];
-		float sector_outline_vertices[2 * CURVE_SUBDIVS+2][4];
-		float r1 = radius1, r2 = radius2;
-		float arc_inc = 3.1415936f*(end_angle - start_angle) / (180.0f*CURVE_SUBDIVS);
-		for (int i = 0; i <= CURVE_SUBDIVS; i++)
-		{
-			float s = i / (float)CURVE_SUBDIVS;
-			sector_vertices[i * 2 + 0][0] = r1 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_vertices[i * 2 + 0][1] = r1 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_vertices[i * 2 + 0][2] = s;
-			sector_vertices[i * 2 + 0][3] = 0.0f;
-			sector_vertices[i * 2 + 1][0] = r2 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_vertices[i * 2 + 1][1] = r2 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_vertices[i * 2 + 1][2] = s;
-			sector_vertices[i * 2 + 1][3] = 1.0f;
-		}
-		for (int i = 0; i <= CURVE_SUBDIVS; i++)
-		{
-			float s = i / (float)CURVE_SUBDIVS;
-			sector_outline_vertices[i][0] = r1 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_outline_vertices[i][1] = r1 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_outline_vertices[i][2] = s;
-			sector_outline_vertices[i][3] = 0.0f;
-		}
-		for (int i = CURVE_SUBDIVS; i >= 0; i--)
-		{
-			float s = (i) / (float)CURVE_SUBDIVS;
-			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][0] = r2 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][1] = r2 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
-			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][2] = s;
-			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][3] = 1.0f;
-		}
-
-
-		// fill
-		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
-		{
-			int tid = textures.getTexture(brush.texture);
-			if (tid > 0)
-			{
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, tid);
-
-			}
-
-			m_flat_shader["color1"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
-
-			if (brush.gradient)
-			{
-				m_flat_shader["color2"] = glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
-					brush.fill_secondary_color[2], brush.fill_secondary_opacity);
-			}
-			else
-			{
-				m_flat_shader["color2"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
-			}
-
-			m_flat_shader["tex"] = 0;
-			if (tid > 0)
-				m_flat_shader["has_texture"] = 1;
-			else
-				m_flat_shader["has_texture"] = 0;
-
-			sggBindVertexArray(m_sector_vao);
-			glBindBuffer(GL_ARRAY_BUFFER, m_sector_vbo);
-			glBufferData(GL_ARRAY_BUFFER, sizeof sector_vertices, sector_vertices, GL_DYNAMIC_DRAW);
-			unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-			glEnableVertexAttribArray(attrib_flat_position);
-			glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 2 * CURVE_SUBDIVS+2);
-
-		}
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		if (brush.outline_opacity > 0.0f)
-		{
-			m_flat_shader.use();
-			m_flat_shader["color1"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
-			m_flat_shader["color2"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
-			m_flat_shader["has_texture"] = 0;
-			glLineWidth(brush.outline_width);
-			
-			sggBindVertexArray(m_sector_outline_vao);
-			glBindBuffer(GL_ARRAY_BUFFER, m_sector_outline_vbo);
-			glBufferData(GL_ARRAY_BUFFER, sizeof sector_outline_vertices, sector_outline_vertices, GL_DYNAMIC_DRAW);
-			unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
-			glEnableVertexAttribArray(attrib_flat_position);
-			glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
-			if (fabs(end_angle-start_angle-360.0f)>0.000f)
-				glDrawArrays(GL_LINE_LOOP, 0, 2 * CURVE_SUBDIVS+2);
-			else
-				glDrawArrays(GL_LINE_LOOP, CURVE_SUBDIVS + 1, CURVE_SUBDIVS );
-			
-			glLineWidth(1);
-
-		}
-
-		
-
+		m_renderer->drawSector(glm::translate(glm::vec3(cx, cy, 0.0f)) * m_transformation, start_angle, end_angle, radius1, radius2, brush);
 	}
 
 	void GLBackend::drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush)
 	{
 		TextRecord entry;
-		entry.text = text;
+		entry.text = m_frame_arena.copyString(text);
+		// out of memory: the text is dropped, as the renderer may keep it until the end of the frame.
+		if (!entry.text)
+			return;
 		entry.pos = glm::vec2(pos_x, pos_y);
 		entry.size = glm::vec2(size, size);
 		entry.color1 = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
@@ -622,7 +898,7 @@ namespace graphics
 		entry.mv = m_transformation;
 		entry.proj = m_projection;
 		
-		m_fontlib.submitText(entry);
+		m_renderer->drawText(entry);
 	}
 
 	void GLBackend::setUserData(const void * user_data) {
@@ -655,68 +931,206 @@ namespace graphics
 
 	bool GLBackend::setFont(std::string fontname)
 	{
-		return m_fontlib.setCurrentFont(fontname);
+		m_font = fontname;
+		if (!ensureFonts())
+			return false;
+		return m_renderer->setFont(fontname);
 	}
 
 	bool GLBackend::getKeyState(scancode_t key)
 	{
-		int numkeys;
-		const uint8_t * keymap = SDL_GetKeyboardState(&numkeys);
-		return keymap[key];
+		return isKeyDown(key);
+	}
+
+	bool GLBackend::isKeyDown(scancode_t key)
+	{
+		if (key < 0 || key >= NUM_SCANCODES)
+			return false;
+		return m_key_state[key];
+	}
+
+	bool GLBackend::wasKeyPressed(scancode_t key)
+	{
+		if (key < 0 || key >= NUM_SCANCODES)
+			return false;
+		return m_key_state[key] && !m_prev_key_state[key];
+	}
+
+	bool GLBackend::wasKeyReleased(scancode_t key)
+	{
+		if (key < 0 || key >= NUM_SCANCODES)
+			return false;
+		return !m_key_state[key] && m_prev_key_state[key];
 	}
 
 
 	bool GLBackend::processMessages()
 	{
-		SDL_Event event;
+		SGG_PROFILE_SCOPE("frame");
 		bool loop = true;
-		while (SDL_PollEvent(&event) && loop)
+		m_alloc_tracker.beginFrame();
+		m_profiler.beginFrame();
+		// closes the frame on every return, so that a frame that ends the loop is still reported.
+		struct FrameEnd
+		{
+			AllocationTracker & alloc_tracker;
+			FrameProfiler & profiler;
+			~FrameEnd() { alloc_tracker.endFrame(); profiler.endFrame(); }
+		} frame_end{ m_alloc_tracker, m_profiler };
+		m_profiler.beginScope(PROFILE_EVENTS);
+		// the event queue only holds the input received since the previous frame.
+		m_input_events.clear();
+		if (m_poll_events)
 		{
-			if (event.type == SDL_WINDOWEVENT_CLOSE || event.type == SDL_QUIT)
+			pumpEvents();
+			m_frame_events.clear();
 			{
-				return false;
+				std::lock_guard<std::mutex> lock(event_mutex);
+				m_frame_events.swap(m_event_inbox);
+			}
+			for (const SDL_Event & event : m_frame_events)
+			{
+				if (event.type == SDL_QUIT || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE))
+					return false;
+				if (!(loop = processEvent(event)))
+					break;
+			}
+		}
+
+		if (m_resize_pending)
+		{
+			m_resize_pending = false;
+			resize(m_pending_size.x, m_pending_size.y);
+		}
+
+		if (m_input_log.isReplaying())
+		{
+			// feed the recorded input and drive the clock with the recorded frame times.
+			if (m_input_log.replayFrame(m_delta_time, m_global_time, m_replay_events))
+			{
+				for (const InputEvent & ev : m_replay_events)
+					applyInputEvent(ev);
 			}
 			else
 			{
-				loop = processEvent(event);
+				stopInputReplay();
+				return false;
 			}
 		}
+		else if (m_input_log.isRecording())
+			m_input_log.recordFrame(m_delta_time, m_global_time, m_input_events);
+
+		if (m_capture_replay && !m_capture_replay->nextFrame())
+		{
+			stopCaptureReplay();
+			return false;
+		}
+
+		// recorded timestamps are meaningless for latency, so only live input is measured.
+		if (!m_input_events.empty() && !m_input_log.isReplaying())
+			m_latency.beginFrame(m_input_events.front().timestamp);
+		m_profiler.endScope(PROFILE_EVENTS);
+
+		m_profiler.beginScope(PROFILE_UPDATE);
 		update();
+		m_profiler.endScope(PROFILE_UPDATE);
 		if (m_idle_callback != nullptr)
+		{
+			SGG_PROFILE_SCOPE("update callback");
+			ProfileScope scope(m_profiler, PROFILE_IDLE_CALLBACK);
 			m_idle_callback(getDeltaTime());
+		}
 		draw();
-		advanceTime();
-		SDL_Delay(5);
+		if (!m_input_log.isReplaying())
+			advanceTime();
+		// captures are replayed as fast as possible, to measure the renderer alone.
+		if (!m_headless && !m_input_log.isUncapped() && !m_capture_replay)
+			SDL_Delay(5);
 
-		return loop;
+		return loop && !m_quit;
+	}
+
+	bool GLBackend::runFrames(unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			if (!processMessages())
+				return false;
+		return true;
+	}
+
+	bool GLBackend::getFramePixels(std::vector<unsigned char> & pixels, int & width, int & height)
+	{
+		if (!m_headless)
+		{
+			std::cout << "Frames can only be read back from a headless window\n";
+			return false;
+		}
+		return m_renderer->readPixels(pixels, width, height);
+	}
+
+	bool GLBackend::saveFrame(const std::string & filename)
+	{
+		std::vector<unsigned char> pixels;
+		int width, height;
+		if (!getFramePixels(pixels, width, height))
+			return false;
+		unsigned int error = lodepng::encode(filename, pixels, width, height);
+		if (error)
+		{
+			std::cout << "Unable to save " << filename << ": " << lodepng_error_text(error) << "\n";
+			return false;
+		}
+		return true;
 	}
 
 	void GLBackend::update(float delta_time)
 	{
-		static bool prev_mouse_state[3] = { 0,0,0 };
 
-		m_button_pressed[0] = (m_button_state[0] && !prev_mouse_state[0]);
-		m_button_pressed[1] = (m_button_state[1] && !prev_mouse_state[1]);
-		m_button_pressed[2] = (m_button_state[2] && !prev_mouse_state[2]);
+		m_button_pressed[0] = (m_button_state[0] && !m_prev_button_state[0]);
+		m_button_pressed[1] = (m_button_state[1] && !m_prev_button_state[1]);
+		m_button_pressed[2] = (m_button_state[2] && !m_prev_button_state[2]);
 
-		m_button_released[0] = (!m_button_state[0] && prev_mouse_state[0]);
-		m_button_released[1] = (!m_button_state[1] && prev_mouse_state[1]);
-		m_button_released[2] = (!m_button_state[2] && prev_mouse_state[2]);
+		m_button_released[0] = (!m_button_state[0] && m_prev_button_state[0]);
+		m_button_released[1] = (!m_button_state[1] && m_prev_button_state[1]);
+		m_button_released[2] = (!m_button_state[2] && m_prev_button_state[2]);
 
-		prev_mouse_state[0] = m_button_state[0];
-		prev_mouse_state[1] = m_button_state[1];
-		prev_mouse_state[2] = m_button_state[2];
+		m_prev_button_state[0] = m_button_state[0];
+		m_prev_button_state[1] = m_button_state[1];
+		m_prev_button_state[2] = m_button_state[2];
+
+		// snapshot the keyboard once per frame, so that key queries do not hit SDL.
+		m_prev_key_state = m_key_state;
+		if (m_input_log.isReplaying())
+		{
+			m_key_state = m_replay_key_state;
+		}
+		else
+		{
+			int numkeys;
+			const uint8_t * keymap = SDL_GetKeyboardState(&numkeys);
+			numkeys = std::min(numkeys, (int)NUM_SCANCODES);
+			m_key_state.reset();
+			for (int i = 0; i < numkeys; i++)
+				if (keymap[i])
+					m_key_state.set(i);
+		}
 
 	}
 
 	void GLBackend::resize(int w, int h)
 	{
+		SGG_PROFILE_SCOPE("resize");
 		m_width = w;
 		m_height = h;
 
 		if (m_resize_callback != nullptr)
 			m_resize_callback(w, h);
 
+		m_canvas_dirty = true;
+	}
+
+	void GLBackend::updateCanvas()
+	{
 		if (m_requested_canvas.z == 0 || m_requested_canvas.w == 0)
 		// default canvas is window-sized, in pixel units.
 			m_canvas = glm::vec4(0, 0, m_width, m_height);
@@ -755,81 +1169,100 @@ namespace graphics
 		}
 
 		computeProjection();
-		glViewport(0, 0, m_width, m_height);
-		//SDL_Delay(100);
-		draw();
+		if (m_renderer)
+			m_renderer->resize(m_width, m_height);
+		m_canvas_dirty = false;
 	}
 
 	float GLBackend::WindowToCanvasX(float x, bool clamped)
 	{
+		if (m_canvas_dirty)
+			updateCanvas();
 		float coord = m_window_to_canvas_factors.x*x + m_window_to_canvas_factors.y;
 		return clamped?glm::clamp(coord, 0.0f, m_canvas.z) : coord;
 	}
 
 	float GLBackend::WindowToCanvasY(float y, bool clamped)
 	{
+		if (m_canvas_dirty)
+			updateCanvas();
 		float coord = m_window_to_canvas_factors.z*y + m_window_to_canvas_factors.w;
 		return clamped?glm::clamp(coord, 0.0f, m_canvas.w) : coord;
 	}
 
 	void GLBackend::draw()
 	{
-		m_flat_shader.use();
-
 		// reset timers on first run
-		static bool first_time = true;
-		if (first_time)
+		if (m_first_frame)
 		{
 			advanceTime();
 			m_global_time = 0.0f;
 			m_delta_time = 0.0f;
-			first_time = false;
+			m_first_frame = false;
 
-			//force a call to resize to take canvas parameters set by the user.
-			resize(m_width, m_height);
-			return;
+			//force a canvas update to take canvas parameters set by the user.
+			m_canvas_dirty = true;
 		}
 
+		if (m_canvas_dirty)
+			updateCanvas();
+
 		resetPose();
-				
-		glDepthMask(0.0f);
-		glDisable(GL_DEPTH_TEST);
-		glClearColor(0.0f, 0.0f, 0.f, 1.0);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		
+
+		SGG_PROFILE_SCOPE("draw");
+		ProfileScope draw_scope(m_profiler, PROFILE_DRAW);
+		glm::vec4 rect;
 		if (m_canvas_mode == CANVAS_SCALE_FIT)
 		{
 			float true_aspect = m_width / (float)m_height;
 			float req_aspect = m_requested_canvas.z / m_requested_canvas.w;
-			glEnable(GL_SCISSOR_TEST);
-			glm::vec4 rect;
 			rect.x = (true_aspect > req_aspect ? (m_width - m_height * req_aspect) / 2.0f : 0.0f);
 			rect.y = (req_aspect > true_aspect ? (m_height - m_width / req_aspect)/2.0f : 0.0f);
 			rect.z = (true_aspect > req_aspect ? m_height * req_aspect : m_width);
 			rect.w = (req_aspect > true_aspect ? m_width / req_aspect : m_height);
-			glScissor(rect.x, rect.y, rect.z, rect.w);
 		}
+		m_profiler.beginGPU();
+		m_renderer->beginFrame(m_projection, m_canvas_mode == CANVAS_SCALE_FIT ? &rect : nullptr);
 
 		Brush bck;
 		bck.fill_color[0] = m_back_color.r, bck.fill_color[1] = m_back_color.g, bck.fill_color[2] = m_back_color.b;
 		bck.outline_opacity = 0.0f;
 		drawRect(m_requested_canvas.z / 2, m_requested_canvas.w / 2, m_requested_canvas.z, m_requested_canvas.w, bck);
-		
-		glEnable(GL_BLEND);
-		glBlendEquation(GL_ADD);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		
-		m_flat_shader["P"] = m_projection;
-		glGetError();
-		if (m_draw_callback != nullptr)
+		m_drawing = true;
+		if (m_capture_replay)
+		{
+			SGG_PROFILE_SCOPE("capture replay");
+			ProfileScope scope(m_profiler, PROFILE_DRAW_CALLBACK);
+			if (!m_capture_replay->executeFrame(*this))
+			{
+				std::cout << "Invalid command in capture file, stopping the replay\n";
+				stopCaptureReplay();
+				terminate();
+			}
+		}
+		else if (m_draw_callback != nullptr)
+		{
+			SGG_PROFILE_SCOPE("draw callback");
+			ProfileScope scope(m_profiler, PROFILE_DRAW_CALLBACK);
 			m_draw_callback();
-
-		m_fontlib.setCanvas(glm::vec2(m_requested_canvas.z, m_requested_canvas.w));
-		m_fontlib.commitText();
-
-		glDisable(GL_SCISSOR_TEST);
+		}
+		m_drawing = false;
+		if (m_capture)
+			m_capture->endFrame(m_delta_time);
+		if (m_remote_server)
+			m_remote_server->render(*this);
+		if (m_overlay_shown && m_profiler.isEnabled())
+			drawOverlay();
+
+		m_profiler.beginScope(PROFILE_TEXT);
+		m_renderer->endFrame();
+		m_profiler.endScope(PROFILE_TEXT);
+		m_profiler.endGPU();
+
+		m_profiler.beginScope(PROFILE_PRESENT);
 		swap();
+		m_profiler.endScope(PROFILE_PRESENT);
 	}
 
 
@@ -853,54 +1286,80 @@ namespace graphics
 	{
 		m_initialized = false;
 
-		if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS | SDL_INIT_AUDIO) < 0)
+		// audio is initialized on first use, see getAudio().
+		AllocationTracker::installLibraryHooks();
+#if defined(__linux__)
+		// without a display, a headless window falls back to SDL's offscreen driver, which renders through EGL
+		// (also on llvmpipe). The driver is only chosen when video is first initialized, and an explicit
+		// SDL_VIDEODRIVER setting is not overwritten.
+		bool offscreen_driver = m_headless && !SDL_WasInit(SDL_INIT_VIDEO) && !getenv("SDL_VIDEODRIVER") &&
+			!getenv("DISPLAY") && !getenv("WAYLAND_DISPLAY");
+		if (offscreen_driver)
+			SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+#endif
+		auto start = std::chrono::steady_clock::now();
+		bool sdl_ready = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS) == 0;
+#if defined(__linux__)
+		// the setting only applies to this initialization, so that windows created after SDL shuts down are not affected.
+		if (offscreen_driver)
+			unsetenv("SDL_VIDEODRIVER");
+#endif
+		if (!sdl_ready)
 		{
 			std::cout << "Failed to init SDL\n";
 			return false;
 		}
-		
-		m_window = SDL_CreateWindow(m_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-			m_width, m_height, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE );
-		m_windowID = SDL_GetWindowID(m_window);
-		m_audio = new AudioManager();
+		recordStartupPhase("SDL video", start);
 
-		if (!m_window)
 		{
-			std::cout << "Unable to create window\n";
-			CheckSDLError(__LINE__);
-			return false;
+			std::lock_guard<std::mutex> lock(event_mutex);
+			if (event_contexts.empty())
+				event_thread = std::this_thread::get_id();
+			event_contexts.push_back(this);
 		}
 		
-		m_context = SDL_GL_CreateContext(m_window);
-
-		
-		//SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
-		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-		SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
-		SDL_GL_SetSwapInterval(0);
-		
-		glewExperimental = GL_TRUE;
-		glewInit();
-		glGetError();
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LEQUAL);
-		glClearDepth(1.0f);
-		glDisable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
-
-		if (!m_fontlib.init())
+		// the GL driver may be broken or missing altogether, in which case the CPU renderer takes over.
+		renderer_t requested = m_renderer_type;
+		const char * renderer = getenv("SGG_RENDERER");
+		if (requested == RENDERER_AUTO && renderer)
 		{
-			std::cout << "Unable to initialize font library\n";
-			CheckSDLError(__LINE__);
-			return false;
+			if (!strcmp(renderer, "opengl"))
+				requested = RENDERER_OPENGL;
+			else if (!strcmp(renderer, "vulkan"))
+				requested = RENDERER_VULKAN;
+			else if (!strcmp(renderer, "software"))
+				requested = RENDERER_SOFTWARE;
+			else if (*renderer)
+				std::cout << "Unknown SGG_RENDERER \"" << renderer << "\", expected opengl, vulkan or software\n";
 		}
-		
-		initPrimitives();
+		bool initialized = false;
+		if (requested == RENDERER_VULKAN)
+		{
+			initialized = initRenderer(RENDERER_VULKAN);
+			if (!initialized)
+			{
+				std::cout << "Vulkan is not available, using the OpenGL renderer\n";
+				requested = RENDERER_AUTO;
+			}
+		}
+		if (!initialized && requested != RENDERER_SOFTWARE)
+		{
+			initialized = initRenderer(RENDERER_OPENGL);
+			if (!initialized && requested == RENDERER_AUTO)
+				std::cout << "OpenGL is not available, using the software renderer\n";
+		}
+		if (!initialized && requested != RENDERER_OPENGL)
+			initialized = initRenderer(RENDERER_SOFTWARE);
+		if (!initialized)
+			return false;
+
+		// the font library is initialized on first use, see ensureFonts().
 		computeProjection();
-		glViewport(0, 0, m_width, m_height);
+
+		// lets the overlay be brought up on a deployed application, without changing its code.
+		const char * overlay = getenv("SGG_PERFORMANCE_OVERLAY");
+		if (overlay && *overlay && strcmp(overlay, "0"))
+			setPerformanceOverlay(true);
 		
 		m_initialized = true;
 		return true;
@@ -908,6 +1367,51 @@ namespace graphics
 
 	
 
+	bool GLBackend::initRenderer(renderer_t type)
+	{
+		if (m_renderer)
+		{
+			// a window that was created for another renderer cannot be reused.
+			m_renderer->release();
+			delete m_renderer;
+			m_renderer = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(event_mutex);
+				m_windowID = 0;
+			}
+			SDL_DestroyWindow(m_window);
+			m_window = nullptr;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		m_renderer = createRenderer(type);
+		m_renderer_type = type;
+		if (!m_renderer)
+		{
+			std::cout << "The library was built without the Vulkan renderer\n";
+			return false;
+		}
+		Uint32 flags = m_renderer->getWindowFlags(m_headless) | (m_headless ? SDL_WINDOW_HIDDEN : (SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE));
+		m_window = SDL_CreateWindow(m_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, m_width, m_height, flags);
+		if (!m_window)
+		{
+			std::cout << "Unable to create window\n";
+			CheckSDLError(__LINE__);
+			return false;
+		}
+		{
+			// read by the event thread, to dispatch the events of the window.
+			std::lock_guard<std::mutex> lock(event_mutex);
+			m_windowID = SDL_GetWindowID(m_window);
+		}
+		recordStartupPhase("window", start);
+
+		start = std::chrono::steady_clock::now();
+		bool ready = m_renderer->init(m_window, m_width, m_height, m_headless);
+		recordStartupPhase(type == RENDERER_OPENGL ? "OpenGL renderer" : type == RENDERER_VULKAN ? "Vulkan renderer" : "software renderer", start);
+		return ready;
+	}
+
 	void CheckSDLError(int line = -1)
 	{
 		std::string error = SDL_GetError();
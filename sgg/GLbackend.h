@@ -1,25 +1,41 @@
 #pragma once
 #define GL3_PROTOTYPES 1
-#include <GL/glew.h>
+#include <sgg/gltrace.h>
 #include <SDL2/SDL.h>
 #include <string>
 #include <thread>
-#include <sgg/shader.h>
+#include <mutex>
+#include <chrono>
 #include <sgg/fonts.h>
 #include <functional>
 #include <glm/vec3.hpp>
 #include <sgg/scancodes.h>
-#include <sgg/texture.h>
 #include <sgg/AudioManager.h>
+#include <sgg/inputlog.h>
+#include <sgg/latency.h>
+#include <sgg/profiler.h>
+#include <sgg/overlay.h>
+#include <sgg/arena.h>
+#include <sgg/alloctrack.h>
+#include <sgg/renderer.h>
+#include <sgg/graphics.h>
 #include <algorithm>
+#include <vector>
+#include <bitset>
 
-#define SGG_CHECK_GL() do {GLenum err;while((err = glGetError()) != GL_NO_ERROR){ printf("Error %s %d\n", (const char*)glewGetErrorString(err), err);exit(0);}printf("Pass\n");} while(0);
-
-constexpr auto CURVE_SUBDIVS = 64;
+// reports the pending GL errors with the location of the check and evaluates to false if there were any.
+#define SGG_CHECK_GL() graphics::GLTrace::checkErrors(__FILE__, __LINE__)
 
 //#undef main
 namespace graphics
 {
+	class RemoteServer;
+	class FrameExporter;
+	class FrameRecorder;
+	class CaptureWriter;
+	class CaptureReplay;
+	class CommandEncoder;
+
 	void PrintSDL_GL_Attributes();
 	void CheckSDLError(int line);
 
@@ -29,48 +45,74 @@ namespace graphics
 		int			  m_width,
 					  m_height;
 		std::string   m_title;
-		SDL_Window *  m_window;
-		uint32_t      m_windowID;
-		SDL_GLContext m_context;
+		SDL_Window *  m_window = nullptr;
+		uint32_t      m_windowID = 0;
 		bool		  m_initialized = false;
-		FontLib		  m_fontlib;
+		Renderer *	  m_renderer = nullptr;
+		renderer_t	  m_renderer_type = RENDERER_AUTO;
 		SDL_TimerID   m_idle_timer;
 		glm::vec3	  m_back_color = { 0.0f, 0.0f, 0.0f };
 		bool		  m_quit = false;
+		bool		  m_first_frame = true;
+		bool		  m_poll_events = true;
+		bool		  m_headless = false;
 
 		glm::ivec2	  m_mouse_pos = glm::ivec2();
 		glm::ivec2	  m_prev_mouse_pos = glm::ivec2();
 		bool		  m_button_state[3] = { 0, 0, 0 };
 		bool		  m_button_pressed[3] = { 0, 0, 0 };
 		bool		  m_button_released[3] = { 0, 0, 0 };
+		bool		  m_prev_button_state[3] = { 0, 0, 0 };
 		bool		  m_mouse_dragging = false;
 
+		std::bitset<NUM_SCANCODES> m_key_state;
+		std::bitset<NUM_SCANCODES> m_prev_key_state;
+
+		std::vector<InputEvent> m_input_events;
+		bool		  m_coalesce_motion = false;
+
+		InputLog	  m_input_log;
+		std::vector<InputEvent> m_replay_events;
+		std::bitset<NUM_SCANCODES> m_replay_key_state;
+
+		LatencyTracker m_latency;
+		FrameProfiler m_profiler;
+		PerformanceOverlay m_overlay;
+		bool		  m_overlay_shown = false;
+		bool		  m_overlay_profiling = false;  // profiling was enabled for the overlay, rather than by the application.
+
 		glm::vec4	  m_requested_canvas = glm::vec4(0.0f);
 		glm::vec4	  m_canvas;
 		int			  m_canvas_mode = 0;
+		bool		  m_canvas_dirty = true;
+		bool		  m_resize_pending = false;
+		glm::ivec2	  m_pending_size = glm::ivec2();
 
 		glm::mat4	  m_projection;
 		glm::mat4	  m_transformation = glm::mat4(1.0f);
 		float		  m_orientation = 0.0f;
 		glm::vec3	  m_scale = glm::vec3(1.0f);
-		Shader		  m_flat_shader;
-		
-		GLuint		m_rect_vbo;
-		GLuint		m_rect_vao;
-		GLuint		m_rect_outline_vbo;
-		GLuint		m_rect_outline_vao;
-		GLuint		m_line_vbo;
-		GLuint		m_line_vao;
-		GLuint		m_sector_vbo;
-		GLuint		m_sector_vao;
-		GLuint		m_sector_outline_vbo;
-		GLuint		m_sector_outline_vao;
+		bool		  m_drawing = false;  // the draw callback (or a capture replay) is running, so the pose applies to its calls.
+		std::string	  m_font;
 
 		glm::vec4	m_window_to_canvas_factors;
 
 		AudioManager * m_audio = nullptr;
+		std::mutex	  m_audio_mutex;
+		std::thread	  m_warmup_thread;
+
+		std::vector<StartupTiming> m_startup_timings;
+		std::mutex	  m_startup_mutex;
+
+		FrameArena	  m_frame_arena;
+		size_t		  m_tracked_arena_capacity = 0;
+		AllocationTracker m_alloc_tracker;
 
-		TextureManager textures;
+		RemoteServer * m_remote_server = nullptr;
+		FrameExporter * m_frame_exporter = nullptr;
+		FrameRecorder * m_frame_recorder = nullptr;
+		CaptureWriter * m_capture = nullptr;
+		CaptureReplay * m_capture_replay = nullptr;
 
 		std::chrono::time_point<std::chrono::steady_clock> m_prev_time_tick;
 		float m_global_time = 0.0f;
@@ -78,12 +120,22 @@ namespace graphics
 
 		const void* m_user_data = nullptr;
 
+		std::vector<SDL_Event> m_event_inbox;	// filled by pumpEvents(), under its lock
+		std::vector<SDL_Event> m_frame_events;
+
+		static void pumpEvents();
 		bool processEvent(SDL_Event event);
+		void applyInputEvent(const InputEvent & ev);
 
 		void advanceTime();
 
+		void recordStartupPhase(const char * phase, std::chrono::steady_clock::time_point start, bool background = false);
+		AudioManager * getAudio(bool background = false);
+		bool ensureFonts();
+
 		void computeProjection();
-		void initPrimitives();
+		void updateCanvas();
+		bool initRenderer(renderer_t type);
 		void computeTransformation();
 
 		std::function<void()> m_draw_callback = nullptr;
@@ -91,21 +143,24 @@ namespace graphics
 		std::function<void(int w, int h)> m_resize_callback = nullptr;
 
 	public:
-		void drawRect(float cx, float cy, float w, float h, const struct Brush & brush);
-		void drawLine(float x_1, float y_1, float x_2, float y_2, const struct Brush & brush);
-		void drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const struct Brush & brush);
-		void drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush);
+		virtual void drawRect(float cx, float cy, float w, float h, const struct Brush & brush);
+		virtual void drawLine(float x_1, float y_1, float x_2, float y_2, const struct Brush & brush);
+		virtual void drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const struct Brush & brush);
+		virtual void drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush);
 		
 		void setUserData(const void* user_data);
 		void* getUserData();
 
-		void setScale(float sx, float sy, float sz);
-		void setOrientation(float degrees);
-		void resetPose();
-		bool setFont(std::string fontname);
+		virtual void setScale(float sx, float sy, float sz);
+		virtual void setOrientation(float degrees);
+		virtual void resetPose();
+		virtual bool setFont(std::string fontname);
 		std::vector<std::string> preloadBitmaps(std::string dir);
 
 		bool getKeyState(scancode_t key);
+		bool isKeyDown(scancode_t key);
+		bool wasKeyPressed(scancode_t key);
+		bool wasKeyReleased(scancode_t key);
 		void setDrawCallback(std::function<void()> drf);
 		void setIdleCallback(std::function<void(float ms)> idf);
 		void setResizeCallback(std::function<void(int w, int h)> rsf);
@@ -114,15 +169,22 @@ namespace graphics
 		virtual void cleanup();
 		void swap();
 		bool processMessages();
+		bool runFrames(unsigned int count);
+		void setHeadless(bool headless) { m_headless = headless; }
+		bool isHeadless() const { return m_headless; }
+		void setRendererType(renderer_t type) { m_renderer_type = type; }
+		renderer_t getRendererType() const { return m_renderer_type; }
+		bool getFramePixels(std::vector<unsigned char> & pixels, int & width, int & height);
+		bool saveFrame(const std::string & filename);
 		virtual void update(float delta_time = 0.0f);
 		virtual void resize(int w, int h);
 		float WindowToCanvasX(float x, bool clamped = true);
 		float WindowToCanvasY(float y, bool clamped = true);
 		virtual void draw();
 		virtual ~GLBackend();
-		void makeCurrent();
-		void show(bool s);
-		void setBackgroundColor(float r, float g, float b);
+		virtual void makeCurrent();
+		virtual void show(bool s);
+		virtual void setBackgroundColor(float r, float g, float b);
 		float getDeltaTime();
 		float getGlobalTime();
 		void getMouseButtonPressed(bool * button_array);
@@ -131,9 +193,47 @@ namespace graphics
 		void getMousePosition(int * x, int * y);
 		void getPrevMousePosition(int * x, int * y);
 		bool isMouseDragging();
-		void setCanvasMode(int m);
-		void setCanvasSize(float w, float h);
+		const std::vector<InputEvent> & getInputEvents();
+		void setInputEventCoalescing(bool coalesce);
+		bool startInputRecording(const std::string & filename);
+		void stopInputRecording();
+		bool startInputReplay(const std::string & filename, bool uncapped);
+		void stopInputReplay();
+		bool isReplayingInput();
+		void setLatencyTracking(bool enable);
+		void getLatencyStats(LatencyStats & stats);
+		void setProfiling(bool enable);
+		bool getFrameStats(FrameStats & stats);
+		void getFrameStatsHistory(std::vector<FrameStats> & history);
+		void setPerformanceOverlay(bool show);
+		void drawOverlay();
+		bool setOverdrawVisualization(bool enable);
+		bool getOverdrawStats(OverdrawStats & stats);
+		void getFrameMemoryStats(FrameMemoryStats & stats);
+		void setAllocationCheck(alloc_check_t check, unsigned int warmup_frames);
+		void getAllocationStats(AllocationStats & stats);
+		virtual void setCanvasMode(int m);
+		virtual void setCanvasSize(float w, float h);
 		void setFullscreen(bool fs);
+		void initSubsystems(unsigned int subsystems, bool background);
+		void getStartupTimings(std::vector<StartupTiming> & timings);
+		bool startRemoteServer(const std::string & socket_path, const std::string & asset_root);
+		void stopRemoteServer();
+		bool isRemoteClientConnected();
+		bool startFrameExport(const std::string & name, unsigned int slots);
+		void stopFrameExport();
+		void getFrameExportStats(FrameExportStats & stats);
+		bool captureFrame(const std::string & filename);
+		bool startFrameRecording(const std::string & filename, recording_format_t format, unsigned int fps);
+		void stopFrameRecording();
+		void getFrameRecordingStats(FrameRecordingStats & stats);
+		bool startCapture(const std::string & filename);
+		void stopCapture();
+		bool isCapturing();
+		CommandEncoder * getCaptureEncoder();
+		bool startCaptureReplay(const std::string & filename, unsigned int loops);
+		void stopCaptureReplay();
+		bool isReplayingCapture();
 
 		void playSound(std::string soundfile, float volume, bool looping = false);
 		void playMusic(std::string soundfile, float volume, bool looping = true, int fade_time = 0);
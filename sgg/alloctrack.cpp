@@ -0,0 +1,268 @@
+#include <sgg/alloctrack.h>
+#include <SDL2/SDL.h>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+namespace graphics
+{
+	// plain data only: these are touched from within operator new, before any dynamic initialization.
+	struct ThreadAllocations
+	{
+		bool         active;
+		bool         capture;
+		unsigned int count;
+		size_t       bytes;
+		unsigned int num_call_sites;
+		void *       call_sites[AllocationTracker::max_call_sites];
+	};
+
+	static thread_local ThreadAllocations thread_allocations;
+
+	static AllocationHooks hooks = { &std::malloc, &std::realloc, &std::free };
+
+	static inline void countAllocation(size_t size, void * call_site)
+	{
+		ThreadAllocations & t = thread_allocations;
+		if (!t.active)
+			return;
+		t.count++;
+		t.bytes += size;
+		if (t.capture && t.num_call_sites < AllocationTracker::max_call_sites)
+			t.call_sites[t.num_call_sites++] = call_site;
+	}
+
+	bool AllocationTracker::isAvailable()
+	{
+#ifdef SGG_TRACK_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void AllocationTracker::setHooks(const AllocationHooks & new_hooks)
+	{
+		hooks = new_hooks;
+	}
+
+	void * AllocationTracker::allocate(size_t size, void * call_site)
+	{
+		countAllocation(size, call_site);
+		return hooks.allocate(size);
+	}
+
+	void * AllocationTracker::reallocate(void * ptr, size_t size, void * call_site)
+	{
+		countAllocation(size, call_site);
+		return hooks.reallocate(ptr, size);
+	}
+
+	void AllocationTracker::deallocate(void * ptr)
+	{
+		hooks.deallocate(ptr);
+	}
+
+#ifdef SGG_TRACK_ALLOCATIONS
+	static void * sdlMalloc(size_t size)
+	{
+		return AllocationTracker::allocate(size, SGG_CALL_SITE());
+	}
+
+	static void * sdlCalloc(size_t count, size_t size)
+	{
+		void * ptr = AllocationTracker::allocate(count * size, SGG_CALL_SITE());
+		if (ptr)
+			memset(ptr, 0, count * size);
+		return ptr;
+	}
+
+	static void * sdlRealloc(void * ptr, size_t size)
+	{
+		return AllocationTracker::reallocate(ptr, size, SGG_CALL_SITE());
+	}
+
+	static void sdlFree(void * ptr)
+	{
+		AllocationTracker::deallocate(ptr);
+	}
+#endif
+
+	static void * ftAlloc(FT_Memory, long size)
+	{
+		return AllocationTracker::allocate((size_t)size, SGG_CALL_SITE());
+	}
+
+	static void * ftRealloc(FT_Memory, long, long new_size, void * block)
+	{
+		return AllocationTracker::reallocate(block, (size_t)new_size, SGG_CALL_SITE());
+	}
+
+	static void ftFree(FT_Memory, void * block)
+	{
+		AllocationTracker::deallocate(block);
+	}
+
+	static FT_MemoryRec_ freetype_memory = { nullptr, ftAlloc, ftFree, ftRealloc };
+
+	void AllocationTracker::installLibraryHooks()
+	{
+#ifdef SGG_TRACK_ALLOCATIONS
+		// SDL must not own any memory when its allocator is replaced.
+		if (SDL_GetNumAllocations() == 0)
+			SDL_SetMemoryFunctions(sdlMalloc, sdlCalloc, sdlRealloc, sdlFree);
+#endif
+	}
+
+	FT_Memory AllocationTracker::getFreeTypeMemory()
+	{
+		return &freetype_memory;
+	}
+
+	void AllocationTracker::setCheck(alloc_check_t check, unsigned int warmup_frames)
+	{
+		m_check = check;
+		m_warmup_frames = warmup_frames;
+		m_frame = 0;
+		m_stats = AllocationStats();
+	}
+
+	void AllocationTracker::beginFrame()
+	{
+		ThreadAllocations & t = thread_allocations;
+		t.count = 0;
+		t.bytes = 0;
+		t.num_call_sites = 0;
+		t.capture = (m_check != ALLOC_CHECK_OFF);
+		t.active = true;
+	}
+
+	void AllocationTracker::endFrame()
+	{
+		ThreadAllocations & t = thread_allocations;
+		t.active = false;
+
+		m_stats.frame_allocations = t.count;
+		m_stats.frame_bytes = t.bytes;
+		m_stats.num_call_sites = t.num_call_sites;
+		for (unsigned int i = 0; i < t.num_call_sites; i++)
+			m_stats.call_sites[i] = t.call_sites[i];
+
+		// the first frames legitimately allocate caches, fonts, textures etc.
+		if (++m_frame <= m_warmup_frames)
+			return;
+
+		m_stats.frames++;
+		if (t.count == 0)
+			return;
+		m_stats.allocating_frames++;
+		if (t.count > m_stats.max_frame_allocations)
+			m_stats.max_frame_allocations = t.count;
+		if (t.bytes > m_stats.max_frame_bytes)
+			m_stats.max_frame_bytes = t.bytes;
+
+		if (m_check == ALLOC_CHECK_OFF)
+			return;
+
+		printf("Frame %u made %u heap allocations (%zu bytes) after warm-up\n", m_frame, t.count, t.bytes);
+#if defined(__GLIBC__)
+		backtrace_symbols_fd(t.call_sites, (int)t.num_call_sites, fileno(stdout));
+#else
+		for (unsigned int i = 0; i < t.num_call_sites; i++)
+			printf("  allocated from %p\n", t.call_sites[i]);
+#endif
+		if (m_check == ALLOC_CHECK_ASSERT)
+		{
+			fflush(stdout);
+			std::abort();
+		}
+	}
+}
+
+#ifdef SGG_TRACK_ALLOCATIONS
+
+using graphics::AllocationTracker;
+
+static void * alignedAllocate(std::size_t size, std::size_t alignment)
+{
+#if defined(_MSC_VER)
+	return _aligned_malloc(size, alignment);
+#else
+	void * ptr = nullptr;
+	if (posix_memalign(&ptr, alignment < sizeof(void *) ? sizeof(void *) : alignment, size))
+		return nullptr;
+	return ptr;
+#endif
+}
+
+static void alignedFree(void * ptr)
+{
+#if defined(_MSC_VER)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void * operator new(std::size_t size)
+{
+	void * ptr = AllocationTracker::allocate(size ? size : 1, SGG_CALL_SITE());
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+	void * ptr = AllocationTracker::allocate(size ? size : 1, SGG_CALL_SITE());
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return AllocationTracker::allocate(size ? size : 1, SGG_CALL_SITE());
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return AllocationTracker::allocate(size ? size : 1, SGG_CALL_SITE());
+}
+
+void operator delete(void * ptr) noexcept { AllocationTracker::deallocate(ptr); }
+void operator delete[](void * ptr) noexcept { AllocationTracker::deallocate(ptr); }
+void operator delete(void * ptr, std::size_t) noexcept { AllocationTracker::deallocate(ptr); }
+void operator delete[](void * ptr, std::size_t) noexcept { AllocationTracker::deallocate(ptr); }
+void operator delete(void * ptr, const std::nothrow_t &) noexcept { AllocationTracker::deallocate(ptr); }
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept { AllocationTracker::deallocate(ptr); }
+
+#ifdef __cpp_aligned_new
+// over-aligned allocations are counted but bypass the hooks, as they need a matching aligned free.
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+	graphics::countAllocation(size, SGG_CALL_SITE());
+	void * ptr = alignedAllocate(size ? size : 1, (std::size_t)alignment);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void * ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void * ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete(void * ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void * ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+#include <sgg/graphics.h>
+#include <cstddef>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SYSTEM_H
+
+// the address the calling function returns to, recorded as the call site of an allocation.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SGG_CALL_SITE() _ReturnAddress()
+#elif defined(__GNUC__)
+#define SGG_CALL_SITE() __builtin_return_address(0)
+#else
+#define SGG_CALL_SITE() nullptr
+#endif
+
+namespace graphics
+{
+	/** The allocator used by the engine when allocation tracking is compiled in (SGG_TRACK_ALLOCATIONS).
+
+		All global operator new / delete calls, as well as the allocations made by SDL (and SDL_mixer) and by
+		FreeType, are routed through these functions, which can be replaced to hook a custom allocator.
+	*/
+	struct AllocationHooks
+	{
+		void * (*allocate)(size_t size);
+		void * (*reallocate)(void * ptr, size_t size);
+		void   (*deallocate)(void * ptr);
+	};
+
+	/** Counts the heap allocations made by a thread between the start and the end of each frame.
+
+		Counting only happens in builds with SGG_TRACK_ALLOCATIONS defined, where the global allocation
+		functions are replaced. Otherwise, all reported counts are zero.
+	*/
+	class AllocationTracker
+	{
+		AllocationStats m_stats;
+		alloc_check_t m_check = ALLOC_CHECK_OFF;
+		unsigned int m_warmup_frames = 0;
+		unsigned int m_frame = 0;
+
+	public:
+		static constexpr unsigned int max_call_sites = 8;
+
+		static bool isAvailable();
+		static void setHooks(const AllocationHooks & hooks);
+		static void * allocate(size_t size, void * call_site);
+		static void * reallocate(void * ptr, size_t size, void * call_site);
+		static void deallocate(void * ptr);
+		static void installLibraryHooks();
+		static FT_Memory getFreeTypeMemory();
+
+		void setCheck(alloc_check_t check, unsigned int warmup_frames);
+		void beginFrame();
+		void endFrame();
+		const AllocationStats & getStats() const { return m_stats; }
+	};
+}
@@ -0,0 +1,94 @@
+#include <sgg/arena.h>
+#include <sgg/alloctrack.h>
+#include <cstring>
+#include <algorithm>
+
+namespace graphics
+{
+	FrameArena::FrameArena(size_t block_size) :
+		m_block_size(block_size)
+	{
+
+	}
+
+	FrameArena::~FrameArena()
+	{
+		releaseBlocks();
+	}
+
+	bool FrameArena::addBlock(size_t min_size)
+	{
+		Block block;
+		block.size = std::max(m_block_size, min_size);
+		// through the tracker, so that a frame that grows the arena shows up in its allocation counts.
+		block.data = static_cast<char *>(AllocationTracker::allocate(block.size, SGG_CALL_SITE()));
+		if (!block.data)
+			return false;
+		m_blocks.push_back(block);
+		m_capacity += block.size;
+		return true;
+	}
+
+	void FrameArena::releaseBlocks()
+	{
+		for (Block & block : m_blocks)
+			AllocationTracker::deallocate(block.data);
+		m_blocks.clear();
+		m_capacity = 0;
+	}
+
+	void * FrameArena::allocate(size_t bytes, size_t alignment)
+	{
+		while (true)
+		{
+			if (m_current < m_blocks.size())
+			{
+				Block & block = m_blocks[m_current];
+				size_t start = (m_offset + alignment - 1) & ~(alignment - 1);
+				if (start + bytes <= block.size)
+				{
+					m_used += (start - m_offset) + bytes;
+					m_peak = std::max(m_peak, m_used);
+					m_offset = start + bytes;
+					return block.data + start;
+				}
+				if (m_current + 1 < m_blocks.size())
+				{
+					m_current++;
+					m_offset = 0;
+					continue;
+				}
+			}
+
+			// out of space: grab another block, large enough for this request.
+			if (!addBlock(bytes + alignment))
+				return nullptr;
+			m_current = m_blocks.size() - 1;
+			m_offset = 0;
+		}
+	}
+
+	const char * FrameArena::copyString(const char * str, size_t length)
+	{
+		char * copy = allocateArray<char>(length + 1);
+		if (!copy)
+			return nullptr;
+		memcpy(copy, str, length);
+		copy[length] = '\0';
+		return copy;
+	}
+
+	void FrameArena::reset()
+	{
+		// a frame that spilled into several blocks gets a single block big enough for the peak usage.
+		if (m_blocks.size() > 1)
+		{
+			size_t size = m_capacity;
+			releaseBlocks();
+			addBlock(size);
+		}
+		m_current = 0;
+		m_offset = 0;
+		m_used = 0;
+	}
+}
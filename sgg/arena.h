@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace graphics
+{
+	/** A linear (bump) allocator for data that only lives for the duration of a single frame.
+
+		Allocations are carved sequentially out of large blocks and are never freed individually: 
+		the whole arena is rewound at once with reset(), at the end of each frame. If a frame needs 
+		more than one block, the blocks are merged into a single one at the next reset, so that 
+		steady-state frames are served from one block without calling into the global heap.
+	*/
+	class FrameArena
+	{
+		struct Block
+		{
+			char * data = nullptr;
+			size_t size = 0;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_block_size;
+		size_t m_current = 0;
+		size_t m_offset = 0;
+		size_t m_used = 0;
+		size_t m_peak = 0;
+		size_t m_capacity = 0;
+
+		bool addBlock(size_t min_size);
+		void releaseBlocks();
+
+	public:
+		explicit FrameArena(size_t block_size = 64 * 1024);
+		FrameArena(const FrameArena &) = delete;
+		FrameArena & operator = (const FrameArena &) = delete;
+		~FrameArena();
+
+		// returns nullptr if the arena is out of space and a new block cannot be allocated.
+		void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+		template <typename T>
+		T * allocateArray(size_t count)
+		{
+			return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+		}
+
+		const char * copyString(const char * str, size_t length);
+		const char * copyString(const std::string & str) { return copyString(str.c_str(), str.length()); }
+
+		void reset();
+
+		size_t getUsed() const { return m_used; }
+		size_t getPeak() const { return m_peak; }
+		size_t getCapacity() const { return m_capacity; }
+		size_t getNumBlocks() const { return m_blocks.size(); }
+	};
+}
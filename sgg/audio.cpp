@@ -20,9 +20,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <atomic>
 #include <SDL2/SDL.h>
 
 #include <sgg/audio.h>
+#include <sgg/graphics.h>
+#ifdef SGG_TRACING
+#include <sgg/trace.h>
+#endif
 
 /*
  * Native WAVE format
@@ -48,17 +53,15 @@
 /* Max number of sounds that can be in the audio queue at anytime, stops too much mixing */
 #define AUDIO_MAX_SOUNDS 25
 
-/* Flags OR'd together, which specify how SDL should behave when a device cannot offer a specific feature
- * If flag is set, SDL will change the format in the actual audio file structure (as opposed to gDevice->want)
- *
- * Note: If you're having issues with Emscripten / EMCC play around with these flags
- *
- * 0                                    Allow no changes
- * SDL_AUDIO_ALLOW_FREQUENCY_CHANGE     Allow frequency changes (e.g. AUDIO_FREQUENCY is 48k, but allow files to play at 44.1k
- * SDL_AUDIO_ALLOW_FORMAT_CHANGE        Allow Format change (e.g. AUDIO_FORMAT may be S32LSB, but allow wave files of S16LSB to play)
- * SDL_AUDIO_ALLOW_CHANNELS_CHANGE      Allow any number of channels (e.g. AUDIO_CHANNELS being 2, allow actual 1)
- * SDL_AUDIO_ALLOW_ANY_CHANGE           Allow all changes above
- */
+/* Max number of musics playing at once: the current one, one fading out and one waiting for the fade to end */
+#define AUDIO_MAX_MUSIC 3
+
+/* Number of preallocated voices the callback mixes */
+#define AUDIO_MAX_VOICES (AUDIO_MAX_SOUNDS + AUDIO_MAX_MUSIC)
+
+/* Capacity of the command queues between the game thread and the callback. Must be a power of 2 */
+#define AUDIO_QUEUE_SIZE 64
+
 #define SDL_AUDIO_ALLOW_CHANGES SDL_AUDIO_ALLOW_ANY_CHANGE
 
 /*
@@ -72,17 +75,70 @@ typedef struct privateAudioDevice
     uint8_t audioEnabled;
 } PrivateAudioDevice;
 
-/* File scope variables to persist data */
-static PrivateAudioDevice * gDevice;
-static uint32_t gSoundCount;
+/*
+ * A request to start playing an Audio, sent from the game thread to the callback, or a voice that has stopped,
+ * sent back from the callback so that the game thread reclaims it
+ *
+ */
+typedef struct audioCommand
+{
+    Audio * audio;
+    uint8_t loop;
+    uint8_t volume;
+    uint8_t owned;  /* the Audio was created by playAudio and is freed once it stops */
+} AudioCommand;
 
 /*
- * Add a music to the queue, addAudio wrapper for music due to fade
+ * Single-producer, single-consumer ring of commands. The producer only writes tail and the consumer only writes
+ * head, so neither side ever waits for the other
  *
- * @param new       New Audio to add
+ */
+typedef struct audioQueue
+{
+    AudioCommand items[AUDIO_QUEUE_SIZE];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+} AudioQueue;
+
+/*
+ * A slot of the mixer, only accessed by the callback while the device is running
  *
  */
-static void addMusic(Audio * root, Audio * news);
+typedef struct voice
+{
+    AudioCommand command;
+    uint8_t * buffer;
+    uint32_t length;
+    uint8_t fade;
+    uint8_t volume;
+    uint8_t active;
+} Voice;
+
+/*
+ * State shared by the game thread and the callback, allocated once by initAudio
+ *
+ */
+typedef struct audioMixer
+{
+    Voice voices[AUDIO_MAX_VOICES];
+    AudioQueue commands;  /* game thread -> callback */
+    AudioQueue finished;  /* callback -> game thread */
+} AudioMixer;
+
+/* File scope variables to persist data */
+static PrivateAudioDevice * gDevice;
+static AudioMixer gMixer;
+
+/* Sounds and Audios started by the game thread and not yet reclaimed, only accessed by the game thread.
+ * Each command sent to the callback comes back through the finished queue exactly once, so keeping the
+ * number of unreclaimed commands within AUDIO_QUEUE_SIZE guarantees that neither queue can overflow */
+static uint32_t gSoundCount;
+static uint32_t gInFlight;
+
+#ifdef SGG_TRACING
+/* Trace buffer of the callback, reserved by initAudio, as the callback must neither lock nor allocate to get one */
+static graphics::TraceBuffer * gTraceBuffer;
+#endif
 
 /*
  * Wrapper function for playMusic, playSound, playMusicFromMemory, playSoundFromMemory
@@ -96,24 +152,85 @@ static void addMusic(Audio * root, Audio * news);
 static inline void playAudio(const char * filename, Audio * audio, uint8_t loop, int volume);
 
 /*
- * Add a sound to the end of the queue
+ * Start a voice for a new Audio, fading out any current music if it is a music
  *
- * @param root      Root of queue
- * @param new       New Audio to add
+ * @param mixer     Mixer to start the voice on
+ * @param command   Audio to play
  *
  */
-static void addAudio(Audio * root, Audio * news);
+static void startVoice(AudioMixer * mixer, const AudioCommand * command);
 
 /*
  * Audio callback function for OpenAudioDevice
  *
- * @param userdata      Points to linked list of sounds to play, first being a placeholder
+ * @param userdata      Points to the AudioMixer
  * @param stream        Stream to mix sound into
  * @param len           Length of sound to play
  *
  */
 static inline void audioCallback(void * userdata, uint8_t * stream, int len);
 
+static void resetQueue(AudioQueue * queue)
+{
+    queue->head.store(0, std::memory_order_relaxed);
+    queue->tail.store(0, std::memory_order_relaxed);
+}
+
+/*
+ * Append a command, returns 0 if the queue is full
+ *
+ */
+static int pushCommand(AudioQueue * queue, const AudioCommand * command)
+{
+    uint32_t tail = queue->tail.load(std::memory_order_relaxed);
+
+    if(tail - queue->head.load(std::memory_order_acquire) == AUDIO_QUEUE_SIZE)
+    {
+        return 0;
+    }
+
+    queue->items[tail & (AUDIO_QUEUE_SIZE - 1)] = *command;
+    queue->tail.store(tail + 1, std::memory_order_release);
+    return 1;
+}
+
+/*
+ * Remove the oldest command, returns 0 if the queue is empty
+ *
+ */
+static int popCommand(AudioQueue * queue, AudioCommand * command)
+{
+    uint32_t head = queue->head.load(std::memory_order_relaxed);
+
+    if(head == queue->tail.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    *command = queue->items[head & (AUDIO_QUEUE_SIZE - 1)];
+    queue->head.store(head + 1, std::memory_order_release);
+    return 1;
+}
+
+/*
+ * Release a command that will not be played anymore, on the game thread
+ *
+ */
+static void releaseCommand(const AudioCommand * command)
+{
+    if(command->owned)
+    {
+        freeAudio(command->audio);
+    }
+
+    if(command->loop == 0)
+    {
+        gSoundCount--;
+    }
+
+    gInFlight--;
+}
+
 void playSound(const char * filename, int volume)
 {
     playAudio(filename, NULL, 0, volume);
@@ -136,9 +253,9 @@ void playMusicFromMemory(Audio * audio, int volume)
 
 void initAudio(void)
 {
-    Audio * global;
     gDevice = (PrivateAudioDevice*)calloc(1, sizeof(PrivateAudioDevice));
     gSoundCount = 0;
+    gInFlight = 0;
 
     if(gDevice == NULL)
     {
@@ -154,6 +271,11 @@ void initAudio(void)
         return;
     }
 
+    /* The device is not open yet, so the callback cannot be running */
+    SDL_memset(gMixer.voices, 0, sizeof(gMixer.voices));
+    resetQueue(&gMixer.commands);
+    resetQueue(&gMixer.finished);
+
     SDL_memset(&(gDevice->want), 0, sizeof(gDevice->want));
 
     (gDevice->want).freq = AUDIO_FREQUENCY;
@@ -161,20 +283,12 @@ void initAudio(void)
     (gDevice->want).channels = AUDIO_CHANNELS;
     (gDevice->want).samples = AUDIO_SAMPLES;
     (gDevice->want).callback = audioCallback;
-    (gDevice->want).userdata = calloc(1, sizeof(Audio));
-
-    global = (Audio*)(gDevice->want).userdata;
-
-    if(global == NULL)
-    {
-        fprintf(stderr, "[%s: %d]Error: Memory allocation error\n", __FILE__, __LINE__);
-        return;
-    }
+    (gDevice->want).userdata = &gMixer;
 
-    global->buffer = NULL;
-    global->next = NULL;
+#ifdef SGG_TRACING
+    gTraceBuffer = graphics::Tracer::reserveBuffer("audio");
+#endif
 
-    /* want.userdata = new; */
     if((gDevice->device = SDL_OpenAudioDevice(NULL, 0, &(gDevice->want), NULL, SDL_AUDIO_ALLOW_CHANGES)) == 0)
     {
         fprintf(stderr, "[%s: %d]Warning: failed to open audio device: %s\n", __FILE__, __LINE__, SDL_GetError());
@@ -191,19 +305,52 @@ void initAudio(void)
 
 void endAudio(void)
 {
+    AudioCommand command;
+    int i;
+
     if(gDevice->audioEnabled)
     {
         pauseAudio();
 
-        freeAudio((Audio *) (gDevice->want).userdata);
-
-        /* Close down audio */
+        /* Close down audio, after which the callback is not running anymore and all voices belong to this thread */
         SDL_CloseAudioDevice(gDevice->device);
+
+        for(i = 0; i < AUDIO_MAX_VOICES; i++)
+        {
+            if(gMixer.voices[i].active)
+            {
+                releaseCommand(&(gMixer.voices[i].command));
+                gMixer.voices[i].active = 0;
+            }
+        }
+
+        while(popCommand(&gMixer.commands, &command) || popCommand(&gMixer.finished, &command))
+        {
+            releaseCommand(&command);
+        }
     }
 
+#ifdef SGG_TRACING
+    if(gTraceBuffer != NULL)
+    {
+        graphics::Tracer::releaseBuffer(gTraceBuffer);
+        gTraceBuffer = NULL;
+    }
+#endif
+
     free(gDevice);
 }
 
+void updateAudio(void)
+{
+    AudioCommand command;
+
+    while(popCommand(&gMixer.finished, &command))
+    {
+        releaseCommand(&command);
+    }
+}
+
 void pauseAudio(void)
 {
     if(gDevice->audioEnabled)
@@ -277,7 +424,7 @@ Audio * createAudio(const char * filename, uint8_t loop, int volume)
 
 static inline void playAudio(const char * filename, Audio * audio, uint8_t loop, int volume)
 {
-    Audio * news;
+    AudioCommand command;
 
     /* Check if audio is enabled */
     if(!gDevice->audioEnabled)
@@ -285,40 +432,30 @@ static inline void playAudio(const char * filename, Audio * audio, uint8_t loop,
         return;
     }
 
+    /* Reclaim the voices that have stopped since the last call */
+    updateAudio();
+
     /* If sound, check if under max number of sounds allowed, else don't play */
-    if(loop == 0)
+    if((loop == 0 && gSoundCount >= AUDIO_MAX_SOUNDS) || gInFlight >= AUDIO_QUEUE_SIZE)
     {
-        if(gSoundCount >= AUDIO_MAX_SOUNDS)
-        {
-            return;
-        }
-        else
-        {
-            gSoundCount++;
-        }
+        return;
     }
 
-    /* Load from filename or from Memory */
+    /* Load from filename or from Memory; Audios from memory are played in place, without a copy */
     if(filename != NULL)
     {
-        /* Create new music sound with loop */
-        news = createAudio(filename, loop, volume);
-    }
-    else if(audio != NULL)
-    {
-        news = (Audio*)malloc(sizeof(Audio));
+        command.audio = createAudio(filename, loop, volume);
+        command.owned = 1;
 
-        if(news == NULL)
+        if(command.audio == NULL)
         {
-            fprintf(stderr, "[%s: %d]Fatal Error: Memory allocation error\n", __FILE__, __LINE__);
             return;
         }
-
-        memcpy(news, audio, sizeof(Audio));
-
-        news->volume = volume;
-        news->loop = loop;
-        news->free = 0;
+    }
+    else if(audio != NULL)
+    {
+        command.audio = audio;
+        command.owned = 0;
     }
     else
     {
@@ -326,134 +463,160 @@ static inline void playAudio(const char * filename, Audio * audio, uint8_t loop,
         return;
     }
 
-    /* Lock callback function */
-    SDL_LockAudioDevice(gDevice->device);
+    command.loop = loop;
+    command.volume = volume;
 
-    if(loop == 1)
-    {
-        addMusic((Audio *) (gDevice->want).userdata, news);
-    }
-    else
+    /* Cannot fail, as the number of commands in flight is bounded by the queue size */
+    pushCommand(&gMixer.commands, &command);
+    gInFlight++;
+
+    if(loop == 0)
     {
-        addAudio((Audio *) (gDevice->want).userdata, news);
+        gSoundCount++;
     }
-
-    SDL_UnlockAudioDevice(gDevice->device);
-
 }
 
-static void addMusic(Audio * root, Audio * news)
+static void startVoice(AudioMixer * mixer, const AudioCommand * command)
 {
     uint8_t musicFound = 0;
-    Audio * rootNext = root->next;
+    Voice * voice;
+    Voice * freeVoice = NULL;
+    int i;
 
-    /* Find any existing musics, 0, 1 or 2 and fade them out */
-    while(rootNext != NULL)
+    if(command->loop == 1)
     {
-        /* Phase out any current music */
-        if(rootNext->loop == 1 && rootNext->fade == 0)
+        /* Set flag to remove any queued up music in favour of new music */
+        for(i = 0; i < AUDIO_MAX_VOICES; i++)
         {
-            if(musicFound)
+            voice = &(mixer->voices[i]);
+
+            if(voice->active && voice->command.loop == 1 && voice->fade == 1)
             {
-                rootNext->length = 0;
-                rootNext->volume = 0;
+                musicFound = 1;
             }
+        }
 
-            rootNext->fade = 1;
+        /* Phase out any current music */
+        for(i = 0; i < AUDIO_MAX_VOICES; i++)
+        {
+            voice = &(mixer->voices[i]);
+
+            if(voice->active && voice->command.loop == 1 && voice->fade == 0)
+            {
+                if(musicFound)
+                {
+                    voice->length = 0;
+                    voice->volume = 0;
+                }
+
+                voice->fade = 1;
+            }
         }
-        /* Set flag to remove any queued up music in favour of new music */
-        else if(rootNext->loop == 1 && rootNext->fade == 1)
+    }
+
+    for(i = 0; i < AUDIO_MAX_VOICES && freeVoice == NULL; i++)
+    {
+        if(!mixer->voices[i].active)
         {
-            musicFound = 1;
+            freeVoice = &(mixer->voices[i]);
         }
+    }
 
-        rootNext = rootNext->next;
+    if(freeVoice == NULL)
+    {
+        /* All voices busy, hand the Audio straight back */
+        pushCommand(&mixer->finished, command);
+        return;
     }
 
-    addAudio(root, news);
+    freeVoice->command = *command;
+    freeVoice->buffer = command->audio->bufferTrue;
+    freeVoice->length = command->audio->lengthTrue;
+    freeVoice->fade = 0;
+    freeVoice->volume = command->volume;
+    freeVoice->active = 1;
 }
 
 static inline void audioCallback(void * userdata, uint8_t * stream, int len)
 {
-    Audio * audio = (Audio *) userdata;
-    Audio * previous = audio;
-    int tempLength;
+#ifdef SGG_TRACING
+    graphics::Tracer::useBuffer(gTraceBuffer);
+#endif
+    SGG_PROFILE_SCOPE("audio callback");
+    AudioMixer * mixer = (AudioMixer *) userdata;
+    AudioCommand command;
+    Voice * voice;
+    uint32_t tempLength;
     uint8_t music = 0;
+    int i;
 
     /* Silence the main buffer */
     SDL_memset(stream, 0, len);
 
-    /* First one is place holder */
-    audio = audio->next;
+    /* Take the Audios started since the last callback */
+    while(popCommand(&mixer->commands, &command))
+    {
+        startVoice(mixer, &command);
+    }
 
-    while(audio != NULL)
+    /* A new music waits for the previous one to fade out */
+    for(i = 0; i < AUDIO_MAX_VOICES; i++)
     {
-        if(audio->length > 0)
+        voice = &(mixer->voices[i]);
+
+        if(voice->active && voice->length > 0 && voice->command.loop == 1 && voice->fade == 1)
         {
-            if(audio->fade == 1 && audio->loop == 1)
-            {
-                music = 1;
+            music = 1;
+        }
+    }
+
+    for(i = 0; i < AUDIO_MAX_VOICES; i++)
+    {
+        voice = &(mixer->voices[i]);
+
+        if(!voice->active)
+        {
+            continue;
+        }
 
-                if(audio->volume > 0)
+        if(voice->length > 0)
+        {
+            if(voice->fade == 1 && voice->command.loop == 1)
+            {
+                if(voice->volume > 0)
                 {
-                    audio->volume--;
+                    voice->volume--;
                 }
                 else
                 {
-                    audio->length = 0;
+                    voice->length = 0;
                 }
             }
 
-            if(music && audio->loop == 1 && audio->fade == 0)
+            if(music && voice->command.loop == 1 && voice->fade == 0)
             {
                 tempLength = 0;
             }
             else
             {
-                tempLength = ((uint32_t) len > audio->length) ? audio->length : (uint32_t) len;
+                tempLength = ((uint32_t) len > voice->length) ? voice->length : (uint32_t) len;
             }
 
-            SDL_MixAudioFormat(stream, audio->buffer, AUDIO_FORMAT, tempLength, audio->volume);
-
-            audio->buffer += tempLength;
-            audio->length -= tempLength;
+            SDL_MixAudioFormat(stream, voice->buffer, AUDIO_FORMAT, tempLength, voice->volume);
 
-            previous = audio;
-            audio = audio->next;
+            voice->buffer += tempLength;
+            voice->length -= tempLength;
         }
-        else if(audio->loop == 1 && audio->fade == 0)
+        else if(voice->command.loop == 1 && voice->fade == 0)
         {
-            audio->buffer = audio->bufferTrue;
-            audio->length = audio->lengthTrue;
+            voice->buffer = voice->command.audio->bufferTrue;
+            voice->length = voice->command.audio->lengthTrue;
         }
         else
         {
-            previous->next = audio->next;
-
-            if(audio->loop == 0)
-            {
-                gSoundCount--;
-            }
-
-            audio->next = NULL;
-            freeAudio(audio);
-
-            audio = previous->next;
+            /* Freeing is left to the game thread */
+            pushCommand(&mixer->finished, &(voice->command));
+            voice->active = 0;
         }
     }
 }
-
-static void addAudio(Audio * root, Audio * news)
-{
-    if(root == NULL)
-    {
-        return;
-    }
-
-    while(root->next != NULL)
-    {
-        root = root->next;
-    }
-
-    root->next = news;
-}
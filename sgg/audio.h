@@ -92,20 +92,22 @@ void playSound(const char * filename, int volume);
 void playMusic(const char * filename, int volume);
 
 /*
- * Plays a sound from a createAudio object (clones), only 1 at a time plays
+ * Plays a sound from a createAudio object, without copying it
  * Advantage to this method is no more disk reads, only once, data is stored and constantly reused
+ * The Audio must not be freed while it may still be playing, i.e. before endAudio
  *
- * @param audio         Audio object to clone and use
+ * @param audio         Audio object to play
  * @param volume        Volume read playSound for moree
  *
  */
 void playSoundFromMemory(Audio * audio, int volume);
 
 /*
- * Plays a music from a createAudio object (clones), only 1 at a time plays
+ * Plays a music from a createAudio object without copying it, only 1 at a time plays
  * Advantage to this method is no more disk reads, only once, data is stored and constantly reused
+ * The Audio must not be freed while it may still be playing, i.e. before endAudio
  *
- * @param audio         Audio object to clone and use
+ * @param audio         Audio object to play
  * @param volume        Volume read playSound for moree
  *
  */
@@ -124,6 +126,13 @@ void endAudio(void);
  */
 void initAudio(void);
 
+/*
+ * Free the sounds that have finished playing, the audio callback never frees memory itself
+ * Also done by every play call, so it only needs to be called when nothing has been played for a while
+ *
+ */
+void updateAudio(void);
+
 /*
  * Pause audio from playing
  *
@@ -0,0 +1,178 @@
+#include <sgg/capture.h>
+#include <sgg/GLbackend.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace graphics
+{
+	static const char     capture_magic[4] = { 'S', 'G', 'G', 'C' };
+	static const uint32_t capture_version = 1;
+	static const size_t   capture_header_size = sizeof(capture_magic) + sizeof(uint32_t) + 2 * sizeof(int32_t) +
+		2 * sizeof(float) + sizeof(int32_t) + 3 * sizeof(float);
+	static const size_t   frame_header_size = sizeof(uint32_t) + sizeof(float);
+
+	template <typename T>
+	static void put(std::ofstream & out, T value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static T get(const uint8_t * data, size_t & pos)
+	{
+		T value;
+		memcpy(&value, data + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+
+	bool CaptureWriter::open(const std::string & filename, const CaptureInfo & info)
+	{
+		close();
+		m_out.open(filename, std::ios::binary | std::ios::trunc);
+		if (!m_out)
+		{
+			std::cout << "Unable to open capture file " << filename << " for writing\n";
+			return false;
+		}
+		m_out.write(capture_magic, sizeof(capture_magic));
+		put<uint32_t>(m_out, capture_version);
+		put<int32_t>(m_out, info.window_width);
+		put<int32_t>(m_out, info.window_height);
+		put<float>(m_out, info.canvas_width);
+		put<float>(m_out, info.canvas_height);
+		put<int32_t>(m_out, info.canvas_mode);
+		for (int i = 0; i < 3; i++)
+			put<float>(m_out, info.background[i]);
+		m_encoder.clear();
+		return true;
+	}
+
+	void CaptureWriter::close()
+	{
+		if (!m_out.is_open())
+			return;
+		m_out.close();
+		m_encoder.clear();
+	}
+
+	void CaptureWriter::endFrame(float delta_time)
+	{
+		put<uint32_t>(m_out, (uint32_t)m_encoder.size());
+		put<float>(m_out, delta_time);
+		m_out.write(reinterpret_cast<const char *>(m_encoder.data()), m_encoder.size());
+		m_encoder.clear();
+	}
+
+	// parses the header and the frame records of a capture file held in memory.
+	static bool parseCapture(const std::vector<uint8_t> & data, CaptureInfo & info, std::vector<size_t> * offsets)
+	{
+		if (data.size() < capture_header_size || memcmp(data.data(), capture_magic, sizeof(capture_magic)))
+			return false;
+		size_t pos = sizeof(capture_magic);
+		if (get<uint32_t>(data.data(), pos) != capture_version)
+			return false;
+		info = CaptureInfo();
+		info.window_width = get<int32_t>(data.data(), pos);
+		info.window_height = get<int32_t>(data.data(), pos);
+		info.canvas_width = get<float>(data.data(), pos);
+		info.canvas_height = get<float>(data.data(), pos);
+		int32_t mode = get<int32_t>(data.data(), pos);
+		if (mode < CANVAS_SCALE_WINDOW || mode > CANVAS_SCALE_FIT)
+			return false;
+		info.canvas_mode = (scale_mode_t)mode;
+		for (int i = 0; i < 3; i++)
+			info.background[i] = get<float>(data.data(), pos);
+
+		// a frame truncated by a crash of the capturing application ends the capture.
+		while (data.size() - pos >= frame_header_size)
+		{
+			size_t offset = pos;
+			uint32_t size = get<uint32_t>(data.data(), pos);
+			float delta_time = get<float>(data.data(), pos);
+			if (data.size() - pos < size)
+				break;
+			if (offsets)
+				offsets->push_back(offset);
+			info.frames++;
+			info.duration += delta_time;
+			pos += size;
+		}
+		return true;
+	}
+
+	static bool readFile(const std::string & filename, std::vector<uint8_t> & data)
+	{
+		std::ifstream in(filename, std::ios::binary);
+		if (!in)
+		{
+			std::cout << "Unable to open capture file " << filename << "\n";
+			return false;
+		}
+		data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	bool CaptureReplay::readInfo(const std::string & filename, CaptureInfo & info)
+	{
+		std::vector<uint8_t> data;
+		if (!readFile(filename, data))
+			return false;
+		if (parseCapture(data, info, nullptr))
+			return true;
+		std::cout << "Invalid capture file " << filename << "\n";
+		return false;
+	}
+
+	bool CaptureReplay::load(const std::string & filename, unsigned int loops)
+	{
+		m_frames.clear();
+		m_next = m_current = 0;
+		m_loops_left = 0;
+		std::vector<size_t> offsets;
+		if (!readFile(filename, m_data))
+			return false;
+		if (!parseCapture(m_data, m_info, &offsets))
+		{
+			std::cout << "Invalid capture file " << filename << "\n";
+			m_data.clear();
+			return false;
+		}
+		for (size_t offset : offsets)
+		{
+			Frame frame;
+			frame.size = get<uint32_t>(m_data.data(), offset);
+			frame.offset = offset + sizeof(float);
+			m_frames.push_back(frame);
+		}
+		m_loops_left = m_frames.empty() ? 0 : std::max(loops, 1u);
+		return true;
+	}
+
+	bool CaptureReplay::nextFrame()
+	{
+		if (m_next == m_frames.size())
+		{
+			if (m_loops_left <= 1)
+			{
+				m_loops_left = 0;
+				return false;
+			}
+			m_loops_left--;
+			m_next = 0;
+		}
+		m_current = m_next++;
+		return true;
+	}
+
+	bool CaptureReplay::executeFrame(GLBackend & target)
+	{
+		if (m_current >= m_frames.size())
+			return false;
+		const Frame & frame = m_frames[m_current];
+		CommandDecoder decoder(m_data.data() + frame.offset, frame.size);
+		return decoder.execute(target);
+	}
+}
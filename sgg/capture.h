@@ -0,0 +1,79 @@
+#pragma once
+#include <sgg/cmdstream.h>
+#include <sgg/graphics.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace graphics
+{
+	class GLBackend;
+
+	/** Writes the drawing calls of an application to a capture file, one frame at a time.
+
+		The file starts with a short header, describing the window and canvas setup at the time the capture was
+		started, followed by one record per frame: the byte size of the frame's commands, the delta time of the
+		frame and the commands themselves, in the command stream format of CommandEncoder. Brushes are stored
+		by value and textures and fonts by file name, so the referenced files must be available when replaying.
+	*/
+	class CaptureWriter
+	{
+		std::ofstream m_out;
+		CommandEncoder m_encoder;
+
+	public:
+		bool open(const std::string & filename, const CaptureInfo & info);
+		void close();
+		bool isOpen() const { return m_out.is_open(); }
+
+		/** The encoder collecting the commands of the current frame.
+		*/
+		CommandEncoder & encoder() { return m_encoder; }
+
+		/** Appends the commands collected since the previous call as a frame record and starts a new frame.
+		*/
+		void endFrame(float delta_time);
+
+		~CaptureWriter() { close(); }
+	};
+
+	/** Loads a capture file written by CaptureWriter and replays its frames on an engine instance.
+
+		The whole file is read into memory up front, so that replaying does not involve any file access, and the
+		frame records are validated while loading. The commands themselves are validated as they are decoded.
+	*/
+	class CaptureReplay
+	{
+		struct Frame
+		{
+			size_t offset;
+			uint32_t size;
+		};
+
+		std::vector<uint8_t> m_data;
+		std::vector<Frame> m_frames;
+		CaptureInfo m_info;
+		size_t m_next = 0;
+		size_t m_current = 0;
+		unsigned int m_loops_left = 0;
+
+	public:
+		/** Reads the header of a capture file and counts its frames, without keeping its contents.
+		*/
+		static bool readInfo(const std::string & filename, CaptureInfo & info);
+
+		bool load(const std::string & filename, unsigned int loops);
+		const CaptureInfo & getInfo() const { return m_info; }
+
+		/** Advances to the next frame, starting over from the first one while loops remain.
+			\return false when all frames of all loops have been replayed.
+		*/
+		bool nextFrame();
+
+		/** Issues the commands of the current frame on the target engine.
+			\return false if the frame contained an invalid command.
+		*/
+		bool executeFrame(GLBackend & target);
+	};
+}
@@ -0,0 +1,261 @@
+#include <sgg/cmdstream.h>
+#include <sgg/GLbackend.h>
+#include <filesystem>
+#include <iostream>
+
+#ifdef  _EXPERIMENTAL_FILESYSTEM_
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+namespace graphics
+{
+	// strings longer than this are rejected by the decoder, to bound the work done for a malformed stream.
+	static const uint32_t max_string_length = 64 * 1024;
+
+	void CommandEncoder::putString(const std::string & str)
+	{
+		uint32_t length = (uint32_t)std::min<size_t>(str.length(), max_string_length);
+		put<uint32_t>(length);
+		m_data.insert(m_data.end(), str.begin(), str.begin() + length);
+	}
+
+	void CommandEncoder::putBrush(const Brush & brush)
+	{
+		for (int i = 0; i < 3; i++)
+			put<float>(brush.fill_color[i]);
+		for (int i = 0; i < 3; i++)
+			put<float>(brush.fill_secondary_color[i]);
+		put<float>(brush.fill_opacity);
+		put<float>(brush.fill_secondary_opacity);
+		for (int i = 0; i < 3; i++)
+			put<float>(brush.outline_color[i]);
+		put<float>(brush.outline_opacity);
+		put<float>(brush.outline_width);
+		put<uint8_t>(brush.gradient ? 1 : 0);
+		put<float>(brush.gradient_dir_u);
+		put<float>(brush.gradient_dir_v);
+		putString(brush.texture);
+	}
+
+	void CommandEncoder::drawRect(float cx, float cy, float w, float h, const Brush & brush)
+	{
+		put<uint8_t>(COMMAND_DRAW_RECT);
+		put<float>(cx);
+		put<float>(cy);
+		put<float>(w);
+		put<float>(h);
+		putBrush(brush);
+	}
+
+	void CommandEncoder::drawLine(float x_1, float y_1, float x_2, float y_2, const Brush & brush)
+	{
+		put<uint8_t>(COMMAND_DRAW_LINE);
+		put<float>(x_1);
+		put<float>(y_1);
+		put<float>(x_2);
+		put<float>(y_2);
+		putBrush(brush);
+	}
+
+	void CommandEncoder::drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush)
+	{
+		put<uint8_t>(COMMAND_DRAW_SECTOR);
+		put<float>(cx);
+		put<float>(cy);
+		put<float>(start_angle);
+		put<float>(end_angle);
+		put<float>(radius1);
+		put<float>(radius2);
+		putBrush(brush);
+	}
+
+	void CommandEncoder::drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush)
+	{
+		put<uint8_t>(COMMAND_DRAW_TEXT);
+		put<float>(pos_x);
+		put<float>(pos_y);
+		put<float>(size);
+		putString(text);
+		putBrush(brush);
+	}
+
+	void CommandEncoder::setFont(const std::string & fontname)
+	{
+		put<uint8_t>(COMMAND_SET_FONT);
+		putString(fontname);
+	}
+
+	void CommandEncoder::setOrientation(float degrees)
+	{
+		put<uint8_t>(COMMAND_SET_ORIENTATION);
+		put<float>(degrees);
+	}
+
+	void CommandEncoder::setScale(float sx, float sy, float sz)
+	{
+		put<uint8_t>(COMMAND_SET_SCALE);
+		put<float>(sx);
+		put<float>(sy);
+		put<float>(sz);
+	}
+
+	void CommandEncoder::resetPose()
+	{
+		put<uint8_t>(COMMAND_RESET_POSE);
+	}
+
+	void CommandEncoder::setBackgroundColor(float r, float g, float b)
+	{
+		put<uint8_t>(COMMAND_SET_BACKGROUND);
+		put<float>(r);
+		put<float>(g);
+		put<float>(b);
+	}
+
+	void CommandEncoder::setCanvasSize(float w, float h)
+	{
+		put<uint8_t>(COMMAND_SET_CANVAS_SIZE);
+		put<float>(w);
+		put<float>(h);
+	}
+
+	void CommandEncoder::setCanvasMode(scale_mode_t mode)
+	{
+		put<uint8_t>(COMMAND_SET_CANVAS_MODE);
+		put<uint8_t>((uint8_t)mode);
+	}
+
+	bool ResourceFilter::accept(const std::string & name)
+	{
+		if (m_accepted.count(name))
+			return true;
+		if (m_accepted.size() >= max_names)
+		{
+			std::cout << "Rejected " << name << ": a remote client may load at most " << max_names << " bitmaps and fonts\n";
+			return false;
+		}
+
+		// ".." is refused anywhere, as it may climb out of a symbolic link below the root.
+		fs::path path(name);
+		bool valid = !name.empty() && name.find('\0') == std::string::npos && path.is_relative() && !path.has_root_name();
+		for (const fs::path & part : path)
+			valid = valid && part != "..";
+		if (valid)
+		{
+			// both sides are resolved against the current directory, so that an absolute root works as well.
+			std::error_code root_error, path_error;
+			fs::path root = fs::absolute(m_root.empty() ? fs::path(".") : fs::path(m_root), root_error).lexically_normal();
+			fs::path relative = fs::absolute(path, path_error).lexically_normal().lexically_relative(root);
+			valid = !root_error && !path_error && !relative.empty() && *relative.begin() != "..";
+		}
+		if (!valid)
+		{
+			std::cout << "Rejected " << name << ": remote clients may only load relative paths inside the asset directory\n";
+			return false;
+		}
+		m_accepted.insert(name);
+		return true;
+	}
+
+	bool CommandDecoder::getString(std::string & str)
+	{
+		uint32_t length;
+		if (!get(length) || length > max_string_length || m_size - m_pos < length)
+			return false;
+		str.assign(reinterpret_cast<const char *>(m_data + m_pos), length);
+		m_pos += length;
+		return true;
+	}
+
+	bool CommandDecoder::getBrush(Brush & brush)
+	{
+		uint8_t gradient;
+		bool ok = true;
+		for (int i = 0; i < 3; i++)
+			ok = ok && get(brush.fill_color[i]);
+		for (int i = 0; i < 3; i++)
+			ok = ok && get(brush.fill_secondary_color[i]);
+		ok = ok && get(brush.fill_opacity) && get(brush.fill_secondary_opacity);
+		for (int i = 0; i < 3; i++)
+			ok = ok && get(brush.outline_color[i]);
+		ok = ok && get(brush.outline_opacity) && get(brush.outline_width) && get(gradient) &&
+			get(brush.gradient_dir_u) && get(brush.gradient_dir_v) && getString(brush.texture);
+		brush.gradient = (gradient != 0);
+		return ok;
+	}
+
+	bool CommandDecoder::execute(GLBackend & target)
+	{
+		Brush brush;
+		float a[6];
+		while (m_pos < m_size)
+		{
+			uint8_t command;
+			get(command);
+			switch (command)
+			{
+			case COMMAND_DRAW_RECT:
+				if (!(get(a[0]) && get(a[1]) && get(a[2]) && get(a[3]) && getBrush(brush) && acceptTexture(brush)))
+					return false;
+				target.drawRect(a[0], a[1], a[2], a[3], brush);
+				break;
+			case COMMAND_DRAW_LINE:
+				if (!(get(a[0]) && get(a[1]) && get(a[2]) && get(a[3]) && getBrush(brush) && acceptTexture(brush)))
+					return false;
+				target.drawLine(a[0], a[1], a[2], a[3], brush);
+				break;
+			case COMMAND_DRAW_SECTOR:
+				if (!(get(a[0]) && get(a[1]) && get(a[2]) && get(a[3]) && get(a[4]) && get(a[5]) && getBrush(brush) && acceptTexture(brush)))
+					return false;
+				target.drawSector(a[0], a[1], a[2], a[3], a[4], a[5], brush);
+				break;
+			case COMMAND_DRAW_TEXT:
+				if (!(get(a[0]) && get(a[1]) && get(a[2]) && getString(m_string) && getBrush(brush) && acceptTexture(brush)))
+					return false;
+				target.drawText(a[0], a[1], a[2], m_string, brush);
+				break;
+			case COMMAND_SET_FONT:
+				if (!getString(m_string) || (m_filter && !m_filter->accept(m_string)))
+					return false;
+				target.setFont(m_string);
+				break;
+			case COMMAND_SET_ORIENTATION:
+				if (!get(a[0]))
+					return false;
+				target.setOrientation(a[0]);
+				break;
+			case COMMAND_SET_SCALE:
+				if (!(get(a[0]) && get(a[1]) && get(a[2])))
+					return false;
+				target.setScale(a[0], a[1], a[2]);
+				break;
+			case COMMAND_RESET_POSE:
+				target.resetPose();
+				break;
+			case COMMAND_SET_BACKGROUND:
+				if (!(get(a[0]) && get(a[1]) && get(a[2])))
+					return false;
+				target.setBackgroundColor(a[0], a[1], a[2]);
+				break;
+			case COMMAND_SET_CANVAS_SIZE:
+				if (!(get(a[0]) && get(a[1])))
+					return false;
+				target.setCanvasSize(a[0], a[1]);
+				break;
+			case COMMAND_SET_CANVAS_MODE:
+			{
+				uint8_t mode;
+				if (!get(mode) || mode > CANVAS_SCALE_FIT)
+					return false;
+				target.setCanvasMode(mode);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <sgg/graphics.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace graphics
+{
+	class GLBackend;
+
+	/** The operations that can be encoded in a command stream. The values are part of the stream format.
+	*/
+	enum command_t : uint8_t
+	{
+		COMMAND_DRAW_RECT = 1,
+		COMMAND_DRAW_LINE,
+		COMMAND_DRAW_SECTOR,
+		COMMAND_DRAW_TEXT,
+		COMMAND_SET_FONT,
+		COMMAND_SET_ORIENTATION,
+		COMMAND_SET_SCALE,
+		COMMAND_RESET_POSE,
+		COMMAND_SET_BACKGROUND,
+		COMMAND_SET_CANVAS_SIZE,
+		COMMAND_SET_CANVAS_MODE
+	};
+
+	/** Serializes drawing calls into a compact binary command stream.
+
+		Each command is a one-byte opcode followed by its arguments in native byte order; brushes are written
+		field by field and strings are length-prefixed. The encoder only appends to its buffer, so one frame of
+		commands can be built up and handed over as a single contiguous block.
+	*/
+	class CommandEncoder
+	{
+		std::vector<uint8_t> m_data;
+
+		template <typename T>
+		void put(T value)
+		{
+			const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+			m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+		}
+
+		void putString(const std::string & str);
+		void putBrush(const Brush & brush);
+
+	public:
+		void drawRect(float cx, float cy, float w, float h, const Brush & brush);
+		void drawLine(float x_1, float y_1, float x_2, float y_2, const Brush & brush);
+		void drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush);
+		void drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush);
+		void setFont(const std::string & fontname);
+		void setOrientation(float degrees);
+		void setScale(float sx, float sy, float sz);
+		void resetPose();
+		void setBackgroundColor(float r, float g, float b);
+		void setCanvasSize(float w, float h);
+		void setCanvasMode(scale_mode_t mode);
+
+		void clear() { m_data.clear(); }
+		bool empty() const { return m_data.empty(); }
+		const uint8_t * data() const { return m_data.data(); }
+		size_t size() const { return m_data.size(); }
+	};
+
+	/** Limits the bitmaps and fonts that command streams from an untrusted process may load.
+
+		Only relative paths inside the asset root are accepted, so that a client cannot read arbitrary files of the
+		renderer. As each new name adds an entry to the texture or font cache of the renderer, the number of distinct
+		names is capped as well. Names accepted once stay accepted, also for later clients.
+	*/
+	class ResourceFilter
+	{
+		std::string m_root;
+		std::unordered_set<std::string> m_accepted;
+
+	public:
+		static constexpr size_t max_names = 256;
+
+		/** Sets the directory that resource paths must lie in. An empty root stands for the current directory.
+		*/
+		void setRoot(const std::string & root) { m_root = root; }
+		bool accept(const std::string & name);
+	};
+
+	/** Decodes a command stream and issues the encoded calls on an engine instance.
+
+		The stream is read in place and every read is bounds-checked, as streams may come from untrusted
+		processes. Decoding stops at the first malformed command, and at the first bitmap or font the resource
+		filter of the decoder (if any) does not accept.
+	*/
+	class CommandDecoder
+	{
+		const uint8_t * m_data;
+		size_t m_size;
+		size_t m_pos = 0;
+		std::string m_string;
+		ResourceFilter * m_filter;
+
+		template <typename T>
+		bool get(T & value)
+		{
+			if (m_size - m_pos < sizeof(T))
+				return false;
+			memcpy(&value, m_data + m_pos, sizeof(T));
+			m_pos += sizeof(T);
+			return true;
+		}
+
+		bool getString(std::string & str);
+		bool getBrush(Brush & brush);
+		bool acceptTexture(const Brush & brush) { return !m_filter || brush.texture.empty() || m_filter->accept(brush.texture); }
+
+	public:
+		CommandDecoder(const uint8_t * data, size_t size, ResourceFilter * filter = nullptr) : m_data(data), m_size(size), m_filter(filter) {}
+
+		/** Executes all commands of the stream.
+			\return true if the whole stream was decoded, false if it contained an invalid command.
+		*/
+		bool execute(GLBackend & target);
+	};
+}
@@ -24,8 +24,26 @@ uniform vec4 color2;
 uniform sampler2D tex;
 uniform int has_texture;
 uniform vec2 gradient;
+uniform int overdraw;  // 1: count fragments (1/255 each, blended additively), 2: show the counts in tex as a heat map.
+
+vec3 heat(float count) {
+	if (count < 1.0) return mix(vec3(0, 0, 0), vec3(0, 0, 1), count);
+	if (count < 2.0) return mix(vec3(0, 0, 1), vec3(0, 1, 1), count - 1.0);
+	if (count < 3.0) return mix(vec3(0, 1, 1), vec3(0, 1, 0), count - 2.0);
+	if (count < 4.0) return mix(vec3(0, 1, 0), vec3(1, 1, 0), count - 3.0);
+	if (count < 6.0) return mix(vec3(1, 1, 0), vec3(1, 0, 0), (count - 4.0) / 2.0);
+	return mix(vec3(1, 0, 0), vec3(1, 1, 1), min((count - 6.0) / 2.0, 1.0));
+}
 
 void main(void) {
+	if (overdraw == 1) {
+		gl_FragColor = vec4(1.0 / 255.0);
+		return;
+	}
+	if (overdraw == 2) {
+		gl_FragColor = vec4(heat(floor(texture2D(tex, texcoord).r * 255.0 + 0.5)), 1);
+		return;
+	}
 	vec4 color = mix( color1, color2, dot(texcoord,gradient));
 	vec4 tex_color = texture2D(tex, texcoord); 
 	if (has_texture>0)
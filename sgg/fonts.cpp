@@ -1,5 +1,9 @@
 
 #include <sgg/fonts.h>
+#include <sgg/alloctrack.h>
+#include <sgg/profiler.h>
+#include <sgg/memregistry.h>
+#include FT_MODULE_H
 #include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
@@ -34,8 +38,13 @@ uniform vec4 color1;
 uniform vec4 color2;
 uniform sampler2D tex;
 uniform vec2 gradient;
+uniform int overdraw;
 
 void main(void) {
+	if (overdraw > 0) {
+		gl_FragColor = vec4(1.0 / 255.0);
+		return;
+	}
 	vec4 color = mix( color1, color2, dot(texcoord,gradient));
 	gl_FragColor = vec4(1, 1, 1, texture2D(tex, texcoord).r) * color;
 }
@@ -43,9 +52,30 @@ void main(void) {
 
 
 
+bool FontLib::initLibrary()
+{
+	SGG_PROFILE_SCOPE("FontLib::initLibrary");
+	// FreeType does not touch GL, so this part can be warmed up from any thread.
+	std::call_once(m_ft_once, [this]()
+	{
+#ifdef SGG_TRACK_ALLOCATIONS
+		// route the allocations of FreeType through the tracked allocator.
+		m_ft_ready = !FT_New_Library(graphics::AllocationTracker::getFreeTypeMemory(), &m_ft);
+		if (m_ft_ready)
+			FT_Add_Default_Modules(m_ft);
+#else
+		m_ft_ready = !FT_Init_FreeType(&m_ft);
+#endif
+	});
+	return m_ft_ready;
+}
+
 bool FontLib::init()
 {
-	if (FT_Init_FreeType(&m_ft))
+	if (m_initialized)
+		return true;
+
+	if (!initLibrary())
 	{
 		return false;
 	}
@@ -76,15 +106,17 @@ bool FontLib::init()
 		{ 1, -1, 1, 1 },
 	};
 	glBufferData(GL_ARRAY_BUFFER, sizeof box, box, GL_DYNAMIC_DRAW);
+	graphics::MemoryRegistry::get().track(this, graphics::MEMORY_GEOMETRY, "text vertices", 0, sizeof box);
 
 	m_curr_font = m_fonts.end();
 
+	m_initialized = true;
 	return true;
 }
 
 void FontLib::submitText(const TextRecord & text)
 {
-	if (m_curr_font == m_fonts.end())
+	if (!m_initialized || m_curr_font == m_fonts.end())
 		return;
 	// Not a very elegant workaround, 
 	// but helps keep changes minimal, 
@@ -93,7 +125,7 @@ void FontLib::submitText(const TextRecord & text)
 	m_content.push_back(text);
 }
 
-void FontLib::drawText(TextRecord entry)
+void FontLib::drawText(const TextRecord & entry)
 {
 	float x = 0.0f;  
 	float y = 0.0f;  
@@ -102,7 +134,7 @@ void FontLib::drawText(TextRecord entry)
 	
 	if (!entry.font)
 		return;
-	Font font = *(entry.font);
+	const Font & font = *(entry.font);
 	FT_GlyphSlot g = font.face->glyph;
 
 #ifndef __APPLE__
@@ -110,21 +142,29 @@ void FontLib::drawText(TextRecord entry)
 #endif
 	
 	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (m_overdraw)
+		glBlendFunc(GL_ONE, GL_ONE);
+	else
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, font.font_tex);
-	static int c = 0;
+	graphics::RenderCounters & counters = graphics::renderCounters();
+	counters.texture_binds++;
 
 	m_font_shader.use();
 
 	m_font_shader["tex"] = 0;
+	m_font_shader["overdraw"] = m_overdraw ? 1 : 0;
 	
 	m_font_shader["color1"] = entry.color1;
 	m_font_shader["color2"] = (entry.use_gradient? entry.color2 : entry.color1);
 	m_font_shader["gradient"] = entry.gradient;
 	m_font_shader["projection"] = entry.proj;
 	   
-	for (p = entry.text.c_str(); *p; p++) {
+	for (p = entry.text; *p; p++) {
+		// glyphs are not cached: each one is rendered and uploaded again.
+		counters.glyphs++;
+		counters.glyph_cache_misses++;
 		if (FT_Load_Char(font.face, *p, FT_LOAD_RENDER))
 			continue;
 		
@@ -163,6 +203,8 @@ void FontLib::drawText(TextRecord entry)
 		glBufferData(GL_ARRAY_BUFFER, sizeof box, box, GL_DYNAMIC_DRAW);
 		
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		counters.draw_calls++;
+		counters.vertices += 4;
 		x += std::max(w+ entry.size.x*0.05f, entry.size.x*0.15f);
 		y += entry.size.y*1.1f*(g->advance.y);
 	}
@@ -173,9 +215,12 @@ void FontLib::drawText(TextRecord entry)
 
 void FontLib::commitText()
 {
+	if (m_content.empty())
+		return;
+	SGG_PROFILE_SCOPE("FontLib::commitText");
 	m_font_shader.use();
 	glEnable(GL_SCISSOR_TEST);
-	for (auto item : m_content)
+	for (const auto & item : m_content)
 	{
 		drawText(item);
 	}
@@ -194,6 +239,7 @@ bool FontLib::setCurrentFont(std::string fontname)
 	if (m_curr_font != m_fonts.end())
 		return true;
 
+	SGG_PROFILE_SCOPE("FontLib::loadFont");
 	Font font;
 	if (FT_New_Face(m_ft, fontname.c_str(), 0, &font.face))
 	{
@@ -211,9 +257,24 @@ bool FontLib::setCurrentFont(std::string fontname)
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	m_curr_font = m_fonts.insert(std::pair<std::string, Font>(fontname,font)).first;
+	// the glyph texture is specified anew for each glyph, up to the size of the largest one.
+	graphics::MemoryRegistry::get().track(this, graphics::MEMORY_FONTS, fontname, 0, m_font_res * m_font_res);
 	return true;
 }
 
 
 
-FT_Library FontLib::m_ft = nullptr;
+FontLib::~FontLib()
+{
+	graphics::MemoryRegistry::get().untrackAll(this);
+	// each engine instance owns its FreeType library, as FT_Library objects are not thread-safe.
+	if (!m_ft)
+		return;
+	for (auto & font : m_fonts)
+		FT_Done_Face(font.second.face);
+#ifdef SGG_TRACK_ALLOCATIONS
+	FT_Done_Library(m_ft);
+#else
+	FT_Done_FreeType(m_ft);
+#endif
+}
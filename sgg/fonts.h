@@ -1,11 +1,13 @@
 #pragma once
 #include <ft2build.h>
 #include FT_FREETYPE_H
-#include "GL/glew.h"
+#include <sgg/gltrace.h>
 #include "sgg/shader.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <mutex>
+#include <atomic>
 
 struct Font
 {
@@ -18,7 +20,7 @@ struct TextRecord
 {
 	glm::vec2 pos;
 	glm::vec2 size;
-	std::string text;
+	const char * text;	// NUL-terminated, owned by the frame arena of the engine.
 	glm::vec4 color1;
 	glm::vec4 color2;
 	glm::vec2 gradient;
@@ -31,7 +33,10 @@ struct TextRecord
 
 class FontLib
 {
-	static FT_Library	m_ft;
+	FT_Library			m_ft = nullptr;
+	std::once_flag		m_ft_once;
+	std::atomic<bool>	m_ft_ready { false };
+	bool				m_initialized = false;
 	std::unordered_map<std::string, Font>::iterator m_curr_font;
 	std::unordered_map<std::string, Font> m_fonts;
 	Shader				m_font_shader;
@@ -41,15 +46,21 @@ class FontLib
 	std::vector<TextRecord> m_content;
 	
 	glm::vec2	  m_canvas;
+	bool		  m_overdraw = false;
 
-	void drawText(TextRecord entry);
+	void drawText(const TextRecord & entry);
 	
 public:
+	bool initLibrary();
+	bool isLibraryReady() const { return m_ft_ready; }
 	bool init();
+	bool isInitialized() const { return m_initialized; }
 	void submitText(const TextRecord & text);
 	void commitText();
 	void setCanvas(glm::vec2 sz);
 	bool setCurrentFont(std::string fontname);
+	void setOverdrawMode(bool count) { m_overdraw = count; }
+	~FontLib();
 	
 };
 
@@ -0,0 +1,230 @@
+#include <sgg/frameexport.h>
+#include <SDL2/SDL.h>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace graphics
+{
+	static const size_t frame_export_alignment = 64;
+
+	static size_t alignExport(size_t size)
+	{
+		return (size + frame_export_alignment - 1) & ~(frame_export_alignment - 1);
+	}
+
+	FrameExporter::~FrameExporter()
+	{
+		stop();
+	}
+
+#ifndef _WIN32
+
+	bool FrameExporter::start(const std::string & name, unsigned int num_slots, int max_width, int max_height)
+	{
+		stop();
+		if (num_slots < 2)
+			num_slots = 2;
+
+		size_t slot_stride = alignExport(sizeof(SharedFrameSlot));
+		size_t slots_offset = alignExport(sizeof(SharedFrameHeader));
+		size_t pixels_offset = alignExport(slots_offset + num_slots * slot_stride);
+		size_t slot_capacity = alignExport((size_t)max_width * max_height * 4);
+		size_t size = pixels_offset + num_slots * slot_capacity;
+
+		int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+		if (fd < 0 || ftruncate(fd, size) < 0)
+		{
+			std::cout << "Unable to create shared memory " << name << " for frame export\n";
+			if (fd >= 0)
+			{
+				::close(fd);
+				shm_unlink(name.c_str());
+			}
+			return false;
+		}
+		void * mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mem == MAP_FAILED)
+		{
+			shm_unlink(name.c_str());
+			return false;
+		}
+
+		if (!m_readback.init(num_slots))
+		{
+			munmap(mem, size);
+			shm_unlink(name.c_str());
+			return false;
+		}
+
+		m_memory = static_cast<uint8_t *>(mem);
+		m_size = size;
+		m_name = name;
+		m_header = new (m_memory) SharedFrameHeader;
+		m_header->num_slots = num_slots;
+		m_header->slot_stride = (uint32_t)slot_stride;
+		m_header->slots_offset = slots_offset;
+		m_header->pixels_offset = pixels_offset;
+		m_header->slot_capacity = slot_capacity;
+		m_header->latest.store(0);
+		for (unsigned int i = 0; i < num_slots; i++)
+		{
+			SharedFrameSlot * slot = new (m_memory + slots_offset + i * slot_stride) SharedFrameSlot;
+			slot->sequence.store(0);
+		}
+		// consumers check the magic last, so it must only become visible once the layout is complete.
+		m_header->version = frame_export_version;
+		std::atomic_thread_fence(std::memory_order_release);
+		m_header->magic = frame_export_magic;
+
+		m_frames = 0;
+		m_exported = 0;
+		m_oversized = 0;
+		return true;
+	}
+
+	void FrameExporter::stop()
+	{
+		if (!m_memory)
+			return;
+		// frames still in flight are published, so that no presented frame is lost when stopping.
+		m_readback.collect([this](const ReadbackFrame & frame) { publish(frame); }, true);
+		m_readback.release();
+		munmap(m_memory, m_size);
+		shm_unlink(m_name.c_str());
+		m_memory = nullptr;
+		m_header = nullptr;
+		m_size = 0;
+	}
+
+	bool FrameExportReader::open(const std::string & name)
+	{
+		close();
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(SharedFrameHeader))
+		{
+			::close(fd);
+			return false;
+		}
+		size_t size = (size_t)st.st_size;
+		void * mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mem == MAP_FAILED)
+			return false;
+
+		const SharedFrameHeader * header = static_cast<const SharedFrameHeader *>(mem);
+		bool valid = header->magic == frame_export_magic;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		valid = valid && header->version == frame_export_version && header->num_slots > 0 &&
+			header->slots_offset + (uint64_t)header->num_slots * header->slot_stride <= size &&
+			header->pixels_offset + (uint64_t)header->num_slots * header->slot_capacity <= size;
+		if (!valid)
+		{
+			munmap(mem, size);
+			return false;
+		}
+		m_memory = static_cast<uint8_t *>(mem);
+		m_size = size;
+		m_header = header;
+		return true;
+	}
+
+	void FrameExportReader::close()
+	{
+		if (m_memory)
+			munmap(m_memory, m_size);
+		m_memory = nullptr;
+		m_header = nullptr;
+		m_size = 0;
+	}
+
+#else
+
+	bool FrameExporter::start(const std::string & name, unsigned int num_slots, int max_width, int max_height)
+	{
+		std::cout << "Frame export is not supported on this platform\n";
+		return false;
+	}
+
+	void FrameExporter::stop()
+	{
+	}
+
+	bool FrameExportReader::open(const std::string & name)
+	{
+		return false;
+	}
+
+	void FrameExportReader::close()
+	{
+	}
+
+#endif
+
+	void FrameExporter::publish(const ReadbackFrame & frame)
+	{
+		size_t size = (size_t)frame.width * frame.height * 4;
+		if (size > m_header->slot_capacity)
+		{
+			m_oversized++;
+			return;
+		}
+
+		uint64_t number = ++m_exported;
+		uint32_t index = (uint32_t)(number % m_header->num_slots);
+		SharedFrameSlot * slot = reinterpret_cast<SharedFrameSlot *>(m_memory + m_header->slots_offset + index * m_header->slot_stride);
+		uint8_t * pixels = m_memory + m_header->pixels_offset + index * m_header->slot_capacity;
+
+		slot->sequence.store(2 * number + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot->frame = frame.frame;
+		slot->timestamp = frame.timestamp;
+		slot->width = (uint32_t)frame.width;
+		slot->height = (uint32_t)frame.height;
+		slot->stride = (uint32_t)frame.width * 4;
+		memcpy(pixels, frame.pixels, size);
+		slot->sequence.store(2 * number + 2, std::memory_order_release);
+		m_header->latest.store(number, std::memory_order_release);
+	}
+
+	void FrameExporter::capture(int width, int height)
+	{
+		if (!m_memory)
+			return;
+		m_readback.collect([this](const ReadbackFrame & frame) { publish(frame); });
+		m_readback.request(0, 0, width, height, ++m_frames, SDL_GetTicks());
+	}
+
+	const SharedFrameSlot * FrameExportReader::acquireLatest(const uint8_t * & pixels, uint64_t & sequence) const
+	{
+		if (!m_header)
+			return nullptr;
+		uint64_t number = m_header->latest.load(std::memory_order_acquire);
+		if (number == 0)
+			return nullptr;
+		uint32_t index = (uint32_t)(number % m_header->num_slots);
+		const SharedFrameSlot * slot = reinterpret_cast<const SharedFrameSlot *>(m_memory + m_header->slots_offset + index * m_header->slot_stride);
+		sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence & 1 || (uint64_t)slot->stride * slot->height > m_header->slot_capacity)
+			return nullptr;
+		pixels = m_memory + m_header->pixels_offset + index * m_header->slot_capacity;
+		return slot;
+	}
+
+	bool FrameExportReader::isValid(const SharedFrameSlot * slot, uint64_t sequence) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot->sequence.load(std::memory_order_relaxed) == sequence;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <sgg/readback.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace graphics
+{
+	/** The header at the start of a shared-memory frame export segment.
+
+		The segment holds a fixed number of frame slots, each made of a SharedFrameSlot record and its pixel data.
+		Frames are written to the slots in a round-robin fashion: the n-th published frame (counting from 1) goes to slot n % num_slots.
+		The layout is fixed once the segment is created: 
+		
+		- the header is followed by the slot records, at offset slots_offset, each one slot_stride bytes apart,
+		- the pixels of slot i start at offset pixels_offset + i * slot_capacity.
+	*/
+	struct SharedFrameHeader
+	{
+		uint32_t magic;                    ///< frame_export_magic.
+		uint32_t version;                  ///< frame_export_version.
+		uint32_t num_slots;                ///< The number of frame slots.
+		uint32_t slot_stride;              ///< The distance in bytes between consecutive slot records.
+		uint64_t slots_offset;             ///< The offset of the first slot record from the start of the segment.
+		uint64_t pixels_offset;            ///< The offset of the pixel data of the first slot from the start of the segment.
+		uint64_t slot_capacity;            ///< The size in bytes of the pixel data of each slot. Larger frames are not exported.
+		std::atomic<uint64_t> latest;      ///< The number of frames published so far, i.e. the most recent one is in slot latest % num_slots.
+	};
+
+	/** The description of a frame in a slot of a frame export segment.
+
+		The slot is protected by a sequence lock: sequence is odd while the frame is being written and is set to 
+		2 * n + 2 when the n-th published frame is complete. A consumer reads sequence before accessing the frame and again 
+		afterwards; the frame is consistent only if both reads return the same, even value. The writer never waits for 
+		consumers, so a consumer that is too slow to process a frame before its slot is reused has to discard it.
+	*/
+	struct SharedFrameSlot
+	{
+		std::atomic<uint64_t> sequence;    ///< The sequence lock of the slot.
+		uint64_t frame;                    ///< The number of the presented frame, counting from 1 since the export started. Gaps indicate dropped frames.
+		uint32_t timestamp;                ///< The time the frame was presented, in milliseconds since the initialization of SDL.
+		uint32_t width;                    ///< The width of the frame in pixels.
+		uint32_t height;                   ///< The height of the frame in pixels.
+		uint32_t stride;                   ///< The distance in bytes between consecutive rows. Rows are stored bottom to top, in RGBA order.
+	};
+
+	static constexpr uint32_t frame_export_magic = 0x46474753; // "SGGF"
+	static constexpr uint32_t frame_export_version = 1;
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "frame export requires lock-free 64-bit atomics");
+
+	/** Publishes the presented frames of an engine instance to a shared-memory segment.
+
+		Frames are read back asynchronously through a PixelReadback ring and copied to the next slot of the segment as
+		soon as their readback completes, typically one or two frames after they were presented.
+	*/
+	class FrameExporter
+	{
+		std::string m_name;
+		uint8_t * m_memory = nullptr;
+		size_t m_size = 0;
+		SharedFrameHeader * m_header = nullptr;
+		PixelReadback m_readback;
+		uint64_t m_frames = 0;
+		uint64_t m_exported = 0;
+		uint64_t m_oversized = 0;
+
+		void publish(const ReadbackFrame & frame);
+
+	public:
+		FrameExporter() {}
+		FrameExporter(const FrameExporter &) = delete;
+		FrameExporter & operator = (const FrameExporter &) = delete;
+		~FrameExporter();
+
+		bool start(const std::string & name, unsigned int num_slots, int max_width, int max_height);
+		void stop();
+
+		/** Queues the readback of the current framebuffer and publishes the frames whose readback has completed.
+		*/
+		void capture(int width, int height);
+
+		uint64_t getExported() const { return m_exported; }
+		uint64_t getDropped() const { return m_readback.getDropped() + m_oversized; }
+	};
+
+	/** Maps a frame export segment created by another process, for reading.
+	*/
+	class FrameExportReader
+	{
+		uint8_t * m_memory = nullptr;
+		size_t m_size = 0;
+		const SharedFrameHeader * m_header = nullptr;
+
+	public:
+		FrameExportReader() {}
+		FrameExportReader(const FrameExportReader &) = delete;
+		FrameExportReader & operator = (const FrameExportReader &) = delete;
+		~FrameExportReader() { close(); }
+
+		bool open(const std::string & name);
+		void close();
+		bool isOpen() const { return m_header != nullptr; }
+
+		/** Returns the most recent complete frame in place, along with the value of its sequence lock, or nullptr if there is
+			no frame yet. The pixels must be considered valid only if isValid() still returns true after they have been used.
+		*/
+		const SharedFrameSlot * acquireLatest(const uint8_t * & pixels, uint64_t & sequence) const;
+		bool isValid(const SharedFrameSlot * slot, uint64_t sequence) const;
+	};
+}
@@ -0,0 +1,320 @@
+#include <sgg/framerecorder.h>
+#include <sgg/renderer.h>
+#include <sgg/memregistry.h>
+#include <sgg/lodepng.h>
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace graphics
+{
+	// converts top-to-bottom RGBA pixels to planar YUV 4:2:0 (full-range BT.601, as in the C420jpeg format of Y4M).
+	static void convertToYUV420(const uint8_t * rgba, int width, int height, std::vector<uint8_t> & yuv)
+	{
+		int chroma_width = (width + 1) / 2, chroma_height = (height + 1) / 2;
+		yuv.resize((size_t)width * height + 2 * (size_t)chroma_width * chroma_height);
+		uint8_t * y_plane = yuv.data();
+		uint8_t * u_plane = y_plane + (size_t)width * height;
+		uint8_t * v_plane = u_plane + (size_t)chroma_width * chroma_height;
+
+		for (size_t i = 0; i < (size_t)width * height; i++)
+		{
+			const uint8_t * p = rgba + 4 * i;
+			y_plane[i] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+		}
+
+		for (int cy = 0; cy < chroma_height; cy++)
+		{
+			for (int cx = 0; cx < chroma_width; cx++)
+			{
+				// the average color of the (up to) 2x2 pixels covered by the chroma sample.
+				int r = 0, g = 0, b = 0, count = 0;
+				for (int y = 2 * cy; y < std::min(2 * cy + 2, height); y++)
+				{
+					for (int x = 2 * cx; x < std::min(2 * cx + 2, width); x++)
+					{
+						const uint8_t * p = rgba + 4 * ((size_t)y * width + x);
+						r += p[0];
+						g += p[1];
+						b += p[2];
+						count++;
+					}
+				}
+				r /= count;
+				g /= count;
+				b /= count;
+				// offset by 128.5 * 256 before shifting, so that the sums are never negative.
+				size_t i = (size_t)cy * chroma_width + cx;
+				u_plane[i] = (uint8_t)std::min((-43 * r - 85 * g + 128 * b + 32896) >> 8, 255);
+				v_plane[i] = (uint8_t)std::min((128 * r - 107 * g - 21 * b + 32896) >> 8, 255);
+			}
+		}
+	}
+
+	FrameRecorder::~FrameRecorder()
+	{
+		finish();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_job_ready.notify_all();
+		for (std::thread & worker : m_workers)
+			worker.join();
+		MemoryRegistry::get().untrackAll(this);
+	}
+
+	void FrameRecorder::startWorkers()
+	{
+		if (!m_workers.empty())
+			return;
+		// PNG encoding is the bottleneck, so several frames are encoded in parallel, leaving cores to the application.
+		unsigned int count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+		m_max_buffers = count + 4;
+		for (unsigned int i = 0; i < count; i++)
+			m_workers.emplace_back(&FrameRecorder::work, this);
+	}
+
+	void FrameRecorder::requestScreenshot(const std::string & filename)
+	{
+		startWorkers();
+		m_screenshot_requests.push_back(filename);
+	}
+
+	bool FrameRecorder::startRecording(const std::string & filename, recording_format_t format, int width, int height, unsigned int fps)
+	{
+		stopRecording();
+		if (format != RECORDING_PNG)
+		{
+			m_stream.open(filename, std::ios::binary | std::ios::trunc);
+			if (!m_stream)
+			{
+				std::cout << "Unable to open " << filename << " for recording\n";
+				return false;
+			}
+			if (format == RECORDING_Y4M)
+				m_stream << "YUV4MPEG2 W" << width << " H" << height << " F" << std::max(1u, fps) << ":1 Ip A1:1 C420jpeg\n";
+		}
+		m_filename = filename;
+		m_format = format;
+		m_width = width;
+		m_height = height;
+		m_sequence = 0;
+		m_next_write = 1;
+		m_recording = true;
+		startWorkers();
+		return true;
+	}
+
+	void FrameRecorder::stopRecording()
+	{
+		if (!m_recording)
+			return;
+		// the frames still being read back belong to the recording.
+		m_readback.collect([this](const ReadbackFrame & frame) { submit(frame.pixels, frame.width, frame.height, true, frame.frame); }, true);
+		drain();
+		m_recording = false;
+		if (m_stream.is_open())
+			m_stream.close();
+	}
+
+	void FrameRecorder::finish()
+	{
+		stopRecording();
+		m_readback.collect([this](const ReadbackFrame & frame) { submit(frame.pixels, frame.width, frame.height, true, frame.frame); }, true);
+		m_readback.release();
+		drain();
+	}
+
+	void FrameRecorder::capture(Renderer & renderer, int width, int height)
+	{
+		bool wanted = m_recording || !m_screenshot_requests.empty();
+		if (renderer.getType() != RENDERER_OPENGL)
+		{
+			// the frame of the software renderer is already in system memory.
+			if (!wanted || !renderer.readPixels(m_software_frame, width, height))
+				return;
+			uint64_t frame = ++m_frames;
+			if (!m_screenshot_requests.empty())
+				m_screenshots_in_flight.emplace_back(frame, std::move(m_screenshot_requests));
+			m_screenshot_requests.clear();
+			submit(m_software_frame.data(), width, height, false, frame);
+			return;
+		}
+
+		if (!wanted && !m_readback.isValid())
+			return;
+		if (!m_readback.isValid() && !m_readback.init(3))
+			return;
+		m_readback.collect([this](const ReadbackFrame & frame) { submit(frame.pixels, frame.width, frame.height, true, frame.frame); });
+		if (!wanted)
+			return;
+
+		uint64_t frame = ++m_frames;
+		if (!m_readback.request(0, 0, width, height, frame, SDL_GetTicks()))
+		{
+			// screenshots are taken from the next frame instead.
+			if (m_recording)
+				m_dropped++;
+			return;
+		}
+		if (!m_screenshot_requests.empty())
+			m_screenshots_in_flight.emplace_back(frame, std::move(m_screenshot_requests));
+		m_screenshot_requests.clear();
+	}
+
+	bool FrameRecorder::submit(const uint8_t * pixels, int width, int height, bool bottom_up, uint64_t frame)
+	{
+		Job job;
+		while (!m_screenshots_in_flight.empty() && m_screenshots_in_flight.front().first <= frame)
+		{
+			if (m_screenshots_in_flight.front().first == frame)
+				job.screenshots = std::move(m_screenshots_in_flight.front().second);
+			m_screenshots_in_flight.pop_front();
+		}
+
+		// streams hold frames of a single size, so frames drawn after a resize are left out.
+		bool record = m_recording && (m_format == RECORDING_PNG || (width == m_width && height == m_height));
+		if (m_recording && !record)
+			m_dropped++;
+		if (!record && job.screenshots.empty())
+			return false;
+
+		size_t buffers;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_free_buffers.empty())
+			{
+				job.pixels = std::move(m_free_buffers.back());
+				m_free_buffers.pop_back();
+			}
+			else if (m_buffers < m_max_buffers || !job.screenshots.empty())
+				m_buffers++;
+			else
+			{
+				// the workers are a whole pool of frames behind: skip the frame rather than wait for them.
+				m_dropped++;
+				return false;
+			}
+			buffers = m_buffers;
+		}
+
+		size_t size = (size_t)width * height * 4;
+		if (job.pixels.size() != size)
+		{
+			job.pixels.resize(size);
+			MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "recording buffers", buffers * size, 0);
+		}
+		memcpy(job.pixels.data(), pixels, size);
+		job.width = width;
+		job.height = height;
+		job.bottom_up = bottom_up;
+		if (record)
+			job.sequence = ++m_sequence;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_job_ready.notify_one();
+		return true;
+	}
+
+	void FrameRecorder::work()
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_job_ready.wait(lock, [this]() { return m_quit || !m_jobs.empty(); });
+				if (m_jobs.empty())
+					return;
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				m_busy++;
+			}
+
+			process(job);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_free_buffers.push_back(std::move(job.pixels));
+				m_busy--;
+			}
+			m_job_done.notify_all();
+		}
+	}
+
+	void FrameRecorder::process(Job & job)
+	{
+		// GL rows are bottom to top; blending leaves partial alpha behind, but the canvas is shown opaque.
+		size_t stride = (size_t)job.width * 4;
+		if (job.bottom_up)
+			for (int y = 0; y < job.height / 2; y++)
+				std::swap_ranges(job.pixels.begin() + y * stride, job.pixels.begin() + (y + 1) * stride,
+					job.pixels.begin() + (job.height - 1 - y) * stride);
+		for (size_t i = 3; i < job.pixels.size(); i += 4)
+			job.pixels[i] = 255;
+
+		for (const std::string & filename : job.screenshots)
+		{
+			unsigned int error = lodepng::encode(filename, job.pixels, job.width, job.height);
+			if (error)
+				std::cout << "Unable to save " << filename << ": " << lodepng_error_text(error) << "\n";
+		}
+
+		if (!job.sequence)
+			return;
+		if (m_format == RECORDING_PNG)
+		{
+			char number[32];
+			snprintf(number, sizeof(number), "_%06llu.png", (unsigned long long)job.sequence);
+			unsigned int error = lodepng::encode(m_filename + number, job.pixels, job.width, job.height);
+			if (error)
+				std::cout << "Unable to save " << m_filename + number << ": " << lodepng_error_text(error) << "\n";
+		}
+		else
+			writeStream(job);
+		m_recorded++;
+	}
+
+	void FrameRecorder::writeStream(const Job & job)
+	{
+		// frames are converted in parallel, but written in the order they were presented.
+		thread_local std::vector<uint8_t> yuv;
+		const uint8_t * data = job.pixels.data();
+		size_t size = job.pixels.size();
+		if (m_format == RECORDING_Y4M)
+		{
+			convertToYUV420(job.pixels.data(), job.width, job.height, yuv);
+			data = yuv.data();
+			size = yuv.size();
+		}
+
+		std::unique_lock<std::mutex> lock(m_stream_mutex);
+		m_stream_turn.wait(lock, [&]() { return m_next_write == job.sequence; });
+		if (m_format == RECORDING_Y4M)
+			m_stream << "FRAME\n";
+		m_stream.write(reinterpret_cast<const char *>(data), size);
+		m_next_write++;
+		lock.unlock();
+		m_stream_turn.notify_all();
+	}
+
+	void FrameRecorder::drain()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_job_done.wait(lock, [this]() { return m_jobs.empty() && m_busy == 0; });
+	}
+
+	void FrameRecorder::getStats(FrameRecordingStats & stats)
+	{
+		stats.recorded = m_recorded;
+		stats.dropped = m_dropped;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		stats.pending = (unsigned int)(m_jobs.size() + m_busy);
+	}
+}
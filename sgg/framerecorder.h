@@ -0,0 +1,108 @@
+#pragma once
+#include <sgg/readback.h>
+#include <sgg/graphics.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace graphics
+{
+	class Renderer;
+
+	/** Saves the presented frames of an engine instance to files, without stalling the render loop.
+
+		With the OpenGL renderer, frames are read back asynchronously through a PixelReadback ring, so their pixels
+		arrive two or three frames after they were presented; the software renderer hands over its frame directly.
+		The render thread only copies the pixels into a buffer from a small pool; flipping, colour conversion, PNG
+		encoding and file output run on worker threads. Frames of a continuous recording are dropped, rather than
+		waited for, when all readback buffers are in flight or the workers have fallen behind by a whole pool of frames.
+		Screenshots requested with requestScreenshot() are never dropped.
+	*/
+	class FrameRecorder
+	{
+		struct Job
+		{
+			std::vector<uint8_t> pixels;
+			int width = 0;
+			int height = 0;
+			bool bottom_up = false;                // rows are stored bottom to top, as read back from GL.
+			std::vector<std::string> screenshots;  // the files to save the frame to as PNG images.
+			uint64_t sequence = 0;                 // the number of the frame in the recording counting from 1, or 0 if not recorded.
+		};
+
+		PixelReadback m_readback;
+		std::vector<unsigned char> m_software_frame;
+		uint64_t m_frames = 0;
+
+		// screenshots waiting for the next requested frame, and the frames they were requested with.
+		std::vector<std::string> m_screenshot_requests;
+		std::deque<std::pair<uint64_t, std::vector<std::string>>> m_screenshots_in_flight;
+
+		recording_format_t m_format = RECORDING_PNG;
+		std::string m_filename;
+		std::ofstream m_stream;
+		int m_width = 0;
+		int m_height = 0;
+		bool m_recording = false;
+		uint64_t m_sequence = 0;
+		uint64_t m_next_write = 1;
+		std::atomic<uint64_t> m_recorded { 0 };
+		std::atomic<uint64_t> m_dropped { 0 };
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_job_ready;
+		std::condition_variable m_job_done;
+		std::deque<Job> m_jobs;
+		std::vector<std::vector<uint8_t>> m_free_buffers;
+		size_t m_buffers = 0;
+		size_t m_max_buffers = 0;
+		unsigned int m_busy = 0;
+		bool m_quit = false;
+
+		std::mutex m_stream_mutex;
+		std::condition_variable m_stream_turn;
+
+		void startWorkers();
+		void work();
+		void process(Job & job);
+		void writeStream(const Job & job);
+		bool submit(const uint8_t * pixels, int width, int height, bool bottom_up, uint64_t frame);
+		void drain();
+
+	public:
+		FrameRecorder() {}
+		FrameRecorder(const FrameRecorder &) = delete;
+		FrameRecorder & operator = (const FrameRecorder &) = delete;
+		~FrameRecorder();
+
+		/** Queues a PNG screenshot of the next presented frame.
+		*/
+		void requestScreenshot(const std::string & filename);
+
+		bool startRecording(const std::string & filename, recording_format_t format, int width, int height, unsigned int fps);
+
+		/** Stops the recording, after saving the frames still being read back or encoded.
+		*/
+		void stopRecording();
+		bool isRecording() const { return m_recording; }
+
+		/** Captures the current frame if a screenshot or recording needs it and saves the frames whose readback has completed.
+			Called on the render thread after the frame has been drawn and before it is presented.
+		*/
+		void capture(Renderer & renderer, int width, int height);
+
+		/** Saves all pending frames, waiting for their readback and encoding, and releases the readback buffers.
+			Must be called on the render thread, while the graphics context is current.
+		*/
+		void finish();
+
+		void getStats(FrameRecordingStats & stats);
+	};
+}
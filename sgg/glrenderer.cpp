@@ -0,0 +1,616 @@
+#include <sgg/glrenderer.h>
+#include <sgg/commonshaders.h>
+#include <sgg/profiler.h>
+#include <sgg/memregistry.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef __APPLE__
+#define sggBindVertexArray glBindVertexArrayAPPLE
+#define sggGenVertexArrays glGenVertexArraysAPPLE
+#else
+#define sggBindVertexArray glBindVertexArray
+#define sggGenVertexArrays glGenVertexArrays
+#endif
+
+namespace graphics
+{
+	bool GLRenderer::init(SDL_Window * window, int width, int height, bool offscreen)
+	{
+		m_window = window;
+		m_width = width;
+		m_height = height;
+		m_offscreen_mode = offscreen;
+
+#ifdef SGG_GL_TRACE
+		// a debug context reports errors through KHR_debug (see GLTrace::initDebugOutput()).
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
+		m_context = SDL_GL_CreateContext(m_window);
+		if (!m_context)
+		{
+			std::cout << "Unable to create an OpenGL context: " << SDL_GetError() << "\n";
+			return false;
+		}
+
+		//SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+		SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+		SDL_GL_SetSwapInterval(0);
+
+		glewExperimental = GL_TRUE;
+		glewInit();
+		glGetError();
+		// glewInit() also reports missing window-system extensions, so the core entry points are checked instead.
+		if (!GLEW_VERSION_2_0 || !GLEW_GET_FUN(__glewGenFramebuffers))
+		{
+			std::cout << "The OpenGL driver does not provide the required functionality\n";
+			return false;
+		}
+		GLTrace::contextChanged();
+		GLTrace::initDebugOutput();
+
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LEQUAL);
+		glClearDepth(1.0f);
+		glDisable(GL_CULL_FACE);
+		glCullFace(GL_BACK);
+
+		if (!initPrimitives())
+			return false;
+		glViewport(0, 0, m_width, m_height);
+
+		if (m_offscreen_mode)
+		{
+			m_offscreen.resize(m_width, m_height);
+			if (!m_offscreen.isValid())
+			{
+				std::cout << "Unable to create the offscreen buffer\n";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void GLRenderer::release()
+	{
+		if (!m_context)
+			return;
+		m_offscreen.release();
+		m_overdraw_target.release();
+		m_overdraw_readback.release();
+		m_overdraw_mode = false;
+		// the buffers of the renderer are freed along with the context.
+		MemoryRegistry::get().untrackAll(this);
+		SDL_GL_DeleteContext(m_context);
+		m_context = nullptr;
+	}
+
+	GLRenderer::~GLRenderer()
+	{
+		release();
+	}
+
+	void GLRenderer::makeCurrent()
+	{
+		SDL_GL_MakeCurrent(m_window, m_context);
+		GLTrace::contextChanged();
+	}
+
+	void GLRenderer::resize(int width, int height)
+	{
+		m_width = width;
+		m_height = height;
+		if (m_offscreen_mode)
+		{
+			m_offscreen.resize(width, height);
+			invalidateState();
+		}
+		glViewport(0, 0, m_width, m_height);
+	}
+
+	bool GLRenderer::initPrimitives()
+	{
+		glGetError();
+
+		m_flat_shader = Shader(__PrimitivesVertexShader, __SolidFragmentShader);
+		
+		if (!m_flat_shader.init())
+			return false;
+		
+		GLfloat box[4][4] = {
+			{ -0.5f, 0.5f, 0, 1 },
+			{ 0.5f, 0.5f, 1, 1 },
+			{ -0.5f, -0.5f, 0, 0 },
+			{ 0.5f, -0.5f, 1, 0 }
+		};
+
+		GLfloat box_outline[4][4] = {
+			{ -0.5f, 0.5f, 0, 0 },
+			{ 0.5f, 0.5f, 1, 0 },
+			{ 0.5f, -0.5f, 1, 1 },
+			{ -0.5f, -0.5f, 0, 1 }
+		};
+
+		// each vertex array keeps its attribute setup, so that drawing only has to bind it.
+		unsigned int attrib_flat_position = m_flat_shader.getAttributeLocation("coord");
+		auto createVertexArray = [attrib_flat_position](GLuint & vao, GLuint & vbo, GLsizeiptr size, const void * data, GLenum usage)
+		{
+			sggGenVertexArrays(1, &vao);
+			sggBindVertexArray(vao);
+			glGenBuffers(1, &vbo);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+			glEnableVertexAttribArray(attrib_flat_position);
+			glVertexAttribPointer(attrib_flat_position, 4, GL_FLOAT, GL_FALSE, 0, 0);
+		};
+		createVertexArray(m_rect_vao, m_rect_vbo, sizeof box, box, GL_STATIC_DRAW);
+		createVertexArray(m_rect_outline_vao, m_rect_outline_vbo, sizeof box_outline, box_outline, GL_STATIC_DRAW);
+		createVertexArray(m_stream_vao, m_stream_vbo, stream_capacity, nullptr, GL_STREAM_DRAW);
+		MemoryRegistry::get().track(this, MEMORY_GEOMETRY, "rectangle vertices", 0, sizeof box + sizeof box_outline);
+		MemoryRegistry::get().track(this, MEMORY_GEOMETRY, "streamed vertices", 0, stream_capacity);
+		m_stream_offset = 0;
+		m_stream_mapping = GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range;
+		sggBindVertexArray(0);
+		invalidateState();
+
+		// state that no primitive changes is set once.
+		glFrontFace(GL_CCW);
+		m_flat_shader.use();
+		m_flat_shader["tex"] = 0;
+		return true;
+	}
+
+	void GLRenderer::invalidateState()
+	{
+		// font rendering and resource creation bind their own objects behind the back of the cache.
+		m_bound_vao = ~0u;
+		m_bound_texture = ~0u;
+		m_line_width = -1.0f;
+	}
+
+	void GLRenderer::bindVertexArray(GLuint vao)
+	{
+		if (vao == m_bound_vao)
+			return;
+		sggBindVertexArray(vao);
+		m_bound_vao = vao;
+	}
+
+	void GLRenderer::bindTexture(GLuint texture)
+	{
+		if (texture == m_bound_texture)
+			return;
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		m_bound_texture = texture;
+		renderCounters().texture_binds++;
+	}
+
+	void GLRenderer::countDraw(int vertices)
+	{
+		RenderCounters & counters = renderCounters();
+		counters.draw_calls++;
+		counters.vertices += vertices;
+	}
+
+	void GLRenderer::setLineWidth(float width)
+	{
+		if (width == m_line_width)
+			return;
+		glLineWidth(width);
+		m_line_width = width;
+	}
+
+	GLint GLRenderer::streamVertices(const GLfloat (*vertices)[4], int count)
+	{
+		GLsizeiptr size = count * sizeof(GLfloat[4]);
+		glBindBuffer(GL_ARRAY_BUFFER, m_stream_vbo);
+		if (m_stream_offset + size > stream_capacity)
+		{
+			// orphan the storage: the driver hands out a fresh buffer, while draws still in flight keep the old one.
+			glBufferData(GL_ARRAY_BUFFER, stream_capacity, nullptr, GL_STREAM_DRAW);
+			m_stream_offset = 0;
+		}
+
+		// vertices are only appended until the buffer is orphaned, so writes never need to wait for the GPU.
+		void * dst = nullptr;
+		if (m_stream_mapping)
+			dst = glMapBufferRange(GL_ARRAY_BUFFER, m_stream_offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (dst)
+		{
+			memcpy(dst, vertices, size);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		else
+			glBufferSubData(GL_ARRAY_BUFFER, m_stream_offset, size, vertices);
+
+		GLint first = (GLint)(m_stream_offset / sizeof(GLfloat[4]));
+		m_stream_offset += size;
+		return first;
+	}
+
+	void GLRenderer::beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor)
+	{
+		// offscreen frames are drawn into the offscreen buffer, which is unbound again when the frame is presented.
+		if (m_offscreen_mode)
+			m_offscreen.bind();
+		// in overdraw mode, fragments are counted in the overdraw target instead; its counts are drawn into the frame by endFrame().
+		if (m_overdraw_mode)
+		{
+			m_overdraw_target.resize(m_width, m_height);
+			m_overdraw_target.bind();
+			m_overdraw_rect = scissor ? glm::ivec4(*scissor) : glm::ivec4(0, 0, m_width, m_height);
+		}
+
+		invalidateState();
+		m_flat_shader.use();
+		glDepthMask(0.0f);
+		glDisable(GL_DEPTH_TEST);
+		glClearColor(0.0f, 0.0f, 0.f, 1.0);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		if (scissor)
+		{
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(scissor->x, scissor->y, scissor->z, scissor->w);
+		}
+
+		glEnable(GL_BLEND);
+		glBlendEquation(GL_ADD);
+		if (m_overdraw_mode)
+			glBlendFunc(GL_ONE, GL_ONE);
+		else
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		m_flat_shader["overdraw"] = m_overdraw_mode ? 1 : 0;
+		m_flat_shader["P"] = projection;
+		glGetError();
+	}
+
+	void GLRenderer::drawRect(const glm::mat4 & modelview, const Brush & brush)
+	{
+		m_flat_shader["gradient"] = glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v);
+		m_flat_shader["MV"] = modelview;
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f )
+		{
+			GLuint tid = m_textures.getTexture(brush.texture);
+			if (tid > 0)
+				bindTexture(tid);
+			
+			m_flat_shader["color1"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+
+			if (brush.gradient)
+			{
+				m_flat_shader["color2"] = glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+					brush.fill_secondary_color[2], brush.fill_secondary_opacity);
+			}
+			else
+			{
+				m_flat_shader["color2"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			}
+				
+			m_flat_shader["has_texture"] = (tid > 0) ? 1 : 0;
+
+			bindVertexArray(m_rect_vao);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			countDraw(4);
+		}
+
+		if (brush.outline_opacity>0.0f)
+		{
+			m_flat_shader["color1"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			m_flat_shader["color2"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			m_flat_shader["has_texture"] = 0;
+			setLineWidth(brush.outline_width);
+			bindVertexArray(m_rect_outline_vao);
+			glDrawArrays(GL_LINE_LOOP, 0, 4);
+			countDraw(4);
+		}
+	}
+
+	void GLRenderer::drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush)
+	{
+		glm::vec4 color = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+		m_flat_shader["color1"] = color;
+		m_flat_shader["color2"] = color;
+		m_flat_shader["has_texture"] = 0;
+		m_flat_shader["MV"] = glm::mat4(1.0f);
+		m_flat_shader["gradient"] = glm::vec2(1.0f, 0.0f);
+		GLfloat line[2][4] = 
+		{
+			{ p1.x, p1.y, 0.0f, 1.0f},
+			{ p2.x, p2.y, 0.1f, 1.0f},
+		};
+
+		GLint first = streamVertices(line, 2);
+		setLineWidth(1.0f);
+		bindVertexArray(m_stream_vao);
+		glDrawArrays(GL_LINES, first, 2);
+		countDraw(2);
+	}
+
+	void GLRenderer::drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush)
+	{
+		m_flat_shader["MV"] = modelview;
+		m_flat_shader["gradient"] = glm::vec2(brush.gradient_dir_u,brush.gradient_dir_v);
+
+		float sector_vertices[2 * CURVE_SUBDIVS+2][4];
+		float sector_outline_vertices[2 * CURVE_SUBDIVS+2][4];
+		float r1 = radius1, r2 = radius2;
+		float arc_inc = 3.1415936f*(end_angle - start_angle) / (180.0f*CURVE_SUBDIVS);
+		for (int i = 0; i <= CURVE_SUBDIVS; i++)
+		{
+			float s = i / (float)CURVE_SUBDIVS;
+			sector_vertices[i * 2 + 0][0] = r1 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_vertices[i * 2 + 0][1] = r1 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_vertices[i * 2 + 0][2] = s;
+			sector_vertices[i * 2 + 0][3] = 0.0f;
+			sector_vertices[i * 2 + 1][0] = r2 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_vertices[i * 2 + 1][1] = r2 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_vertices[i * 2 + 1][2] = s;
+			sector_vertices[i * 2 + 1][3] = 1.0f;
+		}
+		for (int i = 0; i <= CURVE_SUBDIVS; i++)
+		{
+			float s = i / (float)CURVE_SUBDIVS;
+			sector_outline_vertices[i][0] = r1 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_outline_vertices[i][1] = r1 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_outline_vertices[i][2] = s;
+			sector_outline_vertices[i][3] = 0.0f;
+		}
+		for (int i = CURVE_SUBDIVS; i >= 0; i--)
+		{
+			float s = (i) / (float)CURVE_SUBDIVS;
+			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][0] = r2 * cos(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][1] = r2 * -sin(3.1415936f*start_angle / 180.f + i * arc_inc);
+			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][2] = s;
+			sector_outline_vertices[2*CURVE_SUBDIVS-i+1][3] = 1.0f;
+		}
+
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
+		{
+			GLuint tid = m_textures.getTexture(brush.texture);
+			if (tid > 0)
+				bindTexture(tid);
+
+			m_flat_shader["color1"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+
+			if (brush.gradient)
+			{
+				m_flat_shader["color2"] = glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+					brush.fill_secondary_color[2], brush.fill_secondary_opacity);
+			}
+			else
+			{
+				m_flat_shader["color2"] = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			}
+
+			m_flat_shader["has_texture"] = (tid > 0) ? 1 : 0;
+
+			GLint first = streamVertices(sector_vertices, 2 * CURVE_SUBDIVS + 2);
+			bindVertexArray(m_stream_vao);
+			glDrawArrays(GL_TRIANGLE_STRIP, first, 2 * CURVE_SUBDIVS+2);
+			countDraw(2 * CURVE_SUBDIVS + 2);
+		}
+
+		if (brush.outline_opacity > 0.0f)
+		{
+			m_flat_shader["color1"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			m_flat_shader["color2"] = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			m_flat_shader["has_texture"] = 0;
+			setLineWidth(brush.outline_width);
+			
+			GLint first = streamVertices(sector_outline_vertices, 2 * CURVE_SUBDIVS + 2);
+			bindVertexArray(m_stream_vao);
+			if (fabs(end_angle-start_angle-360.0f)>0.000f)
+			{
+				glDrawArrays(GL_LINE_LOOP, first, 2 * CURVE_SUBDIVS+2);
+				countDraw(2 * CURVE_SUBDIVS + 2);
+			}
+			else
+			{
+				glDrawArrays(GL_LINE_LOOP, first + CURVE_SUBDIVS + 1, CURVE_SUBDIVS );
+				countDraw(CURVE_SUBDIVS);
+			}
+		}
+	}
+
+	void GLRenderer::drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color)
+	{
+		m_flat_shader["color1"] = color;
+		m_flat_shader["color2"] = color;
+		m_flat_shader["has_texture"] = 0;
+		m_flat_shader["MV"] = glm::mat4(1.0f);
+		m_flat_shader["gradient"] = glm::vec2(1.0f, 0.0f);
+		bindVertexArray(m_stream_vao);
+
+		// quads are expanded to separate triangles, so that a whole batch takes a single draw call.
+		const int batch_quads = (int)(stream_capacity / (6 * sizeof(GLfloat[4])));
+		for (int batch = 0; batch < count; batch += batch_quads)
+		{
+			int num_quads = std::min(count - batch, batch_quads);
+			m_quad_vertices.clear();
+			for (int i = batch; i < batch + num_quads; i++)
+			{
+				const glm::vec4 & q = quads[i];
+				glm::vec4 corners[4] = {
+					{ q.x, q.y, 0.0f, 0.0f },
+					{ q.z, q.y, 0.0f, 0.0f },
+					{ q.x, q.w, 0.0f, 0.0f },
+					{ q.z, q.w, 0.0f, 0.0f } };
+				m_quad_vertices.insert(m_quad_vertices.end(), { corners[0], corners[1], corners[2], corners[2], corners[1], corners[3] });
+			}
+			GLint first = streamVertices(reinterpret_cast<const GLfloat(*)[4]>(m_quad_vertices.data()), 6 * num_quads);
+			glDrawArrays(GL_TRIANGLES, first, 6 * num_quads);
+			countDraw(6 * num_quads);
+		}
+	}
+
+	bool GLRenderer::initFonts()
+	{
+		bool ready = m_fontlib.init();
+		invalidateState();
+		return ready;
+	}
+
+	bool GLRenderer::setFont(const std::string & fontname)
+	{
+		bool found = m_fontlib.setCurrentFont(fontname);
+		invalidateState();
+		return found;
+	}
+
+	bool GLRenderer::preloadTexture(const std::string & filename)
+	{
+		bool loaded = m_textures.getTexture(filename) != 0;
+		invalidateState();
+		return loaded;
+	}
+
+	void GLRenderer::endFrame()
+	{
+		{
+			SGG_PROFILE_SCOPE("text");
+			m_fontlib.commitText();
+		}
+		glDisable(GL_SCISSOR_TEST);
+		m_flat_shader.use();
+		invalidateState();
+		if (m_overdraw_mode)
+			resolveOverdraw();
+	}
+
+	void GLRenderer::resolveOverdraw()
+	{
+		SGG_PROFILE_SCOPE("overdraw heat map");
+		// the counts are read back without waiting for the GPU, so the statistics are those of a frame a few frames back.
+		glm::ivec4 rect = glm::clamp(m_overdraw_rect, glm::ivec4(0), glm::ivec4(m_width, m_height, m_width, m_height));
+		m_overdraw_readback.request(rect.x, rect.y, std::min(rect.z, m_width - rect.x), std::min(rect.w, m_height - rect.y), m_overdraw_frames++, 0);
+		m_overdraw_readback.collect([this](const ReadbackFrame & frame)
+		{
+			uint64_t fragments = 0;
+			size_t covered = 0;
+			unsigned int max = 0;
+			size_t pixels = (size_t)frame.width * frame.height;
+			for (size_t i = 0; i < pixels; i++)
+			{
+				unsigned int count = frame.pixels[4 * i];
+				fragments += count;
+				covered += count > 0;
+				max = std::max(max, count);
+			}
+			m_overdraw_stats.average = pixels ? fragments / (float)pixels : 0.0f;
+			m_overdraw_stats.coverage = pixels ? covered / (float)pixels : 0.0f;
+			m_overdraw_stats.max = max;
+			m_overdraw_ready = true;
+		});
+		m_overdraw_target.unbind();
+
+		// the counts replace the whole frame, mapped to colors by the flat shader.
+		float u = m_overdraw_target.getWidth() / (float)m_overdraw_target.getAllocatedWidth();
+		float v = m_overdraw_target.getHeight() / (float)m_overdraw_target.getAllocatedHeight();
+		GLfloat quad[4][4] = {
+			{ -1.0f, -1.0f, 0.0f, 0.0f },
+			{ 1.0f, -1.0f, u, 0.0f },
+			{ -1.0f, 1.0f, 0.0f, v },
+			{ 1.0f, 1.0f, u, v }
+		};
+		glDisable(GL_BLEND);
+		m_flat_shader["overdraw"] = 2;
+		m_flat_shader["P"] = glm::mat4(1.0f);
+		m_flat_shader["MV"] = glm::mat4(1.0f);
+		bindTexture(m_overdraw_target.getTexture());
+		GLint first = streamVertices(quad, 4);
+		bindVertexArray(m_stream_vao);
+		glDrawArrays(GL_TRIANGLE_STRIP, first, 4);
+		countDraw(4);
+		glEnable(GL_BLEND);
+		m_flat_shader["overdraw"] = 0;
+	}
+
+	bool GLRenderer::setOverdrawMode(bool enable)
+	{
+		if (enable == m_overdraw_mode)
+			return true;
+		if (enable && !m_overdraw_readback.init(3))
+		{
+			std::cout << "Unable to create the buffers for reading back the overdraw counts\n";
+			return false;
+		}
+		if (!enable)
+		{
+			m_overdraw_target.release();
+			m_overdraw_readback.release();
+		}
+		m_overdraw_mode = enable;
+		m_overdraw_ready = false;
+		m_fontlib.setOverdrawMode(enable);
+		return true;
+	}
+
+	bool GLRenderer::getOverdrawStats(OverdrawStats & stats) const
+	{
+		if (!m_overdraw_mode || !m_overdraw_ready)
+			return false;
+		stats = m_overdraw_stats;
+		return true;
+	}
+
+	void GLRenderer::present()
+	{
+		GLTrace::endFrame();
+		if (m_offscreen_mode)
+		{
+			m_offscreen.unbind();
+			glFlush();
+		}
+		else
+			SDL_GL_SwapWindow(m_window);
+	}
+
+	bool GLRenderer::readPixels(std::vector<unsigned char> & pixels, int & width, int & height)
+	{
+		if (!m_offscreen_mode || !m_offscreen.isValid())
+		{
+			std::cout << "Frames can only be read back from a headless window\n";
+			return false;
+		}
+
+		width = m_offscreen.getWidth();
+		height = m_offscreen.getHeight();
+		pixels.resize((size_t)width * height * 4);
+
+		GLint prev_fbo;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_fbo);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_offscreen.getFramebuffer());
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, prev_fbo);
+
+		// GL rows are bottom to top; blending leaves partial alpha behind, but the canvas is shown opaque.
+		size_t stride = (size_t)width * 4;
+		std::vector<unsigned char> row(stride);
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char * top = pixels.data() + y * stride;
+			unsigned char * bottom = pixels.data() + (height - 1 - y) * stride;
+			memcpy(row.data(), top, stride);
+			memcpy(top, bottom, stride);
+			memcpy(bottom, row.data(), stride);
+		}
+		for (size_t i = 3; i < pixels.size(); i += 4)
+			pixels[i] = 255;
+		return true;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <sgg/gltrace.h>
+#include <sgg/renderer.h>
+#include <sgg/shader.h>
+#include <sgg/fonts.h>
+#include <sgg/texture.h>
+#include <sgg/rendertarget.h>
+#include <sgg/readback.h>
+
+constexpr auto CURVE_SUBDIVS = 64;
+
+namespace graphics
+{
+	/** The OpenGL renderer, drawing through a GL context created for the window.
+	*/
+	class GLRenderer : public Renderer
+	{
+		SDL_Window *  m_window = nullptr;
+		SDL_GLContext m_context = nullptr;
+		bool		  m_offscreen_mode = false;
+		RenderTarget  m_offscreen;
+		int			  m_width = 0,
+					  m_height = 0;
+
+		FontLib		  m_fontlib;
+		TextureManager m_textures;
+		Shader		  m_flat_shader;
+
+		GLuint		m_rect_vbo;
+		GLuint		m_rect_vao;
+		GLuint		m_rect_outline_vbo;
+		GLuint		m_rect_outline_vao;
+
+		// dynamic geometry (lines, sectors) is appended to a single streaming buffer, which is orphaned when full.
+		static constexpr GLsizeiptr stream_capacity = 1 << 20;
+		GLuint		m_stream_vbo;
+		GLuint		m_stream_vao;
+		GLsizeiptr	m_stream_offset = 0;
+		bool		m_stream_mapping = false;
+		std::vector<glm::vec4> m_quad_vertices;
+
+		// the last bound objects, to skip redundant state changes between primitives.
+		GLuint		m_bound_vao = ~0u;
+		GLuint		m_bound_texture = ~0u;
+		float		m_line_width = -1.0f;
+
+		// overdraw mode: fragments are counted into a separate target, which is shown as a heat map when the frame ends.
+		bool		m_overdraw_mode = false;
+		RenderTarget  m_overdraw_target;
+		PixelReadback m_overdraw_readback;
+		glm::ivec4	m_overdraw_rect;  // the canvas area, in pixels from the bottom-left corner, as x, y, width, height.
+		uint64_t	m_overdraw_frames = 0;
+		OverdrawStats m_overdraw_stats;
+		bool		m_overdraw_ready = false;
+
+		bool initPrimitives();
+		void invalidateState();
+		void bindVertexArray(GLuint vao);
+		void bindTexture(GLuint texture);
+		void setLineWidth(float width);
+		void countDraw(int vertices);
+		GLint streamVertices(const GLfloat (*vertices)[4], int count);
+		void resolveOverdraw();
+
+	public:
+		renderer_t getType() const override { return RENDERER_OPENGL; }
+		Uint32 getWindowFlags(bool) const override { return SDL_WINDOW_OPENGL; }
+
+		bool init(SDL_Window * window, int width, int height, bool offscreen) override;
+		void release() override;
+		void makeCurrent() override;
+		void resize(int width, int height) override;
+
+		void beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor) override;
+		void drawRect(const glm::mat4 & modelview, const Brush & brush) override;
+		void drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush) override;
+		void drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush) override;
+		void drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color) override;
+
+		bool initFontLibrary() override { return m_fontlib.initLibrary(); }
+		bool isFontLibraryReady() const override { return m_fontlib.isLibraryReady(); }
+		bool initFonts() override;
+		bool areFontsInitialized() const override { return m_fontlib.isInitialized(); }
+		bool setFont(const std::string & fontname) override;
+		void drawText(const TextRecord & text) override { m_fontlib.submitText(text); }
+
+		bool preloadTexture(const std::string & filename) override;
+		size_t getTextureMemory() const override { return m_textures.getDeviceMemory(); }
+
+		void endFrame() override;
+		void present() override;
+		bool readPixels(std::vector<unsigned char> & pixels, int & width, int & height) override;
+
+		bool setOverdrawMode(bool enable) override;
+		bool getOverdrawStats(OverdrawStats & stats) const override;
+
+		~GLRenderer();
+	};
+}
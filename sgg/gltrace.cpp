@@ -0,0 +1,342 @@
+#include <sgg/gltrace.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace graphics
+{
+	namespace
+	{
+		const char * const g_function_names[GL_FN_COUNT] = {
+#define SGG_GL_FUNCTION_NAME(name) "gl" #name,
+			SGG_GL_FUNCTIONS(SGG_GL_FUNCTION_NAME)
+#undef SGG_GL_FUNCTION_NAME
+		};
+
+		std::atomic<uint32_t> g_calls[GL_FN_COUNT];
+		std::atomic<uint32_t> g_redundant[GL_FN_COUNT];
+		std::atomic<uint32_t> g_errors { 0 };
+		// incremented when tracing starts, so that each thread discards the shadow state it kept before.
+		std::atomic<uint64_t> g_epoch { 0 };
+
+		std::mutex g_mutex;
+		GLTraceStats g_last;
+		unsigned long long g_frame = 0;
+		std::ofstream g_summary;
+
+		struct UniformValue
+		{
+			unsigned char bytes[64];
+			size_t size = 0;
+		};
+
+		// the state the calls of the thread have set; missing entries (or ~0) are unknown.
+		struct ShadowState
+		{
+			uint64_t epoch = ~0ull;
+			GLuint program = ~0u;
+			GLenum active_unit = 0;
+			GLuint vao = ~0u;
+			GLuint draw_framebuffer = ~0u;
+			GLuint read_framebuffer = ~0u;
+			std::map<GLenum, GLuint> buffers;
+			std::map<std::pair<GLenum, GLenum>, GLuint> textures;  // by texture unit and target.
+			std::unordered_map<uint64_t, UniformValue> uniforms;  // by program and location.
+
+			void reset(uint64_t new_epoch)
+			{
+				*this = ShadowState();
+				epoch = new_epoch;
+			}
+		};
+
+		thread_local ShadowState t_state;
+
+		ShadowState & state()
+		{
+			uint64_t epoch = g_epoch.load(std::memory_order_relaxed);
+			if (t_state.epoch != epoch)
+				t_state.reset(epoch);
+			return t_state;
+		}
+
+		template <typename K>
+		bool updateBinding(std::map<K, GLuint> & bindings, const K & key, GLuint name)
+		{
+			auto inserted = bindings.emplace(key, name);
+			if (inserted.second)
+				return false;
+			bool redundant = inserted.first->second == name;
+			inserted.first->second = name;
+			return redundant;
+		}
+
+		template <typename K>
+		void unbindDeleted(std::map<K, GLuint> & bindings, GLsizei count, const GLuint * names)
+		{
+			// deleting a bound object reverts its binding points to 0.
+			for (auto & binding : bindings)
+				if (std::find(names, names + count, binding.second) != names + count)
+					binding.second = 0;
+		}
+
+#ifdef SGG_GL_TRACE
+		void GLAPIENTRY debugCallback(GLenum, GLenum type, GLuint, GLenum severity, GLsizei, const GLchar * message, const void *)
+		{
+			// notifications and performance hints of low severity are too chatty to report.
+			if (type != GL_DEBUG_TYPE_ERROR && severity != GL_DEBUG_SEVERITY_HIGH)
+				return;
+			if (type == GL_DEBUG_TYPE_ERROR)
+				g_errors++;
+			std::cout << "GL " << (type == GL_DEBUG_TYPE_ERROR ? "error" : "warning") << ": " << message << "\n";
+		}
+#endif
+	}
+
+	std::atomic<bool> GLTrace::s_enabled { false };
+
+	bool GLTrace::isAvailable()
+	{
+#ifdef SGG_GL_TRACE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool GLTrace::setEnabled(bool enabled, const std::string & summary_file)
+	{
+		if (!isAvailable())
+		{
+			if (enabled)
+				std::cout << "GL call tracing is not available: the library was built without SGG_GL_TRACE\n";
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(g_mutex);
+		if (g_summary.is_open())
+			g_summary.close();
+		if (enabled && !summary_file.empty())
+		{
+			g_summary.open(summary_file, std::ios::out | std::ios::trunc);
+			if (!g_summary)
+				std::cout << "Unable to write GL call summary " << summary_file << "\n";
+		}
+
+		if (enabled && !s_enabled)
+		{
+			for (int i = 0; i < GL_FN_COUNT; i++)
+				g_calls[i] = g_redundant[i] = 0;
+			g_errors = 0;
+			g_frame = 0;
+			g_last = GLTraceStats();
+			g_epoch++;
+		}
+		s_enabled = enabled;
+		return true;
+	}
+
+	bool GLTrace::getStats(GLTraceStats & stats)
+	{
+		std::lock_guard<std::mutex> lock(g_mutex);
+		if (!g_frame)
+			return false;
+		stats = g_last;
+		return true;
+	}
+
+	void GLTrace::endFrame()
+	{
+		if (!isEnabled())
+			return;
+
+		std::lock_guard<std::mutex> lock(g_mutex);
+		GLTraceStats & stats = g_last;
+		stats.frame = g_frame++;
+		stats.calls = stats.redundant = 0;
+		stats.errors = g_errors.exchange(0);
+		stats.functions.clear();
+		for (int i = 0; i < GL_FN_COUNT; i++)
+		{
+			GLCallCount count;
+			count.function = g_function_names[i];
+			count.calls = g_calls[i].exchange(0, std::memory_order_relaxed);
+			count.redundant = g_redundant[i].exchange(0, std::memory_order_relaxed);
+			if (!count.calls)
+				continue;
+			stats.calls += count.calls;
+			stats.redundant += count.redundant;
+			stats.functions.push_back(count);
+		}
+		std::sort(stats.functions.begin(), stats.functions.end(), [](const GLCallCount & a, const GLCallCount & b)
+		{
+			return a.calls > b.calls;
+		});
+
+		if (!g_summary.is_open())
+			return;
+		g_summary << "frame " << stats.frame << ": " << stats.calls << " calls, " << stats.redundant << " redundant, " << stats.errors << " errors\n";
+		for (const GLCallCount & count : stats.functions)
+		{
+			g_summary << "\t" << count.function << " " << count.calls;
+			if (count.redundant)
+				g_summary << " (" << count.redundant << " redundant)";
+			g_summary << "\n";
+		}
+		g_summary.flush();
+	}
+
+	void GLTrace::contextChanged()
+	{
+		t_state.reset(g_epoch.load(std::memory_order_relaxed));
+	}
+
+	void GLTrace::initDebugOutput()
+	{
+#ifdef SGG_GL_TRACE
+		if (!GLEW_KHR_debug || !GLEW_GET_FUN(__glewDebugMessageCallback))
+		{
+			std::cout << "GL errors are only reported by SGG_CHECK_GL(), as the driver does not support KHR_debug\n";
+			return;
+		}
+		glEnable(GL_DEBUG_OUTPUT);
+		// errors are reported from within the failing call, so that a debugger stops at its caller.
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		glDebugMessageCallback(debugCallback, nullptr);
+#endif
+	}
+
+	bool GLTrace::checkErrors(const char * file, int line)
+	{
+		bool ok = true;
+		GLenum err;
+		while ((err = glGetError()) != GL_NO_ERROR)
+		{
+			std::cout << "GL error " << (const char *)glewGetErrorString(err) << " (" << err << ") at " << file << ":" << line << "\n";
+			g_errors++;
+			ok = false;
+		}
+		return ok;
+	}
+
+	void GLTrace::record(gl_function_t function, bool redundant)
+	{
+		g_calls[function].fetch_add(1, std::memory_order_relaxed);
+		if (redundant)
+			g_redundant[function].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool GLTrace::useProgram(GLuint program)
+	{
+		ShadowState & s = state();
+		bool redundant = s.program == program;
+		s.program = program;
+		return redundant;
+	}
+
+	bool GLTrace::linkProgram(GLuint program)
+	{
+		// linking resets the uniforms of the program to their defaults.
+		ShadowState & s = state();
+		for (auto iter = s.uniforms.begin(); iter != s.uniforms.end();)
+		{
+			if ((GLuint)(iter->first >> 32) == program)
+				iter = s.uniforms.erase(iter);
+			else
+				++iter;
+		}
+		return false;
+	}
+
+	bool GLTrace::activeTexture(GLenum unit)
+	{
+		ShadowState & s = state();
+		bool redundant = s.active_unit == unit;
+		s.active_unit = unit;
+		return redundant;
+	}
+
+	bool GLTrace::bindTexture(GLenum target, GLuint texture)
+	{
+		ShadowState & s = state();
+		// bindings on an unknown texture unit cannot be compared.
+		if (!s.active_unit)
+			return false;
+		return updateBinding(s.textures, std::make_pair(s.active_unit, target), texture);
+	}
+
+	bool GLTrace::bindBuffer(GLenum target, GLuint buffer)
+	{
+		return updateBinding(state().buffers, target, buffer);
+	}
+
+	bool GLTrace::bindVertexArray(GLuint vao)
+	{
+		ShadowState & s = state();
+		bool redundant = s.vao == vao;
+		s.vao = vao;
+		return redundant;
+	}
+
+	bool GLTrace::bindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		ShadowState & s = state();
+		bool redundant;
+		if (target == GL_READ_FRAMEBUFFER)
+		{
+			redundant = s.read_framebuffer == framebuffer;
+			s.read_framebuffer = framebuffer;
+		}
+		else if (target == GL_DRAW_FRAMEBUFFER)
+		{
+			redundant = s.draw_framebuffer == framebuffer;
+			s.draw_framebuffer = framebuffer;
+		}
+		else
+		{
+			redundant = s.read_framebuffer == framebuffer && s.draw_framebuffer == framebuffer;
+			s.read_framebuffer = s.draw_framebuffer = framebuffer;
+		}
+		return redundant;
+	}
+
+	bool GLTrace::setUniform(GLint location, const void * value, size_t size)
+	{
+		ShadowState & s = state();
+		// uniforms are set on the program in use, so they cannot be compared while it is unknown.
+		if (location < 0 || s.program == ~0u || size > sizeof(UniformValue::bytes))
+			return false;
+		UniformValue & current = s.uniforms[((uint64_t)s.program << 32) | (uint32_t)location];
+		bool redundant = current.size == size && !memcmp(current.bytes, value, size);
+		memcpy(current.bytes, value, size);
+		current.size = size;
+		return redundant;
+	}
+
+	void GLTrace::deleteTextures(GLsizei count, const GLuint * textures)
+	{
+		unbindDeleted(state().textures, count, textures);
+	}
+
+	void GLTrace::deleteBuffers(GLsizei count, const GLuint * buffers)
+	{
+		unbindDeleted(state().buffers, count, buffers);
+	}
+
+	void GLTrace::deleteFramebuffers(GLsizei count, const GLuint * framebuffers)
+	{
+		ShadowState & s = state();
+		for (GLsizei i = 0; i < count; i++)
+		{
+			if (s.read_framebuffer == framebuffers[i])
+				s.read_framebuffer = 0;
+			if (s.draw_framebuffer == framebuffers[i])
+				s.draw_framebuffer = 0;
+		}
+	}
+}
@@ -0,0 +1,425 @@
+#pragma once
+#include <GL/glew.h>
+#include <sgg/graphics.h>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// the GL entry points used by the library, which are counted by the GL call tracer.
+#define SGG_GL_FUNCTIONS(X) \
+	X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindFragDataLocation) X(BindFramebuffer) \
+	X(BindTexture) X(BindVertexArray) X(BindVertexArrayAPPLE) X(BlendEquation) X(BlendFunc) X(BufferData) \
+	X(BufferSubData) X(CheckFramebufferStatus) X(Clear) X(ClearColor) X(ClearDepth) X(ClientWaitSync) \
+	X(CompileShader) X(CreateProgram) X(CreateShader) X(CullFace) X(DeleteBuffers) X(DeleteFramebuffers) \
+	X(DeleteQueries) X(DeleteShader) X(DeleteSync) X(DeleteTextures) X(DepthFunc) X(DepthMask) X(DetachShader) \
+	X(Disable) X(DrawArrays) X(Enable) X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) X(Flush) \
+	X(FramebufferTexture2D) X(FrontFace) X(GenBuffers) X(GenFramebuffers) X(GenQueries) X(GenTextures) \
+	X(GenVertexArrays) X(GenVertexArraysAPPLE) X(GenerateMipmap) X(GetAttribLocation) X(GetError) \
+	X(GetIntegerv) X(GetProgramInfoLog) X(GetProgramiv) X(GetQueryObjectiv) X(GetQueryObjectui64v) \
+	X(GetShaderInfoLog) X(GetShaderiv) X(GetUniformLocation) X(IsProgram) X(IsShader) X(LineWidth) \
+	X(LinkProgram) X(MapBufferRange) X(PixelStorei) X(ReadPixels) X(Scissor) X(ShaderSource) X(TexImage2D) \
+	X(TexParameterf) X(TexParameteri) X(Uniform1f) X(Uniform1i) X(Uniform1ui) X(Uniform2fv) X(Uniform2iv) \
+	X(Uniform3f) X(Uniform3iv) X(Uniform4f) X(Uniform4iv) X(UniformMatrix3fv) X(UniformMatrix4fv) \
+	X(UnmapBuffer) X(UseProgram) X(ValidateProgram) X(VertexAttribPointer) X(Viewport)
+
+namespace graphics
+{
+	typedef enum {
+#define SGG_GL_FUNCTION_ID(name) GL_FN_##name,
+		SGG_GL_FUNCTIONS(SGG_GL_FUNCTION_ID)
+#undef SGG_GL_FUNCTION_ID
+		GL_FN_COUNT
+	} gl_function_t;
+
+	/** Counts the GL calls of the library, per frame and per entry point, for setGLTracing().
+
+		In builds with SGG_GL_TRACE defined, every GL entry point used by the library is replaced by a wrapper (see the
+		end of this header), which counts the call while tracing is enabled. Calls that set the state it already has
+		(binding the program, buffer, texture, vertex array or framebuffer that is already bound, or setting a uniform
+		to the value it already has) are counted as redundant, by comparing them with a shadow copy of that state kept
+		for each thread, as a context is only current on one thread at a time. The shadow state starts out unknown, so
+		the first call after tracing starts or the context changes is never redundant.
+
+		GL errors are reported through a KHR_debug callback where the driver supports it, and otherwise only
+		by SGG_CHECK_GL().
+	*/
+	class GLTrace
+	{
+		static std::atomic<bool> s_enabled;
+
+	public:
+		static bool isAvailable();
+		static bool setEnabled(bool enabled, const std::string & summary_file);
+		static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+		static bool getStats(GLTraceStats & stats);
+
+		/** Closes the counts of the frame and writes its summary, if a summary file was given.
+		*/
+		static void endFrame();
+
+		/** Forgets the shadow state of the calling thread, when another context is made current on it.
+		*/
+		static void contextChanged();
+
+		/** Registers the KHR_debug callback with the current context, if the driver supports it.
+		*/
+		static void initDebugOutput();
+
+		/** Reports the pending GL errors, with the location of the check.
+
+			\return true if there were no errors.
+		*/
+		static bool checkErrors(const char * file, int line);
+
+		static void record(gl_function_t function, bool redundant = false);
+
+		// each of these compares the call with the shadow state, which it then updates, and tells whether it was redundant.
+		static bool useProgram(GLuint program);
+		static bool linkProgram(GLuint program);
+		static bool activeTexture(GLenum unit);
+		static bool bindTexture(GLenum target, GLuint texture);
+		static bool bindBuffer(GLenum target, GLuint buffer);
+		static bool bindVertexArray(GLuint vao);
+		static bool bindFramebuffer(GLenum target, GLuint framebuffer);
+		static bool setUniform(GLint location, const void * value, size_t size);
+		static void deleteTextures(GLsizei count, const GLuint * textures);
+		static void deleteBuffers(GLsizei count, const GLuint * buffers);
+		static void deleteFramebuffers(GLsizei count, const GLuint * framebuffers);
+	};
+}
+
+#ifdef SGG_GL_TRACE
+
+namespace graphics
+{
+	namespace gltrace
+	{
+		template <typename T>
+		struct identity { typedef T type; };
+
+		// the arguments take the parameter types of the function (not deduced), so that 0 and NULL still convert to pointers.
+		template <typename R, typename... Params>
+		inline R call(gl_function_t function, R (GLAPIENTRY * fn)(Params...), typename identity<Params>::type... args)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(function);
+			return fn(args...);
+		}
+
+		inline void useProgram(GLuint program)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_UseProgram, GLTrace::useProgram(program));
+			GLEW_GET_FUN(__glewUseProgram)(program);
+		}
+
+		inline void linkProgram(GLuint program)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_LinkProgram, GLTrace::linkProgram(program));
+			GLEW_GET_FUN(__glewLinkProgram)(program);
+		}
+
+		inline void activeTexture(GLenum unit)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_ActiveTexture, GLTrace::activeTexture(unit));
+			GLEW_GET_FUN(__glewActiveTexture)(unit);
+		}
+
+		inline void bindTexture(GLenum target, GLuint texture)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_BindTexture, GLTrace::bindTexture(target, texture));
+			::glBindTexture(target, texture);
+		}
+
+		inline void bindBuffer(GLenum target, GLuint buffer)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_BindBuffer, GLTrace::bindBuffer(target, buffer));
+			GLEW_GET_FUN(__glewBindBuffer)(target, buffer);
+		}
+
+		inline void bindVertexArray(GLuint vao)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_BindVertexArray, GLTrace::bindVertexArray(vao));
+			GLEW_GET_FUN(__glewBindVertexArray)(vao);
+		}
+
+		inline void bindVertexArrayAPPLE(GLuint vao)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_BindVertexArrayAPPLE, GLTrace::bindVertexArray(vao));
+			GLEW_GET_FUN(__glewBindVertexArrayAPPLE)(vao);
+		}
+
+		inline void bindFramebuffer(GLenum target, GLuint framebuffer)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(GL_FN_BindFramebuffer, GLTrace::bindFramebuffer(target, framebuffer));
+			GLEW_GET_FUN(__glewBindFramebuffer)(target, framebuffer);
+		}
+
+		inline void deleteTextures(GLsizei count, const GLuint * textures)
+		{
+			if (GLTrace::isEnabled())
+			{
+				GLTrace::record(GL_FN_DeleteTextures);
+				GLTrace::deleteTextures(count, textures);
+			}
+			::glDeleteTextures(count, textures);
+		}
+
+		inline void deleteBuffers(GLsizei count, const GLuint * buffers)
+		{
+			if (GLTrace::isEnabled())
+			{
+				GLTrace::record(GL_FN_DeleteBuffers);
+				GLTrace::deleteBuffers(count, buffers);
+			}
+			GLEW_GET_FUN(__glewDeleteBuffers)(count, buffers);
+		}
+
+		inline void deleteFramebuffers(GLsizei count, const GLuint * framebuffers)
+		{
+			if (GLTrace::isEnabled())
+			{
+				GLTrace::record(GL_FN_DeleteFramebuffers);
+				GLTrace::deleteFramebuffers(count, framebuffers);
+			}
+			GLEW_GET_FUN(__glewDeleteFramebuffers)(count, framebuffers);
+		}
+
+		inline void uniform(gl_function_t function, GLint location, const void * value, size_t size)
+		{
+			if (GLTrace::isEnabled())
+				GLTrace::record(function, GLTrace::setUniform(location, value, size));
+		}
+
+		inline void uniform1i(GLint location, GLint v0)
+		{
+			uniform(GL_FN_Uniform1i, location, &v0, sizeof v0);
+			GLEW_GET_FUN(__glewUniform1i)(location, v0);
+		}
+
+		inline void uniform1ui(GLint location, GLuint v0)
+		{
+			uniform(GL_FN_Uniform1ui, location, &v0, sizeof v0);
+			GLEW_GET_FUN(__glewUniform1ui)(location, v0);
+		}
+
+		inline void uniform1f(GLint location, GLfloat v0)
+		{
+			uniform(GL_FN_Uniform1f, location, &v0, sizeof v0);
+			GLEW_GET_FUN(__glewUniform1f)(location, v0);
+		}
+
+		inline void uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+		{
+			GLfloat value[3] = { v0, v1, v2 };
+			uniform(GL_FN_Uniform3f, location, value, sizeof value);
+			GLEW_GET_FUN(__glewUniform3f)(location, v0, v1, v2);
+		}
+
+		inline void uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+		{
+			GLfloat value[4] = { v0, v1, v2, v3 };
+			uniform(GL_FN_Uniform4f, location, value, sizeof value);
+			GLEW_GET_FUN(__glewUniform4f)(location, v0, v1, v2, v3);
+		}
+
+		inline void uniform2fv(GLint location, GLsizei count, const GLfloat * value)
+		{
+			uniform(GL_FN_Uniform2fv, location, value, count * 2 * sizeof(GLfloat));
+			GLEW_GET_FUN(__glewUniform2fv)(location, count, value);
+		}
+
+		inline void uniform2iv(GLint location, GLsizei count, const GLint * value)
+		{
+			uniform(GL_FN_Uniform2iv, location, value, count * 2 * sizeof(GLint));
+			GLEW_GET_FUN(__glewUniform2iv)(location, count, value);
+		}
+
+		inline void uniform3iv(GLint location, GLsizei count, const GLint * value)
+		{
+			uniform(GL_FN_Uniform3iv, location, value, count * 3 * sizeof(GLint));
+			GLEW_GET_FUN(__glewUniform3iv)(location, count, value);
+		}
+
+		inline void uniform4iv(GLint location, GLsizei count, const GLint * value)
+		{
+			uniform(GL_FN_Uniform4iv, location, value, count * 4 * sizeof(GLint));
+			GLEW_GET_FUN(__glewUniform4iv)(location, count, value);
+		}
+
+		inline void uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
+		{
+			// transposed and untransposed uploads of the same floats are not told apart; the library only uploads untransposed.
+			uniform(GL_FN_UniformMatrix3fv, location, value, count * 9 * sizeof(GLfloat));
+			GLEW_GET_FUN(__glewUniformMatrix3fv)(location, count, transpose, value);
+		}
+
+		inline void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
+		{
+			uniform(GL_FN_UniformMatrix4fv, location, value, count * 16 * sizeof(GLfloat));
+			GLEW_GET_FUN(__glewUniformMatrix4fv)(location, count, transpose, value);
+		}
+	}
+}
+
+// state changes are checked for redundancy.
+#undef glUseProgram
+#define glUseProgram(...) graphics::gltrace::useProgram(__VA_ARGS__)
+#undef glLinkProgram
+#define glLinkProgram(...) graphics::gltrace::linkProgram(__VA_ARGS__)
+#undef glActiveTexture
+#define glActiveTexture(...) graphics::gltrace::activeTexture(__VA_ARGS__)
+#define glBindTexture(...) graphics::gltrace::bindTexture(__VA_ARGS__)
+#undef glBindBuffer
+#define glBindBuffer(...) graphics::gltrace::bindBuffer(__VA_ARGS__)
+#undef glBindVertexArray
+#define glBindVertexArray(...) graphics::gltrace::bindVertexArray(__VA_ARGS__)
+#undef glBindVertexArrayAPPLE
+#define glBindVertexArrayAPPLE(...) graphics::gltrace::bindVertexArrayAPPLE(__VA_ARGS__)
+#undef glBindFramebuffer
+#define glBindFramebuffer(...) graphics::gltrace::bindFramebuffer(__VA_ARGS__)
+#define glDeleteTextures(...) graphics::gltrace::deleteTextures(__VA_ARGS__)
+#undef glDeleteBuffers
+#define glDeleteBuffers(...) graphics::gltrace::deleteBuffers(__VA_ARGS__)
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers(...) graphics::gltrace::deleteFramebuffers(__VA_ARGS__)
+#undef glUniform1i
+#define glUniform1i(...) graphics::gltrace::uniform1i(__VA_ARGS__)
+#undef glUniform1ui
+#define glUniform1ui(...) graphics::gltrace::uniform1ui(__VA_ARGS__)
+#undef glUniform1f
+#define glUniform1f(...) graphics::gltrace::uniform1f(__VA_ARGS__)
+#undef glUniform3f
+#define glUniform3f(...) graphics::gltrace::uniform3f(__VA_ARGS__)
+#undef glUniform4f
+#define glUniform4f(...) graphics::gltrace::uniform4f(__VA_ARGS__)
+#undef glUniform2fv
+#define glUniform2fv(...) graphics::gltrace::uniform2fv(__VA_ARGS__)
+#undef glUniform2iv
+#define glUniform2iv(...) graphics::gltrace::uniform2iv(__VA_ARGS__)
+#undef glUniform3iv
+#define glUniform3iv(...) graphics::gltrace::uniform3iv(__VA_ARGS__)
+#undef glUniform4iv
+#define glUniform4iv(...) graphics::gltrace::uniform4iv(__VA_ARGS__)
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv(...) graphics::gltrace::uniformMatrix3fv(__VA_ARGS__)
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv(...) graphics::gltrace::uniformMatrix4fv(__VA_ARGS__)
+
+// the other entry points of OpenGL 1.1, which are exported by the GL library itself, are only counted.
+#define SGG_GL_CALL(name, ...) graphics::gltrace::call(graphics::GL_FN_##name, gl##name, __VA_ARGS__)
+#define glBlendFunc(...) SGG_GL_CALL(BlendFunc, __VA_ARGS__)
+#define glClear(...) SGG_GL_CALL(Clear, __VA_ARGS__)
+#define glClearColor(...) SGG_GL_CALL(ClearColor, __VA_ARGS__)
+#define glClearDepth(...) SGG_GL_CALL(ClearDepth, __VA_ARGS__)
+#define glCullFace(...) SGG_GL_CALL(CullFace, __VA_ARGS__)
+#define glDepthFunc(...) SGG_GL_CALL(DepthFunc, __VA_ARGS__)
+#define glDepthMask(...) SGG_GL_CALL(DepthMask, __VA_ARGS__)
+#define glDisable(...) SGG_GL_CALL(Disable, __VA_ARGS__)
+#define glDrawArrays(...) SGG_GL_CALL(DrawArrays, __VA_ARGS__)
+#define glEnable(...) SGG_GL_CALL(Enable, __VA_ARGS__)
+#define glFlush() graphics::gltrace::call(graphics::GL_FN_Flush, glFlush)
+#define glFrontFace(...) SGG_GL_CALL(FrontFace, __VA_ARGS__)
+#define glGenTextures(...) SGG_GL_CALL(GenTextures, __VA_ARGS__)
+#define glGetError() graphics::gltrace::call(graphics::GL_FN_GetError, glGetError)
+#define glGetIntegerv(...) SGG_GL_CALL(GetIntegerv, __VA_ARGS__)
+#define glLineWidth(...) SGG_GL_CALL(LineWidth, __VA_ARGS__)
+#define glPixelStorei(...) SGG_GL_CALL(PixelStorei, __VA_ARGS__)
+#define glReadPixels(...) SGG_GL_CALL(ReadPixels, __VA_ARGS__)
+#define glScissor(...) SGG_GL_CALL(Scissor, __VA_ARGS__)
+#define glTexImage2D(...) SGG_GL_CALL(TexImage2D, __VA_ARGS__)
+#define glTexParameterf(...) SGG_GL_CALL(TexParameterf, __VA_ARGS__)
+#define glTexParameteri(...) SGG_GL_CALL(TexParameteri, __VA_ARGS__)
+#define glViewport(...) SGG_GL_CALL(Viewport, __VA_ARGS__)
+
+// and so are the entry points loaded by GLEW.
+#define SGG_GLEW_CALL(name, ...) graphics::gltrace::call(graphics::GL_FN_##name, GLEW_GET_FUN(__glew##name), __VA_ARGS__)
+#undef glAttachShader
+#define glAttachShader(...) SGG_GLEW_CALL(AttachShader, __VA_ARGS__)
+#undef glBeginQuery
+#define glBeginQuery(...) SGG_GLEW_CALL(BeginQuery, __VA_ARGS__)
+#undef glBindFragDataLocation
+#define glBindFragDataLocation(...) SGG_GLEW_CALL(BindFragDataLocation, __VA_ARGS__)
+#undef glBlendEquation
+#define glBlendEquation(...) SGG_GLEW_CALL(BlendEquation, __VA_ARGS__)
+#undef glBufferData
+#define glBufferData(...) SGG_GLEW_CALL(BufferData, __VA_ARGS__)
+#undef glBufferSubData
+#define glBufferSubData(...) SGG_GLEW_CALL(BufferSubData, __VA_ARGS__)
+#undef glCheckFramebufferStatus
+#define glCheckFramebufferStatus(...) SGG_GLEW_CALL(CheckFramebufferStatus, __VA_ARGS__)
+#undef glClientWaitSync
+#define glClientWaitSync(...) SGG_GLEW_CALL(ClientWaitSync, __VA_ARGS__)
+#undef glCompileShader
+#define glCompileShader(...) SGG_GLEW_CALL(CompileShader, __VA_ARGS__)
+#undef glCreateProgram
+#define glCreateProgram() graphics::gltrace::call(graphics::GL_FN_CreateProgram, GLEW_GET_FUN(__glewCreateProgram))
+#undef glCreateShader
+#define glCreateShader(...) SGG_GLEW_CALL(CreateShader, __VA_ARGS__)
+#undef glDeleteQueries
+#define glDeleteQueries(...) SGG_GLEW_CALL(DeleteQueries, __VA_ARGS__)
+#undef glDeleteShader
+#define glDeleteShader(...) SGG_GLEW_CALL(DeleteShader, __VA_ARGS__)
+#undef glDeleteSync
+#define glDeleteSync(...) SGG_GLEW_CALL(DeleteSync, __VA_ARGS__)
+#undef glDetachShader
+#define glDetachShader(...) SGG_GLEW_CALL(DetachShader, __VA_ARGS__)
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray(...) SGG_GLEW_CALL(EnableVertexAttribArray, __VA_ARGS__)
+#undef glEndQuery
+#define glEndQuery(...) SGG_GLEW_CALL(EndQuery, __VA_ARGS__)
+#undef glFenceSync
+#define glFenceSync(...) SGG_GLEW_CALL(FenceSync, __VA_ARGS__)
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D(...) SGG_GLEW_CALL(FramebufferTexture2D, __VA_ARGS__)
+#undef glGenBuffers
+#define glGenBuffers(...) SGG_GLEW_CALL(GenBuffers, __VA_ARGS__)
+#undef glGenFramebuffers
+#define glGenFramebuffers(...) SGG_GLEW_CALL(GenFramebuffers, __VA_ARGS__)
+#undef glGenQueries
+#define glGenQueries(...) SGG_GLEW_CALL(GenQueries, __VA_ARGS__)
+#undef glGenVertexArrays
+#define glGenVertexArrays(...) SGG_GLEW_CALL(GenVertexArrays, __VA_ARGS__)
+#undef glGenVertexArraysAPPLE
+#define glGenVertexArraysAPPLE(...) SGG_GLEW_CALL(GenVertexArraysAPPLE, __VA_ARGS__)
+#undef glGenerateMipmap
+#define glGenerateMipmap(...) SGG_GLEW_CALL(GenerateMipmap, __VA_ARGS__)
+#undef glGetAttribLocation
+#define glGetAttribLocation(...) SGG_GLEW_CALL(GetAttribLocation, __VA_ARGS__)
+#undef glGetProgramInfoLog
+#define glGetProgramInfoLog(...) SGG_GLEW_CALL(GetProgramInfoLog, __VA_ARGS__)
+#undef glGetProgramiv
+#define glGetProgramiv(...) SGG_GLEW_CALL(GetProgramiv, __VA_ARGS__)
+#undef glGetQueryObjectiv
+#define glGetQueryObjectiv(...) SGG_GLEW_CALL(GetQueryObjectiv, __VA_ARGS__)
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v(...) SGG_GLEW_CALL(GetQueryObjectui64v, __VA_ARGS__)
+#undef glGetShaderInfoLog
+#define glGetShaderInfoLog(...) SGG_GLEW_CALL(GetShaderInfoLog, __VA_ARGS__)
+#undef glGetShaderiv
+#define glGetShaderiv(...) SGG_GLEW_CALL(GetShaderiv, __VA_ARGS__)
+#undef glGetUniformLocation
+#define glGetUniformLocation(...) SGG_GLEW_CALL(GetUniformLocation, __VA_ARGS__)
+#undef glIsProgram
+#define glIsProgram(...) SGG_GLEW_CALL(IsProgram, __VA_ARGS__)
+#undef glIsShader
+#define glIsShader(...) SGG_GLEW_CALL(IsShader, __VA_ARGS__)
+#undef glMapBufferRange
+#define glMapBufferRange(...) SGG_GLEW_CALL(MapBufferRange, __VA_ARGS__)
+#undef glShaderSource
+#define glShaderSource(...) SGG_GLEW_CALL(ShaderSource, __VA_ARGS__)
+#undef glUnmapBuffer
+#define glUnmapBuffer(...) SGG_GLEW_CALL(UnmapBuffer, __VA_ARGS__)
+#undef glValidateProgram
+#define glValidateProgram(...) SGG_GLEW_CALL(ValidateProgram, __VA_ARGS__)
+#undef glVertexAttribPointer
+#define glVertexAttribPointer(...) SGG_GLEW_CALL(VertexAttribPointer, __VA_ARGS__)
+
+#endif
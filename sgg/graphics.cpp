@@ -1,198 +1,601 @@
 #include <sgg/graphics.h>
 #include <sgg/GLbackend.h>
+#include <sgg/remote.h>
+#include <sgg/capture.h>
+#include <sgg/trace.h>
+#include <sgg/gltrace.h>
+#include <sgg/memregistry.h>
 
 
-static graphics::GLBackend * engine = nullptr;
-
 namespace graphics
 {
+	// the context used by the calling thread, unless one was bound with Context::makeCurrent().
+	static thread_local Context * current_context = nullptr;
+
+	static Context * getDefaultContext()
+	{
+		// intentionally never destroyed, so that no SDL or GL calls are made during static destruction.
+		static Context * default_context = new Context();
+		return default_context;
+	}
+
+	Context::Context()
+	{
+	}
+
+	Context::~Context()
+	{
+		destroyWindow();
+		if (current_context == this)
+			current_context = nullptr;
+	}
+
+	void Context::createWindow(int width, int height, std::string title, renderer_t renderer)
+	{
+		// an existing window is replaced, rather than initialized a second time.
+		destroyWindow();
+		m_engine = new GLBackend(width, height, title);
+		m_engine->setRendererType(renderer);
+		m_engine->init();
+		m_engine->show(true);
+	}
+
+	bool Context::createHeadlessWindow(int width, int height, renderer_t renderer)
+	{
+		destroyWindow();
+		m_engine = new GLBackend(width, height, "");
+		m_engine->setHeadless(true);
+		m_engine->setRendererType(renderer);
+		return m_engine->init();
+	}
+
+	void Context::destroyWindow()
+	{
+		if (!m_engine)
+			return;
+		m_engine->cleanup();
+		delete m_engine;
+		m_engine = nullptr;
+	}
+
+	bool Context::connectRenderer(const std::string & socket_path)
+	{
+		destroyWindow();
+		m_engine = new RemoteBackend(socket_path);
+		if (m_engine->init())
+			return true;
+		delete m_engine;
+		m_engine = nullptr;
+		return false;
+	}
+
+	void Context::makeCurrent()
+	{
+		current_context = this;
+		if (m_engine)
+			m_engine->makeCurrent();
+	}
+
+	Context * Context::getCurrent()
+	{
+		return current_context ? current_context : getDefaultContext();
+	}
+
+	GLBackend * engine()
+	{
+		return Context::getCurrent()->m_engine;
+	}
+
+	// the encoder recording the public drawing calls of the current context, or null if no capture is running.
+	static CommandEncoder * capture()
+	{
+		return engine()->getCaptureEncoder();
+	}
+
 	float getDeltaTime()
 	{
-		return engine->getDeltaTime();
+		return engine()->getDeltaTime();
 	}
 
 	float getGlobalTime()
 	{
-		return engine->getGlobalTime();
+		return engine()->getGlobalTime();
 	}
 
 	void drawRect(float center_x, float center_y, float width, float height, const Brush & brush)
 	{
-		engine->drawRect(center_x, center_y, width, height, brush);
+		if (CommandEncoder * encoder = capture())
+			encoder->drawRect(center_x, center_y, width, height, brush);
+		engine()->drawRect(center_x, center_y, width, height, brush);
 	}
 
 	void drawLine(float x1, float y1, float x2, float y2, const Brush & brush)
 	{
-		engine->drawLine(x1, y1, x2, y2, brush);
+		if (CommandEncoder * encoder = capture())
+			encoder->drawLine(x1, y1, x2, y2, brush);
+		engine()->drawLine(x1, y1, x2, y2, brush);
 	}
 
 	bool setFont(std::string fontname)
 	{
-		return engine->setFont(fontname);
+		if (CommandEncoder * encoder = capture())
+			encoder->setFont(fontname);
+		return engine()->setFont(fontname);
 	}
 
 	void drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush)
 	{
-		engine->drawText(pos_x, pos_y, size, text, brush);
+		if (CommandEncoder * encoder = capture())
+			encoder->drawText(pos_x, pos_y, size, text, brush);
+		engine()->drawText(pos_x, pos_y, size, text, brush);
 	}
 
 	void drawDisk(float x, float y, float radius, const Brush & brush)
 	{
-		engine->drawSector(x, y, 0, 360, 0.0f, radius, brush);
+		if (CommandEncoder * encoder = capture())
+			encoder->drawSector(x, y, 0, 360, 0.0f, radius, brush);
+		engine()->drawSector(x, y, 0, 360, 0.0f, radius, brush);
 	}
 
 	void drawSector(float cx, float cy, float radius1, float radius2, float start_angle, float end_angle, const Brush & brush)
 	{
-		engine->drawSector(cx, cy, start_angle, end_angle, radius1, radius2, brush);
+		if (CommandEncoder * encoder = capture())
+			encoder->drawSector(cx, cy, start_angle, end_angle, radius1, radius2, brush);
+		engine()->drawSector(cx, cy, start_angle, end_angle, radius1, radius2, brush);
 	}
 
 	void setOrientation(float angle)
 	{
-		engine->setOrientation(angle);
+		if (CommandEncoder * encoder = capture())
+			encoder->setOrientation(angle);
+		engine()->setOrientation(angle);
 	}
 
 	void setScale(float sx, float sy)
 	{
-		engine->setScale(sx, sy, 1.0f);
+		if (CommandEncoder * encoder = capture())
+			encoder->setScale(sx, sy, 1.0f);
+		engine()->setScale(sx, sy, 1.0f);
 	}
 
 	void resetPose()
 	{
-		engine->resetPose();
+		if (CommandEncoder * encoder = capture())
+			encoder->resetPose();
+		engine()->resetPose();
 	}
 
 	std::vector<std::string> preloadBitmaps(std::string dir)
 	{
-		return engine->preloadBitmaps(dir);
+		return engine()->preloadBitmaps(dir);
 	}
 
 	void playSound(std::string soundfile, float volume, bool looping)
 	{
-		engine->playSound(soundfile, volume, looping);
+		engine()->playSound(soundfile, volume, looping);
 	}
 
 	void stopMusic(int fade_time)
 	{
-		engine->stopMusic(fade_time);
+		engine()->stopMusic(fade_time);
 	}
 
 	void playMusic(std::string soundfile, float volume, bool looping, int fade_time )
 	{
-		engine->playMusic(soundfile, volume, looping, fade_time);
+		engine()->playMusic(soundfile, volume, looping, fade_time);
 	}
 
-	void createWindow(int width, int height, std::string title)
+	void createWindow(int width, int height, std::string title, renderer_t renderer)
 	{
-		if (!engine)
-			engine = new GLBackend(width, height, title);
-		engine->init();
-		engine->show(true);
+		Context::getCurrent()->createWindow(width, height, title, renderer);
 	}
 
 	void setWindowBackground(Brush style)
 	{
-		engine->setBackgroundColor(style.fill_color[0], style.fill_color[1], style.fill_color[2]);
+		if (CommandEncoder * encoder = capture())
+			encoder->setBackgroundColor(style.fill_color[0], style.fill_color[1], style.fill_color[2]);
+		engine()->setBackgroundColor(style.fill_color[0], style.fill_color[1], style.fill_color[2]);
 	}
 
 	void destroyWindow()
 	{
-		engine->cleanup();
-		delete engine;
-		engine = nullptr;
+		Context::getCurrent()->destroyWindow();
 	}
 
 	void startMessageLoop()
 	{
+		GLBackend * backend = engine();
 		bool running = true;
-		engine->draw();
+		backend->draw();
 		while (running)
 		{
-			running = engine->processMessages();
+			running = backend->processMessages();
 			
 		}
 	}
 
 	void stopMessageLoop()
 	{
-		engine->terminate();
+		engine()->terminate();
+	}
+
+	bool createHeadlessWindow(int width, int height, renderer_t renderer)
+	{
+		return Context::getCurrent()->createHeadlessWindow(width, height, renderer);
+	}
+
+	renderer_t getRenderer()
+	{
+		return engine()->getRendererType();
+	}
+
+	bool runFrames(unsigned int count)
+	{
+		return engine()->runFrames(count);
+	}
+
+	bool getFramePixels(std::vector<unsigned char> & pixels, int & width, int & height)
+	{
+		return engine()->getFramePixels(pixels, width, height);
+	}
+
+	bool saveFrame(const std::string & filename)
+	{
+		return engine()->saveFrame(filename);
 	}
 
 	void setCanvasSize(float w, float h)
 	{
-		engine->setCanvasSize(w, h);
+		if (CommandEncoder * encoder = capture())
+			encoder->setCanvasSize(w, h);
+		engine()->setCanvasSize(w, h);
 	}
 
 	void setCanvasScaleMode(scale_mode_t sm)
 	{
-		engine->setCanvasMode((int)sm);
+		if (CommandEncoder * encoder = capture())
+			encoder->setCanvasMode(sm);
+		engine()->setCanvasMode((int)sm);
 	}
 
 	void setFullScreen(bool fs)
 	{
-		engine->setFullscreen(fs);
+		engine()->setFullscreen(fs);
+	}
+
+	void initSubsystems(unsigned int subsystems, bool background)
+	{
+		engine()->initSubsystems(subsystems, background);
 	}
 
 	float windowToCanvasX(float x, bool clamped)
 	{
-		return engine->WindowToCanvasX(x, clamped);
+		return engine()->WindowToCanvasX(x, clamped);
 	}
 
 	float windowToCanvasY(float y, bool clamped)
 	{
-		return engine->WindowToCanvasY(y, clamped);
+		return engine()->WindowToCanvasY(y, clamped);
 	}
 
 	void setDrawFunction(std::function<void()> fdraw)
 	{
-		engine->setDrawCallback(fdraw);
+		engine()->setDrawCallback(fdraw);
 	}
 
 	void setUpdateFunction(std::function<void(float)> fupdate)
 	{
-		engine->setIdleCallback(fupdate);
+		engine()->setIdleCallback(fupdate);
 	}
 
 	void setResizeFunction(std::function<void(int, int)> fresize)
 	{
-		engine->setResizeCallback(fresize);
+		engine()->setResizeCallback(fresize);
 	}
 
 	void setUserData(const void* user_data) {
-		engine->setUserData(user_data);
+		engine()->setUserData(user_data);
 	}
 
 	void* getUserData() {
-		return engine->getUserData();
+		return engine()->getUserData();
 	}
 
 	void getMouseState(MouseState & ms)
 	{
-		ms.dragging = engine->isMouseDragging();
+		ms.dragging = engine()->isMouseDragging();
 		bool ba[3]; 
-		engine->getMouseButtonState(ba);
+		engine()->getMouseButtonState(ba);
 		ms.button_left_down = ba[0];
 		ms.button_middle_down = ba[1];
 		ms.button_right_down = ba[2];
-		engine->getMouseButtonPressed(ba);
+		engine()->getMouseButtonPressed(ba);
 		ms.button_left_pressed = ba[0];
 		ms.button_middle_pressed = ba[1];
 		ms.button_right_pressed = ba[2];
-		engine->getMouseButtonReleased(ba);
+		engine()->getMouseButtonReleased(ba);
 		ms.button_left_released = ba[0];
 		ms.button_middle_released = ba[1];
 		ms.button_right_released = ba[2];
 		int x, y;
-		engine->getMousePosition(&x, &y);
+		engine()->getMousePosition(&x, &y);
 		ms.cur_pos_x = x;
 		ms.cur_pos_y = y;
-		engine->getPrevMousePosition(&x, &y);
+		engine()->getPrevMousePosition(&x, &y);
 		ms.prev_pos_x = x;
 		ms.prev_pos_y = y;
 	}
 
 	bool getKeyState(scancode_t key)
 	{
-		return engine->getKeyState(key);
+		return engine()->getKeyState(key);
+	}
+
+	bool isKeyDown(scancode_t key)
+	{
+		return engine()->isKeyDown(key);
+	}
+
+	bool wasKeyPressed(scancode_t key)
+	{
+		return engine()->wasKeyPressed(key);
+	}
+
+	bool wasKeyReleased(scancode_t key)
+	{
+		return engine()->wasKeyReleased(key);
+	}
+
+	void getInputEvents(std::vector<InputEvent> & events)
+	{
+		const std::vector<InputEvent> & queued = engine()->getInputEvents();
+		events.assign(queued.begin(), queued.end());
+	}
+
+	void setInputEventCoalescing(bool coalesce)
+	{
+		engine()->setInputEventCoalescing(coalesce);
+	}
+
+	bool startInputRecording(const std::string & filename)
+	{
+		return engine()->startInputRecording(filename);
+	}
+
+	void stopInputRecording()
+	{
+		engine()->stopInputRecording();
+	}
+
+	bool startInputReplay(const std::string & filename, bool uncapped)
+	{
+		return engine()->startInputReplay(filename, uncapped);
+	}
+
+	void stopInputReplay()
+	{
+		engine()->stopInputReplay();
+	}
+
+	bool isReplayingInput()
+	{
+		return engine()->isReplayingInput();
+	}
+
+	void setLatencyTracking(bool enable)
+	{
+		engine()->setLatencyTracking(enable);
+	}
+
+	void getLatencyStats(LatencyStats & stats)
+	{
+		engine()->getLatencyStats(stats);
+	}
+
+	void getFrameMemoryStats(FrameMemoryStats & stats)
+	{
+		engine()->getFrameMemoryStats(stats);
+	}
+
+	void setAllocationCheck(alloc_check_t check, unsigned int warmup_frames)
+	{
+		engine()->setAllocationCheck(check, warmup_frames);
+	}
+
+	void getAllocationStats(AllocationStats & stats)
+	{
+		engine()->getAllocationStats(stats);
+	}
+
+	bool isAllocationTrackingAvailable()
+	{
+		return AllocationTracker::isAvailable();
+	}
+
+	void setProfiling(bool enable)
+	{
+		engine()->setProfiling(enable);
+	}
+
+	bool getFrameStats(FrameStats & stats)
+	{
+		return engine()->getFrameStats(stats);
+	}
+
+	void getFrameStatsHistory(std::vector<FrameStats> & history)
+	{
+		engine()->getFrameStatsHistory(history);
+	}
+
+	void setPerformanceOverlay(bool show)
+	{
+		engine()->setPerformanceOverlay(show);
+	}
+
+	bool setOverdrawVisualization(bool enable)
+	{
+		return engine()->setOverdrawVisualization(enable);
+	}
+
+	bool getOverdrawStats(OverdrawStats & stats)
+	{
+		return engine()->getOverdrawStats(stats);
+	}
+
+	void getMemoryUsage(MemoryUsage & usage, memory_category_t category)
+	{
+		MemoryRegistry::get().getUsage(usage, category);
+	}
+
+	void getTopMemoryConsumers(std::vector<MemoryConsumer> & consumers, unsigned int count, memory_category_t category)
+	{
+		MemoryRegistry::get().getTopConsumers(consumers, count, category);
+	}
+
+	bool getAssetMemory(const std::string & name, MemoryConsumer & consumer)
+	{
+		return MemoryRegistry::get().getAsset(name, consumer);
+	}
+
+	const char * getMemoryCategoryName(memory_category_t category)
+	{
+		static const char * names[MEMORY_NUM_CATEGORIES] = { "textures", "fonts", "geometry", "frame buffers", "audio", "frame data" };
+		if (category < 0 || category >= MEMORY_NUM_CATEGORIES)
+			return "total";
+		return names[category];
+	}
+
+	const char * getProfileScopeName(profile_scope_t scope)
+	{
+		static const char * names[PROFILE_NUM_SCOPES] = { "frame", "events", "update", "update callback", "draw", "draw callback", "text", "present" };
+		if (scope < 0 || scope >= PROFILE_NUM_SCOPES)
+			return "";
+		return names[scope];
+	}
+
+	void setTracing(bool enable)
+	{
+		Tracer::setEnabled(enable);
+	}
+
+	bool saveTrace(const std::string & filename)
+	{
+		return Tracer::save(filename);
+	}
+
+	bool isTracingAvailable()
+	{
+		return Tracer::isAvailable();
+	}
+
+	bool setGLTracing(bool enable, const std::string & summary_file)
+	{
+		return GLTrace::setEnabled(enable, summary_file);
+	}
+
+	bool getGLTraceStats(GLTraceStats & stats)
+	{
+		return GLTrace::getStats(stats);
+	}
+
+	bool isGLTracingAvailable()
+	{
+		return GLTrace::isAvailable();
+	}
+
+	bool connectRenderer(const std::string & socket_path)
+	{
+		return Context::getCurrent()->connectRenderer(socket_path);
+	}
+
+	bool startRenderServer(const std::string & socket_path, const std::string & asset_root)
+	{
+		return engine()->startRemoteServer(socket_path, asset_root);
+	}
+
+	void stopRenderServer()
+	{
+		engine()->stopRemoteServer();
+	}
+
+	bool isRemoteClientConnected()
+	{
+		return engine()->isRemoteClientConnected();
+	}
+
+	bool startFrameExport(const std::string & name, unsigned int slots)
+	{
+		return engine()->startFrameExport(name, slots);
+	}
+
+	void stopFrameExport()
+	{
+		engine()->stopFrameExport();
+	}
+
+	void getFrameExportStats(FrameExportStats & stats)
+	{
+		engine()->getFrameExportStats(stats);
+	}
+
+	bool captureFrame(const std::string & filename)
+	{
+		return engine()->captureFrame(filename);
+	}
+
+	bool startFrameRecording(const std::string & filename, recording_format_t format, unsigned int fps)
+	{
+		return engine()->startFrameRecording(filename, format, fps);
+	}
+
+	void stopFrameRecording()
+	{
+		engine()->stopFrameRecording();
+	}
+
+	void getFrameRecordingStats(FrameRecordingStats & stats)
+	{
+		engine()->getFrameRecordingStats(stats);
+	}
+
+	bool startCapture(const std::string & filename)
+	{
+		return engine()->startCapture(filename);
+	}
+
+	void stopCapture()
+	{
+		engine()->stopCapture();
+	}
+
+	bool isCapturing()
+	{
+		return engine()->isCapturing();
+	}
+
+	bool startCaptureReplay(const std::string & filename, unsigned int loops)
+	{
+		return engine()->startCaptureReplay(filename, loops);
+	}
+
+	void stopCaptureReplay()
+	{
+		engine()->stopCaptureReplay();
+	}
+
+	bool isReplayingCapture()
+	{
+		return engine()->isReplayingCapture();
+	}
+
+	bool getCaptureInfo(const std::string & filename, CaptureInfo & info)
+	{
+		return CaptureReplay::readInfo(filename, info);
+	}
+
+	void getStartupTimings(std::vector<StartupTiming> & timings)
+	{
+		engine()->getStartupTimings(timings);
 	}
 
 }
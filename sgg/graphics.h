@@ -122,10 +122,347 @@ namespace graphics
 		int prev_pos_y;				///< The y position in pixel units of the pointing device in the previous update cycle.
 	};
 
+	/** The kinds of input events reported by getInputEvents().
+	*/
+	typedef enum {
+		INPUT_MOUSE_MOTION = 0,
+		INPUT_MOUSE_BUTTON_DOWN,
+		INPUT_MOUSE_BUTTON_UP,
+		INPUT_MOUSE_WHEEL,
+		INPUT_KEY_DOWN,
+		INPUT_KEY_UP
+	}
+	input_event_t;
+
+	/** The mouse buttons reported by mouse button input events.
+	*/
+	typedef enum {
+		MOUSE_BUTTON_LEFT = 0,
+		MOUSE_BUTTON_MIDDLE,
+		MOUSE_BUTTON_RIGHT,
+		MOUSE_BUTTON_OTHER
+	}
+	mouse_button_t;
+
+	/** A single, timestamped input event, as received by the engine between two successive state updates.
+
+		Unlike MouseState, which only reflects the latest state of the pointing device, input events preserve every
+		button click, key stroke, wheel step and cursor motion that occurred between two frames, in the order they
+		were received, so that applications can respond to input with sub-frame precision.
+		See getInputEvents() for more details.
+	*/
+	struct InputEvent
+	{
+		input_event_t type = INPUT_MOUSE_MOTION;  ///< The kind of the event.
+		unsigned int timestamp = 0;               ///< The time the event was received, in miliseconds since the initialization of the library.
+		int x = 0;                                ///< The x position of the cursor in pixel units (mouse events) or the horizontal wheel scroll amount (wheel events).
+		int y = 0;                                ///< The y position of the cursor in pixel units (mouse events) or the vertical wheel scroll amount (wheel events).
+		int dx = 0;                               ///< The relative horizontal motion of the cursor in pixel units (motion events only).
+		int dy = 0;                               ///< The relative vertical motion of the cursor in pixel units (motion events only).
+		mouse_button_t button = MOUSE_BUTTON_OTHER; ///< The button that changed state (mouse button events only).
+		scancode_t key = SCANCODE_UNKNOWN;        ///< The scancode of the key that changed state (key events only).
+		bool repeat = false;                      ///< True if a key down event was generated by the key auto-repeat (key events only).
+	};
+
+	/** Summarizes the input-to-present latency of the most recent frames, as measured when latency tracking is enabled.
+
+		All times are in miliseconds and are measured from the arrival of the oldest input event consumed by a frame. 
+		The present latency ends when the frame has been handed to the windowing system for display, while the GPU latency 
+		ends when the GPU is known to have completed the frame. GPU times are only available on systems supporting OpenGL 
+		sync objects and are reported with a resolution of one frame. Only frames that processed input are measured.
+		See getLatencyStats() for more details.
+	*/
+	struct LatencyStats
+	{
+		unsigned int samples = 0;      ///< The number of measured frames the statistics are computed from.
+		float last = 0.0f;             ///< The input-to-present latency of the most recently measured frame.
+		float mean = 0.0f;             ///< The average input-to-present latency.
+		float p50 = 0.0f;              ///< The median input-to-present latency.
+		float p90 = 0.0f;              ///< The 90th percentile of the input-to-present latency.
+		float p99 = 0.0f;              ///< The 99th percentile of the input-to-present latency.
+		float max = 0.0f;              ///< The maximum input-to-present latency.
+		unsigned int gpu_samples = 0;  ///< The number of measured frames with a known GPU completion time.
+		float last_gpu = -1.0f;        ///< The input-to-GPU-completion latency of the most recently measured frame, or a negative value if not (yet) known.
+		float gpu_p50 = 0.0f;          ///< The median input-to-GPU-completion latency.
+		float gpu_p99 = 0.0f;          ///< The 99th percentile of the input-to-GPU-completion latency.
+	};
+
+	/** Reports the use of the frame arena, the memory pool that holds the transient data of each frame (such as 
+		the text submitted for drawing), as returned by getFrameMemoryStats(). All sizes are in bytes.
+	*/
+	struct FrameMemoryStats
+	{
+		size_t used = 0;          ///< The memory allocated so far in the current frame.
+		size_t peak = 0;          ///< The largest amount of memory allocated in a single frame since the window was created.
+		size_t capacity = 0;      ///< The total memory reserved by the arena.
+		unsigned int blocks = 0;  ///< The number of memory blocks the arena currently consists of. Normally 1 in steady state.
+	};
+
+	/** The action to take when a frame performs heap allocations after the warm-up period, as set with setAllocationCheck().
+	*/
+	typedef enum {
+		ALLOC_CHECK_OFF = 0,  ///< Only count allocations, to be reported by getAllocationStats().
+		ALLOC_CHECK_LOG,      ///< Print the number of allocations of the offending frame and the addresses they were made from.
+		ALLOC_CHECK_ASSERT    ///< Same as ALLOC_CHECK_LOG, and then abort the program.
+	} alloc_check_t;
+
+	/** Reports the heap allocations made by the engine thread during the frames, as returned by getAllocationStats().
+		Frames of the warm-up period are not included in the totals and maxima.
+	*/
+	struct AllocationStats
+	{
+		unsigned int frame_allocations = 0;      ///< The number of allocations of the most recent frame.
+		size_t frame_bytes = 0;                  ///< The number of bytes allocated by the most recent frame.
+		unsigned int max_frame_allocations = 0;  ///< The largest number of allocations made by a frame after the warm-up period.
+		size_t max_frame_bytes = 0;              ///< The largest number of bytes allocated by a frame after the warm-up period.
+		unsigned int frames = 0;                 ///< The number of frames checked after the warm-up period.
+		unsigned int allocating_frames = 0;     ///< How many of the checked frames made at least one allocation.
+		void * call_sites[8] = {};               ///< The return addresses of the first allocations of the most recent frame (only captured when checking is enabled).
+		unsigned int num_call_sites = 0;         ///< The number of valid entries in call_sites.
+	};
+
+	/** The phases of a frame that are timed by the frame profiler (see setProfiling()). Phases are nested as listed:
+		the whole frame contains all other phases and the draw phase contains the draw callback, text and presentation.
+	*/
+	typedef enum {
+		PROFILE_FRAME = 0,      ///< The whole iteration of the message loop, including the idle wait at its end.
+		PROFILE_EVENTS,         ///< Window and input event processing, including input replay.
+		PROFILE_UPDATE,         ///< The update of the input state of the engine.
+		PROFILE_IDLE_CALLBACK,  ///< The user-defined update function (see setUpdateFunction()).
+		PROFILE_DRAW,           ///< Rendering the frame.
+		PROFILE_DRAW_CALLBACK,  ///< The user-defined draw function (see setDrawFunction()).
+		PROFILE_TEXT,           ///< Drawing the text of the frame. With the software renderer, this also includes rasterizing the frame.
+		PROFILE_PRESENT,        ///< Presenting the frame (buffer swap).
+		PROFILE_NUM_SCOPES
+	} profile_scope_t;
+
+	/** The timings and workload of a single frame, as recorded by the frame profiler (see setProfiling()).
+	*/
+	struct FrameStats
+	{
+		unsigned long long frame = 0;              ///< The sequence number of the frame, counted from when profiling was enabled.
+		float cpu_time[PROFILE_NUM_SCOPES] = {};  ///< The time spent in each phase of the frame (see profile_scope_t) in miliseconds, including any nested phases.
+		float gpu_time = -1.0f;                    ///< The time the GPU spent executing the rendering commands of the frame in miliseconds, or a negative value if not (yet) known.
+		unsigned int draw_calls = 0;               ///< The number of draw calls issued to the graphics driver (with the software renderer: the number of shaded primitives).
+		unsigned int vertices = 0;                 ///< The number of vertices submitted by the draw calls.
+		unsigned int texture_binds = 0;            ///< The number of texture binding changes.
+		unsigned int uniform_uploads = 0;          ///< The number of shader uniform values set.
+		unsigned int glyphs = 0;                   ///< The number of text characters drawn.
+		unsigned int glyph_cache_misses = 0;       ///< The number of characters that had to be rasterized, as they were not found in a glyph cache.
+	};
+
+	/** The overdraw of a frame: how many times its pixels were drawn to (see setOverdrawVisualization()).
+	*/
+	struct OverdrawStats
+	{
+		float average = 0.0f;   ///< The number of fragments drawn, divided by the number of pixels of the canvas.
+		unsigned int max = 0;   ///< The highest number of fragments drawn to a single pixel (at most 255).
+		float coverage = 0.0f;  ///< The fraction of the pixels of the canvas that were drawn to at least once.
+	};
+
+	/** The number of calls made to a GL function during a frame (see getGLTraceStats()).
+	*/
+	struct GLCallCount
+	{
+		const char * function = nullptr;  ///< The name of the GL function, e.g. "glBindTexture".
+		unsigned int calls = 0;           ///< The number of calls to the function.
+		unsigned int redundant = 0;       ///< The number of calls that set the state it already had.
+	};
+
+	/** The GL calls made by the library during a frame (see setGLTracing()).
+	*/
+	struct GLTraceStats
+	{
+		unsigned long long frame = 0;        ///< The sequence number of the frame, counted from when tracing was enabled.
+		unsigned int calls = 0;              ///< The number of GL calls of the frame.
+		unsigned int redundant = 0;          ///< The number of calls that bound an object already bound or set a uniform to its current value.
+		unsigned int errors = 0;             ///< The number of GL errors reported during the frame.
+		std::vector<GLCallCount> functions;  ///< The functions called during the frame, most called first.
+	};
+
+	/** The kinds of resources whose memory is accounted for (see getMemoryUsage()).
+	*/
+	typedef enum {
+		MEMORY_TEXTURES = 0,   ///< Bitmaps loaded for brushes, including the copies kept in system memory.
+		MEMORY_FONTS,          ///< Loaded fonts: glyph textures and glyph caches.
+		MEMORY_GEOMETRY,       ///< Vertex buffers.
+		MEMORY_FRAME_BUFFERS,  ///< Offscreen frame buffers, software frame buffers and buffers for reading frames back.
+		MEMORY_AUDIO,          ///< Loaded sound effects and music.
+		MEMORY_FRAME_DATA,     ///< Transient data of the frames being drawn (e.g. text strings).
+		MEMORY_NUM_CATEGORIES
+	} memory_category_t;
+
+	/** The memory held by a category of resources, or by all of them (see getMemoryUsage()).
+	*/
+	struct MemoryUsage
+	{
+		size_t cpu_bytes = 0;        ///< The bytes currently held in system memory.
+		size_t gpu_bytes = 0;        ///< The bytes currently held on the graphics device. This is an estimate, as drivers may pad and duplicate resources.
+		size_t peak_cpu_bytes = 0;   ///< The highest value cpu_bytes has reached since the application started.
+		size_t peak_gpu_bytes = 0;   ///< The highest value gpu_bytes has reached since the application started.
+		unsigned int resources = 0;  ///< The number of resources currently held.
+	};
+
+	/** The memory held by a single asset, e.g. a bitmap, font or sound file (see getTopMemoryConsumers()).
+	*/
+	struct MemoryConsumer
+	{
+		std::string name;                              ///< The name of the asset, usually the file it was loaded from.
+		memory_category_t category = MEMORY_TEXTURES;  ///< The kind of the asset.
+		size_t cpu_bytes = 0;                          ///< The bytes held in system memory, summed over all engine instances that loaded the asset.
+		size_t gpu_bytes = 0;                          ///< The (estimated) bytes held on the graphics device, summed over all engine instances.
+	};
+
+	/** Reports the progress of the frame export started with startFrameExport().
+	*/
+	struct FrameExportStats
+	{
+		unsigned long long exported = 0;  ///< The number of frames published to the shared-memory segment.
+		unsigned long long dropped = 0;   ///< The number of presented frames that were skipped, because all readback buffers were still busy or the frame was larger than a slot.
+	};
+
+	/** The file formats of the frame recordings started with startFrameRecording().
+	*/
+	typedef enum {
+		RECORDING_PNG = 0,  ///< One PNG image per frame, numbered from 1: <filename>_000001.png, <filename>_000002.png etc.
+		RECORDING_RAW,      ///< A single file of raw frames back to back, each made of opaque RGBA pixels, 8 bits per channel, with rows stored from top to bottom.
+		RECORDING_Y4M       ///< A single YUV4MPEG2 video stream (4:2:0 chroma subsampling), readable by most video tools, e.g. ffmpeg.
+	}
+	recording_format_t;
+
+	/** Reports the progress of the frame recording started with startFrameRecording().
+	*/
+	struct FrameRecordingStats
+	{
+		unsigned long long recorded = 0;  ///< The number of frames written to the recording.
+		unsigned long long dropped = 0;   ///< The number of presented frames that were skipped, because the readback or the encoding of earlier frames was still in progress, or the window size had changed.
+		unsigned int pending = 0;         ///< The number of frames waiting to be encoded and written.
+	};
+
+	/** Describes a draw-command capture file written with startCapture() (see getCaptureInfo()).
+	*/
+	struct CaptureInfo
+	{
+		int window_width = 0;                            ///< The width of the window in pixels when the capture was started.
+		int window_height = 0;                           ///< The height of the window in pixels when the capture was started.
+		float canvas_width = 0.0f;                       ///< The requested canvas width when the capture was started (see setCanvasSize()).
+		float canvas_height = 0.0f;                      ///< The requested canvas height when the capture was started.
+		scale_mode_t canvas_mode = CANVAS_SCALE_WINDOW;  ///< The canvas scaling mode when the capture was started.
+		float background[3] = { 0.0f, 0.0f, 0.0f };    ///< The window background color when the capture was started.
+		unsigned int frames = 0;                         ///< The number of captured frames.
+		float duration = 0.0f;                           ///< The sum of the delta times of the captured frames, in miliseconds.
+	};
+
+	/** The renderers that can draw the contents of a window, selected when the window is created.
+
+		RENDERER_AUTO can be overridden without changing the application, by setting the SGG_RENDERER environment
+		variable to "opengl", "vulkan" or "software".
+	*/
+	typedef enum {
+		RENDERER_AUTO = 0,   ///< OpenGL, falling back to the software renderer if no usable OpenGL driver is found.
+		RENDERER_OPENGL,     ///< Hardware-accelerated rendering through OpenGL.
+		RENDERER_SOFTWARE,   ///< Multi-threaded rendering on the CPU, for systems with a broken or missing OpenGL driver.
+		RENDERER_VULKAN      ///< Hardware-accelerated rendering through Vulkan, falling back as RENDERER_AUTO does if no Vulkan driver is found or the library was built without Vulkan.
+	}
+	renderer_t;
+
+	/** The engine subsystems that are initialized on first use and can be warmed up in advance with initSubsystems().
+	*/
+	typedef enum {
+		SUBSYSTEM_AUDIO = 1,
+		SUBSYSTEM_FONTS = 2,
+		SUBSYSTEM_ALL = SUBSYSTEM_AUDIO | SUBSYSTEM_FONTS
+	}
+	subsystem_t;
+
+	/** The time spent in a single phase of the initialization of the engine, as reported by getStartupTimings().
+	*/
+	struct StartupTiming
+	{
+		std::string phase;        ///< A short description of the initialization phase.
+		float duration = 0.0f;    ///< The duration of the phase in miliseconds.
+		bool background = false;  ///< True if the phase was run on a background thread, i.e. it did not delay the caller.
+	};
+
+
+	class GLBackend;
 
 	/** \defgroup _WINDOW Window initialization and handling
 	* @{
 	*/
+
+	/** An independent instance of the engine, with its own window, graphics context, resources and state.
+
+		All SGG functions operate on the *current* context of the calling thread. Applications that only need a single
+		window never have to deal with contexts directly: a default context is used by all threads that have not
+		bound a context of their own. To run several engine instances at once, e.g. to render many charts in parallel,
+		create one Context per thread and bind it to its thread with makeCurrent(), before any other SGG call on 
+		that thread:
+
+		\code{.cpp}
+		void renderChart(ChartData * data)
+		{
+			graphics::Context context;
+			context.makeCurrent();
+			graphics::createWindow(800, 600, "chart");
+			graphics::setUserData(data);
+			graphics::setDrawFunction(drawChart);
+			... 
+			graphics::destroyWindow();
+		}
+
+		std::thread worker1(renderChart, &data1), worker2(renderChart, &data2);
+		\endcode
+
+		SDL delivers the window and input events of the whole process to a single thread, the one that created the first
+		window. The contexts on that thread collect the events at the start of each frame and hand each one to the context 
+		whose window it belongs to, so contexts on other threads receive their events as long as a context on that thread 
+		keeps running frames. Events that belong to no window, such as a request to quit, reach every context. Closing 
+		the window of a context ends its message loop. Audio output is shared by all contexts.
+		Note that some platforms (e.g. macOS) only allow windows to be created on the main thread.
+	*/
+	class Context
+	{
+		GLBackend * m_engine = nullptr;
+
+		friend GLBackend * engine();
+
+	public:
+		Context();
+		Context(const Context &) = delete;
+		Context & operator = (const Context &) = delete;
+
+		/** Destroys the context, along with its window and all its resources, if they still exist.
+		*/
+		~Context();
+
+		/** Creates the window of the context. Equivalent to calling createWindow() with this context bound to the calling thread.
+		*/
+		void createWindow(int width, int height, std::string title, renderer_t renderer = RENDERER_AUTO);
+
+		/** Creates an invisible window for the context. Equivalent to calling createHeadlessWindow() with this context bound to the calling thread.
+		*/
+		bool createHeadlessWindow(int width, int height, renderer_t renderer = RENDERER_AUTO);
+
+		/** Destroys the window of the context. Equivalent to calling destroyWindow() with this context bound to the calling thread.
+		*/
+		void destroyWindow();
+
+		/** Connects the context to a renderer process instead of creating a window. Equivalent to calling connectRenderer() 
+			with this context bound to the calling thread.
+		*/
+		bool connectRenderer(const std::string & socket_path);
+
+		/** Binds the context (and its graphics context, if a window has already been created) to the calling thread.
+
+			All subsequent SGG calls made by the thread operate on this context. A context must only be used by one thread at a time.
+		*/
+		void makeCurrent();
+
+		/** Returns the context bound to the calling thread, or the default context if the thread has not bound one.
+		*/
+		static Context * getCurrent();
+	};
 	
 	/** Creates and shows a framed window with a title of specific dimensions.
 
@@ -135,8 +472,45 @@ namespace graphics
 		\param width is the window canvas width in pixel units.
 		\param height is the window canvas height in pixel units.
 		\param title is the title displayed on the window frame.
+		\param renderer selects how the window contents are drawn. By default, OpenGL is used if the driver supports it
+		       and the software renderer otherwise, so that applications also run on systems with broken or absent GL drivers.
+
+		Calling it again replaces the window: the previous one is destroyed first, as with destroyWindow(), along with
+		its callbacks and resources.
+
+		\see getRenderer
+	*/
+	void createWindow(int width, int height, std::string title, renderer_t renderer = RENDERER_AUTO);
+
+	/** Initializes the library for rendering without a visible window, e.g. on servers without a display or in automated tests.
+
+		Use in place of createWindow(). The window is created hidden and all frames are rendered into an offscreen buffer
+		of the requested size, which can be read back with getFramePixels() or saved with saveFrame(). On Linux, when no 
+		display is available (neither DISPLAY nor WAYLAND_DISPLAY is set) and no video driver was chosen with the SDL_VIDEODRIVER 
+		environment variable, SDL's offscreen video driver is used, which creates the graphics context through EGL and also 
+		runs on a software renderer, such as Mesa's llvmpipe, without a GPU. 
+
+		Headless windows receive no input. Frames are produced either by startMessageLoop(), which runs at full speed 
+		until stopMessageLoop() is called, or by runFrames(). Any previous window of the context is destroyed first,
+		as with createWindow().
+
+		\param width is the width of the offscreen buffer in pixels.
+		\param height is the height of the offscreen buffer in pixels.
+		\param renderer selects how frames are drawn (see createWindow()). The software renderer needs neither a display
+		       nor a graphics driver.
+		\return true if the graphics context and the offscreen buffer were created, false otherwise.
+
+		\see runFrames
+		\see saveFrame
+	*/
+	bool createHeadlessWindow(int width, int height, renderer_t renderer = RENDERER_AUTO);
+
+	/** Returns the renderer that draws the window of the current context, which tells if RENDERER_AUTO fell back to
+		the software renderer.
+
+		\return the renderer chosen when the window was created, never RENDERER_AUTO.
 	*/
-	void createWindow(int width, int height, std::string title);
+	renderer_t getRenderer();
 	
 	/** Sets the color to fill the background of the main window, including the area outside the drawing canvas extents.
 
@@ -196,6 +570,31 @@ namespace graphics
 	 */
 	void stopMessageLoop();
 
+	/** Runs a fixed number of iterations of the message loop, i.e. updates and draws the given number of frames, and then 
+		returns control to the caller. Mostly useful for headless rendering, to produce a frame before reading it back.
+
+		\param count is the number of frames to run.
+		\return false if the loop was terminated (see stopMessageLoop()) before all frames were run, true otherwise.
+	*/
+	bool runFrames(unsigned int count = 1);
+
+	/** Reads back the most recently drawn frame of a headless window (see createHeadlessWindow()).
+
+		\param pixels is the user-provided vector to store the frame in: width x height opaque RGBA pixels, 8 bits per channel,
+		       with rows stored from top to bottom.
+		\param width is set to the width of the frame in pixels.
+		\param height is set to the height of the frame in pixels.
+		\return true if the frame was read back, false if the current window is not headless.
+	*/
+	bool getFramePixels(std::vector<unsigned char> & pixels, int & width, int & height);
+
+	/** Saves the most recently drawn frame of a headless window (see createHeadlessWindow()) as a PNG image.
+
+		\param filename is the path of the PNG file to write.
+		\return true if the image was written, false otherwise.
+	*/
+	bool saveFrame(const std::string & filename);
+
 	/** Defines the extents of the drawing canvas in the custom units used by the application.
 
 	    The function explicitly sets the desired width and height of the drawing canvas in the measurement units
@@ -248,6 +647,22 @@ namespace graphics
 		\param fs should be set to either true for full screen or false for windowed mode.
 	*/
 	void setFullScreen(bool fs);
+
+	/** Initializes engine subsystems ahead of their first use.
+
+		To keep application startup fast, the audio device and the font library are not initialized when the window is
+		created, but when they are first needed. Applications that know they will use them can call this function
+		after createWindow() to warm them up in advance, optionally on a background thread, so that the first 
+		sound played or text drawn does not cause a hitch. The font shaders always need the graphics context and 
+		are therefore compiled on the calling thread on first use.
+
+		\param subsystems is a combination of subsystem_t flags, indicating which subsystems to initialize.
+		\param background when true, the initialization runs on a background thread and the function returns immediately.
+		Default value is true.
+
+		\see getStartupTimings
+	*/
+	void initSubsystems(unsigned int subsystems, bool background = true);
 	
 	/** Converts the horizontal window coordinate of a point to the corresponding canvas coordinate.
 
@@ -507,6 +922,134 @@ namespace graphics
 		\see setUpdateFunction
 	*/
 	bool getKeyState(scancode_t key);
+
+	/** Checks whether a specific key is currently held down.
+
+		The state of the entire keyboard is captured once per engine state update, so querying many keys per frame
+		is cheap. The function is equivalent to getKeyState().
+
+		\param key is the scancode ID of the key to query. The available scancodes are listed in the [scancodes.h](@ref scancodes.h)  file.
+
+		\return true if the key is held down, false otherwise.
+
+		\see wasKeyPressed
+		\see wasKeyReleased
+	*/
+	bool isKeyDown(scancode_t key);
+
+	/** Checks whether a specific key went from a "released" state to a "pressed" one during the last poll cycle.
+
+		This mirrors the button_*_pressed fields of MouseState and is true for a single state update only, so
+		that a key press can be handled once, without the application tracking the previous state of the key itself.
+
+		\param key is the scancode ID of the key to query. The available scancodes are listed in the [scancodes.h](@ref scancodes.h)  file.
+
+		\return true if the key was pressed since the previous state update, false otherwise.
+
+		\see isKeyDown
+		\see wasKeyReleased
+	*/
+	bool wasKeyPressed(scancode_t key);
+
+	/** Checks whether a specific key went from a "pressed" state to a "released" one during the last poll cycle.
+
+		\param key is the scancode ID of the key to query. The available scancodes are listed in the [scancodes.h](@ref scancodes.h)  file.
+
+		\return true if the key was released since the previous state update, false otherwise.
+
+		\see isKeyDown
+		\see wasKeyPressed
+	*/
+	bool wasKeyReleased(scancode_t key);
+
+	/** Retrieves all input events received since the previous engine state update.
+
+		The function fills the user-provided vector with every mouse motion, mouse button, mouse wheel and keyboard
+		event that was received by the engine between the previous update and the current one, in the order of their arrival.
+		Each event carries the timestamp reported by the windowing system, so applications such as drawing programs or
+		rhythm games can process input at a finer granularity than the frame rate. The vector is cleared before being filled.
+		Typically, this function is used from within the update callback of the application:
+
+		\code{.cpp}
+		std::vector<graphics::InputEvent> events;
+		graphics::getInputEvents(events);
+		for (const graphics::InputEvent & ev : events)
+		{
+			if (ev.type == graphics::INPUT_MOUSE_BUTTON_DOWN && ev.button == graphics::MOUSE_BUTTON_LEFT)
+			{
+				// respond to each individual click here, using ev.x, ev.y and ev.timestamp.
+			}
+		}
+		\endcode
+
+		\param events is the user-provided vector to store the input events in.
+
+		\see InputEvent
+		\see setInputEventCoalescing
+	*/
+	void getInputEvents(std::vector<InputEvent> & events);
+
+	/** Enables or disables the merging of consecutive mouse motion events.
+
+		When enabled, successive mouse motion events that are not interleaved with other input events are reported by
+		getInputEvents() as a single motion event, with the latest cursor position and timestamp and the accumulated
+		relative motion. Coalescing is disabled by default.
+
+		\param coalesce set to true to merge consecutive mouse motion events, false to report each one of them.
+
+		\see getInputEvents
+	*/
+	void setInputEventCoalescing(bool coalesce);
+
+	/** Starts recording all input events and frame times to a file.
+
+		From the next engine state update on, the input events of each frame (see getInputEvents()), along with the
+		delta and global time reported to the application, are appended to a compact binary log. The log can later be fed
+		back to the engine with startInputReplay(), to reproduce the exact same session, e.g. for benchmarking or profiling.
+		Any previous recording is stopped.
+
+		\param filename is the path of the log file to create.
+
+		\return true if the log file was successfully created, false otherwise.
+
+		\see stopInputRecording
+		\see startInputReplay
+	*/
+	bool startInputRecording(const std::string & filename);
+
+	/** Stops the recording of input events started with startInputRecording() and closes the log file.
+	*/
+	void stopInputRecording();
+
+	/** Replays a session previously recorded with startInputRecording().
+
+		While replaying, live mouse and keyboard input is ignored and the recorded input events are fed to the
+		engine frame by frame instead. The values returned by getDeltaTime() and getGlobalTime() follow the recorded
+		virtual clock, so the application goes through the exact same sequence of updates as in the recorded session.
+		When all recorded frames have been replayed, the message loop is terminated, as with stopMessageLoop().
+		A corrupt or truncated log ends the replay the same way, at the first invalid frame, with an error message.
+
+		\param filename is the path of the input log to replay.
+
+		\param uncapped when true, the engine does not pause between frames, so that the session is replayed as fast
+		as possible. Default value is false.
+
+		\return true if the log file was successfully opened, false otherwise.
+
+		\see startInputRecording
+		\see stopInputReplay
+	*/
+	bool startInputReplay(const std::string & filename, bool uncapped = false);
+
+	/** Stops replaying an input log and returns to live input.
+	*/
+	void stopInputReplay();
+
+	/** Reports whether an input log is currently being replayed.
+
+		\return true if the engine is replaying an input log started with startInputReplay(), false otherwise.
+	*/
+	bool isReplayingInput();
 	/** @}*/
 
 	/** \defgroup _TIME Time reporting
@@ -795,5 +1338,540 @@ namespace graphics
 	*/
 	void stopMusic(int fade_time = 0);
 	/** @}*/
+
+	/** \defgroup _PROFILING Performance instrumentation
+	* @{
+	*/
+
+	/** Enables or disables the measurement of input-to-present latency.
+
+		When enabled, every frame that processes input events is tagged with the timestamp of the oldest one of them
+		and the time until the frame is presented, as well as the time until the GPU completes it, is recorded.
+		GPU completion is measured with the OpenGL renderer only; with the software renderer, a frame is complete
+		when it is presented, and with the Vulkan renderer, its GPU completion time is not reported.
+		The statistics of the most recent frames can be retrieved with getLatencyStats(). Enabling or disabling the 
+		tracking discards all previous measurements. Latency tracking is disabled by default.
+
+		\param enable set to true to start measuring latency, false to stop.
+
+		\see getLatencyStats
+	*/
+	void setLatencyTracking(bool enable);
+
+	/** Reports the input-to-present latency statistics of the most recently measured frames.
+
+		\param stats is the user-provided record to fill in with the latency statistics.
+
+		\see LatencyStats
+		\see setLatencyTracking
+	*/
+	void getLatencyStats(LatencyStats & stats);
+
+	/** Reports the time spent initializing each engine subsystem.
+
+		Window and graphics context creation happen when the window is created, while the audio device and the font
+		library are only initialized when they are first needed (i.e. on the first call to playSound(), playMusic() or
+		setFont()), or when they are warmed up with initSubsystems(). Each initialization phase is reported once, in the
+		order it was completed.
+
+		\param timings is the user-provided vector to store the timing of each phase in. The vector is cleared before being filled.
+
+		\see initSubsystems
+	*/
+	void getStartupTimings(std::vector<StartupTiming> & timings);
+
+	/** Reports the usage of the per-frame memory arena.
+
+		The engine keeps all transient per-frame data in a linear memory arena, which is rewound after each frame is 
+		presented, instead of allocating them from the heap. The arena grows to fit the largest frame and then stays
+		constant, so the reported peak can be used to verify that steady-state frames do not need more memory.
+
+		\param stats is the user-provided record to fill in with the arena statistics.
+
+		\see FrameMemoryStats
+	*/
+	void getFrameMemoryStats(FrameMemoryStats & stats);
+
+	/** Sets up the verification that steady-state frames do not allocate from the heap.
+
+		Allocations can only be counted when the library is built with allocation tracking (the SGG_TRACK_ALLOCATIONS
+		CMake option), which replaces the global operator new / delete and hooks the allocators of SDL and FreeType. 
+		Only the allocations of the thread running the message loop, made between the start of input processing and
+		the presentation of each frame, are counted. The first frames are not checked, as they legitimately 
+		allocate textures, fonts and other cached resources.
+
+		\param check is the action to take when a frame allocates after the warm-up period.
+		\param warmup_frames is the number of frames to skip before checking.
+
+		\see getAllocationStats
+		\see isAllocationTrackingAvailable
+	*/
+	void setAllocationCheck(alloc_check_t check, unsigned int warmup_frames = 60);
+
+	/** Reports the heap allocations made during the frames.
+
+		\param stats is the user-provided record to fill in with the allocation statistics.
+
+		\see AllocationStats
+		\see setAllocationCheck
+	*/
+	void getAllocationStats(AllocationStats & stats);
+
+	/** Tells whether the library was built with allocation tracking.
+
+		\return true if allocations are counted, false if getAllocationStats() always reports zero allocations.
+	*/
+	bool isAllocationTrackingAvailable();
+
+	/** Enables or disables the frame profiler.
+
+		When enabled, each iteration of the message loop is broken down into its phases (see profile_scope_t), which are
+		timed on the CPU, and the workload submitted to the graphics driver is counted. With the OpenGL renderer, the GPU
+		time of each frame is also measured with timer queries (where GL_ARB_timer_query is supported); their results are
+		collected without waiting for the GPU, so they become available a few frames later. The most recent frames are kept
+		in a history that can be retrieved with getFrameStatsHistory(). Enabling or disabling the profiler discards all
+		previous measurements. The profiler is disabled by default.
+
+		\param enable set to true to start profiling, false to stop.
+
+		\see getFrameStats
+		\see getFrameStatsHistory
+	*/
+	void setProfiling(bool enable);
+
+	/** Reports the statistics of the most recently completed frame.
+
+		The GPU time of the frame is usually not known yet (see setProfiling()); use getFrameStatsHistory()
+		to access the GPU times of the previous frames.
+
+		\param stats is the user-provided record to fill in with the frame statistics.
+		\return true if at least one frame has been profiled, false otherwise.
+
+		\see FrameStats
+	*/
+	bool getFrameStats(FrameStats & stats);
+
+	/** Retrieves the statistics of the most recently profiled frames (up to 256), oldest first.
+
+		\param history is the user-provided vector to store the frame statistics in. The vector is cleared before being filled.
+
+		\see FrameStats
+		\see setProfiling
+	*/
+	void getFrameStatsHistory(std::vector<FrameStats> & history);
+
+	/** Shows or hides the performance overlay, a panel drawn by the engine over the top-left corner of the canvas.
+
+		The overlay is drawn after the draw callback and shows graphs of the recent frame times on the CPU and GPU, along
+		with the average frame rate, draw calls, vertices, texture binds, uniform uploads, the hit rate of the glyph cache,
+		the memory held by textures and the number of sounds playing. It is drawn in a few batched draw calls, using a
+		built-in font, and its own draw calls are not included in the counts it reports. The overlay turns on the frame
+		profiler (see setProfiling()) while shown, if the application has not already done so.
+
+		The overlay can also be shown without changes to the application, by setting the SGG_PERFORMANCE_OVERLAY environment
+		variable to 1 before the window is created.
+
+		\param show set to true to show the overlay, false to hide it.
+	*/
+	void setPerformanceOverlay(bool show);
+
+	/** Enables or disables the overdraw visualization, a debug mode that shows how many times each pixel is drawn to.
+
+		While enabled, shapes and text are not shaded: every fragment they cover adds one to a count kept for its pixel,
+		with additive blending, regardless of its color or opacity. When the frame ends, the counts are shown in place of
+		the frame as a heat map, going from black (not drawn) through blue (1), cyan (2), green (3), yellow (4) and
+		red (6) to white (8 or more). Counts saturate at 255. The canvas background counts as one layer, so areas that
+		are only covered by the background are blue. Stacked translucent shapes, which are costly to fill, stand out as the
+		warm areas of the map. The average and maximum overdraw of the frames are reported by getOverdrawStats().
+
+		\param enable set to true to show the overdraw heat map, false to draw frames normally.
+		\return true if the mode was changed, false if the renderer does not support it.
+
+		\see getOverdrawStats
+	*/
+	bool setOverdrawVisualization(bool enable);
+
+	/** Reports the overdraw of a recent frame, while the overdraw visualization is enabled.
+
+		With the software renderer, the statistics refer to the last frame drawn. With the OpenGL renderer, the counts are
+		read back from the GPU asynchronously, so the statistics refer to a frame drawn two or three frames earlier.
+
+		\param stats is the user-provided record to fill in.
+		\return true if the statistics of a frame are available, false otherwise.
+
+		\see setOverdrawVisualization
+	*/
+	bool getOverdrawStats(OverdrawStats & stats);
+
+	/** Reports the memory held by the resources of the library, for a category of resources or in total.
+
+		Textures, fonts, vertex buffers, frame buffers, sounds and music register their size in system memory and their
+		estimated size on the graphics device as they are loaded and released, across all engine instances. The sizes of
+		music tracks are the sizes of their files, as music is decoded while playing. Along with the current sizes,
+		the highest sizes reached so far are reported, to track down growth in long-running applications.
+
+		\param usage is the user-provided record to fill in.
+		\param category is the category to report, or MEMORY_NUM_CATEGORIES for the total of all categories.
+
+		\see getTopMemoryConsumers
+	*/
+	void getMemoryUsage(MemoryUsage & usage, memory_category_t category = MEMORY_NUM_CATEGORIES);
+
+	/** Retrieves the assets that hold the most memory (system and graphics memory combined), largest first.
+
+		\param consumers is the user-provided vector to store the assets in. The vector is cleared before being filled.
+		\param count is the maximum number of assets to report.
+		\param category restricts the report to a category of resources; MEMORY_NUM_CATEGORIES reports all of them.
+	*/
+	void getTopMemoryConsumers(std::vector<MemoryConsumer> & consumers, unsigned int count, memory_category_t category = MEMORY_NUM_CATEGORIES);
+
+	/** Reports the memory held by a single asset.
+
+		\param name is the name of the asset, usually the path it was loaded with.
+		\param consumer is the user-provided record to fill in.
+		\return true if the asset is currently loaded, false otherwise.
+	*/
+	bool getAssetMemory(const std::string & name, MemoryConsumer & consumer);
+
+	/** Returns a short, human-readable name of a memory category, e.g. for logging memory reports.
+	*/
+	const char * getMemoryCategoryName(memory_category_t category);
+
+	/** Returns a short, human-readable name of a profiled frame phase, e.g. for labelling a profiler display.
+	*/
+	const char * getProfileScopeName(profile_scope_t scope);
+
+	/** Starts or stops recording a timeline of the scopes executed by all threads, for viewing in Chrome or Perfetto.
+
+		Scopes are marked in the code with the SGG_PROFILE_SCOPE() macro, which the library uses for its own work (the
+		message loop, rendering, font and texture loading, audio) and which is also available to the application.
+		Each thread records its scopes into its own buffer, without locking, so recording does not serialize the
+		threads being measured. Starting a trace discards the events of any previous trace. A thread stops recording
+		once its buffer is full (65536 scopes per trace), so long traces should be kept to a few thousand frames.
+
+		Tracing must be compiled in, by building the library with the SGG_TRACING option. Otherwise, the macros expand
+		to nothing, so marking scopes has no cost at all, and this function has no effect.
+
+		\param enable set to true to start recording, false to stop.
+
+		\see saveTrace
+		\see isTracingAvailable
+	*/
+	void setTracing(bool enable);
+
+	/** Writes the events recorded since tracing was last started to a file, in the Chrome trace event format (JSON).
+
+		The file can be opened with chrome://tracing or https://ui.perfetto.dev. A trace can be saved while it is still
+		being recorded, in which case it contains the scopes completed so far.
+
+		\param filename is the path of the JSON file to write.
+		
+eturn true if the trace was written, false if tracing is not available or the file could not be written.
+
+		\see setTracing
+	*/
+	bool saveTrace(const std::string & filename);
+
+	/** Checks whether the library was built with tracing support (the SGG_TRACING option).
+
+		
+eturn true if scopes are recorded while tracing, false if setTracing() has no effect.
+	*/
+	bool isTracingAvailable();
+
+	/** Names the calling thread in saved traces (e.g. "loader"). Use the SGG_PROFILE_THREAD() macro instead of calling
+		this function directly, so that the call is compiled out along with the rest of tracing.
+
+		\param name is the name of the thread. It must remain valid for the lifetime of the application (e.g. a string literal).
+	*/
+	void setTraceThreadName(const char * name);
+
+	/** Records an instantaneous event on the calling thread, shown as a marker on its timeline. Use the SGG_PROFILE_EVENT()
+		macro instead of calling this function directly.
+
+		\param name is the name of the event. It must remain valid for the lifetime of the application (e.g. a string literal).
+	*/
+	void traceEvent(const char * name);
+
+	/** Records the time from its construction to its destruction as a scope of the calling thread, while tracing is on.
+		Use the SGG_PROFILE_SCOPE() macro instead of declaring it directly.
+	*/
+	class TraceScope
+	{
+		const char * m_name;
+		unsigned long long m_start;
+	public:
+		TraceScope(const char * name);
+		~TraceScope();
+	};
+
+	/** Enables or disables the tracing of the GL calls made by the library, a debugging aid for reducing driver overhead.
+
+		While enabled, the calls to each GL function are counted per frame, and calls that do not change the GL state are
+		counted as redundant: binding the program, buffer, texture, vertex array or framebuffer that is already bound,
+		or setting a shader uniform to the value it already has. GL errors are reported to the console as they occur,
+		where the driver supports the KHR_debug extension, and counted. Optionally, a summary of each frame is written
+		to a text file: the number of calls, redundant calls and errors, followed by the calls to each function.
+
+		The GL calls are only counted if the library was built with the SGG_GL_TRACE option, which wraps every GL function
+		it calls; otherwise this function has no effect. The renderer does not make GL calls in software mode.
+
+		\param enable set to true to start counting, false to stop.
+		\param summary_file is the path of the text file to write the frame summaries to, or empty for no summaries.
+		\return true if tracing was enabled or disabled, false if the library was built without SGG_GL_TRACE.
+
+		\see getGLTraceStats
+		\see isGLTracingAvailable
+	*/
+	bool setGLTracing(bool enable, const std::string & summary_file = "");
+
+	/** Reports the GL calls of the most recently completed frame.
+
+		\param stats is the user-provided record to fill in.
+		\return true if at least one frame has been traced, false otherwise.
+
+		\see GLTraceStats
+		\see setGLTracing
+	*/
+	bool getGLTraceStats(GLTraceStats & stats);
+
+	/** Checks whether the library was built with GL call tracing (the SGG_GL_TRACE option).
+
+		\return true if GL calls are counted while tracing, false if setGLTracing() has no effect.
+	*/
+	bool isGLTracingAvailable();
+	/** @}*/
+
+	/** \defgroup _REMOTE Out-of-process rendering
+	* @{
+	*/
+
+	/** Connects the current context to a renderer process, to be used in place of createWindow().
+
+		This lets code that must not own a graphics context, such as untrusted or crash-prone plugins, draw through a
+		separate renderer process. After connecting, all drawing functions encode their calls into a compact binary command 
+		stream, which the message loop submits once per frame, along with the rest of the frame's commands, to a 
+		shared-memory ring buffer read by the renderer. The Unix domain socket is only used to set up the connection and
+		to detect when either side goes away: the message loop of the client ends when the renderer exits. 
+		Frames are dropped, rather than waited for, if the renderer falls behind.
+
+		The client has no window, so it receives no input events and the window functions have no effect. The canvas size
+		and scaling mode set by the client are sent along with every frame and replace those of the renderer's window.
+		Out-of-process rendering is only available on POSIX platforms.
+
+		\param socket_path is the path of the socket the renderer listens on (see startRenderServer()).
+		\return true if the renderer accepted the connection, false otherwise.
+
+		\see startRenderServer
+	*/
+	bool connectRenderer(const std::string & socket_path);
+
+	/** Starts accepting a remote client on a Unix domain socket, for the window of the current context.
+
+		While a client is connected, each frame of the window draws the most recently submitted frame of the client, after
+		the content of the local draw callback. The commands are replayed straight from shared memory and are validated
+		as they are decoded: a client that submits malformed commands, disconnects or crashes is dropped and the renderer
+		keeps running, ready to accept the next client. 
+
+		Clients may only use bitmaps and fonts given as relative paths inside the asset directory; a path that is absolute,
+		contains ".." or lies outside it is rejected. At most 256 distinct bitmap and font names are accepted from all 
+		clients together, which bounds the memory clients can make the renderer hold in its caches. A client that refers
+		to a rejected name is dropped.
+
+		\param socket_path is the filesystem path of the socket to create. An existing file at this path is replaced.
+		\param asset_root is the directory that the bitmaps and fonts of the clients must lie in. By default, the current
+		       directory.
+		\return true if the socket was created, false otherwise.
+
+		\see connectRenderer
+	*/
+	bool startRenderServer(const std::string & socket_path, const std::string & asset_root = "");
+
+	/** Stops accepting remote clients and disconnects the current one, if any.
+	*/
+	void stopRenderServer();
+
+	/** Tells whether a remote client is connected to the render server of the current context.
+	*/
+	bool isRemoteClientConnected();
+	/** @}*/
+
+	/** \defgroup _EXPORT Frame export
+	* @{
+	*/
+
+	/** Starts publishing every presented frame of the current window to a shared-memory segment.
+
+		This allows local processes, such as video encoders, compositors or test harnesses, to consume the output of
+		the window without screen capture. Each presented frame is copied asynchronously into a pixel buffer on the GPU
+		and published to the next slot of a ring of frame slots in the segment, along with its size, number and 
+		timestamp, once the copy has completed (usually one or two frames later). Consumers map the segment (see
+		the FrameExportReader class in sgg/frameexport.h) and read the frames in place. The render loop never waits for
+		the consumers: a slow consumer simply misses frames, and a frame is skipped if all GPU copies are still in flight.
+
+		Frame export is only available on POSIX platforms.
+
+		\param name is the name of the POSIX shared-memory object to create (e.g. "/sgg-frames").
+		\param slots is the number of frame slots in the segment, which is also the number of GPU copies that can be in flight.
+		\return true if the segment was created, false otherwise.
+
+		\see stopFrameExport
+		\see getFrameExportStats
+	*/
+	bool startFrameExport(const std::string & name, unsigned int slots = 3);
+
+	/** Stops publishing frames, after publishing the frames still being copied, and removes the shared-memory segment.
+	*/
+	void stopFrameExport();
+
+	/** Reports the number of published and skipped frames since startFrameExport() was called.
+
+		\param stats is the user-provided record to fill in.
+	*/
+	void getFrameExportStats(FrameExportStats & stats);
+	/** @}*/
+
+	/** \defgroup _RECORDING Screenshots and frame recording
+	* @{
+	*/
+
+	/** Saves the next presented frame of the current window to a PNG image.
+
+		The frame is read back without stalling the render loop (see startFrameRecording()) and saved on a background thread,
+		so the file is only complete a few frames later. Pending screenshots are completed when the window is destroyed.
+
+		\param filename is the path of the PNG image to create. An existing file is replaced.
+		\return true if the screenshot was queued, false if the current context has no window to read back from.
+
+		\see startFrameRecording
+	*/
+	bool captureFrame(const std::string & filename);
+
+	/** Starts recording every presented frame of the current window to files, without slowing down the application.
+
+		With the OpenGL renderer, each frame is copied into one of a ring of pixel buffers on the GPU and is only mapped once 
+		its copy has completed, as signalled by a fence, which usually takes two or three frames: the render loop never waits for
+		the GPU. The frames are then handed to a pool of worker threads, which convert, encode and write them, in order. 
+		With the software renderer, the frame is handed over directly. When all pixel buffers are still in flight, or the 
+		workers have fallen behind, frames are dropped rather than waited for; getFrameRecordingStats() reports how many.
+		Streamed formats only hold frames of the window size at the start of the recording, so frames drawn after the 
+		window has been resized are dropped. Any previous recording is stopped.
+
+		\param filename is the path of the file to write, or the prefix of the numbered image files for RECORDING_PNG.
+		\param format is the file format of the recording (see recording_format_t). Default value is RECORDING_Y4M.
+		\param fps is the frame rate stored in a RECORDING_Y4M stream, as the frames themselves carry no timing.
+		       Default value is 60.
+		\return true if the recording was started, false otherwise.
+
+		\see stopFrameRecording
+		\see getFrameRecordingStats
+		\see captureFrame
+	*/
+	bool startFrameRecording(const std::string & filename, recording_format_t format = RECORDING_Y4M, unsigned int fps = 60);
+
+	/** Stops the recording started with startFrameRecording(), after writing the frames still being read back or encoded.
+	*/
+	void stopFrameRecording();
+
+	/** Reports the number of recorded and skipped frames since startFrameRecording() was called.
+
+		\param stats is the user-provided record to fill in.
+	*/
+	void getFrameRecordingStats(FrameRecordingStats & stats);
+	/** @}*/
+
+	/** \defgroup _CAPTURE Draw-command capture and replay
+	* @{
+	*/
+
+	/** Starts capturing the drawing calls of the current window to a file, to reproduce its frames without the application.
+
+		From now on, the calls to drawRect(), drawLine(), drawDisk(), drawSector(), drawText(), setFont(), setOrientation(), 
+		setScale(), resetPose(), setWindowBackground(), setCanvasSize() and setCanvasScaleMode() are serialized, along with
+		their arguments, into a compact binary file. Each frame is stored as a separate record, holding the calls made since the 
+		previous frame was drawn and the frame's delta time. The file can later be replayed with startCaptureReplay(), e.g. 
+		by the sgg_replay tool, to benchmark the renderer on the frames of a real session.
+
+		Brushes and text are stored by value, but bitmaps and fonts are only referenced by their file names, so they must
+		be available, at the same relative paths, when the capture is replayed. Audio and input are not captured.
+		The current font, and the current pose when called from the draw callback, are recorded at the start of the
+		first frame, so that the capture does not depend on calls made before it started. Any previous capture is stopped.
+
+		\param filename is the path of the capture file to create.
+		\return true if the file was successfully created, false otherwise.
+
+		\see stopCapture
+		\see startCaptureReplay
+	*/
+	bool startCapture(const std::string & filename);
+
+	/** Stops the capture started with startCapture() and closes the capture file.
+	*/
+	void stopCapture();
+
+	/** Reports whether the drawing calls of the current window are being captured.
+	*/
+	bool isCapturing();
+
+	/** Replays a capture file written with startCapture() in place of the draw callback.
+
+		The setup of the captured window (canvas size, scaling mode and background color) is applied immediately and
+		the captured frames are then drawn one per engine frame, instead of calling the draw callback. While replaying, 
+		the message loop does not pause between frames, so that the frames are drawn as fast as the renderer allows. 
+		When all frames have been replayed, the message loop is terminated, as with stopMessageLoop(). The whole file is 
+		loaded in advance and is validated as it is replayed: the replay stops at the first invalid command.
+
+		For meaningful results, the window should have the size reported by getCaptureInfo().
+
+		\param filename is the path of the capture file to replay.
+		\param loops is the number of times the captured frames are replayed. Default value is 1.
+		\return true if the capture file was successfully loaded, false otherwise.
+
+		\see startCapture
+		\see getCaptureInfo
+	*/
+	bool startCaptureReplay(const std::string & filename, unsigned int loops = 1);
+
+	/** Stops replaying a capture file and returns to the draw callback.
+	*/
+	void stopCaptureReplay();
+
+	/** Reports whether a capture file is being replayed by the current window.
+	*/
+	bool isReplayingCapture();
+
+	/** Reads the description of a capture file, e.g. to create a window of the captured size before replaying it.
+
+		This function does not need a window.
+
+		\param filename is the path of the capture file.
+		\param info is the user-provided record to fill in.
+		\return true if the file is a valid capture file, false otherwise.
+	*/
+	bool getCaptureInfo(const std::string & filename, CaptureInfo & info);
+	/** @}*/
 	
 }
+
+#define SGG_TRACE_CONCAT_(a, b) a##b
+#define SGG_TRACE_CONCAT(a, b) SGG_TRACE_CONCAT_(a, b)
+
+#ifdef SGG_TRACING
+/** Records the rest of the enclosing block as a scope named name, a string literal (see graphics::setTracing()).
+*/
+#define SGG_PROFILE_SCOPE(name) graphics::TraceScope SGG_TRACE_CONCAT(sgg_trace_scope_, __LINE__)(name)
+/** Records the rest of the enclosing function as a scope named after the function.
+*/
+#define SGG_PROFILE_FUNCTION() SGG_PROFILE_SCOPE(__func__)
+/** Records an instantaneous event named name, a string literal.
+*/
+#define SGG_PROFILE_EVENT(name) graphics::traceEvent(name)
+/** Names the calling thread in saved traces.
+*/
+#define SGG_PROFILE_THREAD(name) graphics::setTraceThreadName(name)
+#else
+#define SGG_PROFILE_SCOPE(name) ((void)0)
+#define SGG_PROFILE_FUNCTION() ((void)0)
+#define SGG_PROFILE_EVENT(name) ((void)0)
+#define SGG_PROFILE_THREAD(name) ((void)0)
+#endif
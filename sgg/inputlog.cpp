@@ -0,0 +1,152 @@
+#include <sgg/inputlog.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace graphics
+{
+	static const char     input_log_magic[4] = { 'S', 'G', 'G', 'I' };
+	static const uint32_t input_log_version = 1;
+	static const uint32_t input_event_size = 25;  // the bytes written by writeEvent().
+
+	template <typename T>
+	static void put(std::ofstream & out, T value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static bool get(std::ifstream & in, T & value)
+	{
+		in.read(reinterpret_cast<char *>(&value), sizeof(T));
+		return in.gcount() == sizeof(T);
+	}
+
+	void InputLog::writeEvent(const InputEvent & ev)
+	{
+		put<uint8_t>(m_out, (uint8_t)ev.type);
+		put<uint8_t>(m_out, (uint8_t)ev.button);
+		put<uint16_t>(m_out, (uint16_t)ev.key);
+		put<uint8_t>(m_out, ev.repeat ? 1 : 0);
+		put<uint32_t>(m_out, ev.timestamp);
+		put<int32_t>(m_out, ev.x);
+		put<int32_t>(m_out, ev.y);
+		put<int32_t>(m_out, ev.dx);
+		put<int32_t>(m_out, ev.dy);
+	}
+
+	bool InputLog::readEvent(InputEvent & ev)
+	{
+		uint8_t type, button, repeat;
+		uint16_t key;
+		int32_t x, y, dx, dy;
+		if (!(get(m_in, type) && get(m_in, button) && get(m_in, key) && get(m_in, repeat) &&
+			get(m_in, ev.timestamp) && get(m_in, x) && get(m_in, y) && get(m_in, dx) && get(m_in, dy)))
+			return false;
+		// the values index engine state, so a corrupt log must not get past here.
+		if (type > INPUT_KEY_UP || button > MOUSE_BUTTON_OTHER)
+		{
+			std::cout << "Corrupt input log: invalid event (type " << (int)type << ", button " << (int)button << ")\n";
+			return false;
+		}
+		ev.type = (input_event_t)type;
+		ev.button = (mouse_button_t)button;
+		ev.key = (scancode_t)key;
+		ev.repeat = (repeat != 0);
+		ev.x = x;
+		ev.y = y;
+		ev.dx = dx;
+		ev.dy = dy;
+		return true;
+	}
+
+	bool InputLog::startRecording(const std::string & filename)
+	{
+		stopRecording();
+		m_out.open(filename, std::ios::binary | std::ios::trunc);
+		if (!m_out)
+		{
+			std::cout << "Unable to open input log " << filename << " for writing\n";
+			return false;
+		}
+		m_out.write(input_log_magic, sizeof(input_log_magic));
+		put<uint32_t>(m_out, input_log_version);
+		return true;
+	}
+
+	void InputLog::stopRecording()
+	{
+		if (m_out.is_open())
+			m_out.close();
+	}
+
+	void InputLog::recordFrame(float delta_time, float global_time, const std::vector<InputEvent> & events)
+	{
+		put<float>(m_out, delta_time);
+		put<float>(m_out, global_time);
+		put<uint32_t>(m_out, (uint32_t)events.size());
+		for (const InputEvent & ev : events)
+			writeEvent(ev);
+	}
+
+	bool InputLog::startReplay(const std::string & filename, bool uncapped)
+	{
+		stopReplay();
+		m_in.open(filename, std::ios::binary);
+		if (!m_in)
+		{
+			std::cout << "Unable to open input log " << filename << "\n";
+			return false;
+		}
+
+		char magic[4];
+		uint32_t version = 0;
+		m_in.read(magic, sizeof(magic));
+		if (m_in.gcount() != sizeof(magic) || memcmp(magic, input_log_magic, sizeof(magic)) ||
+			!get(m_in, version) || version != input_log_version)
+		{
+			std::cout << "Invalid input log " << filename << "\n";
+			m_in.close();
+			return false;
+		}
+		std::streampos start = m_in.tellg();
+		m_in.seekg(0, std::ios::end);
+		m_in_size = (uint64_t)m_in.tellg();
+		m_in.seekg(start);
+		m_uncapped = uncapped;
+		return true;
+	}
+
+	void InputLog::stopReplay()
+	{
+		if (m_in.is_open())
+			m_in.close();
+		m_uncapped = false;
+	}
+
+	bool InputLog::replayFrame(float & delta_time, float & global_time, std::vector<InputEvent> & events)
+	{
+		events.clear();
+		uint32_t count;
+		if (!(get(m_in, delta_time) && get(m_in, global_time) && get(m_in, count)))
+			return false;
+		// the count is only trusted as far as the rest of the file can hold that many events.
+		uint64_t remaining = m_in_size - (uint64_t)m_in.tellg();
+		if (count > remaining / input_event_size)
+		{
+			std::cout << "Corrupt input log: a frame of " << count << " events exceeds the end of the file\n";
+			return false;
+		}
+		events.resize(count);
+		for (InputEvent & ev : events)
+			if (!readEvent(ev))
+				return false;
+		return true;
+	}
+
+	InputLog::~InputLog()
+	{
+		stopRecording();
+		stopReplay();
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <sgg/graphics.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace graphics
+{
+	/** Records and replays the per-frame input and timing of the engine.
+
+		The log is a compact binary file: a short header followed by one record per frame, holding the
+		delta and global time of the frame and the input events received during it. Replaying a log
+		feeds the recorded events back to the engine and drives its clock with the recorded times,
+		so that the same workload can be reproduced exactly.
+	*/
+	class InputLog
+	{
+		std::ofstream m_out;
+		std::ifstream m_in;
+		uint64_t m_in_size = 0;
+		bool m_uncapped = false;
+
+		void writeEvent(const InputEvent & ev);
+		bool readEvent(InputEvent & ev);
+
+	public:
+		bool startRecording(const std::string & filename);
+		void stopRecording();
+		bool isRecording() const { return m_out.is_open(); }
+		void recordFrame(float delta_time, float global_time, const std::vector<InputEvent> & events);
+
+		bool startReplay(const std::string & filename, bool uncapped);
+		void stopReplay();
+		bool isReplaying() const { return m_in.is_open(); }
+		bool isUncapped() const { return isReplaying() && m_uncapped; }
+		bool replayFrame(float & delta_time, float & global_time, std::vector<InputEvent> & events);
+
+		~InputLog();
+	};
+}
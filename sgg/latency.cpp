@@ -0,0 +1,134 @@
+#include <sgg/latency.h>
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+namespace graphics
+{
+	static float percentile(const std::vector<float> & sorted, float p)
+	{
+		if (sorted.empty())
+			return 0.0f;
+		return sorted[(size_t)(p * (sorted.size() - 1) + 0.5f)];
+	}
+
+	void LatencyTracker::setEnabled(bool enabled, renderer_t renderer)
+	{
+		if (m_enabled == enabled)
+			return;
+		m_enabled = enabled;
+		m_renderer = renderer;
+		m_frame_tagged = false;
+		clearFences();
+		m_samples.clear();
+		m_total_samples = 0;
+	}
+
+	void LatencyTracker::beginFrame(uint32_t oldest_input_time)
+	{
+		if (!m_enabled || m_frame_tagged)
+			return;
+		m_frame_input_time = oldest_input_time;
+		m_frame_tagged = true;
+	}
+
+	void LatencyTracker::framePresented()
+	{
+		if (!m_enabled)
+			return;
+
+		pollFences();
+
+		if (!m_frame_tagged)
+			return;
+		m_frame_tagged = false;
+
+		Sample sample;
+		sample.present = (float)(SDL_GetTicks() - m_frame_input_time);
+		if (m_renderer == RENDERER_SOFTWARE)
+			sample.gpu = sample.present;
+		if (m_samples.size() < history_size)
+			m_samples.push_back(sample);
+		else
+			m_samples[m_total_samples % history_size] = sample;
+
+		// there is no GL context to insert fences into with the other renderers.
+		if (m_renderer == RENDERER_OPENGL && GLEW_ARB_sync)
+		{
+			PendingFence pending;
+			pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			pending.input_time = m_frame_input_time;
+			pending.sequence = m_total_samples;
+			m_fences.push_back(pending);
+		}
+		m_total_samples++;
+	}
+
+	void LatencyTracker::pollFences()
+	{
+		while (!m_fences.empty())
+		{
+			PendingFence & pending = m_fences.front();
+			GLenum status = glClientWaitSync(pending.fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED)
+				break;
+
+			// the sample slot may have been recycled if the fence took longer than the whole history.
+			if (status != GL_WAIT_FAILED && pending.sequence + history_size > m_total_samples)
+				m_samples[pending.sequence % history_size].gpu = (float)(SDL_GetTicks() - pending.input_time);
+			glDeleteSync(pending.fence);
+			m_fences.pop_front();
+		}
+	}
+
+	void LatencyTracker::clearFences()
+	{
+		for (PendingFence & pending : m_fences)
+			glDeleteSync(pending.fence);
+		m_fences.clear();
+	}
+
+	void LatencyTracker::getStats(LatencyStats & stats)
+	{
+		stats = LatencyStats();
+		if (m_samples.empty())
+			return;
+
+		std::vector<float> present, gpu;
+		present.reserve(m_samples.size());
+		for (const Sample & sample : m_samples)
+		{
+			present.push_back(sample.present);
+			if (sample.gpu >= 0.0f)
+				gpu.push_back(sample.gpu);
+		}
+
+		const Sample & last = m_samples[(m_total_samples - 1) % history_size];
+		stats.samples = (unsigned int)present.size();
+		stats.last = last.present;
+		stats.last_gpu = last.gpu;
+
+		float sum = 0.0f;
+		for (float v : present)
+			sum += v;
+		stats.mean = sum / present.size();
+
+		std::sort(present.begin(), present.end());
+		stats.p50 = percentile(present, 0.50f);
+		stats.p90 = percentile(present, 0.90f);
+		stats.p99 = percentile(present, 0.99f);
+		stats.max = present.back();
+
+		if (!gpu.empty())
+		{
+			std::sort(gpu.begin(), gpu.end());
+			stats.gpu_samples = (unsigned int)gpu.size();
+			stats.gpu_p50 = percentile(gpu, 0.50f);
+			stats.gpu_p99 = percentile(gpu, 0.99f);
+		}
+	}
+
+	LatencyTracker::~LatencyTracker()
+	{
+		clearFences();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <sgg/gltrace.h>
+#include <sgg/graphics.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace graphics
+{
+	/** Measures the time from the arrival of input to the presentation of the frame that consumed it.
+
+		Each frame is tagged with the timestamp of the oldest input event processed by it. When the
+		frame is swapped, the input-to-present latency is recorded and, with the OpenGL renderer where sync
+		objects are available, a fence is inserted in the GL command stream, to also record the time the GPU
+		completed the frame. Fences are polled without blocking, so GPU completion times are reported with
+		the granularity of the frame loop. The software renderer has finished a frame when it is presented,
+		so its completion time is the present time.
+	*/
+	class LatencyTracker
+	{
+		struct PendingFence
+		{
+			GLsync   fence;
+			uint32_t input_time;
+			unsigned int sequence;
+		};
+
+		struct Sample
+		{
+			float present = 0.0f;
+			float gpu = -1.0f;
+		};
+
+		bool     m_enabled = false;
+		renderer_t m_renderer = RENDERER_AUTO;
+		bool     m_frame_tagged = false;
+		uint32_t m_frame_input_time = 0;
+
+		std::vector<Sample> m_samples;
+		unsigned int m_total_samples = 0;
+		std::deque<PendingFence> m_fences;
+
+		void pollFences();
+		void clearFences();
+
+	public:
+		static constexpr size_t history_size = 256;
+
+		void setEnabled(bool enabled, renderer_t renderer);
+		bool isEnabled() const { return m_enabled; }
+		void beginFrame(uint32_t oldest_input_time);
+		void framePresented();
+		void getStats(LatencyStats & stats);
+		~LatencyTracker();
+	};
+}
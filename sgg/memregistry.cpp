@@ -0,0 +1,123 @@
+#include <sgg/memregistry.h>
+#include <algorithm>
+
+namespace graphics
+{
+	MemoryRegistry & MemoryRegistry::get()
+	{
+		// never destroyed, as resources of static objects may be released after it would have been.
+		static MemoryRegistry * registry = new MemoryRegistry();
+		return *registry;
+	}
+
+	void MemoryRegistry::add(const Entry & entry, int sign)
+	{
+		for (MemoryUsage * usage : { &m_usage[entry.category], &m_usage[MEMORY_NUM_CATEGORIES] })
+		{
+			if (sign > 0)
+			{
+				usage->cpu_bytes += entry.cpu_bytes;
+				usage->gpu_bytes += entry.gpu_bytes;
+				usage->resources++;
+				usage->peak_cpu_bytes = std::max(usage->peak_cpu_bytes, usage->cpu_bytes);
+				usage->peak_gpu_bytes = std::max(usage->peak_gpu_bytes, usage->gpu_bytes);
+			}
+			else
+			{
+				usage->cpu_bytes -= entry.cpu_bytes;
+				usage->gpu_bytes -= entry.gpu_bytes;
+				usage->resources--;
+			}
+		}
+	}
+
+	void MemoryRegistry::track(const void * owner, memory_category_t category, const std::string & name, size_t cpu_bytes, size_t gpu_bytes)
+	{
+		if (category < 0 || category >= MEMORY_NUM_CATEGORIES)
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Entry entry = { category, cpu_bytes, gpu_bytes };
+		auto inserted = m_entries.emplace(std::make_pair(owner, name), entry);
+		if (!inserted.second)
+		{
+			add(inserted.first->second, -1);
+			inserted.first->second = entry;
+		}
+		add(entry, 1);
+	}
+
+	void MemoryRegistry::untrack(const void * owner, const std::string & name)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto iter = m_entries.find(std::make_pair(owner, name));
+		if (iter == m_entries.end())
+			return;
+		add(iter->second, -1);
+		m_entries.erase(iter);
+	}
+
+	void MemoryRegistry::untrackAll(const void * owner)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// the entries of an owner are adjacent, starting from the empty name.
+		auto iter = m_entries.lower_bound(std::make_pair(owner, std::string()));
+		while (iter != m_entries.end() && iter->first.first == owner)
+		{
+			add(iter->second, -1);
+			iter = m_entries.erase(iter);
+		}
+	}
+
+	void MemoryRegistry::getUsage(MemoryUsage & usage, memory_category_t category) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		usage = m_usage[(category < 0 || category > MEMORY_NUM_CATEGORIES) ? MEMORY_NUM_CATEGORIES : category];
+	}
+
+	bool MemoryRegistry::getAsset(const std::string & name, MemoryConsumer & consumer) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		bool found = false;
+		consumer = MemoryConsumer();
+		consumer.name = name;
+		for (const auto & entry : m_entries)
+		{
+			if (entry.first.second != name)
+				continue;
+			// an asset loaded by several engine instances is held once by each of them.
+			consumer.category = entry.second.category;
+			consumer.cpu_bytes += entry.second.cpu_bytes;
+			consumer.gpu_bytes += entry.second.gpu_bytes;
+			found = true;
+		}
+		return found;
+	}
+
+	void MemoryRegistry::getTopConsumers(std::vector<MemoryConsumer> & consumers, unsigned int count, memory_category_t category) const
+	{
+		consumers.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::map<std::pair<memory_category_t, std::string>, MemoryConsumer> assets;
+			for (const auto & entry : m_entries)
+			{
+				if (category != MEMORY_NUM_CATEGORIES && entry.second.category != category)
+					continue;
+				MemoryConsumer & asset = assets[std::make_pair(entry.second.category, entry.first.second)];
+				asset.name = entry.first.second;
+				asset.category = entry.second.category;
+				asset.cpu_bytes += entry.second.cpu_bytes;
+				asset.gpu_bytes += entry.second.gpu_bytes;
+			}
+			for (auto & asset : assets)
+				consumers.push_back(std::move(asset.second));
+		}
+
+		std::sort(consumers.begin(), consumers.end(), [](const MemoryConsumer & a, const MemoryConsumer & b)
+		{
+			return a.cpu_bytes + a.gpu_bytes > b.cpu_bytes + b.gpu_bytes;
+		});
+		if (consumers.size() > count)
+			consumers.resize(count);
+	}
+}
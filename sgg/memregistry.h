@@ -0,0 +1,45 @@
+#pragma once
+#include <sgg/graphics.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace graphics
+{
+	/** Keeps account of the memory held by the resources of all engine instances, for getMemoryUsage() and related queries.
+
+		Each resource is registered by its owner (the object that frees it) under a name, typically the asset file,
+		with its size in system memory and its estimated size on the graphics device. Registering a name again updates
+		the sizes; owners unregister their resources when releasing them. The registry is shared by all threads and
+		only updated when resources are created, resized or released, never for each frame.
+	*/
+	class MemoryRegistry
+	{
+		struct Entry
+		{
+			memory_category_t category;
+			size_t cpu_bytes;
+			size_t gpu_bytes;
+		};
+
+		mutable std::mutex m_mutex;
+		std::map<std::pair<const void *, std::string>, Entry> m_entries;
+		// one more than the categories, for the totals.
+		MemoryUsage m_usage[MEMORY_NUM_CATEGORIES + 1];
+
+		void add(const Entry & entry, int sign);
+		MemoryRegistry() {}
+
+	public:
+		static MemoryRegistry & get();
+
+		void track(const void * owner, memory_category_t category, const std::string & name, size_t cpu_bytes, size_t gpu_bytes);
+		void untrack(const void * owner, const std::string & name);
+		void untrackAll(const void * owner);
+
+		void getUsage(MemoryUsage & usage, memory_category_t category) const;
+		bool getAsset(const std::string & name, MemoryConsumer & consumer) const;
+		void getTopConsumers(std::vector<MemoryConsumer> & consumers, unsigned int count, memory_category_t category) const;
+	};
+}
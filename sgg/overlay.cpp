@@ -0,0 +1,235 @@
+#include <sgg/overlay.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace graphics
+{
+	// 5x7 pixel glyphs for the characters from ' ' to '_', one byte per row with the leftmost column in bit 4.
+	static const unsigned char overlay_font[64][7] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // space
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // !
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // #
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // $
+		{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },  // %
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // &
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+		{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },  // (
+		{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },  // )
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // *
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // +
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ,
+		{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },  // -
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },  // .
+		{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },  // /
+		{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },  // 0
+		{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },  // 1
+		{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },  // 2
+		{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },  // 3
+		{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },  // 4
+		{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },  // 5
+		{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },  // 6
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },  // 7
+		{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },  // 8
+		{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },  // 9
+		{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },  // :
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ;
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // <
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // =
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // >
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ?
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // @
+		{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },  // A
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },  // B
+		{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },  // C
+		{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },  // D
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },  // E
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },  // F
+		{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },  // G
+		{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },  // H
+		{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },  // I
+		{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },  // J
+		{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },  // K
+		{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },  // L
+		{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },  // M
+		{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },  // N
+		{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // O
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },  // P
+		{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },  // Q
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },  // R
+		{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },  // S
+		{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },  // T
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // U
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },  // V
+		{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },  // W
+		{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },  // X
+		{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },  // Y
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },  // Z
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // [
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // backslash
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ]
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ^
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // _
+	};
+
+	static constexpr float pixel_size = 2.0f;        // window pixels per font pixel.
+	static constexpr float line_height = 10.0f * pixel_size;
+	static constexpr float char_advance = 6.0f * pixel_size;
+	static constexpr float margin = 8.0f;
+	static constexpr float bar_width = 3.0f;
+	static constexpr float graph_height = 64.0f;
+
+	static const glm::vec4 background_color(0.0f, 0.0f, 0.0f, 0.65f);
+	static const glm::vec4 text_color(1.0f, 1.0f, 1.0f, 1.0f);
+	static const glm::vec4 cpu_color(0.3f, 0.9f, 0.3f, 0.9f);
+	static const glm::vec4 gpu_color(1.0f, 0.6f, 0.1f, 0.9f);
+	static const glm::vec4 mark_color(1.0f, 1.0f, 1.0f, 0.35f);
+
+	glm::vec4 PerformanceOverlay::toCanvas(float x0, float y0, float x1, float y1) const
+	{
+		return glm::vec4(m_to_canvas.x + x0 * m_to_canvas.z, m_to_canvas.y + y0 * m_to_canvas.w,
+			m_to_canvas.x + x1 * m_to_canvas.z, m_to_canvas.y + y1 * m_to_canvas.w);
+	}
+
+	void PerformanceOverlay::addText(const char * text, float x, float y, float pixel)
+	{
+		for (const char * p = text; *p; p++, x += 6.0f * pixel)
+		{
+			int c = toupper((unsigned char)*p);
+			if (c < 32 || c >= 96)
+				continue;
+			const unsigned char * rows = overlay_font[c - 32];
+			for (int row = 0; row < 7; row++)
+			{
+				// each horizontal run of set pixels becomes a single rectangle.
+				for (int col = 0; col < 5; col++)
+				{
+					if (!(rows[row] & (0x10 >> col)))
+						continue;
+					int end = col + 1;
+					while (end < 5 && (rows[row] & (0x10 >> end)))
+						end++;
+					m_text.push_back(toCanvas(x + col * pixel, y + row * pixel, x + end * pixel, y + (row + 1) * pixel));
+					col = end;
+				}
+			}
+		}
+	}
+
+	void PerformanceOverlay::refresh(const FrameProfiler & profiler, const OverlayInfo & info)
+	{
+		// the figures are averaged over the frames of the last refresh interval (at most half a second's worth).
+		size_t frames = std::min(profiler.getHistorySize(), (size_t)30);
+		if (frames == 0)
+			return;
+		float frame_ms = 0.0f, gpu_ms = 0.0f;
+		int gpu_frames = 0;
+		unsigned long long draw_calls = 0, vertices = 0, texture_binds = 0, uniforms = 0, glyphs = 0, glyph_misses = 0;
+		for (size_t age = 0; age < frames; age++)
+		{
+			const FrameStats & stats = profiler.getRecent(age);
+			frame_ms += stats.cpu_time[PROFILE_FRAME];
+			if (stats.gpu_time >= 0.0f)
+			{
+				gpu_ms += stats.gpu_time;
+				gpu_frames++;
+			}
+			draw_calls += stats.draw_calls;
+			vertices += stats.vertices;
+			texture_binds += stats.texture_binds;
+			uniforms += stats.uniform_uploads;
+			glyphs += stats.glyphs;
+			glyph_misses += stats.glyph_cache_misses;
+		}
+		frame_ms /= frames;
+
+		snprintf(m_lines[0], line_length, "SGG %s RENDERER", info.renderer == RENDERER_SOFTWARE ? "SOFTWARE" : info.renderer == RENDERER_VULKAN ? "VULKAN" : "OPENGL");
+		if (gpu_frames)
+			snprintf(m_lines[1], line_length, "FPS %.1f  FRAME %.2f MS  GPU %.2f MS", frame_ms > 0.0f ? 1000.0f / frame_ms : 0.0f, frame_ms, gpu_ms / gpu_frames);
+		else
+			snprintf(m_lines[1], line_length, "FPS %.1f  FRAME %.2f MS  GPU -", frame_ms > 0.0f ? 1000.0f / frame_ms : 0.0f, frame_ms);
+		snprintf(m_lines[2], line_length, "DRAW CALLS %llu  VERTICES %llu", draw_calls / frames, vertices / frames);
+		snprintf(m_lines[3], line_length, "TEXTURE BINDS %llu  UNIFORMS %llu", texture_binds / frames, uniforms / frames);
+		if (glyphs)
+			snprintf(m_lines[4], line_length, "GLYPHS %llu  GLYPH CACHE HITS %d%%", glyphs / frames, (int)(100 * (glyphs - glyph_misses) / glyphs));
+		else
+			snprintf(m_lines[4], line_length, "GLYPHS 0  GLYPH CACHE HITS -");
+		if (info.audio_voices >= 0)
+			snprintf(m_lines[5], line_length, "TEXTURES %.1f MB  AUDIO VOICES %d", info.texture_memory / (1024.0f * 1024.0f), info.audio_voices);
+		else
+			snprintf(m_lines[5], line_length, "TEXTURES %.1f MB  AUDIO VOICES -", info.texture_memory / (1024.0f * 1024.0f));
+		m_refreshed = true;
+	}
+
+	void PerformanceOverlay::draw(Renderer & renderer, const FrameProfiler & profiler, const OverlayInfo & info, const glm::vec4 & to_canvas)
+	{
+		m_to_canvas = to_canvas;
+		auto now = std::chrono::steady_clock::now();
+		if (!m_refreshed || std::chrono::duration<float>(now - m_last_refresh).count() >= refresh_interval)
+		{
+			refresh(profiler, info);
+			m_last_refresh = now;
+		}
+
+		m_background.clear();
+		m_text.clear();
+		m_cpu_bars.clear();
+		m_gpu_bars.clear();
+		m_marks.clear();
+
+		// text lines, then the frame-time graph with its legend.
+		float width = graph_frames * bar_width;
+		for (int line = 0; line < num_lines; line++)
+			width = std::max(width, strlen(m_lines[line]) * char_advance);
+		float x = margin * 2.0f, y = margin * 2.0f;
+		for (int line = 0; line < num_lines; line++, y += line_height)
+			addText(m_lines[line], x, y, pixel_size);
+
+		float graph_top = y + margin;
+		float graph_bottom = graph_top + graph_height;
+		float max_ms = 1000.0f / 30.0f;
+		size_t frames = std::min(profiler.getHistorySize(), (size_t)graph_frames);
+		for (size_t age = 0; age < frames; age++)
+			while (profiler.getRecent(age).cpu_time[PROFILE_FRAME] > max_ms && max_ms < 1000.0f)
+				max_ms *= 2.0f;
+		for (size_t age = 0; age < frames; age++)
+		{
+			// the most recent frame is on the right.
+			const FrameStats & stats = profiler.getRecent(age);
+			float left = x + (graph_frames - 1 - age) * bar_width;
+			float cpu = std::min(stats.cpu_time[PROFILE_FRAME] / max_ms, 1.0f) * graph_height;
+			m_cpu_bars.push_back(toCanvas(left, graph_bottom - cpu, left + bar_width - 1.0f, graph_bottom));
+			if (stats.gpu_time >= 0.0f)
+			{
+				float gpu = std::min(stats.gpu_time / max_ms, 1.0f) * graph_height;
+				m_gpu_bars.push_back(toCanvas(left, graph_bottom - gpu, left + 1.0f, graph_bottom));
+			}
+		}
+		for (float mark = 1000.0f / 60.0f; mark <= max_ms; mark *= 2.0f)
+		{
+			float mark_y = graph_bottom - mark / max_ms * graph_height;
+			m_marks.push_back(toCanvas(x, mark_y, x + graph_frames * bar_width, mark_y + 1.0f));
+		}
+
+		// the legend is drawn in the colors of the bars, so it costs no extra draw calls.
+		float legend_y = graph_bottom + margin;
+		std::swap(m_text, m_cpu_bars);
+		addText("FRAME", x, legend_y, pixel_size);
+		std::swap(m_text, m_cpu_bars);
+		std::swap(m_text, m_gpu_bars);
+		addText("GPU", x + 7.0f * char_advance, legend_y, pixel_size);
+		std::swap(m_text, m_gpu_bars);
+
+		m_background.push_back(toCanvas(margin, margin, x + width + margin, legend_y + 7.0f * pixel_size + margin));
+
+		renderer.drawQuads(m_background.data(), (int)m_background.size(), background_color);
+		renderer.drawQuads(m_marks.data(), (int)m_marks.size(), mark_color);
+		renderer.drawQuads(m_cpu_bars.data(), (int)m_cpu_bars.size(), cpu_color);
+		if (!m_gpu_bars.empty())
+			renderer.drawQuads(m_gpu_bars.data(), (int)m_gpu_bars.size(), gpu_color);
+		renderer.drawQuads(m_text.data(), (int)m_text.size(), text_color);
+	}
+}
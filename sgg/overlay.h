@@ -0,0 +1,57 @@
+#pragma once
+#include <sgg/renderer.h>
+#include <sgg/profiler.h>
+#include <chrono>
+#include <vector>
+
+namespace graphics
+{
+	/** The figures shown by the performance overlay that the frame profiler does not record.
+	*/
+	struct OverlayInfo
+	{
+		renderer_t renderer = RENDERER_AUTO;
+		size_t texture_memory = 0;
+		int audio_voices = -1;  // negative if the audio device has not been opened.
+	};
+
+	/** Draws the performance overlay: frame-time graphs of the CPU and GPU and the figures of the recent frames.
+
+		The overlay is drawn on top of the canvas, at a fixed size in window pixels. All of it is drawn as
+		single-colored rectangles through Renderer::drawQuads(), a handful of draw calls in total; text uses a built-in
+		5x7 pixel font, so it needs no font file and does not go through the (per-glyph) text path of the renderer.
+		The figures are averaged and refreshed a few times per second, so that they remain readable.
+	*/
+	class PerformanceOverlay
+	{
+		static constexpr int graph_frames = 120;
+		static constexpr int num_lines = 6;
+		static constexpr int line_length = 48;
+		static constexpr float refresh_interval = 0.25f;  // in seconds.
+
+		char		m_lines[num_lines][line_length] = {};
+		std::chrono::steady_clock::time_point m_last_refresh;
+		bool		m_refreshed = false;
+
+		std::vector<glm::vec4> m_background;
+		std::vector<glm::vec4> m_text;
+		std::vector<glm::vec4> m_cpu_bars;
+		std::vector<glm::vec4> m_gpu_bars;
+		std::vector<glm::vec4> m_marks;
+
+		// window pixels to canvas units, as origin x, origin y, scale x, scale y.
+		glm::vec4	m_to_canvas;
+
+		glm::vec4 toCanvas(float x0, float y0, float x1, float y1) const;
+		void refresh(const FrameProfiler & profiler, const OverlayInfo & info);
+		void addText(const char * text, float x, float y, float pixel);
+
+	public:
+		/** Draws the overlay for the recent frames of the profiler.
+
+			\param to_canvas maps window pixels (from the top-left corner of the canvas) to canvas units,
+			as origin x, origin y, scale x, scale y.
+		*/
+		void draw(Renderer & renderer, const FrameProfiler & profiler, const OverlayInfo & info, const glm::vec4 & to_canvas);
+	};
+}
@@ -0,0 +1,155 @@
+#include <sgg/profiler.h>
+
+namespace graphics
+{
+	RenderCounters & renderCounters()
+	{
+		static thread_local RenderCounters counters;
+		return counters;
+	}
+
+	void FrameProfiler::setEnabled(bool enabled, bool gpu_timing)
+	{
+		releaseQueries();
+		m_enabled = enabled;
+		m_frame_active = false;
+		m_gpu_active = false;
+		m_frames = 0;
+		m_history.clear();
+		m_gpu_timing = enabled && gpu_timing && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+		if (!enabled)
+			return;
+
+		// the history never grows after this, so that profiling does not allocate during frames.
+		m_history.reserve(history_size);
+		if (m_gpu_timing)
+			for (PendingQuery & query : m_queries)
+				glGenQueries(1, &query.query);
+	}
+
+	void FrameProfiler::beginFrame()
+	{
+		if (!m_enabled)
+			return;
+		pollQueries();
+		m_current = FrameStats();
+		m_current.frame = m_frames;
+		renderCounters() = RenderCounters();
+		m_frame_active = true;
+		beginScope(PROFILE_FRAME);
+	}
+
+	void FrameProfiler::endFrame()
+	{
+		if (!m_enabled || !m_frame_active)
+			return;
+		endScope(PROFILE_FRAME);
+		m_frame_active = false;
+
+		const RenderCounters & counters = renderCounters();
+		m_current.draw_calls = counters.draw_calls;
+		m_current.vertices = counters.vertices;
+		m_current.texture_binds = counters.texture_binds;
+		m_current.uniform_uploads = counters.uniform_uploads;
+		m_current.glyphs = counters.glyphs;
+		m_current.glyph_cache_misses = counters.glyph_cache_misses;
+
+		if (m_history.size() < history_size)
+			m_history.push_back(m_current);
+		else
+			m_history[m_frames % history_size] = m_current;
+		m_frames++;
+	}
+
+	void FrameProfiler::endScope(profile_scope_t scope)
+	{
+		if (!m_enabled)
+			return;
+		std::chrono::duration<float> elapsed_seconds = std::chrono::steady_clock::now() - m_scope_start[scope];
+		// a phase may run more than once per frame (e.g. an extra draw outside the loop), so its times add up.
+		m_current.cpu_time[scope] += elapsed_seconds.count() * 1000.0f;
+	}
+
+	void FrameProfiler::beginGPU()
+	{
+		if (!m_gpu_timing || !m_frame_active || m_gpu_active)
+			return;
+		PendingQuery & query = m_queries[m_next_query];
+		if (query.pending)
+			return;
+		glBeginQuery(GL_TIME_ELAPSED, query.query);
+		query.frame = m_frames;
+		m_gpu_active = true;
+	}
+
+	void FrameProfiler::endGPU()
+	{
+		if (!m_gpu_active)
+			return;
+		glEndQuery(GL_TIME_ELAPSED);
+		m_queries[m_next_query].pending = true;
+		m_next_query = (m_next_query + 1) % query_ring_size;
+		m_gpu_active = false;
+	}
+
+	void FrameProfiler::pollQueries()
+	{
+		if (!m_gpu_timing)
+			return;
+		for (PendingQuery & query : m_queries)
+		{
+			if (!query.pending)
+				continue;
+			GLint available = 0;
+			glGetQueryObjectiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				continue;
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(query.query, GL_QUERY_RESULT, &elapsed);
+			query.pending = false;
+
+			// the history entry may have been recycled if the query took longer than the whole history.
+			if (query.frame < m_frames && query.frame + history_size >= m_frames)
+				m_history[query.frame % history_size].gpu_time = elapsed / 1.0e6f;
+		}
+	}
+
+	void FrameProfiler::releaseQueries()
+	{
+		if (m_gpu_active)
+			glEndQuery(GL_TIME_ELAPSED);
+		m_gpu_active = false;
+		if (!m_gpu_timing)
+			return;
+		for (PendingQuery & query : m_queries)
+		{
+			glDeleteQueries(1, &query.query);
+			query = PendingQuery();
+		}
+		m_next_query = 0;
+		m_gpu_timing = false;
+	}
+
+	bool FrameProfiler::getLatest(FrameStats & stats) const
+	{
+		if (m_frames == 0)
+			return false;
+		stats = m_history[(m_frames - 1) % history_size];
+		return true;
+	}
+
+	void FrameProfiler::getHistory(std::vector<FrameStats> & history) const
+	{
+		history.clear();
+		size_t count = m_history.size();
+		for (size_t i = 0; i < count; i++)
+			history.push_back(m_history[(m_frames - count + i) % history_size]);
+	}
+
+	FrameProfiler::~FrameProfiler()
+	{
+		// the GL context is gone by now; the engine disables profiling in cleanup().
+		m_gpu_timing = false;
+		m_gpu_active = false;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <sgg/gltrace.h>
+#include <sgg/graphics.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace graphics
+{
+	/** Counts the graphics work submitted by a thread.
+
+		The counters are incremented where the work is issued (the renderers, the font library and shader uniforms)
+		and are kept per thread, like the engine instances that issue the work, so that each engine only sees its own.
+	*/
+	struct RenderCounters
+	{
+		unsigned int draw_calls = 0;
+		unsigned int vertices = 0;
+		unsigned int texture_binds = 0;
+		unsigned int uniform_uploads = 0;
+		unsigned int glyphs = 0;
+		unsigned int glyph_cache_misses = 0;
+	};
+
+	/** The render counters of the calling thread.
+	*/
+	RenderCounters & renderCounters();
+
+	/** Breaks each frame down into timed phases and records the frame statistics in a fixed-size history.
+
+		CPU phases are timed with the steady clock. The GPU time of a frame is measured with a GL_TIME_ELAPSED query,
+		taken from a small ring of query objects; results are polled without blocking and stored into the history
+		entry of their frame once available. If all queries of the ring are still pending, the frame is not timed
+		on the GPU rather than waiting for one to complete.
+	*/
+	class FrameProfiler
+	{
+		static constexpr int query_ring_size = 4;
+
+		struct PendingQuery
+		{
+			GLuint query = 0;
+			unsigned long long frame = 0;
+			bool pending = false;
+		};
+
+		bool	  m_enabled = false;
+		bool	  m_frame_active = false;
+		bool	  m_gpu_active = false;
+		bool	  m_gpu_timing = false;
+		FrameStats m_current;
+		std::chrono::steady_clock::time_point m_scope_start[PROFILE_NUM_SCOPES];
+
+		std::vector<FrameStats> m_history;
+		unsigned long long m_frames = 0;
+		PendingQuery m_queries[query_ring_size];
+		int		  m_next_query = 0;
+
+		void pollQueries();
+		void releaseQueries();
+
+	public:
+		static constexpr size_t history_size = 256;
+
+		void setEnabled(bool enabled, bool gpu_timing);
+		bool isEnabled() const { return m_enabled; }
+
+		void beginFrame();
+		void endFrame();
+		void beginScope(profile_scope_t scope)
+		{
+			if (m_enabled)
+				m_scope_start[scope] = std::chrono::steady_clock::now();
+		}
+		void endScope(profile_scope_t scope);
+		void beginGPU();
+		void endGPU();
+
+		size_t getHistorySize() const { return m_history.size(); }
+
+		/** A frame of the history, counting back from the most recent one (age 0).
+		*/
+		const FrameStats & getRecent(size_t age) const { return m_history[(m_frames - 1 - age) % history_size]; }
+		bool getLatest(FrameStats & stats) const;
+		void getHistory(std::vector<FrameStats> & history) const;
+		~FrameProfiler();
+	};
+
+	/** Times a phase of the frame for the lifetime of the object.
+	*/
+	class ProfileScope
+	{
+		FrameProfiler & m_profiler;
+		profile_scope_t m_scope;
+	public:
+		ProfileScope(FrameProfiler & profiler, profile_scope_t scope) : m_profiler(profiler), m_scope(scope) { m_profiler.beginScope(scope); }
+		~ProfileScope() { m_profiler.endScope(m_scope); }
+	};
+}
@@ -0,0 +1,118 @@
+#include <sgg/readback.h>
+#include <sgg/memregistry.h>
+
+namespace graphics
+{
+	PixelReadback::~PixelReadback()
+	{
+		release();
+	}
+
+	bool PixelReadback::init(unsigned int num_buffers)
+	{
+		release();
+		if (num_buffers < 2)
+			num_buffers = 2;
+		m_buffers.resize(num_buffers);
+		for (Buffer & buffer : m_buffers)
+			glGenBuffers(1, &buffer.pbo);
+		m_next = 0;
+		m_requests = 0;
+		m_dropped = 0;
+		return glGetError() == GL_NO_ERROR;
+	}
+
+	void PixelReadback::release()
+	{
+		for (Buffer & buffer : m_buffers)
+		{
+			if (buffer.fence)
+				glDeleteSync(buffer.fence);
+			glDeleteBuffers(1, &buffer.pbo);
+		}
+		m_buffers.clear();
+		MemoryRegistry::get().untrackAll(this);
+	}
+
+	bool PixelReadback::request(int x, int y, int width, int height, uint64_t frame, uint32_t timestamp)
+	{
+		if (m_buffers.empty() || width <= 0 || height <= 0)
+			return false;
+
+		Buffer & buffer = m_buffers[m_next];
+		if (buffer.pending)
+		{
+			m_dropped++;
+			return false;
+		}
+
+		size_t size = (size_t)width * height * 4;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+		if (size != buffer.size)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+			buffer.size = size;
+			size_t total = 0;
+			for (const Buffer & other : m_buffers)
+				total += other.size;
+			MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "readback buffers", 0, total);
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (GLEW_ARB_sync)
+			buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		buffer.pending = true;
+		buffer.order = m_requests++;
+		buffer.info.width = width;
+		buffer.info.height = height;
+		buffer.info.frame = frame;
+		buffer.info.timestamp = timestamp;
+		m_next = (m_next + 1) % m_buffers.size();
+		return true;
+	}
+
+	bool PixelReadback::isComplete(Buffer & buffer, bool wait)
+	{
+		if (wait)
+			return true;
+		if (!buffer.fence)
+			// without fences, a buffer is taken to be done once the whole ring has been cycled through after it.
+			return buffer.order + m_buffers.size() - 1 <= m_requests;
+		GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+		return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED;
+	}
+
+	PixelReadback::Buffer * PixelReadback::oldestPending()
+	{
+		Buffer * oldest = nullptr;
+		for (Buffer & buffer : m_buffers)
+			if (buffer.pending && (!oldest || buffer.order < oldest->order))
+				oldest = &buffer;
+		return oldest;
+	}
+
+	void PixelReadback::collect(const std::function<void(const ReadbackFrame & frame)> & consumer, bool wait)
+	{
+		Buffer * buffer;
+		while ((buffer = oldestPending()) && isComplete(*buffer, wait))
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->pbo);
+			// mapping waits for the copy if it has not completed yet, which only happens when wait is set.
+			buffer->info.pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buffer->size, GL_MAP_READ_BIT));
+			if (buffer->info.pixels)
+			{
+				consumer(buffer->info);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			buffer->info.pixels = nullptr;
+
+			if (buffer->fence)
+				glDeleteSync(buffer->fence);
+			buffer->fence = nullptr;
+			buffer->pending = false;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <sgg/gltrace.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace graphics
+{
+	/** A frame read back from the GPU by PixelReadback. The pixels are RGBA, 8 bits per channel, with rows stored
+		bottom to top (OpenGL order) and tightly packed. They are only valid during the consumer callback.
+	*/
+	struct ReadbackFrame
+	{
+		const uint8_t * pixels = nullptr;
+		int width = 0;
+		int height = 0;
+		uint64_t frame = 0;
+		uint32_t timestamp = 0;
+	};
+
+	/** Reads back the contents of the current framebuffer asynchronously, through a ring of pixel buffer objects.
+
+		request() only queues a copy of the framebuffer into the next free buffer and returns immediately; collect() 
+		later maps the buffers whose copies have completed and hands their contents to a consumer, in submission order.
+		Completion is tracked with fences where sync objects are available, otherwise a buffer is assumed complete 
+		once all other buffers of the ring have been requested after it. When all buffers are still in flight,
+		the requested frame is dropped, so the render loop never stalls on a readback.
+	*/
+	class PixelReadback
+	{
+		struct Buffer
+		{
+			GLuint pbo = 0;
+			GLsync fence = nullptr;
+			size_t size = 0;
+			bool pending = false;
+			uint64_t order = 0;
+			ReadbackFrame info;
+		};
+
+		std::vector<Buffer> m_buffers;
+		size_t m_next = 0;
+		uint64_t m_requests = 0;
+		uint64_t m_dropped = 0;
+
+		bool isComplete(Buffer & buffer, bool wait);
+		Buffer * oldestPending();
+
+	public:
+		PixelReadback() {}
+		PixelReadback(const PixelReadback &) = delete;
+		PixelReadback & operator = (const PixelReadback &) = delete;
+		~PixelReadback();
+
+		bool init(unsigned int num_buffers);
+		void release();
+		bool isValid() const { return !m_buffers.empty(); }
+
+		bool request(int x, int y, int width, int height, uint64_t frame, uint32_t timestamp);
+		void collect(const std::function<void(const ReadbackFrame & frame)> & consumer, bool wait = false);
+
+		uint64_t getDropped() const { return m_dropped; }
+	};
+}
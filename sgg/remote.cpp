@@ -0,0 +1,460 @@
+#include <sgg/remote.h>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace graphics
+{
+	static const uint32_t ring_magic = 0x52474753; // "SGGR"
+	static const uint32_t ring_version = 1;
+	static const uint32_t wrap_marker = 0xFFFFFFFFu;
+	static const size_t ring_data_offset = 64;
+
+	// the handshake message sent by the client right after connecting.
+	struct RemoteHello
+	{
+		uint32_t magic;
+		uint32_t version;
+		char ring_name[64];
+	};
+
+	static uint64_t alignRecord(uint64_t size)
+	{
+		return (size + 7) & ~(uint64_t)7;
+	}
+
+#ifndef _WIN32
+
+	bool SharedCommandRing::create(const std::string & name, uint64_t capacity)
+	{
+		close();
+		capacity = alignRecord(capacity);
+		int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0)
+		{
+			std::cout << "Unable to create shared memory " << name << "\n";
+			return false;
+		}
+		size_t size = ring_data_offset + capacity;
+		if (ftruncate(fd, size) < 0)
+		{
+			::close(fd);
+			shm_unlink(name.c_str());
+			std::cout << "Unable to allocate shared memory " << name << "\n";
+			return false;
+		}
+		void * mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mem == MAP_FAILED)
+		{
+			shm_unlink(name.c_str());
+			return false;
+		}
+
+		m_header = new (mem) SharedRingHeader;
+		m_header->magic = ring_magic;
+		m_header->version = ring_version;
+		m_header->capacity = capacity;
+		m_header->write_pos.store(0);
+		m_header->read_pos.store(0);
+		m_data = static_cast<uint8_t *>(mem) + ring_data_offset;
+		m_mapped_size = size;
+		return true;
+	}
+
+	bool SharedCommandRing::open(const std::string & name)
+	{
+		close();
+		int fd = shm_open(name.c_str(), O_RDWR, 0);
+		if (fd < 0)
+			return false;
+		// the name is no longer needed once both sides hold a mapping.
+		shm_unlink(name.c_str());
+
+		struct stat st;
+		if (fstat(fd, &st) < 0 || (size_t)st.st_size < ring_data_offset)
+		{
+			::close(fd);
+			return false;
+		}
+		size_t size = (size_t)st.st_size;
+		void * mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mem == MAP_FAILED)
+			return false;
+
+		SharedRingHeader * header = static_cast<SharedRingHeader *>(mem);
+		if (header->magic != ring_magic || header->version != ring_version || header->capacity % 8 ||
+			header->capacity > size - ring_data_offset)
+		{
+			munmap(mem, size);
+			return false;
+		}
+		m_header = header;
+		m_data = static_cast<uint8_t *>(mem) + ring_data_offset;
+		m_mapped_size = size;
+		return true;
+	}
+
+	void SharedCommandRing::close()
+	{
+		if (m_header)
+			munmap(m_header, m_mapped_size);
+		m_header = nullptr;
+		m_data = nullptr;
+		m_mapped_size = 0;
+	}
+
+#else
+
+	bool SharedCommandRing::create(const std::string & name, uint64_t capacity)
+	{
+		std::cout << "Out-of-process rendering is not supported on this platform\n";
+		return false;
+	}
+
+	bool SharedCommandRing::open(const std::string & name)
+	{
+		return false;
+	}
+
+	void SharedCommandRing::close()
+	{
+	}
+
+#endif
+
+	bool SharedCommandRing::submit(const uint8_t * commands, size_t size)
+	{
+		if (!m_header)
+			return false;
+		uint64_t capacity = m_header->capacity;
+		uint64_t record = alignRecord(sizeof(uint32_t) + size);
+		if (record + 8 > capacity)
+			return false;
+
+		uint64_t write = m_header->write_pos.load(std::memory_order_relaxed);
+		uint64_t read = m_header->read_pos.load(std::memory_order_acquire);
+		uint64_t offset = write % capacity;
+		uint64_t needed = record;
+		if (offset + record > capacity)
+			needed += capacity - offset;
+		if (capacity - (write - read) < needed)
+			return false;
+
+		if (needed != record)
+		{
+			memcpy(m_data + offset, &wrap_marker, sizeof(uint32_t));
+			offset = 0;
+		}
+		uint32_t length = (uint32_t)size;
+		memcpy(m_data + offset, &length, sizeof(uint32_t));
+		memcpy(m_data + offset + sizeof(uint32_t), commands, size);
+		m_header->write_pos.store(write + needed, std::memory_order_release);
+		return true;
+	}
+
+	bool SharedCommandRing::acquireLatest(const uint8_t * & commands, size_t & size)
+	{
+		if (!m_header)
+			return false;
+		// the header lives in memory writable by the client, so it is validated on every access.
+		uint64_t capacity = m_header->capacity;
+		uint64_t read = m_header->read_pos.load(std::memory_order_relaxed);
+		uint64_t write = m_header->write_pos.load(std::memory_order_acquire);
+		if (write - read > capacity || capacity > m_mapped_size - ring_data_offset)
+			return false;
+
+		bool found = false;
+		uint64_t latest = read, data = 0, length = 0;
+		uint64_t pos = read;
+		while (pos != write)
+		{
+			uint64_t start = pos;
+			uint64_t offset = pos % capacity;
+			uint32_t value;
+			memcpy(&value, m_data + offset, sizeof(uint32_t));
+			if (value == wrap_marker)
+			{
+				pos += capacity - offset;
+				offset = 0;
+				memcpy(&value, m_data, sizeof(uint32_t));
+			}
+			uint64_t record = alignRecord(sizeof(uint32_t) + value);
+			if (offset + record > capacity || pos + record - read > write - read)
+				return false;
+			pos += record;
+			latest = start;
+			data = offset + sizeof(uint32_t);
+			length = value;
+			found = true;
+		}
+
+		// the latest frame is never released, so an unchanged ring yields the current frame again.
+		if (!found)
+			return false;
+
+		// frames older than the latest one are released to the client; the latest stays until it is superseded.
+		m_header->read_pos.store(latest, std::memory_order_release);
+		commands = m_data + data;
+		size = (size_t)length;
+		return true;
+	}
+
+#ifndef _WIN32
+
+	static bool fillAddress(const std::string & path, sockaddr_un & address)
+	{
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.length() >= sizeof(address.sun_path))
+		{
+			std::cout << "Socket path " << path << " is too long\n";
+			return false;
+		}
+		strcpy(address.sun_path, path.c_str());
+		return true;
+	}
+
+	bool RemoteServer::listen(const std::string & socket_path, const std::string & asset_root)
+	{
+		close();
+		m_resources.setRoot(asset_root);
+		sockaddr_un address;
+		if (!fillAddress(socket_path, address))
+			return false;
+
+		m_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_listen_fd < 0)
+			return false;
+		unlink(socket_path.c_str());
+		if (bind(m_listen_fd, (sockaddr *)&address, sizeof(address)) < 0 || ::listen(m_listen_fd, 1) < 0)
+		{
+			std::cout << "Unable to listen on " << socket_path << "\n";
+			::close(m_listen_fd);
+			m_listen_fd = -1;
+			return false;
+		}
+		fcntl(m_listen_fd, F_SETFL, O_NONBLOCK);
+		m_socket_path = socket_path;
+		return true;
+	}
+
+	void RemoteServer::close()
+	{
+		dropClient();
+		if (m_listen_fd >= 0)
+		{
+			::close(m_listen_fd);
+			unlink(m_socket_path.c_str());
+		}
+		m_listen_fd = -1;
+	}
+
+	void RemoteServer::dropClient()
+	{
+		if (m_client_fd >= 0)
+			::close(m_client_fd);
+		m_client_fd = -1;
+		m_ring.close();
+	}
+
+	void RemoteServer::acceptClient()
+	{
+		// one client at a time; further connections wait in the backlog.
+		if (m_client_fd < 0)
+		{
+			m_client_fd = accept(m_listen_fd, nullptr, nullptr);
+			if (m_client_fd < 0)
+				return;
+			fcntl(m_client_fd, F_SETFL, O_NONBLOCK);
+		}
+
+		RemoteHello hello;
+		ssize_t received = recv(m_client_fd, &hello, sizeof(hello), MSG_PEEK);
+		if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			dropClient();
+			return;
+		}
+		if (received < (ssize_t)sizeof(hello))
+			return;
+		recv(m_client_fd, &hello, sizeof(hello), 0);
+
+		hello.ring_name[sizeof(hello.ring_name) - 1] = '\0';
+		uint32_t status = (hello.magic == ring_magic && hello.version == ring_version && m_ring.open(hello.ring_name)) ? 1 : 0;
+		send(m_client_fd, &status, sizeof(status), MSG_NOSIGNAL);
+		if (!status)
+		{
+			std::cout << "Rejected remote client\n";
+			dropClient();
+		}
+	}
+
+	void RemoteServer::render(GLBackend & target)
+	{
+		if (m_listen_fd < 0)
+			return;
+		if (!m_ring.isOpen())
+		{
+			acceptClient();
+			return;
+		}
+
+		// the client sends nothing after the handshake, so a readable socket means it has gone away.
+		char byte;
+		ssize_t received = recv(m_client_fd, &byte, 1, 0);
+		if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			dropClient();
+			return;
+		}
+
+		const uint8_t * commands;
+		size_t size;
+		if (!m_ring.acquireLatest(commands, size))
+			return;
+		CommandDecoder decoder(commands, size, &m_resources);
+		if (!decoder.execute(target))
+		{
+			std::cout << "Invalid command stream, disconnecting remote client\n";
+			dropClient();
+		}
+		target.resetPose();
+	}
+
+	bool RemoteBackend::init()
+	{
+		m_initialized = false;
+		// the client has no window: input and window events belong to the renderer process.
+		m_poll_events = false;
+
+		sockaddr_un address;
+		if (!fillAddress(m_socket_path, address))
+			return false;
+
+		static std::atomic<unsigned int> ring_counter(0);
+		std::string ring_name = "/sgg-" + std::to_string(getpid()) + "-" + std::to_string(ring_counter++);
+		if (!m_ring.create(ring_name, SharedCommandRing::default_capacity))
+			return false;
+
+		m_socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_socket_fd < 0 || connect(m_socket_fd, (sockaddr *)&address, sizeof(address)) < 0)
+		{
+			std::cout << "Unable to connect to renderer at " << m_socket_path << "\n";
+			shm_unlink(ring_name.c_str());
+			cleanup();
+			return false;
+		}
+
+		RemoteHello hello;
+		memset(&hello, 0, sizeof(hello));
+		hello.magic = ring_magic;
+		hello.version = ring_version;
+		strncpy(hello.ring_name, ring_name.c_str(), sizeof(hello.ring_name) - 1);
+
+		timeval timeout = { 5, 0 };
+		setsockopt(m_socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		uint32_t status = 0;
+		if (send(m_socket_fd, &hello, sizeof(hello), MSG_NOSIGNAL) != sizeof(hello) ||
+			recv(m_socket_fd, &status, sizeof(status), MSG_WAITALL) != sizeof(status) || status != 1)
+		{
+			std::cout << "Renderer at " << m_socket_path << " refused the connection\n";
+			shm_unlink(ring_name.c_str());
+			cleanup();
+			return false;
+		}
+		fcntl(m_socket_fd, F_SETFL, O_NONBLOCK);
+
+		m_initialized = true;
+		return true;
+	}
+
+	void RemoteBackend::cleanup()
+	{
+		if (m_socket_fd >= 0)
+			::close(m_socket_fd);
+		m_socket_fd = -1;
+		m_ring.close();
+	}
+
+	void RemoteBackend::draw()
+	{
+		if (m_first_frame)
+		{
+			advanceTime();
+			m_global_time = 0.0f;
+			m_delta_time = 0.0f;
+			m_first_frame = false;
+		}
+
+		// every frame is self-contained, as the renderer may have joined (or restarted) at any point.
+		m_commands.clear();
+		m_commands.setBackgroundColor(m_back_color.r, m_back_color.g, m_back_color.b);
+		// the canvas of the renderer is only overridden with the settings the client has made.
+		if (m_canvas_mode_set)
+			m_commands.setCanvasMode((scale_mode_t)m_canvas_mode);
+		if (m_canvas_size_set)
+			m_commands.setCanvasSize(m_requested_canvas.z, m_requested_canvas.w);
+		if (!m_font.empty())
+			m_commands.setFont(m_font);
+		if (m_draw_callback != nullptr)
+			m_draw_callback();
+		// a frame the renderer has no room for is dropped; the next one supersedes it anyway.
+		m_ring.submit(m_commands.data(), m_commands.size());
+
+		char byte;
+		ssize_t received = recv(m_socket_fd, &byte, 1, 0);
+		if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+			terminate();
+	}
+
+#else
+
+	bool RemoteServer::listen(const std::string & socket_path, const std::string & asset_root)
+	{
+		std::cout << "Out-of-process rendering is not supported on this platform\n";
+		return false;
+	}
+
+	void RemoteServer::close()
+	{
+	}
+
+	void RemoteServer::dropClient()
+	{
+	}
+
+	void RemoteServer::acceptClient()
+	{
+	}
+
+	void RemoteServer::render(GLBackend & target)
+	{
+	}
+
+	bool RemoteBackend::init()
+	{
+		std::cout << "Out-of-process rendering is not supported on this platform\n";
+		return false;
+	}
+
+	void RemoteBackend::cleanup()
+	{
+	}
+
+	void RemoteBackend::draw()
+	{
+	}
+
+#endif
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <sgg/cmdstream.h>
+#include <sgg/GLbackend.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace graphics
+{
+	/** The header of a shared-memory command ring, placed at the start of the shared mapping.
+
+		The ring is written by a single client process and read by a single renderer process. Each submitted frame
+		is stored as a contiguous record (a 32-bit length followed by the encoded commands), padded to 8 bytes.
+		A record that does not fit before the end of the ring is preceded by a wrap marker and stored at the start.
+		The positions are monotonically increasing byte counters, so that the ring never needs a full/empty flag.
+	*/
+	struct SharedRingHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t capacity;
+		std::atomic<uint64_t> write_pos;
+		std::atomic<uint64_t> read_pos;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "the command ring requires lock-free 64-bit atomics");
+
+	/** A mapping of a shared-memory command ring, either created (client side) or opened (renderer side).
+	*/
+	class SharedCommandRing
+	{
+		SharedRingHeader * m_header = nullptr;
+		uint8_t * m_data = nullptr;
+		size_t m_mapped_size = 0;
+
+	public:
+		static constexpr uint64_t default_capacity = 4 * 1024 * 1024;
+
+		bool create(const std::string & name, uint64_t capacity);
+		bool open(const std::string & name);
+		void close();
+		bool isOpen() const { return m_header != nullptr; }
+
+		/** Copies one frame of commands into the ring. Returns false, dropping the frame, if the renderer has not yet
+			consumed enough older frames to make room for it, so that the client never waits for the renderer.
+		*/
+		bool submit(const uint8_t * commands, size_t size);
+
+		/** Finds the most recently completed frame, releasing all older ones, and returns its commands in place.
+			The same frame is returned until a newer one is submitted. Returns false if no frame was submitted yet
+			or the ring header is corrupt.
+		*/
+		bool acquireLatest(const uint8_t * & commands, size_t & size);
+
+		~SharedCommandRing() { close(); }
+	};
+
+	/** The renderer side of out-of-process rendering.
+
+		Listens on a Unix domain socket for a client. When the client connects, it sends the name of the shared-memory
+		ring it submits its frames to; the server maps the ring and, every frame, replays the latest submitted frame
+		into the engine. The socket is only used for the handshake and to detect that either side has gone away:
+		a client that crashes or disconnects simply stops contributing to the rendered frames. A client that refers to a
+		bitmap or font the resource filter rejects is dropped, as with a malformed stream.
+	*/
+	class RemoteServer
+	{
+		std::string m_socket_path;
+		int m_listen_fd = -1;
+		int m_client_fd = -1;
+		SharedCommandRing m_ring;
+		ResourceFilter m_resources;
+
+		void acceptClient();
+		void dropClient();
+
+	public:
+		/** Creates the socket. The bitmaps and fonts of the clients are restricted to paths inside asset_root.
+		*/
+		bool listen(const std::string & socket_path, const std::string & asset_root);
+		void close();
+		bool isClientConnected() const { return m_ring.isOpen(); }
+
+		/** Services the socket and replays the latest frame of the connected client, if any, into the target engine.
+		*/
+		void render(GLBackend & target);
+
+		~RemoteServer() { close(); }
+	};
+
+	/** An engine instance that renders through a remote renderer process instead of its own window.
+
+		All drawing calls are encoded into a command stream, which is submitted to the shared-memory ring at the end
+		of each frame. The client process never creates a window or a graphics context.
+	*/
+	class RemoteBackend : public GLBackend
+	{
+		std::string m_socket_path;
+		int m_socket_fd = -1;
+		SharedCommandRing m_ring;
+		CommandEncoder m_commands;
+		std::string m_font;
+		bool m_canvas_mode_set = false;
+		bool m_canvas_size_set = false;
+
+	public:
+		RemoteBackend(const std::string & socket_path) : m_socket_path(socket_path) {}
+
+		bool init() override;
+		void cleanup() override;
+		void draw() override;
+
+		void drawRect(float cx, float cy, float w, float h, const Brush & brush) override { m_commands.drawRect(cx, cy, w, h, brush); }
+		void drawLine(float x_1, float y_1, float x_2, float y_2, const Brush & brush) override { m_commands.drawLine(x_1, y_1, x_2, y_2, brush); }
+		void drawSector(float cx, float cy, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush) override
+			{ m_commands.drawSector(cx, cy, start_angle, end_angle, radius1, radius2, brush); }
+		void drawText(float pos_x, float pos_y, float size, const std::string & text, const Brush & brush) override { m_commands.drawText(pos_x, pos_y, size, text, brush); }
+		bool setFont(std::string fontname) override { m_font = fontname; m_commands.setFont(fontname); return true; }
+		void setOrientation(float degrees) override { m_commands.setOrientation(degrees); }
+		void setScale(float sx, float sy, float sz) override { m_commands.setScale(sx, sy, sz); }
+		void resetPose() override { m_commands.resetPose(); }
+		void setBackgroundColor(float r, float g, float b) override { m_back_color = glm::vec3(r, g, b); }
+		void setCanvasMode(int m) override { GLBackend::setCanvasMode(m); m_canvas_mode_set = true; }
+		void setCanvasSize(float w, float h) override { GLBackend::setCanvasSize(w, h); m_canvas_size_set = true; }
+		void makeCurrent() override {}
+		void show(bool) override {}
+	};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <glm/glm.hpp>
+#include <sgg/graphics.h>
+#include <sgg/fonts.h>
+#include <string>
+#include <vector>
+
+namespace graphics
+{
+	/** The device-specific part of an engine instance: draws the primitives of a frame into the window.
+
+		The engine (GLBackend) keeps all device-independent state, such as the window, the canvas, input, timing and the
+		current pose, and hands each primitive to the renderer already transformed: shapes come with their model-view
+		matrix and the canvas-to-clip-space projection is passed at the start of each frame. Text is collected
+		during the frame and drawn on top of all shapes when the frame ends.
+
+		A renderer is created before the window, as the window may need renderer-specific flags, and is initialized
+		once the window exists. In offscreen mode (headless windows), the frame is kept in memory instead of being shown
+		and can be read back with readPixels().
+	*/
+	class Renderer
+	{
+	public:
+		virtual ~Renderer() {}
+
+		virtual renderer_t getType() const = 0;
+		virtual Uint32 getWindowFlags(bool offscreen) const = 0;
+
+		virtual bool init(SDL_Window * window, int width, int height, bool offscreen) = 0;
+		virtual void release() = 0;
+		virtual void makeCurrent() = 0;
+		virtual void resize(int width, int height) = 0;
+
+		/** Starts a new frame: clears the frame buffer and sets the projection and the (optional) scissor rectangle,
+			given in pixels from the bottom-left corner, as x, y, width, height.
+		*/
+		virtual void beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor) = 0;
+
+		/** Draws a unit square, centered at the origin, transformed by the model-view matrix.
+		*/
+		virtual void drawRect(const glm::mat4 & modelview, const Brush & brush) = 0;
+		virtual void drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush) = 0;
+		virtual void drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush) = 0;
+
+		/** Draws axis-aligned rectangles of a single color, given in canvas units as min x, min y, max x, max y, with as
+			few draw calls as the device allows. Used by the overlays of the engine, which must cost little next to what they show.
+		*/
+		virtual void drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color) = 0;
+
+		/** Thread-safe initialization of the font rasterizer, which does not touch the graphics device (see initSubsystems()).
+		*/
+		virtual bool initFontLibrary() = 0;
+		virtual bool isFontLibraryReady() const = 0;
+		virtual bool initFonts() = 0;
+		virtual bool areFontsInitialized() const = 0;
+		virtual bool setFont(const std::string & fontname) = 0;
+		virtual void drawText(const TextRecord & text) = 0;
+
+		virtual bool preloadTexture(const std::string & filename) = 0;
+
+		/** The memory held by the loaded textures on the device (in system memory for the software renderer), in bytes.
+		*/
+		virtual size_t getTextureMemory() const = 0;
+
+		/** Ends the frame, drawing the text submitted during it. The frame is only shown by present().
+		*/
+		virtual void endFrame() = 0;
+		virtual void present() = 0;
+
+		/** Replaces the shading of fragments with counting them per pixel (see setOverdrawVisualization()). The counts
+			are shown as a heat map, in place of the frame, by endFrame().
+		*/
+		virtual bool setOverdrawMode(bool enable) = 0;
+		virtual bool getOverdrawStats(OverdrawStats & stats) const = 0;
+
+		/** Reads back the last frame as opaque RGBA pixels, with rows stored top to bottom.
+		*/
+		virtual bool readPixels(std::vector<unsigned char> & pixels, int & width, int & height) = 0;
+	};
+
+	Renderer * createRenderer(renderer_t type);
+}
@@ -0,0 +1,114 @@
+#include <sgg/rendertarget.h>
+#include <sgg/memregistry.h>
+#include <iostream>
+
+namespace graphics
+{
+	int RenderTarget::sizeClass(int size)
+	{
+		if (size <= 0)
+			return size_class;
+		return ((size + size_class - 1) / size_class) * size_class;
+	}
+
+	RenderTarget::RenderTarget(GLenum internal_format, GLenum format, GLenum type) :
+		m_internal_format(internal_format), m_format(format), m_type(type)
+	{
+
+	}
+
+	RenderTarget::~RenderTarget()
+	{
+		release();
+	}
+
+	void RenderTarget::allocate(int w, int h)
+	{
+		if (!m_fbo)
+		{
+			glGenFramebuffers(1, &m_fbo);
+			glGenTextures(1, &m_texture);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, m_internal_format, w, h, 0, m_format, m_type, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		GLint prev_fbo;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "Incomplete offscreen render target " << w << "x" << h << "\n";
+		glBindFramebuffer(GL_FRAMEBUFFER, prev_fbo);
+
+		m_alloc_width = w;
+		m_alloc_height = h;
+		MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "offscreen frame", 0, (size_t)w * h * bytesPerPixel());
+	}
+
+	size_t RenderTarget::bytesPerPixel() const
+	{
+		switch (m_internal_format)
+		{
+		case GL_R8:
+			return 1;
+		case GL_RG8:
+		case GL_R16F:
+			return 2;
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_RGBA32F:
+			return 16;
+		default:
+			return 4;
+		}
+	}
+
+	bool RenderTarget::resize(int w, int h)
+	{
+		m_width = w;
+		m_height = h;
+
+		int cw = sizeClass(w);
+		int ch = sizeClass(h);
+		bool grow = cw > m_alloc_width || ch > m_alloc_height;
+		bool shrink = 2 * cw <= m_alloc_width || 2 * ch <= m_alloc_height;
+		if (m_fbo && !grow && !shrink)
+			return false;
+
+		allocate(cw, ch);
+		return true;
+	}
+
+	void RenderTarget::bind()
+	{
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_prev_fbo);
+		glGetIntegerv(GL_VIEWPORT, m_prev_viewport);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		glViewport(0, 0, m_width, m_height);
+	}
+
+	void RenderTarget::unbind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_prev_fbo);
+		glViewport(m_prev_viewport[0], m_prev_viewport[1], m_prev_viewport[2], m_prev_viewport[3]);
+	}
+
+	void RenderTarget::release()
+	{
+		if (m_texture)
+			glDeleteTextures(1, &m_texture);
+		if (m_fbo)
+			glDeleteFramebuffers(1, &m_fbo);
+		m_texture = 0;
+		m_fbo = 0;
+		m_alloc_width = m_alloc_height = 0;
+		MemoryRegistry::get().untrackAll(this);
+	}
+}
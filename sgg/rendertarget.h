@@ -0,0 +1,53 @@
+#pragma once
+#include <sgg/gltrace.h>
+#include <cstddef>
+
+namespace graphics
+{
+	/** An offscreen color buffer (framebuffer object with a texture attachment) that can be drawn into.
+
+		To avoid thrashing GPU memory while a window is being resized, the storage of the target is 
+		allocated in size classes: the texture only grows in steps of size_class pixels per dimension 
+		and is only shrunk when the requested size drops below half of the allocated one. The
+		requested (logical) size is always used for the viewport, so the texture may be larger
+		than the area actually drawn.
+	*/
+	class RenderTarget
+	{
+		GLuint m_fbo = 0;
+		GLuint m_texture = 0;
+		GLenum m_internal_format = GL_RGBA8;
+		GLenum m_format = GL_RGBA;
+		GLenum m_type = GL_UNSIGNED_BYTE;
+		int    m_width = 0,
+			   m_height = 0;
+		int    m_alloc_width = 0,
+			   m_alloc_height = 0;
+		GLint  m_prev_fbo = 0;
+		GLint  m_prev_viewport[4] = { 0, 0, 0, 0 };
+
+		void allocate(int w, int h);
+		size_t bytesPerPixel() const;
+
+	public:
+		static constexpr int size_class = 256;
+		static int sizeClass(int size);
+
+		RenderTarget(GLenum internal_format = GL_RGBA8, GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE);
+		RenderTarget(const RenderTarget &) = delete;
+		RenderTarget & operator = (const RenderTarget &) = delete;
+		~RenderTarget();
+
+		bool resize(int w, int h);
+		void bind();
+		void unbind();
+		void release();
+		bool isValid() const { return m_fbo != 0; }
+		GLuint getFramebuffer() const { return m_fbo; }
+		GLuint getTexture() const { return m_texture; }
+		int getWidth() const { return m_width; }
+		int getHeight() const { return m_height; }
+		int getAllocatedWidth() const { return m_alloc_width; }
+		int getAllocatedHeight() const { return m_alloc_height; }
+	};
+}
@@ -1,5 +1,6 @@
 #include <sgg/shader.h>
-#include <GL/glew.h>
+#include <sgg/gltrace.h>
+#include <sgg/profiler.h>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -179,24 +180,28 @@ Uniform & Uniform::operator=(const Uniform & right)
 Uniform & Uniform::operator=(int i)
 {
 	glUniform1i(this->id, i);
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(float f)
 {
 	glUniform1f(this->id, f);
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(unsigned int i)
 {
 	glUniform1ui(this->id, i);
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::vec3 v)
 {
 	glUniform3f(this->id, v.x, v.y, v.z);
+	graphics::renderCounters().uniform_uploads++;
 	int err = glGetError();
 	assert(err == GL_NO_ERROR);
 
@@ -206,41 +211,48 @@ Uniform & Uniform::operator=(glm::vec3 v)
 Uniform & Uniform::operator=(glm::vec4 v)
 {
 	glUniform4f(this->id, v.x, v.y, v.z, v.w);
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::vec2 v)
 {
 	glUniform2fv(this->id, 1, &(v[0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::ivec3 v)
 {
 	glUniform3iv(this->id, 1, &(v[0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::ivec2 v)
 {
 	glUniform2iv(this->id, 1, &(v[0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::ivec4 v)
 {
 	glUniform4iv(this->id, 1, &(v[0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::mat4 m)
 {
 	glUniformMatrix4fv(this->id, 1, false, &(m[0][0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
 
 Uniform & Uniform::operator=(glm::mat3 m)
 {
 	glUniformMatrix3fv(this->id, 1, false, &(m[0][0]));
+	graphics::renderCounters().uniform_uploads++;
 	return *this;
 }
@@ -0,0 +1,27 @@
+#version 450
+
+// the fragment shader of the Vulkan renderer, for shapes (texture_mode 0 or 1) and glyphs (texture_mode 2).
+
+layout(location = 0) in vec2 texcoord;
+
+layout(push_constant) uniform Draw
+{
+	mat4 transform;
+	vec4 color1;
+	vec4 color2;
+	vec2 gradient;
+	int texture_mode;
+} draw;
+
+layout(set = 0, binding = 0) uniform sampler2D tex;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	color = mix(draw.color1, draw.color2, dot(texcoord, draw.gradient));
+	if (draw.texture_mode == 1)
+		color *= texture(tex, texcoord);
+	else if (draw.texture_mode == 2)
+		color.a *= texture(tex, texcoord).r;
+}
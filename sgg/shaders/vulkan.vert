@@ -0,0 +1,22 @@
+#version 450
+
+// the vertex shader of the Vulkan renderer: the same as the OpenGL one, with the uniforms passed as push constants.
+
+layout(location = 0) in vec4 coord;
+
+layout(push_constant) uniform Draw
+{
+	mat4 transform;
+	vec4 color1;
+	vec4 color2;
+	vec2 gradient;
+	int texture_mode;
+} draw;
+
+layout(location = 0) out vec2 texcoord;
+
+void main()
+{
+	gl_Position = draw.transform * vec4(coord.xy, 0.0, 1.0);
+	texcoord = coord.zw;
+}
@@ -0,0 +1,847 @@
+#include <sgg/softrenderer.h>
+#include <sgg/glrenderer.h>
+#include <sgg/vkrenderer.h>
+#include <sgg/alloctrack.h>
+#include <sgg/profiler.h>
+#include <sgg/memregistry.h>
+#include <sgg/lodepng.h>
+#include FT_MODULE_H
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SGG_SOFT_SSE2
+#endif
+
+namespace graphics
+{
+	static uint32_t packColor(const glm::vec4 & color)
+	{
+		glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+		return ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | (uint32_t)c.b;
+	}
+
+	static glm::vec4 unpackColor(uint32_t color)
+	{
+		return glm::vec4((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, color >> 24) / 255.0f;
+	}
+
+	// source-over blending of a constant color into a span, the same as
+	// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), in 8-bit fixed point.
+	static void blendSpan(uint32_t * dst, int count, uint32_t color)
+	{
+		uint32_t alpha = color >> 24;
+		if (alpha == 0)
+			return;
+		if (alpha == 255)
+		{
+			std::fill(dst, dst + count, color);
+			return;
+		}
+		uint32_t weight = alpha + (alpha >> 7);
+		int i = 0;
+#ifdef SGG_SOFT_SSE2
+		__m128i zero = _mm_setzero_si128();
+		__m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero), _mm_set1_epi16((short)weight));
+		__m128i inv_weight = _mm_set1_epi16((short)(256 - weight));
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128((const __m128i *)(dst + i));
+			__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+			__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+			lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, inv_weight), src), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, inv_weight), src), 8);
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			uint32_t d = dst[i], result = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				uint32_t channel = (((d >> shift) & 0xFF) * (256 - weight) + ((color >> shift) & 0xFF) * weight) >> 8;
+				result |= channel << shift;
+			}
+			dst[i] = result;
+		}
+	}
+
+	static void blendPixel(uint32_t & dst, glm::vec4 color)
+	{
+		color = glm::clamp(color, 0.0f, 1.0f);
+		if (color.a <= 0.0f)
+			return;
+		glm::vec4 result = color * color.a + unpackColor(dst) * (1.0f - color.a);
+		dst = packColor(result);
+	}
+
+	static glm::vec4 sampleTexture(const SoftTexture & texture, float u, float v)
+	{
+		// bilinear filtering with clamp-to-edge addressing, as set up for the OpenGL textures.
+		float fx = glm::clamp(u * texture.width - 0.5f, 0.0f, texture.width - 1.0f);
+		float fy = glm::clamp(v * texture.height - 0.5f, 0.0f, texture.height - 1.0f);
+		int x0 = (int)fx, y0 = (int)fy;
+		int x1 = std::min(x0 + 1, texture.width - 1), y1 = std::min(y0 + 1, texture.height - 1);
+		float sx = fx - x0, sy = fy - y0;
+		const uint32_t * texels = texture.texels.data();
+		glm::vec4 top = glm::mix(unpackColor(texels[y0 * texture.width + x0]), unpackColor(texels[y0 * texture.width + x1]), sx);
+		glm::vec4 bottom = glm::mix(unpackColor(texels[y1 * texture.width + x0]), unpackColor(texels[y1 * texture.width + x1]), sx);
+		return glm::mix(top, bottom, sy);
+	}
+
+	static float sampleCoverage(const SoftGlyph & glyph, float u, float v)
+	{
+		float fx = glm::clamp(u * glyph.width - 0.5f, 0.0f, glyph.width - 1.0f);
+		float fy = glm::clamp(v * glyph.rows - 0.5f, 0.0f, glyph.rows - 1.0f);
+		int x0 = (int)fx, y0 = (int)fy;
+		int x1 = std::min(x0 + 1, glyph.width - 1), y1 = std::min(y0 + 1, glyph.rows - 1);
+		float sx = fx - x0, sy = fy - y0;
+		const uint8_t * coverage = glyph.coverage.data();
+		float top = glm::mix((float)coverage[y0 * glyph.width + x0], (float)coverage[y0 * glyph.width + x1], sx);
+		float bottom = glm::mix((float)coverage[y1 * glyph.width + x0], (float)coverage[y1 * glyph.width + x1], sx);
+		return glm::mix(top, bottom, sy) / 255.0f;
+	}
+
+	bool SoftwareRenderer::init(SDL_Window * window, int width, int height, bool offscreen)
+	{
+		m_window = window;
+		m_offscreen_mode = offscreen;
+		resize(width, height);
+		startWorkers();
+		return true;
+	}
+
+	void SoftwareRenderer::release()
+	{
+		stopWorkers();
+		MemoryRegistry::get().untrackAll(this);
+		for (auto & font : m_fonts)
+			FT_Done_Face(font.second.face);
+		m_fonts.clear();
+		m_current_font = nullptr;
+		if (m_ft)
+		{
+#ifdef SGG_TRACK_ALLOCATIONS
+			FT_Done_Library(m_ft);
+#else
+			FT_Done_FreeType(m_ft);
+#endif
+			m_ft = nullptr;
+		}
+	}
+
+	SoftwareRenderer::~SoftwareRenderer()
+	{
+		release();
+	}
+
+	void SoftwareRenderer::resize(int width, int height)
+	{
+		m_width = std::max(width, 1);
+		m_height = std::max(height, 1);
+		m_frame.assign((size_t)m_width * m_height, 0xFF000000);
+		MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "software frame", m_frame.capacity() * sizeof(uint32_t), 0);
+		m_tiles_x = (m_width + tile_size - 1) / tile_size;
+		m_tiles_y = (m_height + tile_size - 1) / tile_size;
+		m_bins.resize(m_tiles_x * m_tiles_y);
+		m_tile_overdraw.resize(m_tiles_x * m_tiles_y);
+		if (m_overdraw_mode)
+		{
+			m_overdraw.assign((size_t)m_width * m_height, 0);
+			MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "overdraw counts", m_overdraw.capacity(), 0);
+		}
+	}
+
+	void SoftwareRenderer::startWorkers()
+	{
+		// the calling thread rasterizes tiles as well.
+		unsigned int threads = std::max(std::thread::hardware_concurrency(), 1u);
+		threads = std::min(threads, 16u);
+		m_stop_workers = false;
+		for (unsigned int i = 1; i < threads; i++)
+			m_workers.emplace_back(&SoftwareRenderer::workerLoop, this);
+	}
+
+	void SoftwareRenderer::stopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_work_mutex);
+			m_stop_workers = true;
+		}
+		m_work_start.notify_all();
+		for (auto & worker : m_workers)
+			worker.join();
+		m_workers.clear();
+	}
+
+	void SoftwareRenderer::workerLoop()
+	{
+		SGG_PROFILE_THREAD("raster worker");
+		uint64_t generation = 0;
+		std::unique_lock<std::mutex> lock(m_work_mutex);
+		while (true)
+		{
+			m_work_start.wait(lock, [&]() { return m_stop_workers || m_work_generation != generation; });
+			if (m_stop_workers)
+				return;
+			generation = m_work_generation;
+			lock.unlock();
+
+			{
+				SGG_PROFILE_SCOPE("rasterize tiles");
+				int num_tiles = m_tiles_x * m_tiles_y;
+				for (int tile = m_next_tile++; tile < num_tiles; tile = m_next_tile++)
+					rasterizeTile(tile);
+			}
+
+			lock.lock();
+			if (--m_workers_busy == 0)
+				m_work_done.notify_one();
+		}
+	}
+
+	void SoftwareRenderer::rasterizeTiles()
+	{
+		SGG_PROFILE_SCOPE("rasterize tiles");
+		m_next_tile = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_work_mutex);
+			m_workers_busy = (int)m_workers.size();
+			m_work_generation++;
+		}
+		m_work_start.notify_all();
+
+		int num_tiles = m_tiles_x * m_tiles_y;
+		for (int tile = m_next_tile++; tile < num_tiles; tile = m_next_tile++)
+			rasterizeTile(tile);
+
+		std::unique_lock<std::mutex> lock(m_work_mutex);
+		m_work_done.wait(lock, [this]() { return m_workers_busy == 0; });
+	}
+
+	void SoftwareRenderer::rasterizeTile(int tile)
+	{
+		int x0 = (tile % m_tiles_x) * tile_size;
+		int y0 = (tile / m_tiles_x) * tile_size;
+		int x1 = std::min(x0 + tile_size, m_width);
+		int y1 = std::min(y0 + tile_size, m_height);
+
+		// the frame is cleared tile by tile, so that clearing is spread over the workers too.
+		for (int y = y0; y < y1; y++)
+		{
+			std::fill(m_frame.begin() + (size_t)y * m_width + x0, m_frame.begin() + (size_t)y * m_width + x1, 0xFF000000);
+			if (m_overdraw_mode)
+				std::fill(m_overdraw.begin() + (size_t)y * m_width + x0, m_overdraw.begin() + (size_t)y * m_width + x1, 0);
+		}
+
+		x0 = std::max(x0, m_scissor.x);
+		y0 = std::max(y0, m_scissor.y);
+		x1 = std::min(x1, m_scissor.z);
+		y1 = std::min(y1, m_scissor.w);
+		m_tile_overdraw[tile] = TileOverdraw();
+		if (x0 >= x1 || y0 >= y1)
+			return;
+
+		for (uint32_t index : m_bins[tile])
+			rasterizeTriangle(m_triangles[index], x0, y0, x1, y1);
+		if (m_overdraw_mode)
+			resolveOverdraw(tile, x0, y0, x1, y1);
+	}
+
+	static uint32_t heatColor(int count)
+	{
+		// the same color ramp as the overdraw shader of the OpenGL renderer.
+		static const glm::vec3 stops[] = {
+			{ 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0.5f, 0 }, { 1, 0, 0 }, { 1, 0.5f, 0.5f }, { 1, 1, 1 } };
+		glm::vec3 color = stops[std::min(count, 8)];
+		return 0xFF000000 | (uint32_t)(color.r * 255.0f + 0.5f) << 16 | (uint32_t)(color.g * 255.0f + 0.5f) << 8 | (uint32_t)(color.b * 255.0f + 0.5f);
+	}
+
+	void SoftwareRenderer::resolveOverdraw(int tile, int x0, int y0, int x1, int y1)
+	{
+		// tiles are owned by a single worker, so the counts of a tile are complete once its triangles are drawn.
+		TileOverdraw & stats = m_tile_overdraw[tile];
+		for (int y = y0; y < y1; y++)
+		{
+			const uint8_t * counts = m_overdraw.data() + (size_t)y * m_width;
+			uint32_t * row = m_frame.data() + (size_t)y * m_width;
+			for (int x = x0; x < x1; x++)
+			{
+				row[x] = heatColor(counts[x]);
+				stats.fragments += counts[x];
+				stats.covered += counts[x] > 0;
+				stats.max = std::max<uint32_t>(stats.max, counts[x]);
+			}
+		}
+	}
+
+	void SoftwareRenderer::rasterizeTriangle(const Triangle & tri, int x0, int y0, int x1, int y1)
+	{
+		const Vertex * v[3] = { &tri.v[0], &tri.v[1], &tri.v[2] };
+		float area = (v[1]->pos.x - v[0]->pos.x) * (v[2]->pos.y - v[0]->pos.y) - (v[1]->pos.y - v[0]->pos.y) * (v[2]->pos.x - v[0]->pos.x);
+		if (area == 0.0f || !std::isfinite(area))
+			return;
+		// edge functions are set up for counter-clockwise triangles (positive area), so that the inside is positive.
+		if (area < 0.0f)
+		{
+			std::swap(v[1], v[2]);
+			area = -area;
+		}
+
+		glm::vec3 edges[3];
+		bool inclusive[3];
+		for (int i = 0; i < 3; i++)
+		{
+			glm::vec2 p = v[i]->pos;
+			glm::vec2 q = v[(i + 1) % 3]->pos;
+			// the edge is set up from its endpoints in a fixed order, so that the triangle on the other side of it gets
+			// exactly the negated edge function, and no pixel along it is drawn by both triangles or by neither.
+			bool reversed = p.x > q.x || (p.x == q.x && p.y > q.y);
+			if (reversed)
+				std::swap(p, q);
+			float a = p.y - q.y, b = q.x - p.x;
+			edges[i] = glm::vec3(a, b, -(a * p.x + b * p.y));
+			if (reversed)
+			{
+				edges[i] = -edges[i];
+				a = -a, b = -b;
+			}
+			// top-left rule: of two triangles sharing an edge, only one owns the pixels exactly on it.
+			inclusive[i] = a > 0.0f || (a == 0.0f && b > 0.0f);
+		}
+
+		const Shade & shade = m_shades[tri.shade];
+		glm::vec3 u_plane, v_plane;
+		if (!shade.constant)
+		{
+			// the barycentric weight of each vertex is the edge function of the opposite edge.
+			u_plane = (v[0]->uv.x * edges[1] + v[1]->uv.x * edges[2] + v[2]->uv.x * edges[0]) / area;
+			v_plane = (v[0]->uv.y * edges[1] + v[1]->uv.y * edges[2] + v[2]->uv.y * edges[0]) / area;
+		}
+
+		float min_y = std::min({ v[0]->pos.y, v[1]->pos.y, v[2]->pos.y });
+		float max_y = std::max({ v[0]->pos.y, v[1]->pos.y, v[2]->pos.y });
+		y0 = std::max(y0, (int)std::floor(std::max(min_y, (float)y0)));
+		y1 = std::min(y1, (int)std::ceil(std::min(max_y, (float)y1)));
+
+		for (int y = y0; y < y1; y++)
+		{
+			float yc = y + 0.5f;
+			int lo = x0, hi = x1 - 1;
+			for (int i = 0; i < 3 && lo <= hi; i++)
+			{
+				float ey = edges[i].y * yc + edges[i].z;
+				float a = edges[i].x;
+				if (a == 0.0f)
+				{
+					if (ey < 0.0f || (ey == 0.0f && !inclusive[i]))
+						hi = lo - 1;
+					continue;
+				}
+				// the pixel center x + 0.5 where the edge function crosses zero, kept within the tile to stay in int range.
+				float bound = glm::clamp(-ey / a - 0.5f, x0 - 1.0f, x1 + 1.0f);
+				if (a > 0.0f)
+					lo = std::max(lo, inclusive[i] ? (int)std::ceil(bound) : (int)std::floor(bound) + 1);
+				else
+					hi = std::min(hi, inclusive[i] ? (int)std::floor(bound) : (int)std::ceil(bound) - 1);
+			}
+			if (lo <= hi)
+				shadeSpan(shade, u_plane, v_plane, lo, hi + 1, y);
+		}
+	}
+
+	void SoftwareRenderer::shadeSpan(const Shade & shade, const glm::vec3 & u_plane, const glm::vec3 & v_plane, int x0, int x1, int y)
+	{
+		if (m_overdraw_mode)
+		{
+			// every covered pixel counts, whatever its color; counts saturate, as in the 8-bit target of the OpenGL renderer.
+			uint8_t * counts = m_overdraw.data() + (size_t)y * m_width;
+			for (int x = x0; x < x1; x++)
+				counts[x] += counts[x] < 255;
+			return;
+		}
+
+		uint32_t * row = m_frame.data() + (size_t)y * m_width;
+		if (shade.constant)
+		{
+			blendSpan(row + x0, x1 - x0, shade.color);
+			return;
+		}
+
+		// the same computation as the fragment shaders of the OpenGL renderer.
+		float yc = y + 0.5f;
+		for (int x = x0; x < x1; x++)
+		{
+			float xc = x + 0.5f;
+			glm::vec2 uv(u_plane.x * xc + u_plane.y * yc + u_plane.z, v_plane.x * xc + v_plane.y * yc + v_plane.z);
+			glm::vec4 color = glm::mix(shade.color1, shade.color2, glm::dot(uv, shade.gradient));
+			if (shade.texture)
+				color *= sampleTexture(*shade.texture, uv.x, uv.y);
+			if (shade.glyph)
+				color.a *= sampleCoverage(*shade.glyph, uv.x, uv.y);
+			blendPixel(row[x], color);
+		}
+	}
+
+	glm::vec2 SoftwareRenderer::toPixels(const glm::mat4 & transform, float x, float y) const
+	{
+		glm::vec4 clip = transform * glm::vec4(x, y, 0.0f, 1.0f);
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		return glm::vec2((ndc.x + 1.0f) * 0.5f * m_width, (1.0f - ndc.y) * 0.5f * m_height);
+	}
+
+	uint32_t SoftwareRenderer::addShade(const glm::vec4 & color1, const glm::vec4 & color2, const glm::vec2 & gradient, const SoftTexture * texture, const SoftGlyph * glyph)
+	{
+		Shade shade;
+		shade.color1 = color1;
+		shade.color2 = color2;
+		shade.gradient = gradient;
+		shade.texture = texture;
+		shade.glyph = glyph;
+		shade.constant = !texture && !glyph && (color1 == color2 || gradient == glm::vec2(0.0f));
+		shade.color = packColor(color1);
+		m_shades.push_back(shade);
+		// each shade is a state change of the OpenGL renderer, so it is counted as a draw call.
+		renderCounters().draw_calls++;
+		return (uint32_t)m_shades.size() - 1;
+	}
+
+	void SoftwareRenderer::addTriangle(const Vertex & v0, const Vertex & v1, const Vertex & v2, uint32_t shade)
+	{
+		Triangle tri;
+		tri.v[0] = v0;
+		tri.v[1] = v1;
+		tri.v[2] = v2;
+		tri.shade = shade;
+		m_triangles.push_back(tri);
+		renderCounters().vertices += 3;
+	}
+
+	void SoftwareRenderer::addSegment(const glm::vec2 & p1, const glm::vec2 & p2, float width, uint32_t shade)
+	{
+		// lines are drawn as quads of the line width, in pixels.
+		glm::vec2 dir = p2 - p1;
+		float length = glm::length(dir);
+		if (length < 1e-6f)
+			return;
+		glm::vec2 offset = glm::vec2(-dir.y, dir.x) * (std::max(width, 1.0f) * 0.5f / length);
+		Vertex a = { p1 + offset, glm::vec2(0.0f) }, b = { p2 + offset, glm::vec2(0.0f) };
+		Vertex c = { p1 - offset, glm::vec2(0.0f) }, d = { p2 - offset, glm::vec2(0.0f) };
+		addTriangle(a, b, c, shade);
+		addTriangle(c, b, d, shade);
+	}
+
+	void SoftwareRenderer::beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor)
+	{
+		m_projection = projection;
+		m_scissor = glm::ivec4(0, 0, m_width, m_height);
+		if (scissor)
+		{
+			// the scissor rectangle is given bottom-up, as for glScissor().
+			glm::ivec4 rect = glm::ivec4(*scissor);
+			m_scissor.x = std::max(rect.x, 0);
+			m_scissor.y = std::max(m_height - (rect.y + rect.w), 0);
+			m_scissor.z = std::min(rect.x + rect.z, m_width);
+			m_scissor.w = std::min(m_height - rect.y, m_height);
+		}
+		m_triangles.clear();
+		m_shades.clear();
+		m_text.clear();
+	}
+
+	void SoftwareRenderer::drawRect(const glm::mat4 & modelview, const Brush & brush)
+	{
+		glm::mat4 transform = m_projection * modelview;
+		glm::vec2 corners[4] = {
+			toPixels(transform, -0.5f, 0.5f),
+			toPixels(transform, 0.5f, 0.5f),
+			toPixels(transform, -0.5f, -0.5f),
+			toPixels(transform, 0.5f, -0.5f)
+		};
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
+		{
+			glm::vec4 color1 = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			glm::vec4 color2 = brush.gradient ? glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+				brush.fill_secondary_color[2], brush.fill_secondary_opacity) : color1;
+			uint32_t shade = addShade(color1, color2, glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v), getTexture(brush.texture));
+
+			Vertex v[4] = {
+				{ corners[0], glm::vec2(0.0f, 1.0f) },
+				{ corners[1], glm::vec2(1.0f, 1.0f) },
+				{ corners[2], glm::vec2(0.0f, 0.0f) },
+				{ corners[3], glm::vec2(1.0f, 0.0f) }
+			};
+			addTriangle(v[0], v[1], v[2], shade);
+			addTriangle(v[2], v[1], v[3], shade);
+		}
+
+		if (brush.outline_opacity > 0.0f)
+		{
+			glm::vec4 color = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			uint32_t shade = addShade(color, color, glm::vec2(0.0f), nullptr);
+			addSegment(corners[0], corners[1], brush.outline_width, shade);
+			addSegment(corners[1], corners[3], brush.outline_width, shade);
+			addSegment(corners[3], corners[2], brush.outline_width, shade);
+			addSegment(corners[2], corners[0], brush.outline_width, shade);
+		}
+	}
+
+	void SoftwareRenderer::drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush)
+	{
+		glm::vec4 color = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+		uint32_t shade = addShade(color, color, glm::vec2(0.0f), nullptr);
+		addSegment(toPixels(m_projection, p1.x, p1.y), toPixels(m_projection, p2.x, p2.y), 1.0f, shade);
+	}
+
+	void SoftwareRenderer::drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush)
+	{
+		glm::mat4 transform = m_projection * modelview;
+		Vertex inner[CURVE_SUBDIVS + 1], outer[CURVE_SUBDIVS + 1];
+		float arc_inc = 3.1415936f*(end_angle - start_angle) / (180.0f*CURVE_SUBDIVS);
+		for (int i = 0; i <= CURVE_SUBDIVS; i++)
+		{
+			float s = i / (float)CURVE_SUBDIVS;
+			float angle = 3.1415936f*start_angle / 180.f + i * arc_inc;
+			inner[i] = { toPixels(transform, radius1 * cos(angle), radius1 * -sin(angle)), glm::vec2(s, 0.0f) };
+			outer[i] = { toPixels(transform, radius2 * cos(angle), radius2 * -sin(angle)), glm::vec2(s, 1.0f) };
+		}
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
+		{
+			glm::vec4 color1 = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			glm::vec4 color2 = brush.gradient ? glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+				brush.fill_secondary_color[2], brush.fill_secondary_opacity) : color1;
+			uint32_t shade = addShade(color1, color2, glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v), getTexture(brush.texture));
+			for (int i = 0; i < CURVE_SUBDIVS; i++)
+			{
+				addTriangle(inner[i], outer[i], inner[i + 1], shade);
+				addTriangle(inner[i + 1], outer[i], outer[i + 1], shade);
+			}
+		}
+
+		if (brush.outline_opacity > 0.0f)
+		{
+			glm::vec4 color = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			uint32_t shade = addShade(color, color, glm::vec2(0.0f), nullptr);
+			for (int i = 0; i < CURVE_SUBDIVS; i++)
+				addSegment(outer[i].pos, outer[i + 1].pos, brush.outline_width, shade);
+			// a full circle only has its outer rim outlined.
+			if (fabs(end_angle - start_angle - 360.0f) > 0.000f)
+			{
+				for (int i = 0; i < CURVE_SUBDIVS; i++)
+					addSegment(inner[i].pos, inner[i + 1].pos, brush.outline_width, shade);
+				addSegment(inner[0].pos, outer[0].pos, brush.outline_width, shade);
+				addSegment(inner[CURVE_SUBDIVS].pos, outer[CURVE_SUBDIVS].pos, brush.outline_width, shade);
+			}
+		}
+	}
+
+	void SoftwareRenderer::drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color)
+	{
+		if (count <= 0)
+			return;
+		uint32_t shade = addShade(color, color, glm::vec2(0.0f), nullptr);
+		for (int i = 0; i < count; i++)
+		{
+			const glm::vec4 & q = quads[i];
+			Vertex v[4] = {
+				{ toPixels(m_projection, q.x, q.y), glm::vec2(0.0f) },
+				{ toPixels(m_projection, q.z, q.y), glm::vec2(0.0f) },
+				{ toPixels(m_projection, q.x, q.w), glm::vec2(0.0f) },
+				{ toPixels(m_projection, q.z, q.w), glm::vec2(0.0f) }
+			};
+			addTriangle(v[0], v[1], v[2], shade);
+			addTriangle(v[2], v[1], v[3], shade);
+		}
+	}
+
+	bool SoftwareRenderer::initFontLibrary()
+	{
+		// same as FontLib::initLibrary(): safe to call from the warm-up thread.
+		std::call_once(m_ft_once, [this]()
+		{
+#ifdef SGG_TRACK_ALLOCATIONS
+			m_ft_ready = !FT_New_Library(AllocationTracker::getFreeTypeMemory(), &m_ft);
+			if (m_ft_ready)
+				FT_Add_Default_Modules(m_ft);
+#else
+			m_ft_ready = !FT_Init_FreeType(&m_ft);
+#endif
+		});
+		return m_ft_ready;
+	}
+
+	bool SoftwareRenderer::initFonts()
+	{
+		if (!initFontLibrary())
+			return false;
+		m_fonts_initialized = true;
+		return true;
+	}
+
+	bool SoftwareRenderer::setFont(const std::string & fontname)
+	{
+		auto iter = m_fonts.find(fontname);
+		if (iter != m_fonts.end())
+		{
+			m_current_font = &iter->second;
+			return true;
+		}
+
+		SoftFont font;
+		if (FT_New_Face(m_ft, fontname.c_str(), 0, &font.face))
+		{
+			m_current_font = nullptr;
+			return false;
+		}
+		FT_Set_Pixel_Sizes(font.face, 0, glyph_resolution);
+		font.name = fontname;
+		m_current_font = &m_fonts.emplace(fontname, std::move(font)).first->second;
+		MemoryRegistry::get().track(this, MEMORY_FONTS, fontname, 0, 0);
+		return true;
+	}
+
+	void SoftwareRenderer::drawText(const TextRecord & text)
+	{
+		if (!m_fonts_initialized || !m_current_font)
+			return;
+		PendingText entry;
+		entry.record = text;
+		entry.font = m_current_font;
+		m_text.push_back(entry);
+	}
+
+	const SoftGlyph * SoftwareRenderer::getGlyph(SoftFont & font, unsigned char c)
+	{
+		renderCounters().glyphs++;
+		auto iter = font.glyphs.find(c);
+		if (iter != font.glyphs.end())
+			return &iter->second;
+		renderCounters().glyph_cache_misses++;
+
+		if (FT_Load_Char(font.face, c, FT_LOAD_RENDER))
+			return nullptr;
+		FT_GlyphSlot g = font.face->glyph;
+		SoftGlyph glyph;
+		glyph.width = g->bitmap.width;
+		glyph.rows = g->bitmap.rows;
+		glyph.bearing_y = (float)g->metrics.horiBearingY;
+		glyph.advance_y = (float)g->advance.y;
+		glyph.coverage.resize((size_t)glyph.width * glyph.rows);
+		for (int row = 0; row < glyph.rows; row++)
+			std::copy(g->bitmap.buffer + row * g->bitmap.pitch, g->bitmap.buffer + row * g->bitmap.pitch + glyph.width,
+				glyph.coverage.begin() + (size_t)row * glyph.width);
+		font.cache_bytes += sizeof(SoftGlyph) + glyph.coverage.size();
+		MemoryRegistry::get().track(this, MEMORY_FONTS, font.name, font.cache_bytes, 0);
+		return &font.glyphs.emplace(c, std::move(glyph)).first->second;
+	}
+
+	void SoftwareRenderer::drawPendingText(const PendingText & text)
+	{
+		// the same glyph layout as FontLib::drawText().
+		const TextRecord & entry = text.record;
+		glm::mat4 transform = entry.proj * glm::translate(glm::vec3(entry.pos.x, entry.pos.y, 0.0f)) * entry.mv;
+		float x = 0.0f;
+		float y = 0.0f;
+		for (const char * p = entry.text; *p; p++)
+		{
+			const SoftGlyph * glyph = getGlyph(*text.font, (unsigned char)*p);
+			if (!glyph)
+				continue;
+
+			float w = entry.size.x * glyph->width / (float)glyph_resolution;
+			float h = entry.size.y * glyph->rows / (float)glyph_resolution;
+			float b = glyph->bearing_y / (64 * (float)glyph_resolution)*entry.size.y - h;
+
+			if (glyph->width > 0 && glyph->rows > 0)
+			{
+				uint32_t shade = addShade(entry.color1, entry.use_gradient ? entry.color2 : entry.color1, entry.gradient, nullptr, glyph);
+				Vertex v[4] = {
+					{ toPixels(transform, x, y - b), glm::vec2(0.0f, 1.0f) },
+					{ toPixels(transform, x + w, y - b), glm::vec2(1.0f, 1.0f) },
+					{ toPixels(transform, x, y - h - b), glm::vec2(0.0f, 0.0f) },
+					{ toPixels(transform, x + w, y - h - b), glm::vec2(1.0f, 0.0f) }
+				};
+				addTriangle(v[0], v[1], v[2], shade);
+				addTriangle(v[2], v[1], v[3], shade);
+			}
+			x += std::max(w + entry.size.x*0.05f, entry.size.x*0.15f);
+			y += entry.size.y*1.1f*glyph->advance_y;
+		}
+	}
+
+	size_t SoftwareRenderer::getTextureMemory() const
+	{
+		size_t bytes = 0;
+		for (const auto & texture : m_textures)
+			bytes += texture.second.texels.size() * sizeof(uint32_t);
+		return bytes;
+	}
+
+	const SoftTexture * SoftwareRenderer::getTexture(const std::string & filename)
+	{
+		if (filename.empty())
+			return nullptr;
+		auto iter = m_textures.find(filename);
+		if (iter == m_textures.end())
+		{
+			SGG_PROFILE_SCOPE("load texture");
+			// failed loads are cached as well, so that a missing file is only looked up once.
+			SoftTexture texture;
+			std::vector<unsigned char> rgba;
+			unsigned int width, height;
+			if (!lodepng::decode(rgba, width, height, filename.c_str()))
+			{
+				texture.width = width;
+				texture.height = height;
+				texture.texels.resize((size_t)width * height);
+				for (size_t i = 0; i < texture.texels.size(); i++)
+					texture.texels[i] = ((uint32_t)rgba[4 * i + 3] << 24) | ((uint32_t)rgba[4 * i] << 16) | ((uint32_t)rgba[4 * i + 1] << 8) | rgba[4 * i + 2];
+			}
+			iter = m_textures.emplace(filename, std::move(texture)).first;
+			if (iter->second.width > 0)
+				MemoryRegistry::get().track(this, MEMORY_TEXTURES, filename, iter->second.texels.size() * sizeof(uint32_t), 0);
+		}
+		return iter->second.width > 0 ? &iter->second : nullptr;
+	}
+
+	void SoftwareRenderer::binTriangles()
+	{
+		for (auto & bin : m_bins)
+			bin.clear();
+
+		for (uint32_t index = 0; index < (uint32_t)m_triangles.size(); index++)
+		{
+			const Triangle & tri = m_triangles[index];
+			glm::vec2 lo = glm::min(glm::min(tri.v[0].pos, tri.v[1].pos), tri.v[2].pos);
+			glm::vec2 hi = glm::max(glm::max(tri.v[0].pos, tri.v[1].pos), tri.v[2].pos);
+			if (!(lo.x < m_scissor.z && lo.y < m_scissor.w && hi.x > m_scissor.x && hi.y > m_scissor.y))
+				continue;
+			int tx0 = (int)std::max(lo.x, (float)m_scissor.x) / tile_size;
+			int ty0 = (int)std::max(lo.y, (float)m_scissor.y) / tile_size;
+			int tx1 = ((int)std::ceil(std::min(hi.x, (float)m_scissor.z)) - 1) / tile_size;
+			int ty1 = ((int)std::ceil(std::min(hi.y, (float)m_scissor.w)) - 1) / tile_size;
+			for (int ty = ty0; ty <= ty1; ty++)
+				for (int tx = tx0; tx <= tx1; tx++)
+					m_bins[ty * m_tiles_x + tx].push_back(index);
+		}
+	}
+
+	void SoftwareRenderer::endFrame()
+	{
+		{
+			SGG_PROFILE_SCOPE("text");
+			// text is drawn on top of all shapes, as in the OpenGL renderer.
+			for (const PendingText & text : m_text)
+				drawPendingText(text);
+			m_text.clear();
+		}
+
+		{
+			SGG_PROFILE_SCOPE("bin triangles");
+			binTriangles();
+		}
+		rasterizeTiles();
+		m_triangles.clear();
+		m_shades.clear();
+
+		if (m_overdraw_mode)
+		{
+			TileOverdraw total;
+			for (const TileOverdraw & tile : m_tile_overdraw)
+			{
+				total.fragments += tile.fragments;
+				total.covered += tile.covered;
+				total.max = std::max(total.max, tile.max);
+			}
+			size_t pixels = (size_t)std::max(m_scissor.z - m_scissor.x, 0) * std::max(m_scissor.w - m_scissor.y, 0);
+			m_overdraw_stats.average = pixels ? total.fragments / (float)pixels : 0.0f;
+			m_overdraw_stats.coverage = pixels ? total.covered / (float)pixels : 0.0f;
+			m_overdraw_stats.max = total.max;
+			m_overdraw_ready = true;
+		}
+	}
+
+	void SoftwareRenderer::present()
+	{
+		if (m_offscreen_mode)
+			return;
+		SDL_Surface * surface = SDL_GetWindowSurface(m_window);
+		if (!surface)
+			return;
+
+		// the surface follows the window size, which may be ahead of the frame until the resize is processed.
+		int width = std::min(m_width, surface->w);
+		int height = std::min(m_height, surface->h);
+		if (SDL_MUSTLOCK(surface))
+			SDL_LockSurface(surface);
+		SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_ARGB8888, m_frame.data(), m_width * 4,
+			surface->format->format, surface->pixels, surface->pitch);
+		if (SDL_MUSTLOCK(surface))
+			SDL_UnlockSurface(surface);
+		SDL_UpdateWindowSurface(m_window);
+	}
+
+	bool SoftwareRenderer::readPixels(std::vector<unsigned char> & pixels, int & width, int & height)
+	{
+		width = m_width;
+		height = m_height;
+		pixels.resize(m_frame.size() * 4);
+		for (size_t i = 0; i < m_frame.size(); i++)
+		{
+			uint32_t color = m_frame[i];
+			pixels[4 * i + 0] = (color >> 16) & 0xFF;
+			pixels[4 * i + 1] = (color >> 8) & 0xFF;
+			pixels[4 * i + 2] = color & 0xFF;
+			pixels[4 * i + 3] = 255;
+		}
+		return true;
+	}
+
+	bool SoftwareRenderer::setOverdrawMode(bool enable)
+	{
+		m_overdraw_mode = enable;
+		m_overdraw_ready = false;
+		if (enable)
+		{
+			m_overdraw.assign((size_t)m_width * m_height, 0);
+			MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "overdraw counts", m_overdraw.capacity(), 0);
+		}
+		else
+		{
+			std::vector<uint8_t>().swap(m_overdraw);
+			MemoryRegistry::get().untrack(this, "overdraw counts");
+		}
+		return true;
+	}
+
+	bool SoftwareRenderer::getOverdrawStats(OverdrawStats & stats) const
+	{
+		if (!m_overdraw_mode || !m_overdraw_ready)
+			return false;
+		stats = m_overdraw_stats;
+		return true;
+	}
+
+	Renderer * createRenderer(renderer_t type)
+	{
+		if (type == RENDERER_SOFTWARE)
+			return new SoftwareRenderer();
+		if (type == RENDERER_VULKAN)
+		{
+#ifdef SGG_VULKAN
+			return new VulkanRenderer();
+#else
+			return nullptr;
+#endif
+		}
+		return new GLRenderer();
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include <sgg/renderer.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace graphics
+{
+	/** A decoded bitmap, kept in the same layout as the pixels of the frame buffer.
+	*/
+	struct SoftTexture
+	{
+		int width = 0,
+			height = 0;
+		std::vector<uint32_t> texels;  // 0xAARRGGBB, rows top to bottom.
+	};
+
+	/** A rasterized glyph of a font, rendered at the glyph resolution of the renderer.
+	*/
+	struct SoftGlyph
+	{
+		int width = 0,
+			rows = 0;
+		float bearing_y = 0.0f;  // in 26.6 fixed point units, as reported by FreeType.
+		float advance_y = 0.0f;
+		std::vector<uint8_t> coverage;
+	};
+
+	struct SoftFont
+	{
+		std::string name;
+		size_t cache_bytes = 0;
+		FT_Face face = nullptr;
+		std::unordered_map<unsigned char, SoftGlyph> glyphs;
+	};
+
+	/** A renderer that draws on the CPU, for systems without a usable OpenGL driver.
+
+		All primitives are converted to triangles in pixel coordinates as they are submitted. When the frame ends,
+		the triangles are binned into square tiles of the frame buffer and the tiles are rasterized in parallel by a
+		pool of worker threads. Each tile is drawn by a single thread, in submission order, so that blending gives the
+		same result as drawing the triangles one by one. Triangles are scan-converted into horizontal spans; spans of
+		a constant color (the bulk of most frames) are blended with SIMD instructions, while gradients, textures and
+		glyphs are shaded per pixel, mirroring the shaders of the OpenGL renderer.
+
+		The frame is presented by copying it to the surface of the window, so no graphics driver is involved at all.
+	*/
+	class SoftwareRenderer : public Renderer
+	{
+		static constexpr int tile_size = 64;
+		static constexpr int glyph_resolution = 64;
+
+		struct Vertex
+		{
+			glm::vec2 pos;  // in pixels, from the top-left corner of the frame buffer.
+			glm::vec2 uv;
+		};
+
+		struct Shade
+		{
+			uint32_t color = 0;  // the color of constant spans, 0xAARRGGBB.
+			bool constant = true;
+			glm::vec4 color1;
+			glm::vec4 color2;
+			glm::vec2 gradient;
+			const SoftTexture * texture = nullptr;
+			const SoftGlyph * glyph = nullptr;
+		};
+
+		struct Triangle
+		{
+			Vertex v[3];
+			uint32_t shade;
+		};
+
+		struct PendingText
+		{
+			TextRecord record;
+			SoftFont * font;
+		};
+
+		SDL_Window *  m_window = nullptr;
+		bool		  m_offscreen_mode = false;
+		int			  m_width = 0,
+					  m_height = 0;
+		int			  m_tiles_x = 0,
+					  m_tiles_y = 0;
+		std::vector<uint32_t> m_frame;
+
+		// overdraw mode: spans add to the fragment counts of their pixels, which are turned into a heat map per tile.
+		struct TileOverdraw
+		{
+			uint64_t fragments = 0;
+			uint32_t covered = 0;
+			uint32_t max = 0;
+		};
+		bool		  m_overdraw_mode = false;
+		std::vector<uint8_t> m_overdraw;
+		std::vector<TileOverdraw> m_tile_overdraw;
+		OverdrawStats m_overdraw_stats;
+		bool		  m_overdraw_ready = false;
+
+		glm::mat4	  m_projection = glm::mat4(1.0f);
+		glm::ivec4	  m_scissor;  // in pixels, as min x, min y, max x, max y (exclusive), rows top to bottom.
+
+		std::vector<Triangle> m_triangles;
+		std::vector<Shade> m_shades;
+		std::vector<std::vector<uint32_t>> m_bins;
+		std::vector<PendingText> m_text;
+
+		std::unordered_map<std::string, SoftTexture> m_textures;
+
+		FT_Library	  m_ft = nullptr;
+		std::once_flag m_ft_once;
+		std::atomic<bool> m_ft_ready { false };
+		bool		  m_fonts_initialized = false;
+		std::unordered_map<std::string, SoftFont> m_fonts;
+		SoftFont *	  m_current_font = nullptr;
+
+		std::vector<std::thread> m_workers;
+		std::mutex	  m_work_mutex;
+		std::condition_variable m_work_start;
+		std::condition_variable m_work_done;
+		uint64_t	  m_work_generation = 0;
+		int			  m_workers_busy = 0;
+		bool		  m_stop_workers = false;
+		std::atomic<int> m_next_tile { 0 };
+
+		void startWorkers();
+		void stopWorkers();
+		void workerLoop();
+		void rasterizeTiles();
+		void rasterizeTile(int tile);
+		void rasterizeTriangle(const Triangle & tri, int x0, int y0, int x1, int y1);
+		void resolveOverdraw(int tile, int x0, int y0, int x1, int y1);
+		void shadeSpan(const Shade & shade, const glm::vec3 & u_plane, const glm::vec3 & v_plane, int x0, int x1, int y);
+
+		glm::vec2 toPixels(const glm::mat4 & transform, float x, float y) const;
+		uint32_t addShade(const glm::vec4 & color1, const glm::vec4 & color2, const glm::vec2 & gradient, const SoftTexture * texture, const SoftGlyph * glyph = nullptr);
+		void addTriangle(const Vertex & v0, const Vertex & v1, const Vertex & v2, uint32_t shade);
+		void addSegment(const glm::vec2 & p1, const glm::vec2 & p2, float width, uint32_t shade);
+		void binTriangles();
+		void drawPendingText(const PendingText & text);
+
+		const SoftTexture * getTexture(const std::string & filename);
+		const SoftGlyph * getGlyph(SoftFont & font, unsigned char c);
+
+	public:
+		renderer_t getType() const override { return RENDERER_SOFTWARE; }
+		Uint32 getWindowFlags(bool) const override { return 0; }
+
+		bool init(SDL_Window * window, int width, int height, bool offscreen) override;
+		void release() override;
+		void makeCurrent() override {}
+		void resize(int width, int height) override;
+
+		void beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor) override;
+		void drawRect(const glm::mat4 & modelview, const Brush & brush) override;
+		void drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush) override;
+		void drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush) override;
+		void drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color) override;
+
+		bool initFontLibrary() override;
+		bool isFontLibraryReady() const override { return m_ft_ready; }
+		bool initFonts() override;
+		bool areFontsInitialized() const override { return m_fonts_initialized; }
+		bool setFont(const std::string & fontname) override;
+		void drawText(const TextRecord & text) override;
+
+		bool preloadTexture(const std::string & filename) override { return getTexture(filename) != nullptr; }
+		size_t getTextureMemory() const override;
+
+		void endFrame() override;
+		void present() override;
+		bool readPixels(std::vector<unsigned char> & pixels, int & width, int & height) override;
+
+		bool setOverdrawMode(bool enable) override;
+		bool getOverdrawStats(OverdrawStats & stats) const override;
+
+		~SoftwareRenderer();
+	};
+}
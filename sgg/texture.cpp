@@ -1,4 +1,6 @@
 #include <sgg/texture.h>
+#include <sgg/graphics.h>
+#include <sgg/memregistry.h>
 #include <sgg/lodepng.h>
 #include <vector>
 #include <cmath>
@@ -61,6 +63,7 @@ void graphics::Texture::buildGLTexture()
 
 graphics::Texture::Texture(const std::string & filename)
 {
+	SGG_PROFILE_SCOPE("TextureManager::loadTexture");
 	m_filename = filename;
 	if (!load(filename))
 		return;
@@ -68,7 +71,7 @@ graphics::Texture::Texture(const std::string & filename)
 	buildGLTexture();
 }
 
-GLuint graphics::TextureManager::getTexture(std::string file)
+GLuint graphics::TextureManager::getTexture(const std::string & file)
 {
 	auto iter = textures.find(file);
 	if (iter != textures.end())
@@ -77,9 +80,29 @@ GLuint graphics::TextureManager::getTexture(std::string file)
 	}
 	else
 	{
-		std::pair<std::string, Texture> texinfo = std::make_pair(file, Texture(file));
-		textures.insert(texinfo);
-		return texinfo.second.getID();
+		iter = textures.insert(std::make_pair(file, Texture(file))).first;
+		if (iter->second.getID())
+			MemoryRegistry::get().track(this, MEMORY_TEXTURES, file, iter->second.getHostMemory(), iter->second.getDeviceMemory());
+		return iter->second.getID();
 	}
 	
 }
+
+size_t graphics::Texture::getDeviceMemory() const
+{
+	// RGBA8 texels, plus a third for the mipmap chain.
+	return m_id ? (size_t)m_width * m_height * 4 * 4 / 3 : 0;
+}
+
+size_t graphics::TextureManager::getDeviceMemory() const
+{
+	size_t bytes = 0;
+	for (const auto & texture : textures)
+		bytes += texture.second.getDeviceMemory();
+	return bytes;
+}
+
+graphics::TextureManager::~TextureManager()
+{
+	MemoryRegistry::get().untrackAll(this);
+}
@@ -1,5 +1,5 @@
 #pragma once
-#include <GL/glew.h>
+#include <sgg/gltrace.h>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,7 +11,7 @@ namespace graphics
 	private:
 		GLuint m_id = 0;
 		std::string	m_filename;
-		unsigned int m_width, m_height;
+		unsigned int m_width = 0, m_height = 0;
 		unsigned int m_channels;
 		std::vector<unsigned char> m_buffer;
 		bool m_ready = false;
@@ -20,9 +20,11 @@ namespace graphics
 		void buildGLTexture();
 	public:
 		Texture(const std::string & filename);
-		GLuint getID() { return m_id; }
-		int getWidth() { return m_width; }
-		int getHeight() { return m_height; }
+		GLuint getID() const { return m_id; }
+		int getWidth() const { return m_width; }
+		int getHeight() const { return m_height; }
+		size_t getHostMemory() const { return m_buffer.capacity(); }
+		size_t getDeviceMemory() const;
 		
 	};
 
@@ -31,6 +33,8 @@ namespace graphics
 	private:
 		std::unordered_map<std::string, Texture> textures;
 	public:
-		GLuint getTexture(std::string file);
+		GLuint getTexture(const std::string & file);
+		size_t getDeviceMemory() const;
+		~TextureManager();
 	};
 }
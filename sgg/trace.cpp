@@ -0,0 +1,279 @@
+#include <sgg/trace.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace graphics
+{
+	struct TraceEvent
+	{
+		const char * name;
+		uint64_t start;
+		uint64_t duration;  // instant_event for instantaneous events.
+	};
+
+	struct TraceBuffer
+	{
+		std::unique_ptr<TraceEvent[]> events;
+		std::atomic<uint32_t> count { 0 };
+		std::atomic<uint32_t> dropped { 0 };
+		std::atomic<uint64_t> epoch { 0 };
+		std::atomic<const char *> name { nullptr };
+		std::atomic<bool> retired { false };
+		unsigned int tid = 0;
+	};
+
+	namespace
+	{
+		constexpr uint64_t instant_event = ~0ull;
+
+		std::mutex g_registry_mutex;
+		std::vector<std::unique_ptr<TraceBuffer>> g_buffers;
+		std::atomic<uint64_t> g_epoch { 0 };
+		uint64_t g_trace_start = 0;
+
+		// marks the buffer of the thread as reusable when the thread exits.
+		struct ThreadBuffer
+		{
+			TraceBuffer * buffer = nullptr;
+			const char * name = nullptr;
+			~ThreadBuffer()
+			{
+				if (buffer)
+					buffer->retired = true;
+			}
+		};
+
+		thread_local ThreadBuffer t_buffer;
+
+		TraceBuffer * acquireBuffer(const char * name)
+		{
+			std::lock_guard<std::mutex> lock(g_registry_mutex);
+			uint64_t epoch = g_epoch.load();
+			TraceBuffer * buffer = nullptr;
+			for (auto & candidate : g_buffers)
+				if (candidate->retired && candidate->epoch != epoch)
+				{
+					buffer = candidate.get();
+					break;
+				}
+			if (!buffer)
+			{
+				g_buffers.emplace_back(new TraceBuffer());
+				buffer = g_buffers.back().get();
+				buffer->events.reset(new TraceEvent[Tracer::events_per_thread]);
+				buffer->tid = (unsigned int)g_buffers.size();
+			}
+			buffer->retired = false;
+			buffer->name = name;
+			buffer->count = 0;
+			buffer->dropped = 0;
+			buffer->epoch = epoch;
+			return buffer;
+		}
+
+		TraceBuffer * threadBuffer()
+		{
+			TraceBuffer * buffer = t_buffer.buffer;
+			if (!buffer)
+				return t_buffer.buffer = acquireBuffer(t_buffer.name);
+
+			// a new trace has started: only the owning thread resets its buffer.
+			uint64_t epoch = g_epoch.load(std::memory_order_acquire);
+			if (buffer->epoch.load(std::memory_order_relaxed) != epoch)
+			{
+				buffer->count.store(0, std::memory_order_relaxed);
+				buffer->dropped.store(0, std::memory_order_relaxed);
+				buffer->epoch.store(epoch, std::memory_order_release);
+			}
+			return buffer;
+		}
+
+		void record(const char * name, uint64_t start, uint64_t duration)
+		{
+			TraceBuffer * buffer = threadBuffer();
+			uint32_t index = buffer->count.load(std::memory_order_relaxed);
+			if (index >= Tracer::events_per_thread)
+			{
+				buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			buffer->events[index] = { name, start, duration };
+			buffer->count.store(index + 1, std::memory_order_release);
+		}
+
+		void writeString(std::ofstream & out, const char * str)
+		{
+			out << '"';
+			for (const char * c = str ? str : ""; *c; c++)
+			{
+				if (*c == '"' || *c == '\\')
+					out << '\\' << *c;
+				else if ((unsigned char)*c >= 0x20)
+					out << *c;
+			}
+			out << '"';
+		}
+	}
+
+	std::atomic<bool> Tracer::s_enabled { false };
+
+	bool Tracer::isAvailable()
+	{
+#ifdef SGG_TRACING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void Tracer::setEnabled(bool enabled)
+	{
+		if (!isAvailable())
+		{
+			if (enabled)
+				std::cout << "Tracing is not available: the library was built without SGG_TRACING\n";
+			return;
+		}
+		std::lock_guard<std::mutex> lock(g_registry_mutex);
+		if (enabled && !s_enabled)
+		{
+			g_trace_start = now();
+			g_epoch.fetch_add(1, std::memory_order_release);
+		}
+		s_enabled = enabled;
+	}
+
+	uint64_t Tracer::now()
+	{
+		static const auto base = std::chrono::steady_clock::now();
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - base).count();
+	}
+
+	void Tracer::recordScope(const char * name, uint64_t start, uint64_t end)
+	{
+		record(name, start, end - start);
+	}
+
+	void Tracer::recordInstant(const char * name)
+	{
+		record(name, now(), instant_event);
+	}
+
+	void Tracer::setThreadName(const char * name)
+	{
+		t_buffer.name = name;
+		if (t_buffer.buffer)
+			t_buffer.buffer->name = name;
+	}
+
+	TraceBuffer * Tracer::reserveBuffer(const char * thread_name)
+	{
+		return acquireBuffer(thread_name);
+	}
+
+	void Tracer::useBuffer(TraceBuffer * buffer)
+	{
+		if (t_buffer.buffer == buffer)
+			return;
+		if (t_buffer.buffer)
+			t_buffer.buffer->retired = true;
+		t_buffer.buffer = buffer;
+		t_buffer.name = buffer->name;
+	}
+
+	void Tracer::releaseBuffer(TraceBuffer * buffer)
+	{
+		buffer->retired = true;
+	}
+
+	bool Tracer::save(const std::string & filename)
+	{
+		if (!isAvailable())
+		{
+			std::cout << "Tracing is not available: the library was built without SGG_TRACING\n";
+			return false;
+		}
+
+		std::ofstream out(filename, std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "Unable to write trace " << filename << "\n";
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(g_registry_mutex);
+		uint64_t epoch = g_epoch.load(std::memory_order_acquire);
+		uint64_t dropped = 0;
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		out << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"sgg\"}}";
+		for (auto & buffer : g_buffers)
+		{
+			if (buffer->epoch.load(std::memory_order_acquire) != epoch)
+				continue;
+			uint32_t count = buffer->count.load(std::memory_order_acquire);
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+			out << ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+			const char * name = buffer->name;
+			if (name)
+				writeString(out, name);
+			else
+				out << "\"thread " << buffer->tid << "\"";
+			out << "}}";
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const TraceEvent & event = buffer->events[i];
+				// events of the previous trace that were still in flight when it was restarted.
+				if (event.start < g_trace_start)
+					continue;
+				out << ",\n{\"name\":";
+				writeString(out, event.name);
+				out << ",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":" << (event.start - g_trace_start) / 1000.0;
+				if (event.duration == instant_event)
+					out << ",\"ph\":\"i\",\"s\":\"t\"}";
+				else
+					out << ",\"ph\":\"X\",\"dur\":" << event.duration / 1000.0 << "}";
+			}
+		}
+		out << "\n]}\n";
+
+		if (dropped)
+			std::cout << "Trace " << filename << ": " << dropped << " events were dropped, as thread buffers were full\n";
+		if (!out)
+		{
+			std::cout << "Unable to write trace " << filename << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	TraceScope::TraceScope(const char * name)
+		: m_name(name), m_start(Tracer::isEnabled() ? Tracer::now() : 0)
+	{
+	}
+
+	TraceScope::~TraceScope()
+	{
+		// scopes that started before tracing was enabled are not recorded.
+		if (m_start && Tracer::isEnabled())
+			Tracer::recordScope(m_name, m_start, Tracer::now());
+	}
+
+	void traceEvent(const char * name)
+	{
+		if (Tracer::isEnabled())
+			Tracer::recordInstant(name);
+	}
+
+	void setTraceThreadName(const char * name)
+	{
+		Tracer::setThreadName(name);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <sgg/graphics.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace graphics
+{
+	struct TraceBuffer;
+
+	/** Collects the timeline of scopes recorded with SGG_PROFILE_SCOPE() by all threads and exports it as a Chrome trace.
+
+		Each thread writes to a buffer of its own, which is allocated on its first event of a trace and registered
+		in a global list; the lock of the list is only taken for that, and when saving. An event is published by
+		storing it past the end of the buffer and then advancing the event count with release semantics, so that a
+		concurrent save sees only complete events. Buffers never grow, so a full buffer drops further events.
+
+		Starting a trace advances the trace epoch. Each thread notices the new epoch on its next event and resets its
+		own buffer, so buffers are never reset under the feet of their writers. Buffers of threads that have exited are
+		reused by new threads once their events no longer belong to the current trace.
+
+		Threads that must neither lock nor allocate, such as the audio callback, get a buffer reserved for them in
+		advance with reserveBuffer(), and adopt it with useBuffer() before recording any event.
+	*/
+	class Tracer
+	{
+		static std::atomic<bool> s_enabled;
+	public:
+		static constexpr uint32_t events_per_thread = 1 << 16;
+
+		static bool isAvailable();
+		static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+		static void setEnabled(bool enabled);
+
+		/** The current time in nanoseconds, on the clock used for the events.
+		*/
+		static uint64_t now();
+		static void recordScope(const char * name, uint64_t start, uint64_t end);
+		static void recordInstant(const char * name);
+		static void setThreadName(const char * name);
+
+		/** Allocates and registers a buffer for a thread that will adopt it with useBuffer(). The buffer stays reserved
+			until the adopting thread exits or releaseBuffer() is called.
+		*/
+		static TraceBuffer * reserveBuffer(const char * thread_name);
+		static void useBuffer(TraceBuffer * buffer);
+		static void releaseBuffer(TraceBuffer * buffer);
+		static bool save(const std::string & filename);
+	};
+}
@@ -0,0 +1,1560 @@
+#ifdef SGG_VULKAN
+#include <sgg/vkrenderer.h>
+#include <sgg/glrenderer.h>
+#include <sgg/alloctrack.h>
+#include <sgg/profiler.h>
+#include <sgg/memregistry.h>
+#include <sgg/lodepng.h>
+#include <SDL2/SDL_vulkan.h>
+#include FT_MODULE_H
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace graphics
+{
+	// SPIR-V of sgg/shaders/vulkan.vert and vulkan.frag, compiled with glslc by the build.
+	static const uint32_t vertex_shader_code[] = {
+#include <sgg/shaders/vulkan.vert.inc>
+	};
+
+	static const uint32_t fragment_shader_code[] = {
+#include <sgg/shaders/vulkan.frag.inc>
+	};
+
+	static_assert(sizeof(float[4]) == 16, "vertices are streamed as 4 floats");
+
+	static void imageBarrier(VkCommandBuffer commands, VkImage image, VkImageLayout from, VkImageLayout to,
+		VkPipelineStageFlags src_stage, VkAccessFlags src_access, VkPipelineStageFlags dst_stage, VkAccessFlags dst_access,
+		uint32_t base_level = 0, uint32_t levels = 1)
+	{
+		VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+		barrier.srcAccessMask = src_access;
+		barrier.dstAccessMask = dst_access;
+		barrier.oldLayout = from;
+		barrier.newLayout = to;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, base_level, levels, 0, 1 };
+		vkCmdPipelineBarrier(commands, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	bool VulkanRenderer::init(SDL_Window * window, int width, int height, bool offscreen)
+	{
+		m_window = window;
+		m_width = std::max(width, 1);
+		m_height = std::max(height, 1);
+		m_offscreen_mode = offscreen;
+
+		if (!createInstance() || !selectDevice() || !createDevice())
+			return false;
+		if (!createRenderPass() || !createPipelines() || !createTarget())
+			return false;
+		if (!m_offscreen_mode && !createSwapchain())
+			return false;
+
+		for (Frame & frame : m_frames)
+		{
+			VkCommandBufferAllocateInfo alloc = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			alloc.commandPool = m_command_pool;
+			alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			alloc.commandBufferCount = 1;
+			// fences start signaled, as no frame is in flight yet.
+			VkFenceCreateInfo fence = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+			fence.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+			VkSemaphoreCreateInfo semaphore = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			if (vkAllocateCommandBuffers(m_device, &alloc, &frame.commands) != VK_SUCCESS ||
+				vkCreateFence(m_device, &fence, nullptr, &frame.done) != VK_SUCCESS ||
+				vkCreateSemaphore(m_device, &semaphore, nullptr, &frame.image_acquired) != VK_SUCCESS)
+			{
+				std::cout << "Unable to create the Vulkan frame resources\n";
+				return false;
+			}
+		}
+
+		float vertices[9][4] = {
+			// the rectangle, as a triangle strip
+			{ -0.5f, 0.5f, 0, 1 },
+			{ 0.5f, 0.5f, 1, 1 },
+			{ -0.5f, -0.5f, 0, 0 },
+			{ 0.5f, -0.5f, 1, 0 },
+			// its outline, as a closed line strip
+			{ -0.5f, 0.5f, 0, 0 },
+			{ 0.5f, 0.5f, 1, 0 },
+			{ 0.5f, -0.5f, 1, 1 },
+			{ -0.5f, -0.5f, 0, 1 },
+			{ -0.5f, 0.5f, 0, 0 }
+		};
+		if (!createHostBuffer(m_static_vertices, sizeof vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
+			return false;
+		memcpy(m_static_vertices.data, vertices, sizeof vertices);
+		MemoryRegistry::get().track(this, MEMORY_GEOMETRY, "rectangle vertices", 0, sizeof vertices);
+
+		// untextured draws still need a descriptor set bound, so they get a white texel.
+		uint32_t white = 0xFFFFFFFF;
+		if (!createTexture(m_white, reinterpret_cast<const uint8_t *>(&white), 1, 1, VK_FORMAT_R8G8B8A8_UNORM, false))
+			return false;
+		return true;
+	}
+
+	bool VulkanRenderer::createInstance()
+	{
+		std::vector<const char *> extensions;
+		if (!m_offscreen_mode)
+		{
+			unsigned int count = 0;
+			if (!SDL_Vulkan_GetInstanceExtensions(m_window, &count, nullptr))
+			{
+				std::cout << "Unable to query the Vulkan extensions of the window: " << SDL_GetError() << "\n";
+				return false;
+			}
+			extensions.resize(count);
+			SDL_Vulkan_GetInstanceExtensions(m_window, &count, extensions.data());
+		}
+
+		// flipping the viewport, to keep the clip space of the engine, requires Vulkan 1.1.
+		VkApplicationInfo application = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+		application.pApplicationName = "sgg";
+		application.pEngineName = "sgg";
+		application.apiVersion = VK_API_VERSION_1_1;
+
+		VkInstanceCreateInfo info = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+		info.pApplicationInfo = &application;
+		info.enabledExtensionCount = (uint32_t)extensions.size();
+		info.ppEnabledExtensionNames = extensions.data();
+
+		// SGG_VULKAN_VALIDATION=1 enables the validation layer, which reports API misuse on the standard output.
+		const char * validation_layer = "VK_LAYER_KHRONOS_validation";
+		const char * validation = getenv("SGG_VULKAN_VALIDATION");
+		if (validation && *validation && strcmp(validation, "0"))
+		{
+			uint32_t count = 0;
+			vkEnumerateInstanceLayerProperties(&count, nullptr);
+			std::vector<VkLayerProperties> layers(count);
+			vkEnumerateInstanceLayerProperties(&count, layers.data());
+			bool found = std::any_of(layers.begin(), layers.end(), [&](const VkLayerProperties & layer) { return !strcmp(layer.layerName, validation_layer); });
+			if (found)
+			{
+				info.enabledLayerCount = 1;
+				info.ppEnabledLayerNames = &validation_layer;
+			}
+			else
+				std::cout << "The Vulkan validation layer is not installed\n";
+		}
+
+		VkResult result = vkCreateInstance(&info, nullptr, &m_instance);
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Unable to create a Vulkan instance (error " << result << ")\n";
+			m_instance = VK_NULL_HANDLE;
+			return false;
+		}
+
+		if (!m_offscreen_mode && !SDL_Vulkan_CreateSurface(m_window, m_instance, &m_surface))
+		{
+			std::cout << "Unable to create a Vulkan surface for the window: " << SDL_GetError() << "\n";
+			m_surface = VK_NULL_HANDLE;
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::selectDevice()
+	{
+		uint32_t count = 0;
+		vkEnumeratePhysicalDevices(m_instance, &count, nullptr);
+		std::vector<VkPhysicalDevice> devices(count);
+		vkEnumeratePhysicalDevices(m_instance, &count, devices.data());
+
+		// hardware devices are preferred; software ones (lavapipe) are taken when nothing else is usable.
+		int best_score = -1;
+		for (VkPhysicalDevice device : devices)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(device, &properties);
+			if (properties.apiVersion < VK_API_VERSION_1_1)
+				continue;
+			int score = 1;
+			if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+				score = 3;
+			else if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU)
+				score = 2;
+			else if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+				score = 0;
+			if (score <= best_score)
+				continue;
+
+			uint32_t num_families = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &num_families, nullptr);
+			std::vector<VkQueueFamilyProperties> families(num_families);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &num_families, families.data());
+			for (uint32_t i = 0; i < num_families; i++)
+			{
+				if (!(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+					continue;
+				VkBool32 present = VK_TRUE;
+				if (m_surface)
+					vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &present);
+				if (!present)
+					continue;
+				best_score = score;
+				m_physical_device = device;
+				m_queue_family = i;
+				break;
+			}
+		}
+
+		if (!m_physical_device)
+		{
+			std::cout << "No Vulkan 1.1 device can draw to the window\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::createDevice()
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(m_physical_device, &properties);
+		VkPhysicalDeviceFeatures supported;
+		vkGetPhysicalDeviceFeatures(m_physical_device, &supported);
+
+		// outlines are drawn as lines of the brush width, where the device supports wide lines.
+		VkPhysicalDeviceFeatures features = {};
+		features.wideLines = supported.wideLines;
+		m_wide_lines = supported.wideLines == VK_TRUE;
+		m_line_width_range[0] = properties.limits.lineWidthRange[0];
+		m_line_width_range[1] = properties.limits.lineWidthRange[1];
+
+		float priority = 1.0f;
+		VkDeviceQueueCreateInfo queue = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+		queue.queueFamilyIndex = m_queue_family;
+		queue.queueCount = 1;
+		queue.pQueuePriorities = &priority;
+
+		const char * swapchain_extension = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+		VkDeviceCreateInfo info = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+		info.queueCreateInfoCount = 1;
+		info.pQueueCreateInfos = &queue;
+		info.enabledExtensionCount = m_surface ? 1 : 0;
+		info.ppEnabledExtensionNames = &swapchain_extension;
+		info.pEnabledFeatures = &features;
+		VkResult result = vkCreateDevice(m_physical_device, &info, nullptr, &m_device);
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan device (error " << result << ")\n";
+			m_device = VK_NULL_HANDLE;
+			return false;
+		}
+		vkGetDeviceQueue(m_device, m_queue_family, 0, &m_queue);
+		vkGetPhysicalDeviceMemoryProperties(m_physical_device, &m_memory_properties);
+
+		// mipmaps are generated with linear blits, where the texture format allows them.
+		VkFormatProperties format;
+		vkGetPhysicalDeviceFormatProperties(m_physical_device, VK_FORMAT_R8G8B8A8_UNORM, &format);
+		VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		m_texture_mipmaps = (format.optimalTilingFeatures & needed) == needed;
+
+		VkCommandPoolCreateInfo pool = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		pool.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		pool.queueFamilyIndex = m_queue_family;
+		if (vkCreateCommandPool(m_device, &pool, nullptr, &m_command_pool) != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan command pool\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::createRenderPass()
+	{
+		VkAttachmentDescription color = {};
+		color.format = VK_FORMAT_R8G8B8A8_UNORM;
+		color.samples = VK_SAMPLE_COUNT_1_BIT;
+		color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		// the frame is only read by copies: the blit to the swapchain and readPixels().
+		color.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		VkAttachmentReference reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &reference;
+
+		// the copies of the previous frame finish reading the target before it is cleared, and the copies of this frame
+		// wait for it to be drawn.
+		VkSubpassDependency dependencies[2] = {};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].srcAccessMask = 0;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		VkRenderPassCreateInfo info = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+		info.attachmentCount = 1;
+		info.pAttachments = &color;
+		info.subpassCount = 1;
+		info.pSubpasses = &subpass;
+		info.dependencyCount = 2;
+		info.pDependencies = dependencies;
+		if (vkCreateRenderPass(m_device, &info, nullptr, &m_render_pass) != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan render pass\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::createPipelines()
+	{
+		VkSamplerCreateInfo sampler = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+		// the same filtering as the OpenGL textures: bilinear, nearest mipmap, clamped to the edges.
+		sampler.magFilter = VK_FILTER_LINEAR;
+		sampler.minFilter = VK_FILTER_LINEAR;
+		sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		sampler.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler.maxLod = VK_LOD_CLAMP_NONE;
+		if (vkCreateSampler(m_device, &sampler, nullptr, &m_sampler) != VK_SUCCESS)
+			return false;
+
+		VkDescriptorSetLayoutBinding binding = {};
+		binding.binding = 0;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		binding.descriptorCount = 1;
+		binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		VkDescriptorSetLayoutCreateInfo set_layout = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		set_layout.bindingCount = 1;
+		set_layout.pBindings = &binding;
+		if (vkCreateDescriptorSetLayout(m_device, &set_layout, nullptr, &m_set_layout) != VK_SUCCESS)
+			return false;
+
+		VkPushConstantRange constants = { VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawConstants) };
+		VkPipelineLayoutCreateInfo layout = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		layout.setLayoutCount = 1;
+		layout.pSetLayouts = &m_set_layout;
+		layout.pushConstantRangeCount = 1;
+		layout.pPushConstantRanges = &constants;
+		if (vkCreatePipelineLayout(m_device, &layout, nullptr, &m_pipeline_layout) != VK_SUCCESS)
+			return false;
+
+		VkShaderModuleCreateInfo module = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+		VkShaderModule vertex_shader = VK_NULL_HANDLE, fragment_shader = VK_NULL_HANDLE;
+		module.codeSize = sizeof vertex_shader_code;
+		module.pCode = vertex_shader_code;
+		vkCreateShaderModule(m_device, &module, nullptr, &vertex_shader);
+		module.codeSize = sizeof fragment_shader_code;
+		module.pCode = fragment_shader_code;
+		vkCreateShaderModule(m_device, &module, nullptr, &fragment_shader);
+
+		VkPipelineShaderStageCreateInfo stages[2] = { { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO }, { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO } };
+		stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		stages[0].module = vertex_shader;
+		stages[0].pName = "main";
+		stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		stages[1].module = fragment_shader;
+		stages[1].pName = "main";
+
+		VkVertexInputBindingDescription vertex_binding = { 0, sizeof(float[4]), VK_VERTEX_INPUT_RATE_VERTEX };
+		VkVertexInputAttributeDescription coord = { 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 0 };
+		VkPipelineVertexInputStateCreateInfo vertex_input = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+		vertex_input.vertexBindingDescriptionCount = 1;
+		vertex_input.pVertexBindingDescriptions = &vertex_binding;
+		vertex_input.vertexAttributeDescriptionCount = 1;
+		vertex_input.pVertexAttributeDescriptions = &coord;
+
+		VkPipelineViewportStateCreateInfo viewport = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+		viewport.viewportCount = 1;
+		viewport.scissorCount = 1;
+
+		VkPipelineRasterizationStateCreateInfo rasterization = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+		rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterization.cullMode = VK_CULL_MODE_NONE;
+		rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterization.lineWidth = 1.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisample = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+		multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), for color and alpha alike.
+		VkPipelineColorBlendAttachmentState blend = {};
+		blend.blendEnable = VK_TRUE;
+		blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blend.colorBlendOp = VK_BLEND_OP_ADD;
+		blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blend.alphaBlendOp = VK_BLEND_OP_ADD;
+		blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		VkPipelineColorBlendStateCreateInfo color_blend = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+		color_blend.attachmentCount = 1;
+		color_blend.pAttachments = &blend;
+
+		VkDynamicState dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_LINE_WIDTH };
+		VkPipelineDynamicStateCreateInfo dynamic = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+		dynamic.dynamicStateCount = 3;
+		dynamic.pDynamicStates = dynamic_states;
+
+		// the pipelines only differ in their topology.
+		const VkPrimitiveTopology topologies[NUM_TOPOLOGIES] = {
+			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+			VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+			VK_PRIMITIVE_TOPOLOGY_LINE_STRIP };
+		VkPipelineInputAssemblyStateCreateInfo input_assembly[NUM_TOPOLOGIES];
+		VkGraphicsPipelineCreateInfo pipelines[NUM_TOPOLOGIES];
+		for (int i = 0; i < NUM_TOPOLOGIES; i++)
+		{
+			input_assembly[i] = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+			input_assembly[i].topology = topologies[i];
+			pipelines[i] = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+			pipelines[i].stageCount = 2;
+			pipelines[i].pStages = stages;
+			pipelines[i].pVertexInputState = &vertex_input;
+			pipelines[i].pInputAssemblyState = &input_assembly[i];
+			pipelines[i].pViewportState = &viewport;
+			pipelines[i].pRasterizationState = &rasterization;
+			pipelines[i].pMultisampleState = &multisample;
+			pipelines[i].pColorBlendState = &color_blend;
+			pipelines[i].pDynamicState = &dynamic;
+			pipelines[i].layout = m_pipeline_layout;
+			pipelines[i].renderPass = m_render_pass;
+			pipelines[i].subpass = 0;
+		}
+		VkResult result = VK_ERROR_INITIALIZATION_FAILED;
+		if (vertex_shader && fragment_shader)
+			result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, NUM_TOPOLOGIES, pipelines, nullptr, m_pipelines);
+		vkDestroyShaderModule(m_device, vertex_shader, nullptr);
+		vkDestroyShaderModule(m_device, fragment_shader, nullptr);
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan pipelines (error " << result << ")\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::createTarget()
+	{
+		VkImageCreateInfo image = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		image.imageType = VK_IMAGE_TYPE_2D;
+		image.format = VK_FORMAT_R8G8B8A8_UNORM;
+		image.extent = { (uint32_t)m_width, (uint32_t)m_height, 1 };
+		image.mipLevels = 1;
+		image.arrayLayers = 1;
+		image.samples = VK_SAMPLE_COUNT_1_BIT;
+		image.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		image.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(m_device, &image, nullptr, &m_target) != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan frame buffer\n";
+			return false;
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_device, m_target, &requirements);
+		VkMemoryAllocateInfo alloc = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		alloc.allocationSize = requirements.size;
+		if (!findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, alloc.memoryTypeIndex) ||
+			vkAllocateMemory(m_device, &alloc, nullptr, &m_target_memory) != VK_SUCCESS)
+		{
+			std::cout << "Unable to allocate the Vulkan frame buffer\n";
+			return false;
+		}
+		vkBindImageMemory(m_device, m_target, m_target_memory, 0);
+		MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "vulkan frame", 0, requirements.size);
+
+		VkImageViewCreateInfo view = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		view.image = m_target;
+		view.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view.format = VK_FORMAT_R8G8B8A8_UNORM;
+		view.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		if (vkCreateImageView(m_device, &view, nullptr, &m_target_view) != VK_SUCCESS)
+			return false;
+
+		VkFramebufferCreateInfo framebuffer = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+		framebuffer.renderPass = m_render_pass;
+		framebuffer.attachmentCount = 1;
+		framebuffer.pAttachments = &m_target_view;
+		framebuffer.width = m_width;
+		framebuffer.height = m_height;
+		framebuffer.layers = 1;
+		if (vkCreateFramebuffer(m_device, &framebuffer, nullptr, &m_framebuffer) != VK_SUCCESS)
+			return false;
+		m_target_drawn = false;
+		return true;
+	}
+
+	void VulkanRenderer::destroyTarget()
+	{
+		vkDestroyFramebuffer(m_device, m_framebuffer, nullptr);
+		vkDestroyImageView(m_device, m_target_view, nullptr);
+		vkDestroyImage(m_device, m_target, nullptr);
+		vkFreeMemory(m_device, m_target_memory, nullptr);
+		m_framebuffer = VK_NULL_HANDLE;
+		m_target_view = VK_NULL_HANDLE;
+		m_target = VK_NULL_HANDLE;
+		m_target_memory = VK_NULL_HANDLE;
+		m_target_drawn = false;
+	}
+
+	bool VulkanRenderer::createSwapchain()
+	{
+		destroySwapchain();
+		m_swapchain_outdated = false;
+
+		VkSurfaceCapabilitiesKHR capabilities;
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physical_device, m_surface, &capabilities);
+		if (!(capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+		{
+			std::cout << "The Vulkan surface of the window cannot be copied to\n";
+			return false;
+		}
+		VkExtent2D extent = capabilities.currentExtent;
+		if (extent.width == 0xFFFFFFFF)
+		{
+			extent.width = glm::clamp((uint32_t)m_width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+			extent.height = glm::clamp((uint32_t)m_height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+		}
+		// a minimized window has no surface area: frames are still drawn, but not shown.
+		if (extent.width == 0 || extent.height == 0)
+			return true;
+
+		// the frame is blitted to the swapchain, which converts it to any format that blits can write.
+		uint32_t count = 0;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(m_physical_device, m_surface, &count, nullptr);
+		std::vector<VkSurfaceFormatKHR> formats(count);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(m_physical_device, m_surface, &count, formats.data());
+		VkSurfaceFormatKHR format = { VK_FORMAT_UNDEFINED, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		for (const VkSurfaceFormatKHR & candidate : formats)
+		{
+			VkFormatProperties properties;
+			vkGetPhysicalDeviceFormatProperties(m_physical_device, candidate.format, &properties);
+			if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT))
+				continue;
+			if (format.format == VK_FORMAT_UNDEFINED || candidate.format == VK_FORMAT_B8G8R8A8_UNORM || candidate.format == VK_FORMAT_R8G8B8A8_UNORM)
+				format = candidate;
+		}
+		if (format.format == VK_FORMAT_UNDEFINED)
+		{
+			std::cout << "The Vulkan surface of the window has no usable format\n";
+			return false;
+		}
+
+		// frames are not synchronized to the display, the same as the OpenGL renderer with a swap interval of 0.
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physical_device, m_surface, &count, nullptr);
+		std::vector<VkPresentModeKHR> modes(count);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physical_device, m_surface, &count, modes.data());
+		VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR;
+		for (VkPresentModeKHR preferred : { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR })
+			if (std::find(modes.begin(), modes.end(), preferred) != modes.end())
+				mode = preferred;
+
+		VkCompositeAlphaFlagBitsKHR composite = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+		for (VkCompositeAlphaFlagBitsKHR candidate : { VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR, VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR })
+			if (capabilities.supportedCompositeAlpha & candidate)
+				composite = candidate;
+
+		VkSwapchainCreateInfoKHR info = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
+		info.surface = m_surface;
+		info.minImageCount = capabilities.minImageCount + 1;
+		if (capabilities.maxImageCount > 0)
+			info.minImageCount = std::min(info.minImageCount, capabilities.maxImageCount);
+		info.imageFormat = format.format;
+		info.imageColorSpace = format.colorSpace;
+		info.imageExtent = extent;
+		info.imageArrayLayers = 1;
+		info.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.preTransform = capabilities.currentTransform;
+		info.compositeAlpha = composite;
+		info.presentMode = mode;
+		info.clipped = VK_TRUE;
+		VkResult result = vkCreateSwapchainKHR(m_device, &info, nullptr, &m_swapchain);
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Unable to create the Vulkan swapchain (error " << result << ")\n";
+			m_swapchain = VK_NULL_HANDLE;
+			return false;
+		}
+		m_swapchain_extent = extent;
+
+		vkGetSwapchainImagesKHR(m_device, m_swapchain, &count, nullptr);
+		m_swapchain_images.resize(count);
+		vkGetSwapchainImagesKHR(m_device, m_swapchain, &count, m_swapchain_images.data());
+		m_swapchain_rendered.resize(count, VK_NULL_HANDLE);
+		VkSemaphoreCreateInfo semaphore = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		for (VkSemaphore & rendered : m_swapchain_rendered)
+			vkCreateSemaphore(m_device, &semaphore, nullptr, &rendered);
+		return true;
+	}
+
+	void VulkanRenderer::destroySwapchain()
+	{
+		if (!m_swapchain)
+			return;
+		vkDeviceWaitIdle(m_device);
+		for (VkSemaphore rendered : m_swapchain_rendered)
+			vkDestroySemaphore(m_device, rendered, nullptr);
+		m_swapchain_rendered.clear();
+		m_swapchain_images.clear();
+		vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
+		m_swapchain = VK_NULL_HANDLE;
+	}
+
+	void VulkanRenderer::release()
+	{
+		if (!m_instance)
+			return;
+		if (m_device)
+		{
+			vkDeviceWaitIdle(m_device);
+			for (auto & texture : m_textures)
+				destroyTexture(texture.second);
+			m_textures.clear();
+			for (auto & font : m_fonts)
+				for (auto & glyph : font.second.glyphs)
+					destroyTexture(glyph.second.texture);
+			destroyTexture(m_white);
+			for (Frame & frame : m_frames)
+			{
+				for (HostBuffer & chunk : frame.stream)
+					destroyHostBuffer(chunk);
+				frame.stream.clear();
+				vkDestroyFence(m_device, frame.done, nullptr);
+				vkDestroySemaphore(m_device, frame.image_acquired, nullptr);
+				// command buffers are freed along with their pool.
+				frame = Frame();
+			}
+			destroyHostBuffer(m_static_vertices);
+			destroyHostBuffer(m_readback);
+			destroySwapchain();
+			destroyTarget();
+			for (VkPipeline & pipeline : m_pipelines)
+			{
+				vkDestroyPipeline(m_device, pipeline, nullptr);
+				pipeline = VK_NULL_HANDLE;
+			}
+			vkDestroyPipelineLayout(m_device, m_pipeline_layout, nullptr);
+			vkDestroyDescriptorSetLayout(m_device, m_set_layout, nullptr);
+			vkDestroySampler(m_device, m_sampler, nullptr);
+			for (VkDescriptorPool pool : m_descriptor_pools)
+				vkDestroyDescriptorPool(m_device, pool, nullptr);
+			m_descriptor_pools.clear();
+			vkDestroyRenderPass(m_device, m_render_pass, nullptr);
+			vkDestroyCommandPool(m_device, m_command_pool, nullptr);
+			vkDestroyDevice(m_device, nullptr);
+			m_pipeline_layout = VK_NULL_HANDLE;
+			m_set_layout = VK_NULL_HANDLE;
+			m_sampler = VK_NULL_HANDLE;
+			m_render_pass = VK_NULL_HANDLE;
+			m_command_pool = VK_NULL_HANDLE;
+			m_device = VK_NULL_HANDLE;
+		}
+		if (m_surface)
+			vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+		vkDestroyInstance(m_instance, nullptr);
+		m_surface = VK_NULL_HANDLE;
+		m_instance = VK_NULL_HANDLE;
+		m_physical_device = VK_NULL_HANDLE;
+		m_frame_state = FRAME_IDLE;
+		MemoryRegistry::get().untrackAll(this);
+
+		for (auto & font : m_fonts)
+			FT_Done_Face(font.second.face);
+		m_fonts.clear();
+		m_current_font = nullptr;
+		if (m_ft)
+		{
+#ifdef SGG_TRACK_ALLOCATIONS
+			FT_Done_Library(m_ft);
+#else
+			FT_Done_FreeType(m_ft);
+#endif
+			m_ft = nullptr;
+		}
+	}
+
+	VulkanRenderer::~VulkanRenderer()
+	{
+		release();
+	}
+
+	void VulkanRenderer::resize(int width, int height)
+	{
+		m_pending_width = std::max(width, 1);
+		m_pending_height = std::max(height, 1);
+		m_resize_pending = true;
+		// the command buffer of the current frame refers to the target, which is replaced after the frame is presented.
+		if (m_frame_state == FRAME_IDLE)
+			applyResize();
+	}
+
+	void VulkanRenderer::applyResize()
+	{
+		m_resize_pending = false;
+		m_width = m_pending_width;
+		m_height = m_pending_height;
+		if (!m_device)
+			return;
+		// frames still in flight draw into the old target.
+		vkDeviceWaitIdle(m_device);
+		destroyTarget();
+		if (!createTarget())
+			std::cout << "Unable to resize the Vulkan frame buffer\n";
+		if (!m_offscreen_mode)
+			createSwapchain();
+	}
+
+	bool VulkanRenderer::findMemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties, uint32_t & type) const
+	{
+		for (uint32_t i = 0; i < m_memory_properties.memoryTypeCount; i++)
+		{
+			if ((type_bits & (1u << i)) && (m_memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				type = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool VulkanRenderer::createHostBuffer(HostBuffer & buffer, VkDeviceSize size, VkBufferUsageFlags usage)
+	{
+		VkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		info.size = size;
+		info.usage = usage;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(m_device, &info, nullptr, &buffer.buffer) != VK_SUCCESS)
+		{
+			buffer.buffer = VK_NULL_HANDLE;
+			std::cout << "Unable to create a Vulkan buffer\n";
+			return false;
+		}
+
+		// coherent memory needs no flushes: writes are visible to the GPU when the command buffer is submitted.
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(m_device, buffer.buffer, &requirements);
+		VkMemoryAllocateInfo alloc = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		alloc.allocationSize = requirements.size;
+		void * data = nullptr;
+		if (!findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, alloc.memoryTypeIndex) ||
+			vkAllocateMemory(m_device, &alloc, nullptr, &buffer.memory) != VK_SUCCESS ||
+			vkBindBufferMemory(m_device, buffer.buffer, buffer.memory, 0) != VK_SUCCESS ||
+			vkMapMemory(m_device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS)
+		{
+			std::cout << "Unable to allocate a Vulkan buffer of " << size << " bytes\n";
+			destroyHostBuffer(buffer);
+			return false;
+		}
+		buffer.size = size;
+		buffer.data = static_cast<uint8_t *>(data);
+		return true;
+	}
+
+	void VulkanRenderer::destroyHostBuffer(HostBuffer & buffer)
+	{
+		// freeing the memory also unmaps it.
+		vkDestroyBuffer(m_device, buffer.buffer, nullptr);
+		vkFreeMemory(m_device, buffer.memory, nullptr);
+		buffer = HostBuffer();
+	}
+
+	VkCommandBuffer VulkanRenderer::beginOneShot()
+	{
+		VkCommandBufferAllocateInfo alloc = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		alloc.commandPool = m_command_pool;
+		alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		alloc.commandBufferCount = 1;
+		VkCommandBuffer commands = VK_NULL_HANDLE;
+		vkAllocateCommandBuffers(m_device, &alloc, &commands);
+		VkCommandBufferBeginInfo begin = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(commands, &begin);
+		return commands;
+	}
+
+	void VulkanRenderer::endOneShot(VkCommandBuffer commands)
+	{
+		// uploads and readbacks are rare, so they are simply waited for.
+		vkEndCommandBuffer(commands);
+		VkSubmitInfo submit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submit.commandBufferCount = 1;
+		submit.pCommandBuffers = &commands;
+		vkQueueSubmit(m_queue, 1, &submit, VK_NULL_HANDLE);
+		vkQueueWaitIdle(m_queue);
+		vkFreeCommandBuffers(m_device, m_command_pool, 1, &commands);
+	}
+
+	VkDescriptorSet VulkanRenderer::allocateDescriptorSet()
+	{
+		VkDescriptorSetAllocateInfo alloc = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		alloc.descriptorSetCount = 1;
+		alloc.pSetLayouts = &m_set_layout;
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		if (!m_descriptor_pools.empty())
+		{
+			alloc.descriptorPool = m_descriptor_pools.back();
+			if (vkAllocateDescriptorSets(m_device, &alloc, &set) == VK_SUCCESS)
+				return set;
+		}
+
+		// sets live as long as their textures, which are only freed with the renderer, so a full pool is followed by a new one.
+		VkDescriptorPoolSize size = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descriptor_pool_sets };
+		VkDescriptorPoolCreateInfo info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		info.maxSets = descriptor_pool_sets;
+		info.poolSizeCount = 1;
+		info.pPoolSizes = &size;
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		if (vkCreateDescriptorPool(m_device, &info, nullptr, &pool) != VK_SUCCESS)
+			return VK_NULL_HANDLE;
+		m_descriptor_pools.push_back(pool);
+		alloc.descriptorPool = pool;
+		if (vkAllocateDescriptorSets(m_device, &alloc, &set) != VK_SUCCESS)
+			return VK_NULL_HANDLE;
+		return set;
+	}
+
+	bool VulkanRenderer::createTexture(VulkanTexture & texture, const uint8_t * pixels, int width, int height, VkFormat format, bool mipmaps)
+	{
+		VkDeviceSize size = (VkDeviceSize)width * height * (format == VK_FORMAT_R8_UNORM ? 1 : 4);
+		uint32_t levels = 1;
+		if (mipmaps && m_texture_mipmaps)
+			while ((std::max(width, height) >> levels) > 0)
+				levels++;
+
+		VkImageCreateInfo image = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		image.imageType = VK_IMAGE_TYPE_2D;
+		image.format = format;
+		image.extent = { (uint32_t)width, (uint32_t)height, 1 };
+		image.mipLevels = levels;
+		image.arrayLayers = 1;
+		image.samples = VK_SAMPLE_COUNT_1_BIT;
+		image.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (levels > 1 ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+		image.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(m_device, &image, nullptr, &texture.image) != VK_SUCCESS)
+		{
+			texture.image = VK_NULL_HANDLE;
+			return false;
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_device, texture.image, &requirements);
+		VkMemoryAllocateInfo alloc = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		alloc.allocationSize = requirements.size;
+		HostBuffer staging;
+		if (!findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, alloc.memoryTypeIndex) ||
+			vkAllocateMemory(m_device, &alloc, nullptr, &texture.memory) != VK_SUCCESS ||
+			vkBindImageMemory(m_device, texture.image, texture.memory, 0) != VK_SUCCESS ||
+			!createHostBuffer(staging, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT))
+		{
+			destroyTexture(texture);
+			return false;
+		}
+		memcpy(staging.data, pixels, size);
+
+		VkCommandBuffer commands = beginOneShot();
+		imageBarrier(commands, texture.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, 0, levels);
+		VkBufferImageCopy copy = {};
+		copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copy.imageExtent = { (uint32_t)width, (uint32_t)height, 1 };
+		vkCmdCopyBufferToImage(commands, staging.buffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+		// each level is downsampled from the previous one, which is then ready for sampling.
+		for (uint32_t level = 1; level < levels; level++)
+		{
+			imageBarrier(commands, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, level - 1);
+			VkImageBlit blit = {};
+			blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+			blit.srcOffsets[1] = { std::max(width >> (level - 1), 1), std::max(height >> (level - 1), 1), 1 };
+			blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+			blit.dstOffsets[1] = { std::max(width >> level, 1), std::max(height >> level, 1), 1 };
+			vkCmdBlitImage(commands, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+			imageBarrier(commands, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, level - 1);
+		}
+		imageBarrier(commands, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, levels - 1);
+		endOneShot(commands);
+		destroyHostBuffer(staging);
+
+		VkImageViewCreateInfo view = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		view.image = texture.image;
+		view.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view.format = format;
+		view.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levels, 0, 1 };
+		if (vkCreateImageView(m_device, &view, nullptr, &texture.view) != VK_SUCCESS)
+		{
+			texture.view = VK_NULL_HANDLE;
+			destroyTexture(texture);
+			return false;
+		}
+
+		// the descriptor set is written once, here, and only bound from then on.
+		texture.set = allocateDescriptorSet();
+		if (!texture.set)
+		{
+			destroyTexture(texture);
+			return false;
+		}
+		VkDescriptorImageInfo descriptor = { m_sampler, texture.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		write.dstSet = texture.set;
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &descriptor;
+		vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+
+		texture.width = width;
+		texture.height = height;
+		texture.bytes = requirements.size;
+		return true;
+	}
+
+	void VulkanRenderer::destroyTexture(VulkanTexture & texture)
+	{
+		// the descriptor set goes back with its pool.
+		vkDestroyImageView(m_device, texture.view, nullptr);
+		vkDestroyImage(m_device, texture.image, nullptr);
+		vkFreeMemory(m_device, texture.memory, nullptr);
+		texture = VulkanTexture();
+	}
+
+	const VulkanRenderer::VulkanTexture * VulkanRenderer::getTexture(const std::string & filename)
+	{
+		if (filename.empty())
+			return nullptr;
+		auto iter = m_textures.find(filename);
+		if (iter == m_textures.end())
+		{
+			SGG_PROFILE_SCOPE("TextureManager::loadTexture");
+			// failed loads are cached as well, so that a missing file is only looked up once.
+			VulkanTexture texture;
+			std::vector<unsigned char> rgba;
+			unsigned int width, height;
+			if (!lodepng::decode(rgba, width, height, filename.c_str()) && width > 0 && height > 0)
+				createTexture(texture, rgba.data(), width, height, VK_FORMAT_R8G8B8A8_UNORM, true);
+			iter = m_textures.emplace(filename, texture).first;
+			if (iter->second.set)
+				MemoryRegistry::get().track(this, MEMORY_TEXTURES, filename, 0, iter->second.bytes);
+		}
+		return iter->second.set ? &iter->second : nullptr;
+	}
+
+	size_t VulkanRenderer::getTextureMemory() const
+	{
+		size_t bytes = 0;
+		for (const auto & texture : m_textures)
+			bytes += texture.second.bytes;
+		return bytes;
+	}
+
+	void VulkanRenderer::beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor)
+	{
+		if (m_resize_pending)
+			applyResize();
+
+		// the slot is free once the GPU has finished the frame submitted from it frames_in_flight frames ago.
+		Frame & frame = m_frames[m_frame_index];
+		vkWaitForFences(m_device, 1, &frame.done, VK_TRUE, UINT64_MAX);
+		frame.stream_chunk = 0;
+		frame.stream_offset = 0;
+
+		vkResetCommandBuffer(frame.commands, 0);
+		VkCommandBufferBeginInfo begin = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(frame.commands, &begin);
+
+		VkClearValue clear = {};
+		clear.color.float32[3] = 1.0f;
+		VkRenderPassBeginInfo pass = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+		pass.renderPass = m_render_pass;
+		pass.framebuffer = m_framebuffer;
+		pass.renderArea = { { 0, 0 }, { (uint32_t)m_width, (uint32_t)m_height } };
+		pass.clearValueCount = 1;
+		pass.pClearValues = &clear;
+		vkCmdBeginRenderPass(frame.commands, &pass, VK_SUBPASS_CONTENTS_INLINE);
+
+		// the viewport is flipped, so that the y axis of clip space points up as in OpenGL and the projection of the
+		// engine is used as is; rows of the target are then stored top to bottom.
+		VkViewport viewport = { 0.0f, (float)m_height, (float)m_width, -(float)m_height, 0.0f, 1.0f };
+		vkCmdSetViewport(frame.commands, 0, 1, &viewport);
+
+		m_scissor = { { 0, 0 }, { (uint32_t)m_width, (uint32_t)m_height } };
+		if (scissor)
+		{
+			// the scissor rectangle is given bottom-up, as for glScissor().
+			glm::ivec4 rect = glm::ivec4(*scissor);
+			int x0 = std::max(rect.x, 0);
+			int y0 = std::max(m_height - (rect.y + rect.w), 0);
+			int x1 = std::min(rect.x + rect.z, m_width);
+			int y1 = std::min(m_height - rect.y, m_height);
+			m_scissor = { { x0, y0 }, { (uint32_t)std::max(x1 - x0, 0), (uint32_t)std::max(y1 - y0, 0) } };
+		}
+		vkCmdSetScissor(frame.commands, 0, 1, &m_scissor);
+		// the line width is dynamic state of all pipelines, so it must be set before the first draw.
+		vkCmdSetLineWidth(frame.commands, 1.0f);
+
+		m_projection = projection;
+		m_bound_pipeline = VK_NULL_HANDLE;
+		m_bound_set = VK_NULL_HANDLE;
+		m_bound_buffer = VK_NULL_HANDLE;
+		m_line_width = 1.0f;
+		m_text.clear();
+		m_frame_state = FRAME_DRAWING;
+	}
+
+	void VulkanRenderer::bindPipeline(int topology)
+	{
+		VkPipeline pipeline = m_pipelines[topology];
+		if (pipeline == m_bound_pipeline)
+			return;
+		vkCmdBindPipeline(m_frames[m_frame_index].commands, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		m_bound_pipeline = pipeline;
+	}
+
+	void VulkanRenderer::bindTexture(const VulkanTexture * texture)
+	{
+		VkDescriptorSet set = texture ? texture->set : m_white.set;
+		if (set == m_bound_set)
+			return;
+		vkCmdBindDescriptorSets(m_frames[m_frame_index].commands, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layout, 0, 1, &set, 0, nullptr);
+		m_bound_set = set;
+		renderCounters().texture_binds++;
+	}
+
+	void VulkanRenderer::setLineWidth(float width)
+	{
+		width = m_wide_lines ? glm::clamp(width, m_line_width_range[0], m_line_width_range[1]) : 1.0f;
+		if (width == m_line_width)
+			return;
+		vkCmdSetLineWidth(m_frames[m_frame_index].commands, width);
+		m_line_width = width;
+	}
+
+	void VulkanRenderer::streamVertices(const float (*vertices)[4], int count, VkBuffer & buffer, uint32_t & first)
+	{
+		Frame & frame = m_frames[m_frame_index];
+		VkDeviceSize size = count * sizeof(float[4]);
+		if (frame.stream_offset + size > stream_chunk_size)
+		{
+			frame.stream_chunk++;
+			frame.stream_offset = 0;
+		}
+		if (frame.stream_chunk == frame.stream.size())
+		{
+			// a frame that outgrows its chunks gets another one, which is kept for the frames after it.
+			HostBuffer chunk;
+			if (!createHostBuffer(chunk, stream_chunk_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
+			{
+				buffer = VK_NULL_HANDLE;
+				return;
+			}
+			frame.stream.push_back(chunk);
+			size_t chunks = 0;
+			for (const Frame & f : m_frames)
+				chunks += f.stream.size();
+			MemoryRegistry::get().track(this, MEMORY_GEOMETRY, "streamed vertices", 0, chunks * stream_chunk_size);
+		}
+
+		// the chunk is not read by the GPU until the frame is submitted, so it is written without synchronization.
+		HostBuffer & chunk = frame.stream[frame.stream_chunk];
+		memcpy(chunk.data + frame.stream_offset, vertices, size);
+		buffer = chunk.buffer;
+		first = (uint32_t)(frame.stream_offset / sizeof(float[4]));
+		frame.stream_offset += size;
+	}
+
+	void VulkanRenderer::draw(int topology, const DrawConstants & constants, VkBuffer buffer, uint32_t first, uint32_t count)
+	{
+		if (m_frame_state != FRAME_DRAWING || !buffer)
+			return;
+		VkCommandBuffer commands = m_frames[m_frame_index].commands;
+		bindPipeline(topology);
+		if (!m_bound_set)
+			bindTexture(nullptr);
+		if (buffer != m_bound_buffer)
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commands, 0, 1, &buffer, &offset);
+			m_bound_buffer = buffer;
+		}
+		vkCmdPushConstants(commands, m_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawConstants), &constants);
+		vkCmdDraw(commands, count, 1, first, 0);
+
+		RenderCounters & counters = renderCounters();
+		counters.draw_calls++;
+		counters.vertices += count;
+		counters.uniform_uploads++;
+	}
+
+	void VulkanRenderer::drawRect(const glm::mat4 & modelview, const Brush & brush)
+	{
+		DrawConstants constants = {};
+		constants.transform = m_projection * modelview;
+		constants.gradient = glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v);
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
+		{
+			const VulkanTexture * texture = getTexture(brush.texture);
+			bindTexture(texture);
+			constants.color1 = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			constants.color2 = brush.gradient ? glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+				brush.fill_secondary_color[2], brush.fill_secondary_opacity) : constants.color1;
+			constants.texture_mode = texture ? 1 : 0;
+			draw(TOPOLOGY_TRIANGLE_STRIP, constants, m_static_vertices.buffer, 0, 4);
+		}
+
+		if (brush.outline_opacity > 0.0f)
+		{
+			constants.color1 = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			constants.color2 = constants.color1;
+			constants.texture_mode = 0;
+			setLineWidth(brush.outline_width);
+			draw(TOPOLOGY_LINE_STRIP, constants, m_static_vertices.buffer, 4, 5);
+		}
+	}
+
+	void VulkanRenderer::drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush)
+	{
+		DrawConstants constants = {};
+		constants.transform = m_projection;
+		constants.color1 = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+		constants.color2 = constants.color1;
+		constants.gradient = glm::vec2(1.0f, 0.0f);
+		float line[2][4] =
+		{
+			{ p1.x, p1.y, 0.0f, 1.0f },
+			{ p2.x, p2.y, 0.1f, 1.0f },
+		};
+
+		VkBuffer buffer;
+		uint32_t first;
+		streamVertices(line, 2, buffer, first);
+		setLineWidth(1.0f);
+		draw(TOPOLOGY_LINES, constants, buffer, first, 2);
+	}
+
+	void VulkanRenderer::drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush)
+	{
+		DrawConstants constants = {};
+		constants.transform = m_projection * modelview;
+		constants.gradient = glm::vec2(brush.gradient_dir_u, brush.gradient_dir_v);
+
+		// the same vertices as the OpenGL renderer, with room to close the outline, as Vulkan has no line loops.
+		float sector_vertices[2 * CURVE_SUBDIVS + 2][4];
+		float sector_outline_vertices[2 * CURVE_SUBDIVS + 3][4];
+		float r1 = radius1, r2 = radius2;
+		float arc_inc = 3.1415936f*(end_angle - start_angle) / (180.0f*CURVE_SUBDIVS);
+		for (int i = 0; i <= CURVE_SUBDIVS; i++)
+		{
+			float s = i / (float)CURVE_SUBDIVS;
+			float angle = 3.1415936f*start_angle / 180.f + i * arc_inc;
+			sector_vertices[i * 2 + 0][0] = r1 * cos(angle);
+			sector_vertices[i * 2 + 0][1] = r1 * -sin(angle);
+			sector_vertices[i * 2 + 0][2] = s;
+			sector_vertices[i * 2 + 0][3] = 0.0f;
+			sector_vertices[i * 2 + 1][0] = r2 * cos(angle);
+			sector_vertices[i * 2 + 1][1] = r2 * -sin(angle);
+			sector_vertices[i * 2 + 1][2] = s;
+			sector_vertices[i * 2 + 1][3] = 1.0f;
+			sector_outline_vertices[i][0] = r1 * cos(angle);
+			sector_outline_vertices[i][1] = r1 * -sin(angle);
+			sector_outline_vertices[i][2] = s;
+			sector_outline_vertices[i][3] = 0.0f;
+			sector_outline_vertices[2 * CURVE_SUBDIVS - i + 1][0] = r2 * cos(angle);
+			sector_outline_vertices[2 * CURVE_SUBDIVS - i + 1][1] = r2 * -sin(angle);
+			sector_outline_vertices[2 * CURVE_SUBDIVS - i + 1][2] = s;
+			sector_outline_vertices[2 * CURVE_SUBDIVS - i + 1][3] = 1.0f;
+		}
+
+		// fill
+		if (brush.fill_opacity != 0.0f || brush.fill_secondary_opacity != 0.0f)
+		{
+			const VulkanTexture * texture = getTexture(brush.texture);
+			bindTexture(texture);
+			constants.color1 = glm::vec4(brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity);
+			constants.color2 = brush.gradient ? glm::vec4(brush.fill_secondary_color[0], brush.fill_secondary_color[1],
+				brush.fill_secondary_color[2], brush.fill_secondary_opacity) : constants.color1;
+			constants.texture_mode = texture ? 1 : 0;
+
+			VkBuffer buffer;
+			uint32_t first;
+			streamVertices(sector_vertices, 2 * CURVE_SUBDIVS + 2, buffer, first);
+			draw(TOPOLOGY_TRIANGLE_STRIP, constants, buffer, first, 2 * CURVE_SUBDIVS + 2);
+		}
+
+		if (brush.outline_opacity > 0.0f)
+		{
+			constants.color1 = glm::vec4(brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity);
+			constants.color2 = constants.color1;
+			constants.texture_mode = 0;
+			setLineWidth(brush.outline_width);
+
+			// a full circle only has its outer rim outlined.
+			int start = 0, count = 2 * CURVE_SUBDIVS + 2;
+			if (fabs(end_angle - start_angle - 360.0f) <= 0.000f)
+			{
+				start = CURVE_SUBDIVS + 1;
+				count = CURVE_SUBDIVS;
+			}
+			memcpy(sector_outline_vertices[start + count], sector_outline_vertices[start], sizeof(float[4]));
+
+			VkBuffer buffer;
+			uint32_t first;
+			streamVertices(sector_outline_vertices + start, count + 1, buffer, first);
+			draw(TOPOLOGY_LINE_STRIP, constants, buffer, first, count + 1);
+		}
+	}
+
+	void VulkanRenderer::drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color)
+	{
+		DrawConstants constants = {};
+		constants.transform = m_projection;
+		constants.color1 = color;
+		constants.color2 = color;
+		constants.gradient = glm::vec2(1.0f, 0.0f);
+
+		// quads are expanded to separate triangles, so that a whole batch takes a single draw call.
+		const int batch_quads = (int)(stream_chunk_size / (6 * sizeof(float[4])));
+		for (int batch = 0; batch < count; batch += batch_quads)
+		{
+			int num_quads = std::min(count - batch, batch_quads);
+			m_quad_vertices.clear();
+			for (int i = batch; i < batch + num_quads; i++)
+			{
+				const glm::vec4 & q = quads[i];
+				glm::vec4 corners[4] = {
+					{ q.x, q.y, 0.0f, 0.0f },
+					{ q.z, q.y, 0.0f, 0.0f },
+					{ q.x, q.w, 0.0f, 0.0f },
+					{ q.z, q.w, 0.0f, 0.0f } };
+				m_quad_vertices.insert(m_quad_vertices.end(), { corners[0], corners[1], corners[2], corners[2], corners[1], corners[3] });
+			}
+			VkBuffer buffer;
+			uint32_t first;
+			streamVertices(reinterpret_cast<const float(*)[4]>(m_quad_vertices.data()), 6 * num_quads, buffer, first);
+			draw(TOPOLOGY_TRIANGLES, constants, buffer, first, 6 * num_quads);
+		}
+	}
+
+	bool VulkanRenderer::initFontLibrary()
+	{
+		// same as FontLib::initLibrary(): safe to call from the warm-up thread.
+		std::call_once(m_ft_once, [this]()
+		{
+#ifdef SGG_TRACK_ALLOCATIONS
+			m_ft_ready = !FT_New_Library(AllocationTracker::getFreeTypeMemory(), &m_ft);
+			if (m_ft_ready)
+				FT_Add_Default_Modules(m_ft);
+#else
+			m_ft_ready = !FT_Init_FreeType(&m_ft);
+#endif
+		});
+		return m_ft_ready;
+	}
+
+	bool VulkanRenderer::initFonts()
+	{
+		if (!initFontLibrary())
+			return false;
+		m_fonts_initialized = true;
+		return true;
+	}
+
+	bool VulkanRenderer::setFont(const std::string & fontname)
+	{
+		auto iter = m_fonts.find(fontname);
+		if (iter != m_fonts.end())
+		{
+			m_current_font = &iter->second;
+			return true;
+		}
+
+		VulkanFont font;
+		if (FT_New_Face(m_ft, fontname.c_str(), 0, &font.face))
+		{
+			m_current_font = nullptr;
+			return false;
+		}
+		FT_Set_Pixel_Sizes(font.face, 0, glyph_resolution);
+		font.name = fontname;
+		m_current_font = &m_fonts.emplace(fontname, std::move(font)).first->second;
+		MemoryRegistry::get().track(this, MEMORY_FONTS, fontname, 0, 0);
+		return true;
+	}
+
+	void VulkanRenderer::drawText(const TextRecord & text)
+	{
+		if (!m_fonts_initialized || !m_current_font)
+			return;
+		PendingText entry;
+		entry.record = text;
+		entry.font = m_current_font;
+		m_text.push_back(entry);
+	}
+
+	const VulkanRenderer::VulkanGlyph * VulkanRenderer::getGlyph(VulkanFont & font, unsigned char c)
+	{
+		// unlike the OpenGL renderer, which uploads every glyph it draws, glyphs are uploaded once into their own texture.
+		renderCounters().glyphs++;
+		auto iter = font.glyphs.find(c);
+		if (iter != font.glyphs.end())
+			return &iter->second;
+		renderCounters().glyph_cache_misses++;
+
+		if (FT_Load_Char(font.face, c, FT_LOAD_RENDER))
+			return nullptr;
+		FT_GlyphSlot g = font.face->glyph;
+		VulkanGlyph glyph;
+		glyph.bearing_y = (float)g->metrics.horiBearingY;
+		glyph.advance_y = (float)g->advance.y;
+		int width = g->bitmap.width, rows = g->bitmap.rows;
+		if (width > 0 && rows > 0)
+		{
+			std::vector<uint8_t> coverage((size_t)width * rows);
+			for (int row = 0; row < rows; row++)
+				std::copy(g->bitmap.buffer + row * g->bitmap.pitch, g->bitmap.buffer + row * g->bitmap.pitch + width,
+					coverage.begin() + (size_t)row * width);
+			if (!createTexture(glyph.texture, coverage.data(), width, rows, VK_FORMAT_R8_UNORM, false))
+				return nullptr;
+			font.cache_bytes += glyph.texture.bytes;
+			MemoryRegistry::get().track(this, MEMORY_FONTS, font.name, 0, font.cache_bytes);
+		}
+		return &font.glyphs.emplace(c, glyph).first->second;
+	}
+
+	void VulkanRenderer::drawPendingText(const PendingText & text)
+	{
+		// the same glyph layout as FontLib::drawText().
+		const TextRecord & entry = text.record;
+		DrawConstants constants = {};
+		constants.transform = entry.proj * glm::translate(glm::vec3(entry.pos.x, entry.pos.y, 0.0f)) * entry.mv;
+		constants.color1 = entry.color1;
+		constants.color2 = entry.use_gradient ? entry.color2 : entry.color1;
+		constants.gradient = entry.gradient;
+		constants.texture_mode = 2;
+
+		float x = 0.0f;
+		float y = 0.0f;
+		for (const char * p = entry.text; *p; p++)
+		{
+			const VulkanGlyph * glyph = getGlyph(*text.font, (unsigned char)*p);
+			if (!glyph)
+				continue;
+
+			float w = entry.size.x * glyph->texture.width / (float)glyph_resolution;
+			float h = entry.size.y * glyph->texture.height / (float)glyph_resolution;
+			float b = glyph->bearing_y / (64 * (float)glyph_resolution)*entry.size.y - h;
+
+			if (glyph->texture.set)
+			{
+				float box[4][4] = {
+					{ x, y - b, 0, 1 },
+					{ x + w, y - b, 1, 1 },
+					{ x, y - h - b, 0, 0 },
+					{ x + w, y - h - b, 1, 0 },
+				};
+				VkBuffer buffer;
+				uint32_t first;
+				streamVertices(box, 4, buffer, first);
+				bindTexture(&glyph->texture);
+				draw(TOPOLOGY_TRIANGLE_STRIP, constants, buffer, first, 4);
+			}
+			x += std::max(w + entry.size.x*0.05f, entry.size.x*0.15f);
+			y += entry.size.y*1.1f*glyph->advance_y;
+		}
+	}
+
+	void VulkanRenderer::endFrame()
+	{
+		if (m_frame_state != FRAME_DRAWING)
+			return;
+		{
+			SGG_PROFILE_SCOPE("text");
+			// text is drawn on top of all shapes, as in the OpenGL renderer.
+			for (const PendingText & text : m_text)
+				drawPendingText(text);
+			m_text.clear();
+		}
+		vkCmdEndRenderPass(m_frames[m_frame_index].commands);
+		m_target_drawn = true;
+		m_frame_state = FRAME_ENDED;
+	}
+
+	void VulkanRenderer::recordReadback(VkCommandBuffer commands)
+	{
+		// the render pass leaves the target in the transfer source layout, and its dependency orders the copy after drawing.
+		VkBufferImageCopy copy = {};
+		copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copy.imageExtent = { (uint32_t)m_width, (uint32_t)m_height, 1 };
+		vkCmdCopyImageToBuffer(commands, m_target, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_readback.buffer, 1, &copy);
+
+		VkBufferMemoryBarrier barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = m_readback.buffer;
+		barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+	}
+
+	void VulkanRenderer::submitFrame()
+	{
+		Frame & frame = m_frames[m_frame_index];
+		m_image_acquired = false;
+		if (m_swapchain)
+		{
+			VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, frame.image_acquired, VK_NULL_HANDLE, &m_swapchain_index);
+			m_image_acquired = result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+			// the swapchain is recreated after this frame, which is not shown.
+			if (result == VK_ERROR_OUT_OF_DATE_KHR)
+				m_swapchain_outdated = true;
+		}
+
+		if (m_image_acquired)
+		{
+			// the blit converts the frame to the format of the swapchain and scales it to a window that was resized since.
+			VkImage image = m_swapchain_images[m_swapchain_index];
+			imageBarrier(frame.commands, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+			VkImageBlit blit = {};
+			blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			blit.srcOffsets[1] = { m_width, m_height, 1 };
+			blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			blit.dstOffsets[1] = { (int32_t)m_swapchain_extent.width, (int32_t)m_swapchain_extent.height, 1 };
+			vkCmdBlitImage(frame.commands, m_target, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+			imageBarrier(frame.commands, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+		}
+		vkEndCommandBuffer(frame.commands);
+
+		VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		VkSubmitInfo submit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submit.commandBufferCount = 1;
+		submit.pCommandBuffers = &frame.commands;
+		if (m_image_acquired)
+		{
+			submit.waitSemaphoreCount = 1;
+			submit.pWaitSemaphores = &frame.image_acquired;
+			submit.pWaitDstStageMask = &wait_stage;
+			submit.signalSemaphoreCount = 1;
+			submit.pSignalSemaphores = &m_swapchain_rendered[m_swapchain_index];
+		}
+		vkResetFences(m_device, 1, &frame.done);
+		VkResult result = vkQueueSubmit(m_queue, 1, &submit, frame.done);
+		if (result != VK_SUCCESS)
+			std::cout << "Unable to submit the Vulkan frame (error " << result << ")\n";
+		m_frame_state = FRAME_SUBMITTED;
+	}
+
+	void VulkanRenderer::present()
+	{
+		if (m_frame_state == FRAME_ENDED)
+			submitFrame();
+		if (m_frame_state != FRAME_SUBMITTED)
+			return;
+
+		if (m_image_acquired)
+		{
+			VkPresentInfoKHR info = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+			info.waitSemaphoreCount = 1;
+			info.pWaitSemaphores = &m_swapchain_rendered[m_swapchain_index];
+			info.swapchainCount = 1;
+			info.pSwapchains = &m_swapchain;
+			info.pImageIndices = &m_swapchain_index;
+			VkResult result = vkQueuePresentKHR(m_queue, &info);
+			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+				m_swapchain_outdated = true;
+			m_image_acquired = false;
+		}
+		// minimized windows have no swapchain, until they are restored.
+		if (!m_offscreen_mode && (m_swapchain_outdated || !m_swapchain))
+			createSwapchain();
+
+		m_frame_index = (m_frame_index + 1) % frames_in_flight;
+		m_frame_state = FRAME_IDLE;
+		if (m_resize_pending)
+			applyResize();
+	}
+
+	bool VulkanRenderer::readPixels(std::vector<unsigned char> & pixels, int & width, int & height)
+	{
+		if (m_frame_state == FRAME_DRAWING || !m_target_drawn)
+		{
+			std::cout << "No Vulkan frame has been completed to read back\n";
+			return false;
+		}
+
+		VkDeviceSize size = (VkDeviceSize)m_width * m_height * 4;
+		if (m_readback.size < size)
+		{
+			destroyHostBuffer(m_readback);
+			if (!createHostBuffer(m_readback, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+				return false;
+			MemoryRegistry::get().track(this, MEMORY_FRAME_BUFFERS, "vulkan readback", size, 0);
+		}
+
+		if (m_frame_state == FRAME_ENDED)
+		{
+			// the copy is appended to the current frame, which is then submitted ahead of present().
+			recordReadback(m_frames[m_frame_index].commands);
+			submitFrame();
+			vkWaitForFences(m_device, 1, &m_frames[m_frame_index].done, VK_TRUE, UINT64_MAX);
+		}
+		else
+		{
+			VkCommandBuffer commands = beginOneShot();
+			recordReadback(commands);
+			endOneShot(commands);
+		}
+
+		// rows are top to bottom, as the viewport is flipped; the canvas is shown opaque.
+		width = m_width;
+		height = m_height;
+		pixels.assign(m_readback.data, m_readback.data + size);
+		for (size_t i = 3; i < pixels.size(); i += 4)
+			pixels[i] = 255;
+		return true;
+	}
+
+	bool VulkanRenderer::setOverdrawMode(bool enable)
+	{
+		if (!enable)
+			return true;
+		std::cout << "Overdraw visualization is not supported by the Vulkan renderer\n";
+		return false;
+	}
+
+	bool VulkanRenderer::getOverdrawStats(OverdrawStats &) const
+	{
+		return false;
+	}
+}
+#endif
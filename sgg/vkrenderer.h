@@ -0,0 +1,236 @@
+#pragma once
+#ifdef SGG_VULKAN
+#include <sgg/renderer.h>
+#include <vulkan/vulkan.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphics
+{
+	/** The Vulkan renderer, for lower driver overhead than OpenGL on systems with a Vulkan driver.
+
+		Each frame is recorded into the command buffer of one of frames_in_flight frame slots, so that the CPU records
+		a frame while the GPU still executes the previous one; a slot is reused once the fence of its last submission has
+		signaled. Per-draw state (transform, colors, gradient and texture mode) is passed as push constants, and every
+		texture and glyph gets a descriptor set when it is loaded, which is kept and only bound afterwards. Dynamic
+		geometry is appended to persistently mapped buffers of the frame slot.
+
+		Frames are drawn into an image owned by the renderer, which is copied to the swapchain when presented. Headless
+		windows need no surface at all, so the renderer runs without a display, e.g. on lavapipe.
+	*/
+	class VulkanRenderer : public Renderer
+	{
+		static constexpr int frames_in_flight = 2;
+		static constexpr int glyph_resolution = 64;
+		static constexpr VkDeviceSize stream_chunk_size = 1 << 20;
+		static constexpr uint32_t descriptor_pool_sets = 256;
+
+		enum { TOPOLOGY_TRIANGLES, TOPOLOGY_TRIANGLE_STRIP, TOPOLOGY_LINES, TOPOLOGY_LINE_STRIP, NUM_TOPOLOGIES };
+
+		// the command buffer of the current frame is recorded between beginFrame() and endFrame(), and submitted by present().
+		enum frame_state_t { FRAME_IDLE, FRAME_DRAWING, FRAME_ENDED, FRAME_SUBMITTED };
+
+		// a buffer in host-visible memory, mapped for as long as it exists.
+		struct HostBuffer
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			uint8_t * data = nullptr;
+		};
+
+		struct VulkanTexture
+		{
+			VkImage image = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			int width = 0,
+				height = 0;
+			size_t bytes = 0;
+		};
+
+		struct VulkanGlyph
+		{
+			VulkanTexture texture;
+			float bearing_y = 0.0f;  // in 26.6 fixed point units, as reported by FreeType.
+			float advance_y = 0.0f;
+		};
+
+		struct VulkanFont
+		{
+			std::string name;
+			size_t cache_bytes = 0;
+			FT_Face face = nullptr;
+			std::unordered_map<unsigned char, VulkanGlyph> glyphs;
+		};
+
+		struct PendingText
+		{
+			TextRecord record;
+			VulkanFont * font;
+		};
+
+		// the resources of a frame that may still be executing on the GPU while the next ones are recorded.
+		struct Frame
+		{
+			VkCommandBuffer commands = VK_NULL_HANDLE;
+			VkFence done = VK_NULL_HANDLE;
+			VkSemaphore image_acquired = VK_NULL_HANDLE;
+			std::vector<HostBuffer> stream;  // vertex chunks, rewritten from the start once the fence has signaled.
+			size_t stream_chunk = 0;
+			VkDeviceSize stream_offset = 0;
+		};
+
+		// the push constants of the shaders, in std430 layout.
+		struct DrawConstants
+		{
+			glm::mat4 transform;  // projection * modelview
+			glm::vec4 color1;
+			glm::vec4 color2;
+			glm::vec2 gradient;
+			int32_t texture_mode;  // 0: none, 1: RGBA texture, 2: glyph coverage in the red channel.
+			int32_t padding;
+		};
+
+		SDL_Window *	 m_window = nullptr;
+		bool			 m_offscreen_mode = false;
+		int				 m_width = 0,
+						 m_height = 0;
+		bool			 m_resize_pending = false;  // a resize during a frame is applied once the frame is presented.
+		int				 m_pending_width = 0,
+						 m_pending_height = 0;
+
+		VkInstance		 m_instance = VK_NULL_HANDLE;
+		VkSurfaceKHR	 m_surface = VK_NULL_HANDLE;
+		VkPhysicalDevice m_physical_device = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties m_memory_properties;
+		VkDevice		 m_device = VK_NULL_HANDLE;
+		uint32_t		 m_queue_family = 0;
+		VkQueue			 m_queue = VK_NULL_HANDLE;
+		VkCommandPool	 m_command_pool = VK_NULL_HANDLE;
+		bool			 m_wide_lines = false;
+		float			 m_line_width_range[2] = { 1.0f, 1.0f };
+		bool			 m_texture_mipmaps = false;
+
+		// the frame is drawn into m_target, which is blitted to the swapchain image when presented.
+		VkSwapchainKHR	 m_swapchain = VK_NULL_HANDLE;
+		VkExtent2D		 m_swapchain_extent = { 0, 0 };
+		std::vector<VkImage> m_swapchain_images;
+		std::vector<VkSemaphore> m_swapchain_rendered;  // one per image, as presentation may hold it past the next frame.
+		uint32_t		 m_swapchain_index = 0;
+		bool			 m_image_acquired = false;
+		bool			 m_swapchain_outdated = false;
+
+		VkImage			 m_target = VK_NULL_HANDLE;
+		VkDeviceMemory	 m_target_memory = VK_NULL_HANDLE;
+		VkImageView		 m_target_view = VK_NULL_HANDLE;
+		VkFramebuffer	 m_framebuffer = VK_NULL_HANDLE;
+		VkRenderPass	 m_render_pass = VK_NULL_HANDLE;
+		bool			 m_target_drawn = false;
+
+		VkDescriptorSetLayout m_set_layout = VK_NULL_HANDLE;
+		VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+		VkPipeline		 m_pipelines[NUM_TOPOLOGIES] = {};
+		VkSampler		 m_sampler = VK_NULL_HANDLE;
+		std::vector<VkDescriptorPool> m_descriptor_pools;
+
+		Frame			 m_frames[frames_in_flight];
+		int				 m_frame_index = 0;
+		frame_state_t	 m_frame_state = FRAME_IDLE;
+
+		HostBuffer		 m_static_vertices;  // the rectangle and its outline.
+		HostBuffer		 m_readback;
+
+		glm::mat4		 m_projection = glm::mat4(1.0f);
+		VkRect2D		 m_scissor;
+
+		// the last bound objects, to skip redundant state changes between primitives.
+		VkPipeline		 m_bound_pipeline = VK_NULL_HANDLE;
+		VkDescriptorSet	 m_bound_set = VK_NULL_HANDLE;
+		VkBuffer		 m_bound_buffer = VK_NULL_HANDLE;
+		float			 m_line_width = -1.0f;
+		std::vector<glm::vec4> m_quad_vertices;
+
+		VulkanTexture	 m_white;
+		std::unordered_map<std::string, VulkanTexture> m_textures;
+
+		FT_Library		 m_ft = nullptr;
+		std::once_flag	 m_ft_once;
+		std::atomic<bool> m_ft_ready { false };
+		bool			 m_fonts_initialized = false;
+		std::unordered_map<std::string, VulkanFont> m_fonts;
+		VulkanFont *	 m_current_font = nullptr;
+		std::vector<PendingText> m_text;
+
+		bool createInstance();
+		bool selectDevice();
+		bool createDevice();
+		bool createRenderPass();
+		bool createPipelines();
+		bool createTarget();
+		void destroyTarget();
+		void applyResize();
+		bool createSwapchain();
+		void destroySwapchain();
+
+		bool findMemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties, uint32_t & type) const;
+		bool createHostBuffer(HostBuffer & buffer, VkDeviceSize size, VkBufferUsageFlags usage);
+		void destroyHostBuffer(HostBuffer & buffer);
+		VkCommandBuffer beginOneShot();
+		void endOneShot(VkCommandBuffer commands);
+		VkDescriptorSet allocateDescriptorSet();
+		bool createTexture(VulkanTexture & texture, const uint8_t * pixels, int width, int height, VkFormat format, bool mipmaps);
+		void destroyTexture(VulkanTexture & texture);
+		const VulkanTexture * getTexture(const std::string & filename);
+		const VulkanGlyph * getGlyph(VulkanFont & font, unsigned char c);
+
+		void submitFrame();
+		void recordReadback(VkCommandBuffer commands);
+		void bindPipeline(int topology);
+		void bindTexture(const VulkanTexture * texture);
+		void setLineWidth(float width);
+		void streamVertices(const float (*vertices)[4], int count, VkBuffer & buffer, uint32_t & first);
+		void draw(int topology, const DrawConstants & constants, VkBuffer buffer, uint32_t first, uint32_t count);
+		void drawPendingText(const PendingText & text);
+
+	public:
+		renderer_t getType() const override { return RENDERER_VULKAN; }
+		Uint32 getWindowFlags(bool offscreen) const override { return offscreen ? 0 : SDL_WINDOW_VULKAN; }
+
+		bool init(SDL_Window * window, int width, int height, bool offscreen) override;
+		void release() override;
+		void makeCurrent() override {}
+		void resize(int width, int height) override;
+
+		void beginFrame(const glm::mat4 & projection, const glm::vec4 * scissor) override;
+		void drawRect(const glm::mat4 & modelview, const Brush & brush) override;
+		void drawLine(const glm::vec2 & p1, const glm::vec2 & p2, const Brush & brush) override;
+		void drawSector(const glm::mat4 & modelview, float start_angle, float end_angle, float radius1, float radius2, const Brush & brush) override;
+		void drawQuads(const glm::vec4 * quads, int count, const glm::vec4 & color) override;
+
+		bool initFontLibrary() override;
+		bool isFontLibraryReady() const override { return m_ft_ready; }
+		bool initFonts() override;
+		bool areFontsInitialized() const override { return m_fonts_initialized; }
+		bool setFont(const std::string & fontname) override;
+		void drawText(const TextRecord & text) override;
+
+		bool preloadTexture(const std::string & filename) override { return getTexture(filename) != nullptr; }
+		size_t getTextureMemory() const override;
+
+		void endFrame() override;
+		void present() override;
+		bool readPixels(std::vector<unsigned char> & pixels, int & width, int & height) override;
+
+		bool setOverdrawMode(bool enable) override;
+		bool getOverdrawStats(OverdrawStats & stats) const override;
+
+		~VulkanRenderer();
+	};
+}
+#endif
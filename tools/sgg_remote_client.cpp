@@ -0,0 +1,52 @@
+// A minimal client for out-of-process rendering: draws an animation through a renderer process
+// started with sgg_render_host, without opening a window of its own.
+//
+// usage: sgg_remote_client <socket path>
+
+#include <sgg/graphics.h>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+void draw()
+{
+	float t = graphics::getGlobalTime() / 1000.0f;
+
+	graphics::Brush br;
+	br.fill_color[0] = 0.2f;
+	br.fill_color[1] = 0.6f;
+	br.fill_color[2] = 1.0f;
+	br.outline_opacity = 0.0f;
+	graphics::setOrientation(t * 90.0f);
+	graphics::drawRect(50.0f, 50.0f, 30.0f, 30.0f, br);
+	graphics::resetPose();
+
+	br.fill_color[0] = 1.0f;
+	br.fill_color[1] = 0.5f;
+	br.fill_color[2] = 0.1f;
+	graphics::drawDisk(50.0f + 30.0f * std::cos(t), 50.0f + 30.0f * std::sin(t), 5.0f, br);
+
+	br.fill_color[0] = br.fill_color[1] = br.fill_color[2] = 1.0f;
+	graphics::drawText(5.0f, 95.0f, 5.0f, "remote client, t = " + std::to_string((int)t), br);
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <socket path>\n";
+		return 1;
+	}
+
+	if (!graphics::connectRenderer(argv[1]))
+		return 1;
+
+	graphics::Brush br;
+	br.fill_color[0] = br.fill_color[1] = br.fill_color[2] = 0.1f;
+	graphics::setWindowBackground(br);
+	graphics::setDrawFunction(draw);
+
+	graphics::startMessageLoop();
+	graphics::destroyWindow();
+	return 0;
+}
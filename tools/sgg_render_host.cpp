@@ -0,0 +1,39 @@
+// A renderer process for out-of-process rendering: opens a window and draws the frames submitted by 
+// a client connected through graphics::connectRenderer().
+//
+// usage: sgg_render_host <socket path> [canvas width] [canvas height] [asset dir]
+//
+// Clients may only load bitmaps and fonts inside the asset directory (by default, the current one).
+
+#include <sgg/graphics.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char ** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <socket path> [canvas width] [canvas height] [asset dir]\n";
+		return 1;
+	}
+
+	float canvas_width = argc > 2 ? std::stof(argv[2]) : 100.0f;
+	float canvas_height = argc > 3 ? std::stof(argv[3]) : 100.0f;
+	std::string assets = argc > 4 ? argv[4] : "";
+
+	graphics::createWindow(1024, 768, "sgg render host");
+	graphics::setCanvasSize(canvas_width, canvas_height);
+	graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
+
+	if (!graphics::startRenderServer(argv[1], assets))
+	{
+		graphics::destroyWindow();
+		return 1;
+	}
+	std::cout << "Waiting for clients on " << argv[1] << "\n";
+
+	graphics::startMessageLoop();
+	graphics::stopRenderServer();
+	graphics::destroyWindow();
+	return 0;
+}
@@ -0,0 +1,166 @@
+// Replays a draw-command capture written with graphics::startCapture() in a headless window, as fast as possible,
+// and reports the frame timings measured by the frame profiler.
+//
+// usage: sgg_replay <capture file> [--renderer opengl|vulkan|software] [--loops count] [--assets dir] [--csv file]
+//
+// --assets sets the directory the bitmap and font paths of the capture are relative to (by default, the current one).
+// --csv writes the statistics of every replayed frame to a file (relative to the directory the tool is run from).
+
+#include <bench/common.h>
+#include <sgg/graphics.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printUsage(const char * program)
+{
+	std::cout << "usage: " << program << " <capture file> [--renderer opengl|vulkan|software] [--loops count] [--assets dir] [--csv file]\n";
+}
+
+// parses a positive number, without the exceptions (and the silent truncation) of std::stoi.
+static bool parseCount(const std::string & value, unsigned int & count)
+{
+	if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+		return false;
+	unsigned long long parsed = std::strtoull(value.c_str(), nullptr, 10);
+	if (parsed == 0 || parsed > UINT_MAX)
+		return false;
+	count = (unsigned int)parsed;
+	return true;
+}
+
+static bool parseRenderer(const std::string & value, graphics::renderer_t & renderer)
+{
+	if (value == "opengl")
+		renderer = graphics::RENDERER_OPENGL;
+	else if (value == "vulkan")
+		renderer = graphics::RENDERER_VULKAN;
+	else if (value == "software")
+		renderer = graphics::RENDERER_SOFTWARE;
+	else
+		return false;
+	return true;
+}
+
+// prints the mean, median and 95th percentile of the given times, ignoring unknown (negative) ones.
+static void printTimes(const char * label, std::vector<float> times)
+{
+	times.erase(std::remove_if(times.begin(), times.end(), [](float t) { return t < 0.0f; }), times.end());
+	if (times.empty())
+	{
+		std::cout << label << ": n/a\n";
+		return;
+	}
+	std::sort(times.begin(), times.end());
+	double sum = 0.0;
+	for (float t : times)
+		sum += t;
+	std::cout << label << ": mean " << sum / times.size() << " ms, median " << times[times.size() / 2]
+		<< " ms, p95 " << times[std::min(times.size() - 1, times.size() * 95 / 100)] << " ms\n";
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 2)
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	std::string capture = std::filesystem::absolute(argv[1]).string();
+	std::string csv_file, assets;
+	graphics::renderer_t renderer = graphics::RENDERER_AUTO;
+	unsigned int loops = 1;
+	for (int i = 2; i < argc; i += 2)
+	{
+		std::string option = argv[i], value = i + 1 < argc ? argv[i + 1] : "";
+		bool valid = i + 1 < argc;
+		if (option == "--renderer")
+			valid = valid && parseRenderer(value, renderer);
+		else if (option == "--loops")
+			valid = valid && parseCount(value, loops);
+		else if (option == "--assets")
+			assets = value;
+		else if (option == "--csv")
+			csv_file = value;
+		else
+			valid = false;
+		if (!valid)
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// the output file is relative to the directory the tool was started in, not to the assets.
+	if (!csv_file.empty())
+		csv_file = std::filesystem::absolute(csv_file).string();
+	if (!assets.empty())
+	{
+		std::error_code error;
+		std::filesystem::current_path(assets, error);
+		if (error)
+		{
+			std::cout << "Unable to change to the assets directory " << assets << ": " << error.message() << "\n";
+			return 1;
+		}
+	}
+
+	graphics::CaptureInfo info;
+	if (!graphics::getCaptureInfo(capture, info))
+		return 1;
+	std::cout << capture << ": " << info.frames << " frames, " << info.window_width << "x" << info.window_height
+		<< " window, " << info.duration / 1000.0f << " s captured\n";
+
+	if (!graphics::createHeadlessWindow(info.window_width, info.window_height, renderer))
+		return 1;
+	if (!graphics::startCaptureReplay(capture, loops))
+	{
+		graphics::destroyWindow();
+		return 1;
+	}
+	// the replay ends the window loop after its last frame.
+	std::vector<graphics::FrameStats> frames = profileFrames(0);
+	// the renderer that was actually used, which may be a fallback of the requested one.
+	renderer = graphics::getRenderer();
+	graphics::destroyWindow();
+
+	std::vector<float> frame_times, draw_times, gpu_times;
+	double draw_calls = 0.0;
+	for (const graphics::FrameStats & frame : frames)
+	{
+		frame_times.push_back(frame.cpu_time[graphics::PROFILE_FRAME]);
+		draw_times.push_back(frame.cpu_time[graphics::PROFILE_DRAW]);
+		gpu_times.push_back(frame.gpu_time);
+		draw_calls += frame.draw_calls;
+	}
+
+	std::cout << "replayed " << frames.size() << " frames with the "
+		<< (renderer == graphics::RENDERER_SOFTWARE ? "software" : renderer == graphics::RENDERER_VULKAN ? "Vulkan" : "OpenGL") << " renderer\n";
+	printTimes("frame", frame_times);
+	printTimes("draw", draw_times);
+	printTimes("gpu", gpu_times);
+	if (!frames.empty())
+		std::cout << "draw calls: " << draw_calls / frames.size() << " per frame\n";
+
+	if (!csv_file.empty())
+	{
+		std::ofstream csv(csv_file);
+		if (!csv)
+		{
+			std::cout << "Unable to write " << csv_file << "\n";
+			return 1;
+		}
+		csv << "frame,frame_ms,draw_ms,text_ms,present_ms,gpu_ms,draw_calls,vertices,texture_binds,glyphs\n";
+		for (const graphics::FrameStats & frame : frames)
+			csv << frame.frame << "," << frame.cpu_time[graphics::PROFILE_FRAME] << "," << frame.cpu_time[graphics::PROFILE_DRAW] << ","
+				<< frame.cpu_time[graphics::PROFILE_TEXT] << "," << frame.cpu_time[graphics::PROFILE_PRESENT] << "," << frame.gpu_time << ","
+				<< frame.draw_calls << "," << frame.vertices << "," << frame.texture_binds << "," << frame.glyphs << "\n";
+	}
+	return 0;
+}